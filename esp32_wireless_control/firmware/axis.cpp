@@ -1,6 +1,7 @@
 #include "soc/gpio_struct.h"
 
 #include "axis.h"
+#include "metrics.h"
 #include "uart.h"
 
 #if MICROSTEPPING_MOTOR_DRIVER == USE_MSx_PINS_MICROSTEPPING
@@ -42,6 +43,7 @@ void IRAM_ATTR stepTimerRA_ISR()
     uint16_t uStep = ra_axis.getMicrostep();
     if (ra_axis_step_phase)
     {
+        metrics.countStep();
         if (ra_axis.direction.absolute ^ ra_axis.direction.tracking)
         {
             position -= MAX_MICROSTEPS / (uStep ? uStep : 1);
@@ -225,6 +227,7 @@ void Axis::gotoTarget(uint16_t microstep, uint64_t rateArg, const Position& curr
         driver->setDirection(motorDirection ^ invertDirectionPin);
 
         slewActive = true;
+        metrics.beginMotion(MOTION_GOTO);
         stepTimer.start(rateArg, true);
     }
 }
@@ -275,6 +278,7 @@ bool Axis::panByDegrees(float degrees, int speed, uint16_t microstep)
         stepTimer.stop();
         setDirection(directionTmp);
         slewActive = true;
+        metrics.beginMotion(MOTION_GOTO);
         stepTimer.start((2 * rate.tracking) / speed, true);
         print_out("Pan started: counterActive=%d, goToTarget=%d, targetCount=%lld", counterActive,
                   goToTarget, getAxisTargetCount());
@@ -302,6 +306,7 @@ void Axis::startSlew(uint64_t rate, bool directionArg)
     slewActive = true;
     setMicrostep(TRACKER_MOTOR_MICROSTEPPING / 2);
     slewTimeOut.start(12000, true);
+    metrics.beginMotion(MOTION_SLEW);
     stepTimer.start(rate, true);
 }
 
@@ -310,6 +315,7 @@ void Axis::stopSlew()
     slewActive = false;
     stepTimer.stop();
     slewTimeOut.stop();
+    metrics.endMotion();
     if (trackingActive)
     {
         requestTracking(rate.tracking, direction.tracking);
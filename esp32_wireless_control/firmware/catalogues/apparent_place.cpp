@@ -0,0 +1,167 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "apparent_place.h"
+#include "uart.h"
+
+#define ARCSEC_TO_RAD (M_PI / (180.0 * 3600.0))
+#define SKY_ANGLE_TO_RAD ((float) (2.0 * M_PI / SKY_ANGLE_TURN))
+#define RAD_TO_SKY_ANGLE ((float) (SKY_ANGLE_TURN / (2.0 * M_PI)))
+
+ApparentPlace& ApparentPlace::getInstance()
+{
+    static ApparentPlace instance;
+    return instance;
+}
+
+void ApparentPlace::setEpoch(time_t utc)
+{
+    time_t age = utc > _epoch ? utc - _epoch : _epoch - utc;
+    if (_valid && age < APPARENT_PLACE_REFRESH_S)
+        return;
+
+    computeRotation(utc);
+    _epoch = utc;
+    _valid = true;
+
+#if DEBUG == 1
+    print_out("Apparent place epoch set to %lld", (long long) utc);
+#endif
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+static long daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    long era = (year >= 0 ? year : year - 399) / 400;
+    long year_of_era = year - era * 400;
+    long day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+bool ApparentPlace::parseUtc(const String& iso_utc, time_t& utc)
+{
+    int year, month, day, hour, minute, second;
+    if (sscanf(iso_utc.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d", &year, &month, &day, &hour, &minute,
+               &second) != 6)
+        return false;
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 ||
+        second > 60)
+        return false;
+
+    // long is 32 bit on the ESP32, the days are widened first to get past 2038
+    utc = (time_t) daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
+bool ApparentPlace::setEpoch(const String& iso_utc)
+{
+    time_t utc;
+    if (!parseUtc(iso_utc, utc))
+        return false;
+    setEpoch(utc);
+    return true;
+}
+
+void ApparentPlace::computeRotation(time_t utc)
+{
+    // Julian centuries since J2000, UTC is close enough to TT here
+    double t = (utc / 86400.0 + UNIX_EPOCH_JD - J2000_JD) / DAYS_PER_CENTURY;
+
+    // Precession angles (Lieske 1977)
+    double zeta = (2306.2181 * t + 0.30188 * t * t + 0.017998 * t * t * t) * ARCSEC_TO_RAD;
+    double z = (2306.2181 * t + 1.09468 * t * t + 0.018203 * t * t * t) * ARCSEC_TO_RAD;
+    double theta = (2004.3109 * t - 0.42665 * t * t - 0.041833 * t * t * t) * ARCSEC_TO_RAD;
+
+    double cz = cos(z), sz = sin(z);
+    double ct = cos(theta), st = sin(theta);
+    double czeta = cos(zeta), szeta = sin(zeta);
+    double p[3][3] = {
+        {cz * ct * czeta - sz * szeta, -cz * ct * szeta - sz * czeta, -cz * st},
+        {sz * ct * czeta + cz * szeta, -sz * ct * szeta + cz * czeta, -sz * st},
+        {st * czeta, -st * szeta, ct},
+    };
+
+    // Nutation, largest terms of IAU 1980 (Meeus, Astronomical Algorithms, ch. 22)
+    double omega = (125.04452 - 1934.136261 * t) * DEG_TO_RAD;
+    double sun = (280.4665 + 36000.7698 * t) * DEG_TO_RAD;
+    double moon = (218.3165 + 481267.8813 * t) * DEG_TO_RAD;
+    double dpsi = (-17.20 * sin(omega) - 1.32 * sin(2 * sun) - 0.23 * sin(2 * moon) +
+                   0.21 * sin(2 * omega)) *
+                  ARCSEC_TO_RAD;
+    double deps = (9.20 * cos(omega) + 0.57 * cos(2 * sun) + 0.10 * cos(2 * moon) -
+                   0.09 * cos(2 * omega)) *
+                  ARCSEC_TO_RAD;
+    double eps =
+        (84381.448 - 46.8150 * t - 0.00059 * t * t + 0.001813 * t * t * t) * ARCSEC_TO_RAD;
+    double true_eps = eps + deps;
+
+    double cp = cos(dpsi), sp = sin(dpsi);
+    double ce = cos(eps), se = sin(eps);
+    double cte = cos(true_eps), ste = sin(true_eps);
+    double n[3][3] = {
+        {cp, -sp * ce, -sp * se},
+        {sp * cte, cp * cte * ce + ste * se, cp * cte * se - ste * ce},
+        {sp * ste, cp * ste * ce - cte * se, cp * ste * se + cte * ce},
+    };
+
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            double sum = 0.0;
+            for (int k = 0; k < 3; k++)
+                sum += n[row][k] * p[k][col];
+            _rotation[row][col] = (float) sum;
+        }
+    }
+}
+
+void ApparentPlace::apply(int32_t& ra, int32_t& dec) const
+{
+    if (!_valid)
+        return;
+
+    float v[3];
+    toVector(ra, dec, v);
+
+    float x = _rotation[0][0] * v[0] + _rotation[0][1] * v[1] + _rotation[0][2] * v[2];
+    float y = _rotation[1][0] * v[0] + _rotation[1][1] * v[1] + _rotation[1][2] * v[2];
+    float z = _rotation[2][0] * v[0] + _rotation[2][1] * v[1] + _rotation[2][2] * v[2];
+
+    int32_t ra_out = (int32_t) (atan2f(y, x) * RAD_TO_SKY_ANGLE);
+    ra = ra_out < 0 ? (int32_t) (ra_out + SKY_ANGLE_TURN) : ra_out;
+    // asin loses precision towards the poles (~4 arcsec at Polaris), atan2 does not
+    float dec_out = fabsf(z) < 0.9f ? asinf(z) : atan2f(z, sqrtf(x * x + y * y));
+    dec = (int32_t) (dec_out * RAD_TO_SKY_ANGLE);
+}
+
+void ApparentPlace::apply(StarUnifiedEntry& entry) const
+{
+    apply(entry.ra, entry.dec);
+}
+
+void ApparentPlace::apply(StarUnifiedEntry* entries, size_t count) const
+{
+    for (size_t i = 0; i < count; i++)
+        apply(entries[i].ra, entries[i].dec);
+}
+
+void ApparentPlace::toVector(int32_t ra, int32_t dec, float v[3])
+{
+    // Right ascension folded to [-pi, pi), float keeps 24 bits of the angle either way
+    float ra_rad = (ra >= SKY_ANGLE_TURN / 2 ? ra - SKY_ANGLE_TURN : ra) * SKY_ANGLE_TO_RAD;
+    float dec_rad = dec * SKY_ANGLE_TO_RAD;
+    float cos_dec = cosf(dec_rad);
+    v[0] = cos_dec * cosf(ra_rad);
+    v[1] = cos_dec * sinf(ra_rad);
+    v[2] = sinf(dec_rad);
+}
+
+void ApparentPlace::getRotation(float rotation[3][3]) const
+{
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 3; col++)
+            rotation[row][col] = _rotation[row][col];
+}
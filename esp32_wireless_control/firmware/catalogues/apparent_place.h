@@ -0,0 +1,102 @@
+/**
+ * @file apparent_place.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef APPARENT_PLACE_H
+#define APPARENT_PLACE_H
+
+#include <Arduino.h>
+#include <time.h>
+
+#include "star_database_interface.h"
+
+// The cached rotation is recomputed once the epoch moved by more than this.
+// Precession is ~50 arcsec per year, so one hour is far below any error
+// that matters for pointing.
+#define APPARENT_PLACE_REFRESH_S 3600
+
+#define UNIX_EPOCH_JD 2440587.5
+#define J2000_JD 2451545.0
+#define DAYS_PER_CENTURY 36525.0
+
+/**
+ * @brief Converts J2000 catalogue coordinates to the apparent (true
+ * equator and equinox of date) place the mount has to point at
+ *
+ * Precession (IAU 1976) and nutation (the four largest IAU 1980 terms, good
+ * to ~0.5 arcsec) are combined into one rotation matrix. The matrix is
+ * computed in double precision when the epoch is set and only refreshed
+ * every APPARENT_PLACE_REFRESH_S seconds, converting a position is a
+ * single precision matrix-vector product on fixed point input and output.
+ * The float math adds less than 0.1 arcsec at any position (the catalogues
+ * are quantized to 0.08 arcsec), the host harness checks this against a
+ * double precision reference. Annual
+ * aberration and proper motion are not applied.
+ *
+ * The device has no clock of its own, the epoch comes from the time the web
+ * interface sends. Used from the web server task only.
+ */
+class ApparentPlace
+{
+  public:
+    static ApparentPlace& getInstance();
+
+    /**
+     * @brief Set the observation time
+     * @param utc Unix time in seconds (UTC)
+     */
+    void setEpoch(time_t utc);
+
+    /**
+     * @brief Set the observation time from an ISO 8601 UTC timestamp
+     * @param iso_utc e.g. "2025-11-16T10:30:00.000Z" as sent by the web interface
+     * @return false if the timestamp could not be parsed, the epoch is unchanged then
+     */
+    bool setEpoch(const String& iso_utc);
+
+    /**
+     * @brief Parse an ISO 8601 UTC timestamp as sent by the web interface
+     * @return false if the timestamp could not be parsed
+     */
+    static bool parseUtc(const String& iso_utc, time_t& utc);
+
+    bool isValid() const
+    {
+        return _valid;
+    }
+    time_t getEpoch() const
+    {
+        return _epoch;
+    }
+
+    // J2000 to apparent place in SKY_ANGLE_TURN units, no-op as long as no epoch was set
+    void apply(int32_t& ra, int32_t& dec) const;
+    void apply(StarUnifiedEntry& entry) const;
+    void apply(StarUnifiedEntry* entries, size_t count) const;
+
+    // The rotation in use, J2000 to date
+    void getRotation(float rotation[3][3]) const;
+
+    // Unit vector of a position in SKY_ANGLE_TURN units, single precision
+    static void toVector(int32_t ra, int32_t dec, float v[3]);
+
+  private:
+    ApparentPlace() : _valid(false), _epoch(0)
+    {
+    }
+
+    ApparentPlace(const ApparentPlace&) = delete;
+    ApparentPlace& operator=(const ApparentPlace&) = delete;
+
+    void computeRotation(time_t utc);
+
+    bool _valid;
+    time_t _epoch;
+    float _rotation[3][3]; // Nutation * precession, J2000 to true of date
+};
+
+#endif // APPARENT_PLACE_H
@@ -3,8 +3,13 @@ import json
 import struct
 import os
 import re
+import sys
 import argparse
 
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+from catalogue_blob import (write_catalogue_blob, turns_from_radians, COL_MAG, COL_NAME,
+                            COL_SPECTRAL)
+
 def parse_bsc5_header(f):
     """Parse the 28-byte BSC5 header according to specification"""
     header_data = f.read(28)
@@ -120,15 +125,61 @@ def parse_names(names_path):
                 names[star_id].append(line.strip())
     return names
 
+def parse_designations(designations_path):
+    """Parse sources/designations.dat, Bayer and Flamsteed designations by HR number"""
+    designations = {}
+    if not os.path.exists(designations_path):
+        return designations
+
+    with open(designations_path, encoding="utf-8") as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            star_id, designation = line.split('|', 1)
+            designations.setdefault(int(star_id), []).append(designation.strip())
+    return designations
+
+# Lower-case words allowed inside a proper name ("Nair al Zaurak", "Star of Arcady")
+NAME_PARTICLES = {'al', 'el', 'ar', 'as', 'ash', 'ad', 'az', 'er', 'of', 'the'}
+
+def parse_other_names(name_line):
+    """Further proper names of a star from its ybsc5.names line ("ALPHERATZ; Alpherat; Sirrah")"""
+    other_names = []
+    for part in name_line.split(';')[1:]:
+        # A sentence or a remark after the name ends it
+        part = re.split(r'[.,(]', part, 1)[0].strip()
+        words = part.split()
+        if not words or len(part) > 32 or not words[0][0].isupper():
+            continue
+        if all(re.match(r"[A-Z][A-Za-z'-]*$", word) or word in NAME_PARTICLES for word in words):
+            other_names.append(part)
+    return other_names
+
+def star_aliases(star_id, name_line, name, designations):
+    """Other designations of a star for the alias index of the binary catalogue"""
+    aliases = [f"HR {star_id}"]
+    flamsteed = re.match(r"(\d+ [A-Z][A-Za-z]{2})\b", name)
+    if flamsteed:
+        aliases.append(flamsteed.group(1))
+    aliases.extend(parse_other_names(name_line))
+    aliases.extend(designations.get(star_id, []))
+    return aliases
+
 def main():
     # Parse command line arguments
     parser = argparse.ArgumentParser(description='Convert BSC5 catalog to JSON or binary format')
     parser.add_argument('--binary', action='store_true',
-                       help='Write output as binary file (default: JSON)')
+                       help='Write block-compressed binary catalogue, full and compact (default: JSON)')
     parser.add_argument('--compact', action='store_true',
                        help='Generate compact format (reduced fields)')
     args = parser.parse_args()
 
+    # One binary blob serves both the full and the compact catalogue
+    if args.binary and args.compact:
+        print("Note: the binary catalogue always contains the compact projection, ignoring --compact")
+        args.compact = False
+
     # Determine base directory
     base = os.environ.get('PROJECT_DIR')
     if base is None:
@@ -139,6 +190,7 @@ def main():
     # Parse notes and names
     notes = parse_notes(os.path.join(base, "sources/ybsc5.notes"))
     names = parse_names(os.path.join(base, "sources/ybsc5.names"))
+    designations = parse_designations(os.path.join(base, "sources/designations.dat"))
 
     # Parse binary catalog
     bsc5_path = os.path.join(base, "sources/BSC5ra.bsc5")
@@ -241,6 +293,7 @@ def main():
             format_type = "compact" if args.compact else "full"
 
         # Apply format-specific length limits
+        fits_compact = len(name_entry) <= 32
         if args.compact:
             # Drop objects with names that still exceed 32 characters after clipping
             if len(name_entry) > 32:
@@ -268,6 +321,9 @@ def main():
             "mag": star_entry.get('mag', 0),
             "name": name_entry,
         }
+        if args.binary:
+            star["compact"] = fits_compact
+            star["aliases"] = star_aliases(idx, original_name, name_entry, designations)
 
         # Add additional fields for full format only
         if not args.compact:
@@ -291,43 +347,23 @@ def main():
     # Output files based on format
 
     if args.binary:
-        suffix = "_compact" if args.compact else ""
-        out_path = os.path.join(base, f"converted/bsc5ra{suffix}.bin")
-        def write_binary_format(stars, output_path, compact_format):
-            with open(output_path, 'wb') as f:
-                # Write header: number of stars (uint32), magic, version
-                f.write(struct.pack('<I', len(stars)))
-                if compact_format:
-                    f.write(b'BSC5RC')  # BSC5 Revised Compact
-                else:
-                    f.write(b'BSC5RA')  # BSC5 Revised All
-                f.write(struct.pack('<I', 1))
-                
-                for star in stars:
-                    # RA, Dec (float64)
-                    f.write(struct.pack('<d', star['sra0']))
-                    f.write(struct.pack('<d', star['sdec0']))
-                    # Magnitude (float32)
-                    f.write(struct.pack('<f', float(star.get('mag', 0.0))))
-                    
-                    if compact_format:
-                        # Compact: only name (length-prefixed string, max 32)
-                        name_bytes = star.get('name', '').encode('utf-8')
-                        f.write(struct.pack('<B', min(len(name_bytes), 32)))
-                        f.write(name_bytes[:32])
-                    else:
-                        # Full format: spectral type, name (no notes in binary)
-                        # Spectral type (2 bytes, padded)
-                        spec = star.get('spectral_type', '')[:2].ljust(2, '\0')
-                        f.write(spec.encode('ascii'))
-                        # Name (length-prefixed string, max 255)
-                        name_bytes = star.get('name', '').encode('utf-8')
-                        f.write(struct.pack('<B', min(len(name_bytes), 255)))
-                        f.write(name_bytes[:255])
-        write_binary_format(stars, out_path, args.compact)
+        out_path = os.path.join(base, "converted/bsc5ra.bin")
+        records = []
+        for star in stars:
+            records.append({
+                'compact': star['compact'],
+                'ra': turns_from_radians(star['sra0'], wrap=True),
+                'dec': turns_from_radians(star['sdec0'], wrap=False),
+                'mag': float(star.get('mag', 0.0)),
+                'name': star.get('name', ''),
+                'spectral': star.get('spectral_type', '')[:2],
+                'aliases': star['aliases'],
+            })
+        stats = write_catalogue_blob(records, out_path, b'BSC5', [COL_MAG, COL_NAME, COL_SPECTRAL])
         file_size = os.path.getsize(out_path)
-        print(f"Successfully wrote {len(stars)} stars to {out_path}")
-        print(f"Output format: binary, file size: {file_size:,} bytes")
+        print(f"Successfully wrote {len(stars)} stars ({stats['compact_records']} compact) to {out_path}")
+        print(f"Output format: binary, {stats['blocks']} blocks, {stats['aliases']} aliases, "
+              f"file size: {file_size:,} bytes")
     else:
         suffix = "_compact" if args.compact else ""
         out_path = os.path.join(base, f"converted/bsc5ra{suffix}.json")
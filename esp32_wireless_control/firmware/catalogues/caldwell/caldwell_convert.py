@@ -0,0 +1,32 @@
+#!/usr/bin/env python3
+"""
+Caldwell catalogue to JSON/Binary converter
+
+The list in sources/caldwell.dat is resolved against NGC 2000.0, see
+../object_list.py. One blob serves the catalogue, there is no compact
+projection.
+"""
+
+import argparse
+import os
+import sys
+
+BASE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(BASE, '..'))
+from object_list import convert_object_list
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert the Caldwell catalogue to JSON/Binary format')
+    parser.add_argument('--input', default='sources/caldwell.dat',
+                        help='Object list (default: sources/caldwell.dat)')
+    parser.add_argument('--binary', action='store_true',
+                        help='Generate the block-compressed binary catalogue instead of JSON')
+    args = parser.parse_args()
+
+    convert_object_list(os.path.join(BASE, args.input), b'CALD',
+                        os.path.join(BASE, 'converted', 'caldwell'), args.binary)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,187 @@
+#include <string.h>
+#include <strings.h>
+
+#include "catalogue_attribute_query.h"
+#include "catalogue_page_cache.h"
+
+// Blob column decoded into each scan column
+static const CatalogueColumn scan_sources[] = {COL_FLAGS, COL_MAG, COL_SIZE, COL_TYPE,
+                                               COL_CONSTELLATION};
+
+CatalogueAttributeQuery::CatalogueAttributeQuery()
+    : type(nullptr), constellation(nullptr), mag_min(INT16_MIN), mag_max(INT16_MAX), size_min(0),
+      size_max(UINT16_MAX)
+{
+}
+
+CatalogueAttributeScan::CatalogueAttributeScan(const CatalogueBlob& blob, bool compact,
+                                               const CatalogueAttributeQuery& query)
+    : _blob(blob), _compact(compact), _query(query), _match_type(false),
+      _match_constellation(false), _empty(false), _type(0), _constellation(0)
+{
+    _match_type = query.type != nullptr && query.type[0] != '\0';
+    _match_constellation = query.constellation != nullptr && query.constellation[0] != '\0';
+    if (_match_type && !resolve(COL_TYPE, query.type, _type))
+        _empty = true;
+    if (_match_constellation && !resolve(COL_CONSTELLATION, query.constellation, _constellation))
+        _empty = true;
+    if (query.mag_min > query.mag_max || query.size_min > query.size_max)
+        _empty = true;
+}
+
+bool CatalogueAttributeScan::resolve(CatalogueColumn column, const char* text,
+                                     int32_t& offset) const
+{
+    if (!_blob.isOpen() || !_blob.hasColumn(column))
+        return false;
+
+    // Values repeat from record to record, the first blocks nearly always hold the one searched
+    int32_t last = -1;
+    for (size_t block = 0; block < _blob.getBlockCount(); block++)
+    {
+        CatalogueColumnReader readers[COL_COUNT];
+        uint8_t count;
+        if (!_blob.getColumns(block, readers, count))
+            return false;
+        for (uint8_t i = 0; i < count; i++)
+        {
+            int32_t value;
+            if (!readers[column].next(value))
+                return false;
+            if (value == last)
+                continue;
+            last = value;
+            if (strcasecmp(_blob.getString((uint32_t) value), text) == 0)
+            {
+                offset = value;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void CatalogueAttributeScan::compare(const int32_t values[][CATALOGUE_SCAN_CHUNK], size_t count,
+                                     uint8_t match[CATALOGUE_SCAN_CHUNK]) const
+{
+    // One condition per loop, plain integer compares the compiler can vectorize
+    const int32_t* flags = values[SCAN_FLAGS];
+    int32_t projection = _compact ? CATALOGUE_FLAG_COMPACT : 0;
+    for (size_t i = 0; i < count; i++)
+        match[i] = (flags[i] & projection) == projection;
+
+    if (_match_type)
+    {
+        const int32_t* type = values[SCAN_TYPE];
+        for (size_t i = 0; i < count; i++)
+            match[i] &= type[i] == _type;
+    }
+    if (_match_constellation)
+    {
+        const int32_t* constellation = values[SCAN_CONSTELLATION];
+        for (size_t i = 0; i < count; i++)
+            match[i] &= constellation[i] == _constellation;
+    }
+    if (_query.hasMagnitude())
+    {
+        const int32_t* mag = values[SCAN_MAG];
+        int32_t low = _query.mag_min;
+        int32_t high = _query.mag_max;
+        for (size_t i = 0; i < count; i++)
+            match[i] &= (mag[i] != 0) & (mag[i] >= low) & (mag[i] <= high);
+    }
+    if (_query.hasSize())
+    {
+        const int32_t* size = values[SCAN_SIZE];
+        int32_t low = _query.size_min;
+        int32_t high = _query.size_max;
+        for (size_t i = 0; i < count; i++)
+            match[i] &= (size[i] != 0) & (size[i] >= low) & (size[i] <= high);
+    }
+}
+
+size_t CatalogueAttributeScan::run(size_t offset, size_t limit, CatalogueRecordVisitor& visitor,
+                                   size_t& total) const
+{
+    return scan(0, offset, limit, visitor, total, true);
+}
+
+size_t CatalogueAttributeScan::runAfter(size_t after, size_t limit,
+                                        CatalogueRecordVisitor& visitor) const
+{
+    size_t total = 0;
+    return scan(after + 1, 0, limit, visitor, total, false);
+}
+
+size_t CatalogueAttributeScan::scan(size_t first, size_t offset, size_t limit,
+                                    CatalogueRecordVisitor& visitor, size_t& total,
+                                    bool count_all) const
+{
+    total = 0;
+    size_t first_block = 0;
+    size_t first_index;
+    if (!_blob.isOpen() || _empty ||
+        (first > 0 && !_blob.findBlock(first, _compact, first_block, first_index)))
+        return 0;
+
+    // Columns of conditions not in the query are never decoded
+    bool needed[SCAN_COUNT] = {true, _query.hasMagnitude(), _query.hasSize(), _match_type,
+                               _match_constellation};
+    CatalogueFilter filter;
+    filter.mag_min = _query.mag_min;
+    filter.mag_max = _query.mag_max;
+
+    int32_t values[SCAN_COUNT][CATALOGUE_SCAN_CHUNK];
+    uint8_t match[CATALOGUE_SCAN_CHUNK];
+    size_t visited = 0;
+    bool visiting = limit > 0;
+    for (size_t block = _blob.findMatchingBlock(first_block, filter);
+         block < _blob.getBlockCount(); block = _blob.findMatchingBlock(block + 1, filter))
+    {
+        CatalogueColumnReader readers[COL_COUNT];
+        uint8_t count;
+        if (!_blob.getColumns(block, readers, count))
+            return visited;
+
+        // Projection index of the first record of the block
+        size_t index = _compact ? _blob.getCompactBefore(block) : block * _blob.getBlockSize();
+        for (size_t start = 0; start < count; start += CATALOGUE_SCAN_CHUNK)
+        {
+            size_t chunk = count - start < CATALOGUE_SCAN_CHUNK ? count - start
+                                                                : CATALOGUE_SCAN_CHUNK;
+            for (int column = 0; column < SCAN_COUNT; column++)
+            {
+                if (!needed[column])
+                    continue;
+                CatalogueColumnReader& reader = readers[scan_sources[column]];
+                for (size_t i = 0; i < chunk; i++)
+                {
+                    if (!reader.next(values[column][i]))
+                        return visited;
+                }
+            }
+            compare(values, chunk, match);
+
+            for (size_t i = 0; i < chunk; i++)
+            {
+                if (_compact && (values[SCAN_FLAGS][i] & CATALOGUE_FLAG_COMPACT) == 0)
+                    continue;
+                size_t record_index = index++;
+                if (!match[i] || record_index < first || total++ < offset || !visiting)
+                    continue;
+
+                // Only the records of the page are decoded in full
+                CatalogueRecord record;
+                if (!CataloguePageCache::getInstance().getRecord(_blob, _compact, record_index,
+                                                                 record))
+                    return visited;
+                visited++;
+                if (!visitor.visit(record_index, record) || visited == limit)
+                    visiting = false;
+                if (!visiting && !count_all)
+                    return visited;
+            }
+        }
+    }
+    return visited;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file catalogue_attribute_query.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef CATALOGUE_ATTRIBUTE_QUERY_H
+#define CATALOGUE_ATTRIBUTE_QUERY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "catalogue_blob.h"
+
+// Records decoded per pass of the comparison loops, sets the stack use of a scan
+#define CATALOGUE_SCAN_CHUNK 32
+
+/**
+ * @brief Conditions of an attribute query, the default query matches every record
+ *
+ * Type and constellation are compared case-insensitively with the catalogue
+ * spelling ("Gx", "Leo"). With a magnitude or size bound, records without a
+ * magnitude or size are left out.
+ */
+struct CatalogueAttributeQuery
+{
+    const char* type;          // nullptr or "" for any type
+    const char* constellation; // nullptr or "" for any constellation
+    int16_t mag_min;           // Hundredths of a magnitude
+    int16_t mag_max;
+    uint16_t size_min; // Tenths of an arcminute
+    uint16_t size_max;
+
+    CatalogueAttributeQuery();
+
+    bool hasMagnitude() const
+    {
+        return mag_min != INT16_MIN || mag_max != INT16_MAX;
+    }
+    bool hasSize() const
+    {
+        return size_min != 0 || size_max != UINT16_MAX;
+    }
+};
+
+/**
+ * @brief Counts and pages the records of a catalogue projection by attributes
+ *
+ * Type and constellation are resolved once to their offset in the string
+ * table (strings are deduplicated), so a record is compared by integers
+ * only. The scan decodes just the columns the query needs, CATALOGUE_SCAN_CHUNK
+ * records at a time into small arrays, and runs one branch-free loop per
+ * condition over them that the compiler can vectorize. Blocks ruled out by
+ * their magnitude statistics are skipped without decoding. Only the records
+ * of the requested page are decoded in full (through CataloguePageCache).
+ * Nothing is allocated.
+ */
+class CatalogueAttributeScan
+{
+  public:
+    CatalogueAttributeScan(const CatalogueBlob& blob, bool compact,
+                           const CatalogueAttributeQuery& query);
+
+    /**
+     * @brief Count all matches and visit up to limit of them from position offset on
+     * @param total Number of records matching the query
+     * @return Number of records visited, in index order
+     */
+    size_t run(size_t offset, size_t limit, CatalogueRecordVisitor& visitor, size_t& total) const;
+
+    /**
+     * @brief Visit up to limit matches following the record at index after
+     *
+     * Continues a page where the visitor stopped it. The scan starts at the
+     * block holding the next record and ends with the visits, the other
+     * matches are not counted.
+     * @return Number of records visited, in index order
+     */
+    size_t runAfter(size_t after, size_t limit, CatalogueRecordVisitor& visitor) const;
+
+  private:
+    // Visit matches from record index first on, with count_all the scan goes on to count them all
+    size_t scan(size_t first, size_t offset, size_t limit, CatalogueRecordVisitor& visitor,
+                size_t& total, bool count_all) const;
+    // Offset of the first value of a string column equal to text, false if none is
+    bool resolve(CatalogueColumn column, const char* text, int32_t& offset) const;
+    // Marks the records of a chunk that match in match[]
+    void compare(const int32_t values[][CATALOGUE_SCAN_CHUNK], size_t count,
+                 uint8_t match[CATALOGUE_SCAN_CHUNK]) const;
+
+    // Decoded columns of a chunk, in this order
+    enum ScanColumn
+    {
+        SCAN_FLAGS = 0,
+        SCAN_MAG,
+        SCAN_SIZE,
+        SCAN_TYPE,
+        SCAN_CONSTELLATION,
+        SCAN_COUNT
+    };
+
+    const CatalogueBlob& _blob;
+    bool _compact;
+    CatalogueAttributeQuery _query;
+    // Strings resolved to table offsets, a string missing from the catalogue matches nothing
+    bool _match_type;
+    bool _match_constellation;
+    bool _empty;
+    int32_t _type;
+    int32_t _constellation;
+};
+
+#endif // CATALOGUE_ATTRIBUTE_QUERY_H
@@ -0,0 +1,825 @@
+#include <ctype.h>
+#include <string.h>
+
+#include "catalogue_blob.h"
+#include "star_database.h"
+#include "uart.h"
+
+#define CATALOGUE_MAGIC "OGCB"
+#define CATALOGUE_VERSION 2
+#define CATALOGUE_HEADER_SIZE 40
+#define CATALOGUE_INDEX_ENTRY_SIZE 24
+#define CATALOGUE_NAME_INDEX_ENTRY_SIZE 6
+#define CATALOGUE_ALIAS_INDEX_ENTRY_SIZE 9
+#define CATALOGUE_HEADER_FLAG_ALIASES 0x0001
+#define CATALOGUE_COLUMN_HEADER_SIZE 3
+
+#define CATALOGUE_REQUIRED_COLUMNS ((1 << COL_FLAGS) | (1 << COL_RA) | (1 << COL_DEC))
+
+// The blob has no alignment guarantees, always read byte-wise
+static uint16_t readU16(const uint8_t* p)
+{
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t readU32(const uint8_t* p)
+{
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) |
+           ((uint32_t) p[3] << 24);
+}
+
+static uint32_t readU24(const uint8_t* p)
+{
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16);
+}
+
+static int32_t readI24(const uint8_t* p)
+{
+    uint32_t value = readU24(p);
+    if (value & 0x800000)
+        value |= 0xFF000000;
+    return (int32_t) value;
+}
+
+static inline bool readVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value)
+{
+    // Single byte values are by far the most common
+    if (p < end && (*p & 0x80) == 0)
+    {
+        value = *p++;
+        return true;
+    }
+
+    value = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7)
+    {
+        uint8_t byte = *p++;
+        value |= (uint32_t) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+    return (int32_t) (value >> 1) ^ -(int32_t) (value & 1);
+}
+
+// FNV-1a of the ASCII lower-case name folded to 24 bits, see name_hash() in catalogue_blob.py
+static uint32_t nameHash(const char* name)
+{
+    uint32_t hash = 0x811C9DC5;
+    for (; *name != '\0'; name++)
+    {
+        uint8_t c = (uint8_t) *name;
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        hash = (hash ^ c) * 0x01000193;
+    }
+    return (hash >> 24) ^ (hash & 0xFFFFFF);
+}
+
+// First entry with the hash in a hash index sorted by hash, the hash is the
+// uint24 at the start of each entry
+static size_t findFirstHash(const uint8_t* entries, size_t count, size_t entry_size,
+                            uint32_t hash)
+{
+    size_t low = 0;
+    size_t high = count;
+    while (low < high)
+    {
+        size_t mid = (low + high) / 2;
+        if (readU24(entries + mid * entry_size) < hash)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+// Whole words replaced in designation keys, see DESIGNATION_WORDS in catalogue_blob.py
+static const char* const designation_words[][2] = {
+    {"alpha", "alf"},   {"beta", "bet"},    {"gamma", "gam"},   {"delta", "del"},
+    {"epsilon", "eps"}, {"zeta", "zet"},    {"theta", "the"},   {"iota", "iot"},
+    {"kappa", "kap"},   {"lambda", "lam"},  {"omicron", "omi"}, {"sigma", "sig"},
+    {"upsilon", "ups"}, {"omega", "ome"},   {"messier", "m"},   {"caldwell", "c"},
+    {"bs", "hr"},       {"bsc", "hr"},
+};
+
+static bool isDesignationDigit(uint8_t c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Bytes of UTF-8 sequences count as letters, they are kept as they are
+static bool isDesignationLetter(uint8_t c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+
+static bool appendKey(char* key, size_t size, size_t& len, const char* text, size_t count)
+{
+    if (len + count >= size)
+        return false;
+    memcpy(key + len, text, count);
+    len += count;
+    key[len] = '\0';
+    return true;
+}
+
+bool catalogueDesignationKey(const char* text, char* key, size_t size)
+{
+    const uint8_t* p = (const uint8_t*) text;
+    size_t len = 0;
+    while (*p != '\0')
+    {
+        if (isDesignationDigit(*p))
+        {
+            const uint8_t* end = p;
+            while (isDesignationDigit(*end))
+                end++;
+            // Leading zeros are dropped, a zero on its own is kept
+            while (p + 1 < end && *p == '0')
+                p++;
+            if (!appendKey(key, size, len, (const char*) p, end - p))
+                return false;
+            p = end;
+        }
+        else if (isDesignationLetter(*p))
+        {
+            // Longer words do not fit any key
+            char word[CATALOGUE_DESIGNATION_KEY_SIZE];
+            size_t word_len = 0;
+            for (; isDesignationLetter(*p); p++)
+            {
+                if (word_len + 1 >= sizeof(word))
+                    return false;
+                word[word_len++] = (char) (*p >= 'A' && *p <= 'Z' ? *p + ('a' - 'A') : *p);
+            }
+            word[word_len] = '\0';
+
+            const char* replacement = word;
+            for (size_t i = 0; i < sizeof(designation_words) / sizeof(designation_words[0]); i++)
+            {
+                if (strcmp(word, designation_words[i][0]) == 0)
+                {
+                    replacement = designation_words[i][1];
+                    break;
+                }
+            }
+            if (!appendKey(key, size, len, replacement, strlen(replacement)))
+                return false;
+        }
+        else
+        {
+            p++;
+        }
+    }
+    return len > 0;
+}
+
+CatalogueFilter::CatalogueFilter()
+    : ra_min(0), ra_max(CATALOGUE_TURN - 1), dec_min(-CATALOGUE_TURN / 4),
+      dec_max(CATALOGUE_TURN / 4), mag_min(INT16_MIN), mag_max(INT16_MAX)
+{
+}
+
+bool CatalogueFilter::matches(const CatalogueRecord& record) const
+{
+    bool ra = ra_min <= ra_max ? record.ra >= ra_min && record.ra <= ra_max
+                               : record.ra >= ra_min || record.ra <= ra_max;
+    return ra && record.dec >= dec_min && record.dec <= dec_max && record.mag_centi >= mag_min &&
+           record.mag_centi <= mag_max;
+}
+
+bool CatalogueFilter::mayMatch(const CatalogueBlockStats& stats) const
+{
+    bool ra = ra_min <= ra_max ? stats.ra_max >= ra_min && stats.ra_min <= ra_max
+                               : stats.ra_max >= ra_min || stats.ra_min <= ra_max;
+    return ra && stats.dec_max >= dec_min && stats.dec_min <= dec_max &&
+           stats.mag_max >= mag_min && stats.mag_min <= mag_max;
+}
+
+uint16_t CatalogueFilter::getColumns() const
+{
+    uint16_t columns = 0;
+    if (ra_min != 0 || ra_max != CATALOGUE_TURN - 1)
+        columns |= 1 << COL_RA;
+    if (dec_min != -CATALOGUE_TURN / 4 || dec_max != CATALOGUE_TURN / 4)
+        columns |= 1 << COL_DEC;
+    if (mag_min != INT16_MIN || mag_max != INT16_MAX)
+        columns |= 1 << COL_MAG;
+    return columns;
+}
+
+CatalogueNamePredicate::CatalogueNamePredicate(const char* search, bool fragment)
+    : _search(search), _fragment(fragment), _first(tolower((unsigned char) search[0]))
+{
+}
+
+bool CatalogueNamePredicate::matches(const CatalogueRecord& record) const
+{
+    // Reject on the first character before the full comparison
+    if (_fragment)
+        return catalogueNameContains(record.name, SIZE_MAX, _search);
+    return tolower((unsigned char) record.name[0]) == _first &&
+           catalogueNameEquals(record.name, SIZE_MAX, _search);
+}
+
+// Stops a visit at the first record
+struct CatalogueFirstMatch : public CatalogueRecordVisitor
+{
+    size_t index = 0;
+
+    bool visit(size_t record_index, const CatalogueRecord& record) override
+    {
+        (void) record;
+        index = record_index;
+        return false;
+    }
+};
+
+bool CatalogueColumnReader::next(int32_t& out)
+{
+    if (encoding == CATALOGUE_ENC_CONSTANT)
+    {
+        out = value;
+        return true;
+    }
+
+    uint32_t raw;
+    if (!readVarint(pos, end, raw))
+        return false;
+    if (encoding == CATALOGUE_ENC_DELTA && !first)
+        value += unzigzag(raw);
+    else
+        value = unzigzag(raw);
+    first = false;
+    out = value;
+    return true;
+}
+
+CatalogueBlob::CatalogueBlob()
+    : _data(nullptr), _len(0), _block_size(0), _column_mask(0), _record_count(0),
+      _compact_count(0), _block_count(0), _string_offset(0), _string_size(0),
+      _name_index_offset(0), _alias_index_offset(0), _alias_count(0)
+{
+}
+
+bool CatalogueBlob::open(const uint8_t* data, size_t len, const char* tag)
+{
+    close();
+
+    if (data == nullptr || len < CATALOGUE_HEADER_SIZE)
+    {
+        print_out("Error: Catalogue data too small for header");
+        return false;
+    }
+    if (memcmp(data, CATALOGUE_MAGIC, 4) != 0 || memcmp(data + 4, tag, 4) != 0)
+    {
+        print_out("Error: Invalid catalogue magic, expected %s", tag);
+        return false;
+    }
+    if (readU16(data + 8) != CATALOGUE_VERSION)
+    {
+        print_out("Error: Unsupported catalogue version %u", readU16(data + 8));
+        return false;
+    }
+
+    uint16_t block_size = readU16(data + 10);
+    uint16_t column_mask = readU16(data + 12);
+    uint32_t record_count = readU32(data + 16);
+    uint32_t compact_count = readU32(data + 20);
+    uint32_t block_count = readU32(data + 24);
+    uint32_t string_offset = readU32(data + 28);
+    uint32_t string_size = readU32(data + 32);
+    uint32_t name_index_offset = readU32(data + 36);
+
+    // Never trust the header beyond the data we actually have
+    bool valid = block_size > 0 && block_size <= 255 &&
+                 (column_mask & CATALOGUE_REQUIRED_COLUMNS) == CATALOGUE_REQUIRED_COLUMNS &&
+                 compact_count <= record_count &&
+                 block_count == (record_count + block_size - 1) / block_size &&
+                 CATALOGUE_HEADER_SIZE + (size_t) block_count * CATALOGUE_INDEX_ENTRY_SIZE <=
+                     string_offset &&
+                 string_size > 0 && (size_t) string_offset + string_size <= len &&
+                 data[string_offset + string_size - 1] == '\0' &&
+                 (name_index_offset == 0 ||
+                  (name_index_offset >= (size_t) string_offset + string_size &&
+                   name_index_offset + (size_t) record_count * CATALOGUE_NAME_INDEX_ENTRY_SIZE <=
+                       len));
+
+    // The alias index follows the name index, or the string table without one
+    uint32_t alias_index_offset = 0;
+    uint32_t alias_count = 0;
+    if (valid && (readU16(data + 14) & CATALOGUE_HEADER_FLAG_ALIASES) != 0)
+    {
+        alias_index_offset =
+            name_index_offset != 0
+                ? name_index_offset + record_count * CATALOGUE_NAME_INDEX_ENTRY_SIZE
+                : string_offset + string_size;
+        valid = (size_t) alias_index_offset + 4 <= len;
+        if (valid)
+        {
+            alias_count = readU32(data + alias_index_offset);
+            valid = alias_count <=
+                    (len - alias_index_offset - 4) / CATALOGUE_ALIAS_INDEX_ENTRY_SIZE;
+        }
+    }
+    if (!valid)
+    {
+        print_out("Error: Corrupt catalogue header");
+        return false;
+    }
+
+    _data = data;
+    _len = len;
+    _block_size = block_size;
+    _column_mask = column_mask;
+    _record_count = record_count;
+    _compact_count = compact_count;
+    _block_count = block_count;
+    _string_offset = string_offset;
+    _string_size = string_size;
+    _name_index_offset = name_index_offset;
+    _alias_index_offset = alias_index_offset;
+    _alias_count = alias_count;
+    return true;
+}
+
+void CatalogueBlob::close()
+{
+    _data = nullptr;
+    _len = 0;
+    _record_count = 0;
+    _compact_count = 0;
+    _block_count = 0;
+    _name_index_offset = 0;
+    _alias_index_offset = 0;
+    _alias_count = 0;
+}
+
+const uint8_t* CatalogueBlob::getBlock(size_t block) const
+{
+    if (block >= _block_count)
+        return nullptr;
+
+    uint32_t offset = readU32(_data + CATALOGUE_HEADER_SIZE + block * CATALOGUE_INDEX_ENTRY_SIZE);
+    if (offset < CATALOGUE_HEADER_SIZE + _block_count * CATALOGUE_INDEX_ENTRY_SIZE ||
+        offset >= _string_offset)
+        return nullptr;
+    return _data + offset;
+}
+
+size_t CatalogueBlob::getCompactBefore(size_t block) const
+{
+    return readU32(_data + CATALOGUE_HEADER_SIZE + block * CATALOGUE_INDEX_ENTRY_SIZE + 4);
+}
+
+bool CatalogueBlob::findBlock(size_t index, bool compact, size_t& block, size_t& first_index) const
+{
+    if (index >= getRecordCount(compact))
+        return false;
+
+    if (!compact)
+    {
+        block = index / _block_size;
+        first_index = block * _block_size;
+        return true;
+    }
+
+    // Last block whose preceding compact count is <= index
+    size_t low = 0;
+    size_t high = _block_count;
+    while (high - low > 1)
+    {
+        size_t mid = (low + high) / 2;
+        if (getCompactBefore(mid) <= index)
+            low = mid;
+        else
+            high = mid;
+    }
+    block = low;
+    first_index = getCompactBefore(block);
+    return true;
+}
+
+bool CatalogueBlob::getBlockStats(size_t block, CatalogueBlockStats& stats) const
+{
+    if (block >= _block_count)
+        return false;
+
+    const uint8_t* p = _data + CATALOGUE_HEADER_SIZE + block * CATALOGUE_INDEX_ENTRY_SIZE + 8;
+    stats.ra_min = (int32_t) readU24(p);
+    stats.ra_max = (int32_t) readU24(p + 3);
+    stats.dec_min = readI24(p + 6);
+    stats.dec_max = readI24(p + 9);
+    stats.mag_min = (int16_t) readU16(p + 12);
+    stats.mag_max = (int16_t) readU16(p + 14);
+    return true;
+}
+
+size_t CatalogueBlob::findMatchingBlock(size_t block, const CatalogueFilter& filter) const
+{
+    CatalogueBlockStats stats;
+    for (; block < _block_count; block++)
+    {
+        if (getBlockStats(block, stats) && filter.mayMatch(stats))
+            return block;
+    }
+    return _block_count;
+}
+
+bool CatalogueBlob::getColumns(size_t block, CatalogueColumnReader readers[COL_COUNT],
+                               uint8_t& count) const
+{
+    const uint8_t* p = getBlock(block);
+    if (p == nullptr)
+        return false;
+
+    const uint8_t* limit = _data + _string_offset;
+    count = *p++;
+
+    // Encoding and length of every present column
+    const uint8_t* column_data = p;
+    for (int column = 0; column < COL_COUNT; column++)
+    {
+        if (_column_mask & (1 << column))
+            column_data += CATALOGUE_COLUMN_HEADER_SIZE;
+    }
+    if (count == 0 || column_data > limit)
+        return false;
+
+    for (int column = 0; column < COL_COUNT; column++)
+    {
+        CatalogueColumnReader& reader = readers[column];
+        reader.first = true;
+        reader.value = 0;
+
+        // Missing columns read as a constant 0
+        if ((_column_mask & (1 << column)) == 0)
+        {
+            reader.encoding = CATALOGUE_ENC_CONSTANT;
+            reader.pos = column_data;
+            reader.end = column_data;
+            continue;
+        }
+
+        reader.encoding = p[0];
+        reader.pos = column_data;
+        reader.end = column_data + readU16(p + 1);
+        column_data = reader.end;
+        p += CATALOGUE_COLUMN_HEADER_SIZE;
+        if (column_data > limit || reader.encoding > CATALOGUE_ENC_CONSTANT)
+            return false;
+
+        if (reader.encoding == CATALOGUE_ENC_CONSTANT)
+        {
+            uint32_t raw;
+            if (!readVarint(reader.pos, reader.end, raw))
+                return false;
+            reader.value = unzigzag(raw);
+        }
+    }
+    return true;
+}
+
+bool CatalogueBlob::findName(const char* search, bool fragment, bool compact, size_t& index) const
+{
+    if (!isOpen() || !hasColumn(COL_NAME))
+        return false;
+
+    if (!fragment && hasNameIndex())
+        return findIndexedName(search, compact, index);
+
+    // Without an index, or for a fragment, the first match of a scan over the names
+    CatalogueNamePredicate predicate(search, fragment);
+    CatalogueFirstMatch first;
+    if (visit(compact, CatalogueFilter(), 1 << COL_NAME, &predicate, first) == 0)
+        return false;
+    index = first.index;
+    return true;
+}
+
+size_t CatalogueBlob::visit(bool compact, const CatalogueFilter& filter, uint16_t columns,
+                            const CatalogueRecordPredicate* predicate,
+                            CatalogueRecordVisitor& visitor) const
+{
+    if (!isOpen())
+        return 0;
+
+    // Name scans take a tight loop, a filter matching everything is not checked per record
+    uint16_t filter_columns = filter.getColumns();
+    if (filter_columns == 0 && (columns & ~(1 << COL_FLAGS)) == (1 << COL_NAME) &&
+        hasColumn(COL_NAME))
+        return visitNames(compact, predicate, visitor);
+
+    CatalogueCursor cursor(*this, compact, columns | filter_columns);
+    CatalogueRecord record;
+    size_t visited = 0;
+    while (filter_columns != 0 ? cursor.next(record, filter) : cursor.next(record))
+    {
+        if (predicate != nullptr && !predicate->matches(record))
+            continue;
+        visited++;
+        if (!visitor.visit(cursor.index(), record))
+            break;
+    }
+    return visited;
+}
+
+bool CatalogueBlob::findIndexedName(const char* search, bool compact, size_t& index) const
+{
+    const uint8_t* entries = _data + _name_index_offset;
+    uint32_t hash = nameHash(search);
+
+    // Entries of one hash are in record order
+    size_t low = findFirstHash(entries, _record_count, CATALOGUE_NAME_INDEX_ENTRY_SIZE, hash);
+    for (; low < _record_count; low++)
+    {
+        const uint8_t* entry = entries + low * CATALOGUE_NAME_INDEX_ENTRY_SIZE;
+        if (readU24(entry) != hash)
+            break;
+
+        // Different names can share a hash, compare the name itself
+        size_t record = readU24(entry + 3);
+        uint8_t flags;
+        const char* name;
+        if (!readName(record, flags, name))
+            return false;
+        if (compact && (flags & CATALOGUE_FLAG_COMPACT) == 0)
+            continue;
+        if (catalogueNameEquals(name, SIZE_MAX, search))
+            return getProjectedIndex(record, compact, index);
+    }
+    return false;
+}
+
+bool CatalogueBlob::findAlias(const char* key, bool compact, size_t& index) const
+{
+    if (!isOpen() || !hasAliasIndex() || !hasColumn(COL_NAME))
+        return false;
+
+    const uint8_t* entries = _data + _alias_index_offset + 4;
+    uint32_t hash = nameHash(key);
+
+    // Entries of one hash are in record order, the first record with the alias wins
+    size_t low = findFirstHash(entries, _alias_count, CATALOGUE_ALIAS_INDEX_ENTRY_SIZE, hash);
+    for (; low < _alias_count; low++)
+    {
+        const uint8_t* entry = entries + low * CATALOGUE_ALIAS_INDEX_ENTRY_SIZE;
+        if (readU24(entry) != hash)
+            break;
+        // Keys are stored normalized, compare them byte by byte
+        if (strcmp(getString(readU24(entry + 6)), key) != 0)
+            continue;
+
+        size_t record = readU24(entry + 3);
+        uint8_t flags;
+        const char* name;
+        if (!readName(record, flags, name))
+            return false;
+        if (compact && (flags & CATALOGUE_FLAG_COMPACT) == 0)
+            continue;
+        return getProjectedIndex(record, compact, index);
+    }
+    return false;
+}
+
+size_t CatalogueBlob::visitNames(bool compact, const CatalogueRecordPredicate* predicate,
+                                 CatalogueRecordVisitor& visitor) const
+{
+    // Tight loop over the flags and name columns only, this is the hot
+    // path of name scans so it does not go through a CatalogueCursor
+    CatalogueRecord record;
+    memset(&record, 0, sizeof(record));
+    record.type = record.constellation = record.spectral = record.description = "";
+
+    size_t projected = 0;
+    size_t visited = 0;
+    for (size_t block = 0; block < _block_count; block++)
+    {
+        CatalogueColumnReader readers[COL_COUNT];
+        uint8_t count;
+        if (!getColumns(block, readers, count))
+            return visited;
+
+        for (uint8_t i = 0; i < count; i++)
+        {
+            int32_t flags;
+            int32_t offset;
+            if (!readers[COL_FLAGS].next(flags) || !readers[COL_NAME].next(offset))
+                return visited;
+            if (compact && (flags & CATALOGUE_FLAG_COMPACT) == 0)
+                continue;
+
+            record.flags = (uint8_t) flags;
+            record.name = getString((uint32_t) offset);
+            size_t index = projected++;
+            if (predicate != nullptr && !predicate->matches(record))
+                continue;
+            visited++;
+            if (!visitor.visit(index, record))
+                return visited;
+        }
+    }
+    return visited;
+}
+
+bool CatalogueBlob::readName(size_t record, uint8_t& flags, const char*& name) const
+{
+    CatalogueColumnReader readers[COL_COUNT];
+    uint8_t count;
+    size_t block = record / _block_size;
+    if (record >= _record_count || !getColumns(block, readers, count))
+        return false;
+
+    int32_t flags_value;
+    int32_t offset;
+    for (size_t i = block * _block_size; i <= record; i++)
+    {
+        if (!readers[COL_FLAGS].next(flags_value) || !readers[COL_NAME].next(offset))
+            return false;
+    }
+    flags = (uint8_t) flags_value;
+    name = getString((uint32_t) offset);
+    return true;
+}
+
+bool CatalogueBlob::getProjectedIndex(size_t record, bool compact, size_t& index) const
+{
+    if (!compact)
+    {
+        index = record;
+        return true;
+    }
+
+    // Count the compact records of the block in front of the record
+    CatalogueColumnReader readers[COL_COUNT];
+    uint8_t count;
+    size_t block = record / _block_size;
+    if (!getColumns(block, readers, count))
+        return false;
+
+    index = getCompactBefore(block);
+    for (size_t i = block * _block_size; i < record; i++)
+    {
+        int32_t flags;
+        if (!readers[COL_FLAGS].next(flags))
+            return false;
+        if (flags & CATALOGUE_FLAG_COMPACT)
+            index++;
+    }
+    return true;
+}
+
+const char* CatalogueBlob::getString(uint32_t offset) const
+{
+    if (offset >= _string_size)
+        return "";
+    return reinterpret_cast<const char*>(_data + _string_offset + offset);
+}
+
+CatalogueCursor::CatalogueCursor(const CatalogueBlob& blob, bool compact, uint16_t columns)
+    : _blob(blob), _compact(compact), _columns(columns & blob._column_mask), _block(0),
+      _remaining(0), _block_start(false), _index(0)
+{
+    seek(0);
+}
+
+bool CatalogueCursor::seek(size_t index)
+{
+    _remaining = 0;
+    _block = _blob._block_count;
+
+    size_t block;
+    size_t first_index;
+    if (!_blob.findBlock(index, _compact, block, first_index) || !openBlock(block))
+        return false;
+
+    // Records inside a block are delta-encoded, decode up to the target
+    CatalogueRecord skipped;
+    while (_index < index)
+    {
+        if (!next(skipped))
+            return false;
+    }
+    return true;
+}
+
+bool CatalogueCursor::next(CatalogueRecord& record)
+{
+    for (;;)
+    {
+        if (_remaining == 0)
+        {
+            if (_block + 1 >= _blob._block_count || !openBlock(_block + 1))
+                return false;
+        }
+
+        if (!decodeRecord(record))
+        {
+            _remaining = 0;
+            _block = _blob._block_count;
+            return false;
+        }
+        _remaining--;
+
+        if (!_compact || (record.flags & CATALOGUE_FLAG_COMPACT))
+        {
+            _index++;
+            return true;
+        }
+    }
+}
+
+bool CatalogueCursor::next(CatalogueRecord& record, const CatalogueFilter& filter)
+{
+    for (;;)
+    {
+        // Jump over blocks that cannot hold a match before decoding anything
+        if (_remaining == 0 || _block_start)
+        {
+            size_t block = _blob.findMatchingBlock(_remaining == 0 ? _block + 1 : _block, filter);
+            if (block >= _blob._block_count)
+            {
+                _remaining = 0;
+                _block = _blob._block_count;
+                return false;
+            }
+            if ((block != _block || _remaining == 0) && !openBlock(block))
+                return false;
+            _block_start = false;
+        }
+
+        if (!next(record))
+            return false;
+        if (filter.matches(record))
+            return true;
+    }
+}
+
+bool CatalogueCursor::openBlock(size_t block)
+{
+    uint8_t count;
+    if (!_blob.getColumns(block, _readers, count))
+        return false;
+
+    _block = block;
+    _remaining = count;
+    _block_start = true;
+    _index = _compact ? _blob.getCompactBefore(block) : block * _blob._block_size;
+    return true;
+}
+
+bool CatalogueCursor::decodeString(int column, const char*& target)
+{
+    int32_t offset;
+    target = "";
+    if ((_columns & (1 << column)) == 0)
+        return true;
+    if (!_readers[column].next(offset))
+        return false;
+    target = _blob.getString((uint32_t) offset);
+    return true;
+}
+
+bool CatalogueCursor::decodeRecord(CatalogueRecord& record)
+{
+    int32_t value;
+
+    _block_start = false;
+    if (!_readers[COL_FLAGS].next(value))
+        return false;
+    record.flags = (uint8_t) value;
+
+    record.ra = 0;
+    record.dec = 0;
+    if (_columns & ((1 << COL_RA) | (1 << COL_DEC)))
+    {
+        if (!_readers[COL_RA].next(record.ra) || !_readers[COL_DEC].next(record.dec))
+            return false;
+    }
+
+    record.mag_centi = 0;
+    if (_columns & (1 << COL_MAG))
+    {
+        if (!_readers[COL_MAG].next(value))
+            return false;
+        record.mag_centi = (int16_t) value;
+    }
+
+    record.size_decimin = 0;
+    if (_columns & (1 << COL_SIZE))
+    {
+        if (!_readers[COL_SIZE].next(value))
+            return false;
+        record.size_decimin = (uint16_t) value;
+    }
+
+    return decodeString(COL_NAME, record.name) && decodeString(COL_TYPE, record.type) &&
+           decodeString(COL_CONSTELLATION, record.constellation) &&
+           decodeString(COL_SPECTRAL, record.spectral) &&
+           decodeString(COL_DESCRIPTION, record.description);
+}
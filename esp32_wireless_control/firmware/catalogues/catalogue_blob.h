@@ -0,0 +1,356 @@
+/**
+ * @file catalogue_blob.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef CATALOGUE_BLOB_H
+#define CATALOGUE_BLOB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Block-compressed columnar catalogue ("OGCB"), written by catalogue_blob.py.
+// See catalogue_blob.py for the byte layout.
+
+// Column ids, also the bit positions in the header column mask.
+// The order is part of the format.
+enum CatalogueColumn
+{
+    COL_FLAGS = 0,
+    COL_RA,
+    COL_DEC,
+    COL_MAG,
+    COL_SIZE,
+    COL_NAME,
+    COL_TYPE,
+    COL_CONSTELLATION,
+    COL_SPECTRAL,
+    COL_DESCRIPTION,
+    COL_COUNT
+};
+
+#define CATALOGUE_FLAG_COMPACT 0x01
+
+// Buffer size of a designation key, see catalogueDesignationKey()
+#define CATALOGUE_DESIGNATION_KEY_SIZE 33
+#define CATALOGUE_COLUMNS_ALL ((uint16_t) ((1 << COL_COUNT) - 1))
+
+// Coordinates are quantized to 1/2^24 of a turn (~0.077 arcsec)
+#define CATALOGUE_TURN (1L << 24)
+
+// Column encodings, chosen per block and column by the writer
+#define CATALOGUE_ENC_PLAIN 0
+#define CATALOGUE_ENC_DELTA 1
+#define CATALOGUE_ENC_CONSTANT 2
+
+// Decoded record, plain data only. Strings point into the string table in
+// flash and are never null, missing columns decode to 0 or "".
+struct CatalogueRecord
+{
+    int32_t ra;            // [0, CATALOGUE_TURN)
+    int32_t dec;           // [-CATALOGUE_TURN / 4, CATALOGUE_TURN / 4]
+    int16_t mag_centi;     // Hundredths of a magnitude
+    uint16_t size_decimin; // Tenths of an arcminute
+    uint8_t flags;
+    const char* name;
+    const char* type;
+    const char* constellation;
+    const char* spectral;
+    const char* description;
+
+    float magnitude() const
+    {
+        return mag_centi / 100.0f;
+    }
+    float sizeArcmin() const
+    {
+        return size_decimin / 10.0f;
+    }
+};
+
+// Smallest and largest values of one block, stored in the block index
+struct CatalogueBlockStats
+{
+    int32_t ra_min;
+    int32_t ra_max;
+    int32_t dec_min;
+    int32_t dec_max;
+    int16_t mag_min;
+    int16_t mag_max;
+};
+
+/**
+ * @brief Position and magnitude window of a catalogue query
+ *
+ * Blocks whose statistics do not overlap the window are skipped without
+ * decoding them. The default filter matches every record.
+ */
+struct CatalogueFilter
+{
+    // RA window, wraps through 0 when ra_min > ra_max
+    int32_t ra_min;
+    int32_t ra_max;
+    int32_t dec_min;
+    int32_t dec_max;
+    int16_t mag_min;
+    int16_t mag_max;
+
+    CatalogueFilter();
+
+    bool matches(const CatalogueRecord& record) const;
+    bool mayMatch(const CatalogueBlockStats& stats) const;
+    // Columns matches() reads, none for the default filter
+    uint16_t getColumns() const;
+};
+
+// Selects records of a visit beyond the filter, runs on every record the
+// filter lets through so it should be cheap
+class CatalogueRecordPredicate
+{
+  public:
+    virtual ~CatalogueRecordPredicate()
+    {
+    }
+    virtual bool matches(const CatalogueRecord& record) const = 0;
+};
+
+// Receives the records of a visit one at a time, return false to stop
+class CatalogueRecordVisitor
+{
+  public:
+    virtual ~CatalogueRecordVisitor()
+    {
+    }
+    virtual bool visit(size_t index, const CatalogueRecord& record) = 0;
+};
+
+// Case-insensitive match of the whole name or a fragment of it, needs COL_NAME
+class CatalogueNamePredicate : public CatalogueRecordPredicate
+{
+  public:
+    CatalogueNamePredicate(const char* search, bool fragment);
+    bool matches(const CatalogueRecord& record) const override;
+
+  private:
+    const char* _search;
+    bool _fragment;
+    int _first;
+};
+
+/**
+ * @brief Normalized form of a designation or common name, for alias lookups
+ *
+ * Letters are lower-cased, numbers lose their leading zeros, Greek letter
+ * names become the Bayer abbreviations and "Messier"/"Caldwell"/"BS" the
+ * catalogue prefixes, everything between words is dropped: "M 031" is
+ * "m31", "Alpha Ori" is "alfori". Same as designation_key() of
+ * catalogue_blob.py, which writes the alias keys.
+ * @param size At least CATALOGUE_DESIGNATION_KEY_SIZE for every key to fit
+ * @return false if nothing is left or the key does not fit
+ */
+bool catalogueDesignationKey(const char* text, char* key, size_t size);
+
+// Decoder of one column of one block
+struct CatalogueColumnReader
+{
+    const uint8_t* pos;
+    const uint8_t* end;
+    uint8_t encoding;
+    bool first;
+    int32_t value;
+
+    bool next(int32_t& out);
+};
+
+/**
+ * @brief Read-only view of a catalogue blob in flash
+ *
+ * Only the header is parsed, blocks are decoded on demand with a
+ * CatalogueCursor. Holds no mutable state after open(). Exact name lookups
+ * use the name index of the blob (binary search over name hashes), so they
+ * stay fast for catalogues with 100k+ records. Other designations and
+ * common names are looked up the same way in the alias index.
+ */
+class CatalogueBlob
+{
+  public:
+    CatalogueBlob();
+
+    /**
+     * @brief Validate the header and block index
+     * @param tag Expected 4-byte catalogue tag, e.g. "NGC2"
+     */
+    bool open(const uint8_t* data, size_t len, const char* tag);
+    void close();
+    bool isOpen() const
+    {
+        return _data != nullptr;
+    }
+
+    // Number of records in the full or the compact projection
+    size_t getRecordCount(bool compact) const
+    {
+        return compact ? _compact_count : _record_count;
+    }
+    size_t getBlockCount() const
+    {
+        return _block_count;
+    }
+    size_t getBlockSize() const
+    {
+        return _block_size;
+    }
+    bool hasColumn(CatalogueColumn column) const
+    {
+        return (_column_mask & (1 << column)) != 0;
+    }
+    bool hasNameIndex() const
+    {
+        return _name_index_offset != 0;
+    }
+    bool hasAliasIndex() const
+    {
+        return _alias_count != 0;
+    }
+    const uint8_t* getData() const
+    {
+        return _data;
+    }
+    size_t getDataSize() const
+    {
+        return _len;
+    }
+
+    /**
+     * @brief Find the block holding a record of a projection
+     * @param first_index Projection index of the first record of the block
+     *   (for the compact projection: of the first compact record in it)
+     * @return false if index is out of range
+     */
+    bool findBlock(size_t index, bool compact, size_t& block, size_t& first_index) const;
+
+    bool getBlockStats(size_t block, CatalogueBlockStats& stats) const;
+
+    /**
+     * @brief First block from block on that may hold a record matching the filter
+     * @return getBlockCount() if there is none
+     */
+    size_t findMatchingBlock(size_t block, const CatalogueFilter& filter) const;
+
+    /**
+     * @brief Find the first record whose name matches (case-insensitive)
+     * @param fragment Match substrings instead of the whole name
+     * @param index Projection index of the match, see CatalogueCursor::seek()
+     */
+    bool findName(const char* search, bool fragment, bool compact, size_t& index) const;
+
+    /**
+     * @brief Find the first record with an alias (other designation or common name)
+     * @param key Designation key, see catalogueDesignationKey()
+     * @param index Projection index of the record, see CatalogueCursor::seek()
+     */
+    bool findAlias(const char* key, bool compact, size_t& index) const;
+
+    /**
+     * @brief Visit the records of a projection matching a filter and a predicate
+     *
+     * Records are decoded one by one into a CatalogueRecord on the stack,
+     * its strings point into the blob. Nothing is allocated. Blocks ruled
+     * out by the filter are skipped without decoding them.
+     * @param columns Columns the predicate and the visitor read, the columns
+     *   of the filter are added
+     * @param predicate nullptr accepts every record of the filter
+     * @return Number of records visited, in index order
+     */
+    size_t visit(bool compact, const CatalogueFilter& filter, uint16_t columns,
+                 const CatalogueRecordPredicate* predicate, CatalogueRecordVisitor& visitor) const;
+
+  private:
+    friend class CatalogueAttributeScan;
+    friend class CatalogueCursor;
+
+    const uint8_t* getBlock(size_t block) const;
+    bool getColumns(size_t block, CatalogueColumnReader readers[COL_COUNT], uint8_t& count) const;
+    size_t getCompactBefore(size_t block) const;
+    const char* getString(uint32_t offset) const;
+
+    bool findIndexedName(const char* search, bool compact, size_t& index) const;
+    size_t visitNames(bool compact, const CatalogueRecordPredicate* predicate,
+                      CatalogueRecordVisitor& visitor) const;
+    // Flags and name of a record of the full projection
+    bool readName(size_t record, uint8_t& flags, const char*& name) const;
+    bool getProjectedIndex(size_t record, bool compact, size_t& index) const;
+
+    const uint8_t* _data;
+    size_t _len;
+    uint16_t _block_size;
+    uint16_t _column_mask;
+    uint32_t _record_count;
+    uint32_t _compact_count;
+    uint32_t _block_count;
+    uint32_t _string_offset;
+    uint32_t _string_size;
+    uint32_t _name_index_offset;
+    uint32_t _alias_index_offset;
+    uint32_t _alias_count;
+};
+
+/**
+ * @brief Streaming decoder over one projection of a CatalogueBlob
+ *
+ * Decodes record by record without buffering a block. Columns not in the
+ * requested mask are skipped. Cursors are cheap stack objects, use one per
+ * search.
+ */
+class CatalogueCursor
+{
+  public:
+    CatalogueCursor(const CatalogueBlob& blob, bool compact,
+                    uint16_t columns = CATALOGUE_COLUMNS_ALL);
+
+    /**
+     * @brief Position the cursor so that next() returns the record at index
+     * @return false if index is out of range
+     */
+    bool seek(size_t index);
+
+    /**
+     * @brief Decode the next record of the projection
+     * @return false at the end of the catalogue or on corrupt data
+     */
+    bool next(CatalogueRecord& record);
+
+    /**
+     * @brief Decode the next record matching the filter
+     * @note Blocks ruled out by their statistics are skipped without decoding
+     */
+    bool next(CatalogueRecord& record, const CatalogueFilter& filter);
+
+    // Projection index of the record last returned by next()
+    size_t index() const
+    {
+        return _index - 1;
+    }
+
+  private:
+    bool openBlock(size_t block);
+    bool decodeRecord(CatalogueRecord& record);
+    bool decodeString(int column, const char*& target);
+
+    const CatalogueBlob& _blob;
+    bool _compact;
+    uint16_t _columns;
+
+    size_t _block;
+    uint8_t _remaining;
+    // No record of the current block decoded yet
+    bool _block_start;
+    size_t _index;
+
+    CatalogueColumnReader _readers[COL_COUNT];
+};
+
+#endif // CATALOGUE_BLOB_H
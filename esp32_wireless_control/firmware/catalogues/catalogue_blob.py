@@ -0,0 +1,453 @@
+#!/usr/bin/env python3
+"""
+Block-compressed columnar catalogue writer (OGCB format)
+
+Shared by the NGC and BSC5 converters. One blob holds every record of a
+catalogue, the compact projection is a flag on each record, so the full and
+the compact catalogue are served from the same data.
+
+Layout (all integers little-endian):
+
+  Header (40 bytes)
+     0  char[4]  magic "OGCB"
+     4  char[4]  catalogue tag, e.g. "NGC2" or "BSC5"
+     8  uint16   format version
+    10  uint16   records per block
+    12  uint16   column mask, bit n set if column n is present
+    14  uint16   flags, bit 0: an alias index follows the name index
+    16  uint32   record count
+    20  uint32   compact record count
+    24  uint32   block count
+    28  uint32   string table offset
+    32  uint32   string table size
+    36  uint32   name index offset, 0 if the blob has no name index
+
+  Block index (24 bytes per block)
+     uint32  block offset from the start of the blob
+     uint32  compact records in all preceding blocks
+     uint24  smallest RA in the block     uint24  largest RA
+     int24   smallest Dec                 int24   largest Dec
+     int16   smallest magnitude           int16   largest magnitude (0 without magnitudes)
+
+  Block
+     uint8   record count
+     per present column, in column order: uint8 encoding, uint16 byte length
+     column data, in column order
+
+  String table
+     null-terminated UTF-8 strings, deduplicated, offset 0 is "",
+     all names first in record order
+
+  Name index (6 bytes per record, sorted by hash, then record number)
+     uint24  hash of the lower-case name (see name_hash())
+     uint24  record number in the full projection
+
+  Alias index (only with header flag bit 0), directly after the name index,
+  or after the string table if there is none
+     uint32  entry count
+     entries (9 bytes each), sorted by hash, then record number
+       uint24  hash of the alias key (see name_hash())
+       uint24  record number in the full projection
+       uint24  string table offset of the alias key
+
+  Alias keys are other designations and common names of a record in the form
+  of designation_key(), e.g. "m31" or "alfori" for a record named "NGC224"
+  or "BETELGEUSE". Keys are at most DESIGNATION_KEY_MAX bytes.
+
+Column values are integers, every column of every block picks the smallest
+of these encodings:
+  0  plain     zigzag varint per record
+  1  delta     zigzag varint of the first value, then zigzag varint deltas
+  2  constant  one zigzag varint, the value of every record in the block
+
+Column values:
+  flags        bit 0: record is part of the compact projection
+  ra, dec      quantized to 1/2^24 of a turn (~0.077 arcsec)
+  magnitude    hundredths of a magnitude
+  size         tenths of an arcminute
+  strings      byte offset into the string table
+"""
+
+import re
+import struct
+
+MAGIC = b'OGCB'
+VERSION = 2
+HEADER_SIZE = 40
+BLOCK_INDEX_ENTRY_SIZE = 24
+NAME_INDEX_ENTRY_SIZE = 6
+ALIAS_INDEX_ENTRY_SIZE = 9
+DESIGNATION_KEY_MAX = 32
+
+HEADER_FLAG_ALIASES = 0x0001
+DEFAULT_BLOCK_SIZE = 32
+
+FLAG_COMPACT = 0x01
+
+ENC_PLAIN = 0
+ENC_DELTA = 1
+ENC_CONSTANT = 2
+
+# Column order is part of the format, keep in sync with catalogue_blob.h
+COL_FLAGS = 0
+COL_RA = 1
+COL_DEC = 2
+COL_MAG = 3
+COL_SIZE = 4
+COL_NAME = 5
+COL_TYPE = 6
+COL_CONSTELLATION = 7
+COL_SPECTRAL = 8
+COL_DESCRIPTION = 9
+COLUMN_COUNT = 10
+
+STRING_COLUMNS = {
+    COL_NAME: 'name',
+    COL_TYPE: 'type',
+    COL_CONSTELLATION: 'constellation',
+    COL_SPECTRAL: 'spectral',
+    COL_DESCRIPTION: 'description',
+}
+
+TURN = 1 << 24
+
+
+def turns_from_hours(hours):
+    return int(round(hours / 24.0 * TURN)) % TURN
+
+
+def turns_from_degrees(degrees):
+    return int(round(degrees / 360.0 * TURN))
+
+
+def turns_from_radians(radians, wrap):
+    value = int(round(radians / (2.0 * 3.141592653589793) * TURN))
+    return value % TURN if wrap else value
+
+
+def _varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def _zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def _int24(value):
+    return struct.pack('<i', value)[:3]
+
+
+def name_hash(name):
+    """FNV-1a of the ASCII lower-case name folded to 24 bits, matches catalogue_blob.cpp"""
+    value = 0x811C9DC5
+    for byte in name.encode('utf-8'):
+        if 0x41 <= byte <= 0x5A:
+            byte += 0x20
+        value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return (value >> 24) ^ (value & 0xFFFFFF)
+
+
+# Whole words replaced by designation_key(), keep in sync with catalogue_blob.cpp
+DESIGNATION_WORDS = {
+    'alpha': 'alf', 'beta': 'bet', 'gamma': 'gam', 'delta': 'del', 'epsilon': 'eps',
+    'zeta': 'zet', 'theta': 'the', 'iota': 'iot', 'kappa': 'kap', 'lambda': 'lam',
+    'omicron': 'omi', 'sigma': 'sig', 'upsilon': 'ups', 'omega': 'ome',
+    'messier': 'm', 'caldwell': 'c', 'bs': 'hr', 'bsc': 'hr',
+}
+
+# Generic last words of common names, "Crab Nebula" is also found as "Crab"
+_GENERIC_WORDS = {'galaxy', 'nebula', 'nebulae', 'cluster', 'planetary'}
+
+
+def designation_key(text):
+    """
+    Normalized form of a designation or common name, matches catalogue_blob.cpp
+
+    Letters are lower-cased, numbers lose their leading zeros, Greek letter
+    names become the Bayer abbreviations and "Messier"/"Caldwell"/"BS" the
+    catalogue prefixes. Everything else between words is dropped:
+    "M 031" -> "m31", "Alpha Ori" -> "alfori", "Barnard's Galaxy" -> "barnardsgalaxy".
+    Returns None if nothing is left or the key is longer than DESIGNATION_KEY_MAX.
+    """
+    key = ''
+    for word in re.findall(r'[A-Za-z\u0080-\U0010ffff]+|[0-9]+', text):
+        if '0' <= word[0] <= '9':
+            key += word.lstrip('0') or '0'
+        else:
+            # ASCII only, like the firmware
+            word = ''.join(c.lower() if 'A' <= c <= 'Z' else c for c in word)
+            key += DESIGNATION_WORDS.get(word, word)
+    if not key or len(key.encode('utf-8')) > DESIGNATION_KEY_MAX:
+        return None
+    return key
+
+
+def common_name_aliases(name):
+    """Common name and its short forms ("Crab Nebula": "Crab", "Great Nebula in Orion": "Orion")"""
+    aliases = [name]
+    words = name.split()
+    if len(words) > 1 and words[-1].lower() in _GENERIC_WORDS:
+        aliases.append(' '.join(words[:-1]))
+    match = re.match(r'(?:great\s+)?(?:nebula|galaxy|cluster)\s+in\s+(\S.*)$', name, re.IGNORECASE)
+    if match:
+        aliases.append(match.group(1))
+    return aliases
+
+
+def _encode_column(values):
+    """Smallest encoding of one column of a block, as (encoding, data)"""
+    if all(value == values[0] for value in values):
+        return ENC_CONSTANT, _varint(_zigzag(values[0]))
+
+    plain = b''.join(_varint(_zigzag(value)) for value in values)
+    delta = bytearray(_varint(_zigzag(values[0])))
+    for prev, value in zip(values, values[1:]):
+        delta += _varint(_zigzag(value - prev))
+    if len(delta) < len(plain):
+        return ENC_DELTA, bytes(delta)
+    return ENC_PLAIN, plain
+
+
+class StringTable:
+    """Deduplicated null-terminated string table addressed by byte offset"""
+
+    def __init__(self):
+        self._data = bytearray(b'\0')
+        self._offsets = {'': 0}
+
+    def add(self, text):
+        text = text or ''
+        if text not in self._offsets:
+            self._offsets[text] = len(self._data)
+            self._data += text.encode('utf-8') + b'\0'
+        return self._offsets[text]
+
+    def data(self):
+        return bytes(self._data)
+
+
+def _record_values(rec, columns, strings):
+    values = [0] * COLUMN_COUNT
+    values[COL_FLAGS] = FLAG_COMPACT if rec.get('compact') else 0
+    values[COL_RA] = rec['ra']
+    values[COL_DEC] = rec['dec']
+    values[COL_MAG] = int(round((rec.get('mag') or 0.0) * 100))
+    values[COL_SIZE] = max(0, int(round((rec.get('size') or 0.0) * 10)))
+    for col, key in STRING_COLUMNS.items():
+        if col in columns:
+            values[col] = strings.add(rec.get(key, ''))
+    return values
+
+
+def _encode_block(records, columns, strings):
+    """Encode one block, returns the block data and its index statistics"""
+    rows = [_record_values(rec, columns, strings) for rec in records]
+
+    header = bytearray(struct.pack('<B', len(records)))
+    data = bytearray()
+    for col in columns:
+        encoding, column_data = _encode_column([row[col] for row in rows])
+        if len(column_data) > 0xFFFF:
+            raise ValueError(f"Column {col} too large for one block, lower the block size")
+        header += struct.pack('<BH', encoding, len(column_data))
+        data += column_data
+
+    mags = [row[COL_MAG] for row in rows] if COL_MAG in columns else [0]
+    stats = (_int24(min(row[COL_RA] for row in rows)) + _int24(max(row[COL_RA] for row in rows)) +
+             _int24(min(row[COL_DEC] for row in rows)) + _int24(max(row[COL_DEC] for row in rows)) +
+             struct.pack('<hh', min(mags), max(mags)))
+    return bytes(header + data), stats
+
+
+def write_catalogue_blob(records, output_path, tag, columns, block_size=DEFAULT_BLOCK_SIZE,
+                         name_index_enabled=True):
+    """
+    Write records to an OGCB blob.
+
+    records: list of dicts with 'ra'/'dec' already quantized (see turns_from_*),
+             optional 'mag', 'size', 'compact' and the string fields named in
+             STRING_COLUMNS. Records in (roughly) RA order give small deltas.
+             Optional 'aliases' lists other designations and common names,
+             they are stored in the alias index as designation_key().
+    tag:     4-byte catalogue tag checked by the firmware backend
+    columns: column ids present in this catalogue (flags, ra and dec are implied)
+    name_index_enabled: append the sorted name hash index for exact name lookups
+    """
+    if len(tag) != 4:
+        raise ValueError("Catalogue tag must be 4 bytes")
+    if not 0 < block_size <= 255:
+        raise ValueError("Block size must be 1..255 records")
+    if len(records) >= 1 << 24:
+        raise ValueError("Too many records for the name index")
+
+    columns = sorted(set(columns) | {COL_FLAGS, COL_RA, COL_DEC})
+    column_mask = 0
+    for col in columns:
+        column_mask |= 1 << col
+
+    # Names go first so a name scan reads one contiguous run of the table
+    strings = StringTable()
+    if COL_NAME in columns:
+        for rec in records:
+            strings.add(rec.get('name', ''))
+
+    blocks = []
+    block_stats = []
+    block_compact_before = []
+    compact_count = 0
+    for start in range(0, len(records), block_size):
+        chunk = records[start:start + block_size]
+        block_compact_before.append(compact_count)
+        compact_count += sum(1 for rec in chunk if rec.get('compact'))
+        block, stats = _encode_block(chunk, columns, strings)
+        blocks.append(block)
+        block_stats.append(stats)
+
+    offset = HEADER_SIZE + BLOCK_INDEX_ENTRY_SIZE * len(blocks)
+    index = bytearray()
+    for block, compact_before, stats in zip(blocks, block_compact_before, block_stats):
+        index += struct.pack('<II', offset, compact_before) + stats
+        offset += len(block)
+
+    # Other designations and common names, each resolved with one lookup in the alias index
+    aliases = set()
+    for number, rec in enumerate(records):
+        own_key = designation_key(rec.get('name') or '')
+        for alias in rec.get('aliases', ()):
+            key = designation_key(alias)
+            if key is not None and key != own_key:
+                aliases.add((name_hash(key), number, strings.add(key)))
+
+    string_offset = offset
+    string_data = strings.data()
+
+    # Exact name lookups binary search this instead of scanning every name
+    name_index = bytearray()
+    name_index_offset = 0
+    if name_index_enabled and COL_NAME in columns:
+        name_index_offset = string_offset + len(string_data)
+        entries = sorted((name_hash(rec.get('name') or ''), number)
+                         for number, rec in enumerate(records))
+        for name_hash_value, number in entries:
+            name_index += struct.pack('<I', name_hash_value)[:3] + struct.pack('<I', number)[:3]
+
+    alias_index = bytearray()
+    flags = 0
+    if aliases:
+        flags |= HEADER_FLAG_ALIASES
+        alias_index += struct.pack('<I', len(aliases))
+        for alias_hash, number, key_offset in sorted(aliases):
+            alias_index += (struct.pack('<I', alias_hash)[:3] + struct.pack('<I', number)[:3] +
+                            struct.pack('<I', key_offset)[:3])
+
+    header = MAGIC + tag + struct.pack('<HHHHIIIIII', VERSION, block_size, column_mask, flags,
+                                       len(records), compact_count, len(blocks), string_offset,
+                                       len(string_data), name_index_offset)
+
+    with open(output_path, 'wb') as f:
+        f.write(header)
+        f.write(index)
+        for block in blocks:
+            f.write(block)
+        f.write(string_data)
+        f.write(name_index)
+        f.write(alias_index)
+
+    return {
+        'records': len(records),
+        'compact_records': compact_count,
+        'blocks': len(blocks),
+        'string_table': len(string_data),
+        'name_index': len(name_index),
+        'aliases': len(aliases),
+        'alias_index': len(alias_index),
+        'size': string_offset + len(string_data) + len(name_index) + len(alias_index),
+    }
+
+
+def _read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def _unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def _decode_column(encoding, data, count):
+    """Values of one column of a block, the inverse of _encode_column()"""
+    if encoding == ENC_CONSTANT:
+        return [_unzigzag(_read_varint(data, 0)[0])] * count
+    values = []
+    pos = 0
+    for _ in range(count):
+        raw, pos = _read_varint(data, pos)
+        value = _unzigzag(raw)
+        if encoding == ENC_DELTA and values:
+            value += values[-1]
+        values.append(value)
+    return values
+
+
+def read_catalogue_blob(data):
+    """
+    Decode an OGCB blob, the inverse of write_catalogue_blob().
+
+    Returns (tag, records) with records in the form write_catalogue_blob()
+    takes: 'ra'/'dec' quantized, 'mag', 'size', 'compact' and the string
+    fields of the columns present. Aliases are not read back.
+    """
+    if len(data) < HEADER_SIZE or data[:4] != MAGIC:
+        raise ValueError("Not a catalogue blob")
+    (tag, version, _, column_mask, _, record_count, _, block_count, string_offset,
+     string_size, _) = struct.unpack_from('<4sHHHHIIIIII', data, 4)
+    if version != VERSION:
+        raise ValueError(f"Unsupported catalogue blob version {version}")
+    columns = [col for col in range(COLUMN_COUNT) if column_mask & (1 << col)]
+    strings = data[string_offset:string_offset + string_size]
+
+    def string_at(offset):
+        return strings[offset:strings.index(b'\0', offset)].decode('utf-8')
+
+    records = []
+    for block in range(block_count):
+        offset = struct.unpack_from('<I', data, HEADER_SIZE + block * BLOCK_INDEX_ENTRY_SIZE)[0]
+        count = data[offset]
+        pos = offset + 1 + 3 * len(columns)
+        values = {}
+        for i, col in enumerate(columns):
+            encoding, length = struct.unpack_from('<BH', data, offset + 1 + 3 * i)
+            values[col] = _decode_column(encoding, data[pos:pos + length], count)
+            pos += length
+        for i in range(count):
+            rec = {
+                'ra': values[COL_RA][i],
+                'dec': values[COL_DEC][i],
+                'compact': bool(values[COL_FLAGS][i] & FLAG_COMPACT),
+            }
+            if COL_MAG in values:
+                rec['mag'] = values[COL_MAG][i] / 100.0
+            if COL_SIZE in values:
+                rec['size'] = values[COL_SIZE][i] / 10.0
+            for col, key in STRING_COLUMNS.items():
+                if col in values:
+                    rec[key] = string_at(values[col][i])
+            records.append(rec)
+    if len(records) != record_count:
+        raise ValueError("Record count does not match the blocks")
+    return tag, records
@@ -0,0 +1,199 @@
+#include <string.h>
+#include <strings.h>
+
+#include "catalogue_browser.h"
+#include "catalogue_page_cache.h"
+
+// Sorts objects without magnitude after all others
+#define NO_MAGNITUDE_KEY INT32_MAX
+
+static const char* const key_names[SORT_KEY_COUNT] = {"index", "name", "magnitude", "ra", "dec"};
+
+CatalogueBrowser::CatalogueBrowser(const CatalogueBlob& blob, bool compact, CatalogueSortKey key)
+    : _blob(blob), _compact(compact), _key(key)
+{
+}
+
+const char* CatalogueBrowser::getKeyName(CatalogueSortKey key)
+{
+    return key >= 0 && key < SORT_KEY_COUNT ? key_names[key] : nullptr;
+}
+
+bool CatalogueBrowser::parseKey(const char* name, CatalogueSortKey& key)
+{
+    for (int i = 0; i < SORT_KEY_COUNT; i++)
+    {
+        if (strcasecmp(name, key_names[i]) == 0)
+        {
+            key = (CatalogueSortKey) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+CatalogueBrowser::Position CatalogueBrowser::positionOf(const CatalogueRecord& record,
+                                                        size_t index) const
+{
+    Position position;
+    position.value = 0;
+    position.name = record.name;
+    position.index = index;
+    if (_key == SORT_KEY_MAGNITUDE)
+        position.value = record.mag_centi == 0 ? NO_MAGNITUDE_KEY : record.mag_centi;
+    else if (_key == SORT_KEY_RA)
+        position.value = record.ra;
+    else if (_key == SORT_KEY_DEC)
+        position.value = record.dec;
+    return position;
+}
+
+bool CatalogueBrowser::isBefore(const Position& a, const Position& b) const
+{
+    if (_key == SORT_KEY_NAME)
+    {
+        int order = strcasecmp(a.name, b.name);
+        if (order != 0)
+            return order < 0;
+    }
+    if (a.value != b.value)
+        return a.value < b.value;
+    return a.index < b.index;
+}
+
+uint16_t CatalogueBrowser::keyColumns() const
+{
+    switch (_key)
+    {
+        case SORT_KEY_NAME:
+            return (1 << COL_FLAGS) | (1 << COL_NAME);
+        case SORT_KEY_MAGNITUDE:
+            return (1 << COL_FLAGS) | (1 << COL_MAG);
+        case SORT_KEY_RA:
+        case SORT_KEY_DEC:
+            return (1 << COL_FLAGS) | (1 << COL_RA) | (1 << COL_DEC);
+        default:
+            return 1 << COL_FLAGS;
+    }
+}
+
+size_t CatalogueBrowser::selectWindow(const Position* last,
+                                      Position window[CATALOGUE_BROWSE_WINDOW]) const
+{
+    // Blocks entirely before the last record returned cannot contribute
+    CatalogueFilter filter;
+    if (last != nullptr && _key == SORT_KEY_RA)
+        filter.ra_min = last->value;
+    else if (last != nullptr && _key == SORT_KEY_DEC)
+        filter.dec_min = last->value;
+
+    CatalogueCursor cursor(_blob, _compact, keyColumns());
+    CatalogueRecord record;
+    size_t count = 0;
+    while (cursor.next(record, filter))
+    {
+        Position position = positionOf(record, cursor.index());
+        if (last != nullptr && !isBefore(*last, position))
+            continue;
+        if (count == CATALOGUE_BROWSE_WINDOW && !isBefore(position, window[count - 1]))
+            continue;
+
+        size_t slot = count < CATALOGUE_BROWSE_WINDOW ? count++ : count - 1;
+        while (slot > 0 && isBefore(position, window[slot - 1]))
+        {
+            window[slot] = window[slot - 1];
+            slot--;
+        }
+        window[slot] = position;
+
+        // Once the window is full, blocks entirely after its last record are skipped too
+        if (count < CATALOGUE_BROWSE_WINDOW)
+            continue;
+        int32_t bound = window[count - 1].value;
+        if (_key == SORT_KEY_RA)
+            filter.ra_max = bound;
+        else if (_key == SORT_KEY_DEC)
+            filter.dec_max = bound;
+        else if (_key == SORT_KEY_MAGNITUDE && bound != NO_MAGNITUDE_KEY)
+            filter.mag_max = (int16_t) bound;
+    }
+    return count;
+}
+
+size_t CatalogueBrowser::visitSorted(const Position* last, size_t skip, size_t limit,
+                                     CatalogueRecordVisitor& visitor) const
+{
+    Position window[CATALOGUE_BROWSE_WINDOW];
+    Position after = last != nullptr ? *last : Position{0, "", 0};
+
+    size_t visited = 0;
+    bool started = last != nullptr;
+    while (visited < limit)
+    {
+        size_t count = selectWindow(started ? &after : nullptr, window);
+        for (size_t i = 0; i < count && visited < limit; i++)
+        {
+            after = window[i];
+            started = true;
+            if (skip > 0)
+            {
+                skip--;
+                continue;
+            }
+
+            CatalogueRecord record;
+            if (!CataloguePageCache::getInstance().getRecord(_blob, _compact, window[i].index,
+                                                             record))
+                return visited;
+            visited++;
+            if (!visitor.visit(window[i].index, record))
+                return visited;
+        }
+        if (count < CATALOGUE_BROWSE_WINDOW)
+            break;
+    }
+    return visited;
+}
+
+size_t CatalogueBrowser::visitInOrder(size_t first, size_t limit,
+                                      CatalogueRecordVisitor& visitor) const
+{
+    CatalogueCursor cursor(_blob, _compact);
+    if (!cursor.seek(first))
+        return 0;
+
+    size_t visited = 0;
+    CatalogueRecord record;
+    while (visited < limit && cursor.next(record))
+    {
+        visited++;
+        if (!visitor.visit(cursor.index(), record))
+            break;
+    }
+    return visited;
+}
+
+size_t CatalogueBrowser::browse(size_t offset, size_t limit,
+                                CatalogueRecordVisitor& visitor) const
+{
+    if (!_blob.isOpen() || limit == 0)
+        return 0;
+    if (_key == SORT_KEY_INDEX)
+        return visitInOrder(offset, limit, visitor);
+    return visitSorted(nullptr, offset, limit, visitor);
+}
+
+size_t CatalogueBrowser::browseAfter(size_t after, size_t limit,
+                                     CatalogueRecordVisitor& visitor) const
+{
+    if (!_blob.isOpen() || limit == 0 || after >= _blob.getRecordCount(_compact))
+        return 0;
+    if (_key == SORT_KEY_INDEX)
+        return visitInOrder(after + 1, limit, visitor);
+
+    CatalogueRecord record;
+    if (!CataloguePageCache::getInstance().getRecord(_blob, _compact, after, record))
+        return 0;
+    Position last = positionOf(record, after);
+    return visitSorted(&last, 0, limit, visitor);
+}
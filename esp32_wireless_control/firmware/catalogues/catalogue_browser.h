@@ -0,0 +1,87 @@
+/**
+ * @file catalogue_browser.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef CATALOGUE_BROWSER_H
+#define CATALOGUE_BROWSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "catalogue_blob.h"
+
+// Records sorted per pass over the catalogue, sets the stack use of a sorted page
+#define CATALOGUE_BROWSE_WINDOW 32
+
+enum CatalogueSortKey
+{
+    SORT_KEY_INDEX = 0, // Catalogue order
+    SORT_KEY_NAME,      // Case-insensitive
+    SORT_KEY_MAGNITUDE, // Brightest first, objects without magnitude last
+    SORT_KEY_RA,
+    SORT_KEY_DEC,       // South to north
+    SORT_KEY_COUNT
+};
+
+/**
+ * @brief Pages through one projection of a catalogue blob in a sort order
+ *
+ * Records are decoded straight from the blob (through CataloguePageCache)
+ * and handed to a visitor, nothing is allocated and memory use does not
+ * depend on the page size.
+ *
+ * Catalogue order seeks to the offset and reads sequentially. Other orders
+ * are built by repeated passes that each select the next
+ * CATALOGUE_BROWSE_WINDOW records after the last one returned, skipping
+ * blocks whose statistics rule them out. Ties are ordered by index, so a
+ * page can continue after the index of the last record of the previous
+ * page (keyset paging) at the same cost as the first page, an offset has
+ * to select all records before it.
+ */
+class CatalogueBrowser
+{
+  public:
+    CatalogueBrowser(const CatalogueBlob& blob, bool compact, CatalogueSortKey key);
+
+    /**
+     * @brief Visit up to limit records starting at position offset of the sort order
+     * @return Number of records visited
+     */
+    size_t browse(size_t offset, size_t limit, CatalogueRecordVisitor& visitor) const;
+
+    /**
+     * @brief Visit up to limit records following the record at index after
+     * @return Number of records visited, 0 if after is out of range
+     */
+    size_t browseAfter(size_t after, size_t limit, CatalogueRecordVisitor& visitor) const;
+
+    // Names of the sort keys as used by the API, nullptr for an unknown key
+    static const char* getKeyName(CatalogueSortKey key);
+    static bool parseKey(const char* name, CatalogueSortKey& key);
+
+  private:
+    struct Position
+    {
+        int32_t value;
+        const char* name;
+        size_t index;
+    };
+
+    Position positionOf(const CatalogueRecord& record, size_t index) const;
+    bool isBefore(const Position& a, const Position& b) const;
+    uint16_t keyColumns() const;
+    size_t selectWindow(const Position* last, Position window[CATALOGUE_BROWSE_WINDOW]) const;
+    size_t visitSorted(const Position* last, size_t skip, size_t limit,
+                       CatalogueRecordVisitor& visitor) const;
+    size_t visitInOrder(size_t first, size_t limit, CatalogueRecordVisitor& visitor) const;
+
+    const CatalogueBlob& _blob;
+    bool _compact;
+    CatalogueSortKey _key;
+};
+
+#endif // CATALOGUE_BROWSER_H
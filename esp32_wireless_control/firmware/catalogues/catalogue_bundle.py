@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""
+Catalogue bundle writer (OGCP format)
+
+Packs the OGCB blobs written by the converters into one versioned bundle for
+the "catalogue" flash partition. The firmware maps the partition at boot and
+serves the catalogues straight from it, a new bundle can be uploaded over
+HTTP (POST /catalogUpload) without reflashing the firmware.
+
+Layout (all integers little-endian):
+
+  Header (24 bytes)
+     0  char[4]  magic "OGCP"
+     4  uint16   format version
+     6  uint16   entry count
+     8  uint32   bundle version (data revision, e.g. 20251116)
+    12  uint32   total bundle size in bytes, header included
+    16  uint32   CRC-32 (zlib) of everything after the header
+    20  uint32   reserved (0)
+
+  Directory (12 bytes per entry)
+     char[4]  catalogue tag, the tag of the OGCB blob ("NGC2", "BSC5")
+     uint32   blob offset from the start of the bundle, 4-byte aligned
+     uint32   blob size
+
+  Blobs, each padded to 4 bytes
+
+Usage:
+  python catalogue_bundle.py ngc/converted/ngc2000.bin bsc5/converted/bsc5ra.bin
+"""
+
+import argparse
+import datetime
+import struct
+import sys
+import zlib
+
+MAGIC = b'OGCP'
+VERSION = 1
+HEADER_SIZE = 24
+ENTRY_SIZE = 12
+BLOB_MAGIC = b'OGCB'
+
+
+def align4(value):
+    return (value + 3) & ~3
+
+
+def write_bundle(blob_paths, output_path, bundle_version):
+    blobs = []
+    for path in blob_paths:
+        with open(path, 'rb') as f:
+            data = f.read()
+        if len(data) < 8 or data[:4] != BLOB_MAGIC:
+            raise ValueError(f'{path} is not a catalogue blob')
+        tag = data[4:8]
+        if any(tag == existing for existing, _ in blobs):
+            raise ValueError(f'Duplicate catalogue {tag.decode()} in {path}')
+        blobs.append((tag, data))
+
+    offset = align4(HEADER_SIZE + ENTRY_SIZE * len(blobs))
+    directory = bytearray()
+    payload = bytearray()
+    for tag, data in blobs:
+        directory += struct.pack('<4sII', tag, offset + len(payload), len(data))
+        payload += data
+        payload += b'\0' * (align4(len(payload)) - len(payload))
+
+    body = directory + b'\0' * (offset - HEADER_SIZE - len(directory)) + payload
+    header = struct.pack('<4sHHIIII', MAGIC, VERSION, len(blobs), bundle_version,
+                         HEADER_SIZE + len(body), zlib.crc32(body), 0)
+
+    with open(output_path, 'wb') as f:
+        f.write(header + body)
+
+    print(f'Catalogue bundle version {bundle_version}: {len(blobs)} catalogues, '
+          f'{HEADER_SIZE + len(body)} bytes -> {output_path}')
+    for tag, data in blobs:
+        print(f'  {tag.decode()}: {len(data)} bytes')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Pack catalogue blobs into a partition bundle')
+    parser.add_argument('blobs', nargs='+', help='OGCB blobs written by the converters')
+    parser.add_argument('--output', default='catalogue_bundle.bin', help='Output bundle file')
+    parser.add_argument('--bundle-version', type=int,
+                        default=int(datetime.date.today().strftime('%Y%m%d')),
+                        help='Data revision stored in the bundle (default: today as YYYYMMDD)')
+    args = parser.parse_args()
+
+    try:
+        write_bundle(args.blobs, args.output, args.bundle_version)
+    except (OSError, ValueError) as e:
+        print(f'Error: {e}', file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
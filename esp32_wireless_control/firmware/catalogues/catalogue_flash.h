@@ -0,0 +1,32 @@
+/**
+ * @file catalogue_flash.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef CATALOGUE_FLASH_H
+#define CATALOGUE_FLASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Raw access to the "catalogue" data partition. Implemented with the
+// esp_partition API on the target (catalogue_flash_esp32.cpp) and with a
+// memory-mapped file by the host tools. Offsets are relative to the start
+// of the partition, erases work on whole sectors. Like NOR flash, a write
+// can only clear bits, the range has to be erased first.
+
+#define CATALOGUE_FLASH_SECTOR_SIZE 4096
+
+// Partition size in bytes, 0 if the partition table has no catalogue partition
+size_t catalogueFlashCapacity();
+
+// Map the whole partition read-only, nullptr on failure
+const uint8_t* catalogueFlashMap();
+
+bool catalogueFlashErase(size_t offset, size_t length);
+bool catalogueFlashWrite(size_t offset, const uint8_t* data, size_t length);
+
+#endif // CATALOGUE_FLASH_H
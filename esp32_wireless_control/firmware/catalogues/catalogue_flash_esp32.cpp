@@ -0,0 +1,55 @@
+#include <esp_partition.h>
+
+#include "catalogue_flash.h"
+#include "uart.h"
+
+#define CATALOGUE_PARTITION_LABEL "catalogue"
+#define CATALOGUE_PARTITION_SUBTYPE ((esp_partition_subtype_t) 0x40)
+
+static const esp_partition_t* findPartition()
+{
+    static const esp_partition_t* partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, CATALOGUE_PARTITION_SUBTYPE, CATALOGUE_PARTITION_LABEL);
+    return partition;
+}
+
+size_t catalogueFlashCapacity()
+{
+    const esp_partition_t* partition = findPartition();
+    return partition != nullptr ? partition->size : 0;
+}
+
+const uint8_t* catalogueFlashMap()
+{
+    static const void* mapped = nullptr;
+    static esp_partition_mmap_handle_t handle;
+
+    const esp_partition_t* partition = findPartition();
+    if (partition == nullptr)
+        return nullptr;
+
+    // The mapping lives until reboot, catalogues are never unloaded
+    if (mapped == nullptr)
+    {
+        esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA,
+                                           &mapped, &handle);
+        if (err != ESP_OK)
+        {
+            print_out("Error: Cannot map catalogue partition (%s)", esp_err_to_name(err));
+            mapped = nullptr;
+        }
+    }
+    return static_cast<const uint8_t*>(mapped);
+}
+
+bool catalogueFlashErase(size_t offset, size_t length)
+{
+    const esp_partition_t* partition = findPartition();
+    return partition != nullptr && esp_partition_erase_range(partition, offset, length) == ESP_OK;
+}
+
+bool catalogueFlashWrite(size_t offset, const uint8_t* data, size_t length)
+{
+    const esp_partition_t* partition = findPartition();
+    return partition != nullptr && esp_partition_write(partition, offset, data, length) == ESP_OK;
+}
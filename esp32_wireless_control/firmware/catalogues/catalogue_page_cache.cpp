@@ -0,0 +1,317 @@
+#include "catalogue_page_cache.h"
+#include "uart.h"
+
+CataloguePageCache& CataloguePageCache::getInstance()
+{
+    static CataloguePageCache instance;
+    return instance;
+}
+
+CataloguePageCache::CataloguePageCache()
+    : _head(nullptr), _tail(nullptr), _budget(CATALOGUE_PAGE_CACHE_BUDGET), _used(0),
+      _pinned_bytes(0), _pages(0), _pinned_pages(0), _hits(0), _misses(0), _evictions(0)
+{
+    _mutex = xSemaphoreCreateMutex();
+    for (size_t i = 0; i < CATALOGUE_PAGE_CACHE_BUCKETS; i++)
+        _buckets[i] = nullptr;
+}
+
+size_t CataloguePageCache::bucketOf(const uint8_t* data, size_t block)
+{
+    uint32_t hash = ((uint32_t) (uintptr_t) data ^ (uint32_t) block) * 2654435761u;
+    return (hash >> 16) % CATALOGUE_PAGE_CACHE_BUCKETS;
+}
+
+CataloguePageCache::Page* CataloguePageCache::find(const CatalogueBlob& blob, size_t block)
+{
+    const uint8_t* data = blob.getData();
+    for (Page* page = _buckets[bucketOf(data, block)]; page != nullptr; page = page->bucket_next)
+    {
+        if (page->data == data && page->block == block)
+            return page;
+    }
+    return nullptr;
+}
+
+void CataloguePageCache::touch(Page* page)
+{
+    if (page == _head)
+        return;
+
+    unlink(page);
+    page->prev = nullptr;
+    page->next = _head;
+    if (_head != nullptr)
+        _head->prev = page;
+    _head = page;
+    if (_tail == nullptr)
+        _tail = page;
+}
+
+void CataloguePageCache::unlink(Page* page)
+{
+    if (page->prev != nullptr)
+        page->prev->next = page->next;
+    else if (_head == page)
+        _head = page->next;
+    if (page->next != nullptr)
+        page->next->prev = page->prev;
+    else if (_tail == page)
+        _tail = page->prev;
+    page->prev = nullptr;
+    page->next = nullptr;
+}
+
+void CataloguePageCache::release(Page* page)
+{
+    Page** link = &_buckets[bucketOf(page->data, page->block)];
+    while (*link != page)
+        link = &(*link)->bucket_next;
+    *link = page->bucket_next;
+
+    unlink(page);
+    _used -= page->bytes;
+    _pages--;
+    if (page->pinned)
+    {
+        _pinned_bytes -= page->bytes;
+        _pinned_pages--;
+    }
+    free(page);
+}
+
+void CataloguePageCache::evict(const Page* keep)
+{
+    Page* page = _tail;
+    while (_used > _budget && page != nullptr)
+    {
+        Page* prev = page->prev;
+        if (page != keep && !page->pinned)
+        {
+            release(page);
+            _evictions++;
+        }
+        page = prev;
+    }
+}
+
+CataloguePageCache::Page* CataloguePageCache::load(const CatalogueBlob& blob, size_t block)
+{
+    size_t first = block * blob.getBlockSize();
+    size_t count = blob.getRecordCount(false) - first;
+    if (count > blob.getBlockSize())
+        count = blob.getBlockSize();
+
+    size_t bytes = sizeof(Page) + count * sizeof(CatalogueRecord);
+    Page* page = (Page*) malloc(bytes);
+    if (page == nullptr)
+        return nullptr;
+
+    page->records = reinterpret_cast<CatalogueRecord*>(page + 1);
+    CatalogueCursor cursor(blob, false);
+    if (!cursor.seek(first))
+    {
+        free(page);
+        return nullptr;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!cursor.next(page->records[i]))
+        {
+            free(page);
+            return nullptr;
+        }
+    }
+
+    page->data = blob.getData();
+    page->block = block;
+    page->prev = nullptr;
+    page->next = nullptr;
+    page->bytes = bytes;
+    page->count = (uint16_t) count;
+    page->pinned = false;
+
+    size_t bucket = bucketOf(page->data, block);
+    page->bucket_next = _buckets[bucket];
+    _buckets[bucket] = page;
+    _used += bytes;
+    _pages++;
+
+    touch(page);
+    evict(page);
+    return page;
+}
+
+bool CataloguePageCache::decodeRecord(const CatalogueBlob& blob, bool compact, size_t index,
+                                      CatalogueRecord& record)
+{
+    CatalogueCursor cursor(blob, compact);
+    return cursor.seek(index) && cursor.next(record);
+}
+
+bool CataloguePageCache::getRecord(const CatalogueBlob& blob, bool compact, size_t index,
+                                   CatalogueRecord& record)
+{
+    size_t block;
+    size_t first_index;
+    if (!blob.isOpen() || !blob.findBlock(index, compact, block, first_index))
+        return false;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    // setBudget() may disable the cache from another task at any time
+    if (_budget == 0)
+    {
+        xSemaphoreGive(_mutex);
+        return decodeRecord(blob, compact, index, record);
+    }
+
+    Page* page = find(blob, block);
+    if (page != nullptr)
+    {
+        _hits++;
+        touch(page);
+    }
+    else
+    {
+        _misses++;
+        page = load(blob, block);
+    }
+
+    bool found = false;
+    if (page != nullptr)
+    {
+        // Walk the compact records of the block, full records are addressed directly
+        size_t position = index - first_index;
+        if (compact)
+        {
+            for (position = 0; position < page->count; position++)
+            {
+                if ((page->records[position].flags & CATALOGUE_FLAG_COMPACT) == 0)
+                    continue;
+                if (first_index++ == index)
+                    break;
+            }
+        }
+        if (position < page->count)
+        {
+            record = page->records[position];
+            found = true;
+        }
+    }
+
+    xSemaphoreGive(_mutex);
+
+    // Without heap for the page the record is decoded directly, the cache only saves time
+    if (page == nullptr)
+        return decodeRecord(blob, compact, index, record);
+    return found;
+}
+
+size_t CataloguePageCache::pinBrightest(const CatalogueBlob& blob, float magnitude)
+{
+    if (!blob.isOpen() || !blob.hasColumn(COL_MAG))
+        return 0;
+
+    int16_t limit = (int16_t) (magnitude * 100.0f);
+    size_t pinned = 0;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    if (_budget == 0)
+    {
+        xSemaphoreGive(_mutex);
+        return 0;
+    }
+
+    // The block statistics tell which blocks hold a bright object
+    CatalogueFilter filter;
+    filter.mag_max = limit - 1;
+    for (size_t block = blob.findMatchingBlock(0, filter); block < blob.getBlockCount();
+         block = blob.findMatchingBlock(block + 1, filter))
+    {
+        Page* page = find(blob, block);
+        if (page == nullptr)
+        {
+            _misses++;
+            page = load(blob, block);
+        }
+        if (page == nullptr || page->pinned)
+            continue;
+        if (_pinned_bytes + page->bytes > _budget / 2)
+            break;
+
+        page->pinned = true;
+        _pinned_bytes += page->bytes;
+        _pinned_pages++;
+        pinned++;
+    }
+
+    xSemaphoreGive(_mutex);
+
+    print_out("Catalogue cache: pinned %zu pages with objects brighter than %.1f mag", pinned,
+              magnitude);
+    return pinned;
+}
+
+void CataloguePageCache::setBudget(size_t bytes)
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    _budget = bytes;
+    if (_budget == 0)
+    {
+        while (_head != nullptr)
+            release(_head);
+    }
+    evict(nullptr);
+
+    xSemaphoreGive(_mutex);
+}
+
+void CataloguePageCache::invalidate(const CatalogueBlob& blob)
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    for (size_t block = 0; block < blob.getBlockCount(); block++)
+    {
+        Page* page = find(blob, block);
+        if (page != nullptr)
+            release(page);
+    }
+
+    xSemaphoreGive(_mutex);
+}
+
+void CataloguePageCache::clear()
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    while (_head != nullptr)
+        release(_head);
+    xSemaphoreGive(_mutex);
+}
+
+CataloguePageCacheStats CataloguePageCache::getStats() const
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    CataloguePageCacheStats stats;
+    stats.budget_bytes = _budget;
+    stats.used_bytes = _used;
+    stats.pages = _pages;
+    stats.pinned_pages = _pinned_pages;
+    stats.hits = _hits;
+    stats.misses = _misses;
+    stats.evictions = _evictions;
+
+    xSemaphoreGive(_mutex);
+    return stats;
+}
+
+void CataloguePageCache::resetStats()
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _hits = 0;
+    _misses = 0;
+    _evictions = 0;
+    xSemaphoreGive(_mutex);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file catalogue_page_cache.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef CATALOGUE_PAGE_CACHE_H
+#define CATALOGUE_PAGE_CACHE_H
+
+#include <Arduino.h>
+
+#include "catalogue_blob.h"
+
+// Heap used for decoded pages, one page is one block of a catalogue blob
+// (~1.2 KB for 32 records). 0 disables the cache.
+#ifndef CATALOGUE_PAGE_CACHE_BUDGET
+#define CATALOGUE_PAGE_CACHE_BUDGET (16 * 1024)
+#endif
+
+// Pages holding objects brighter than this stay resident
+#ifndef CATALOGUE_PAGE_CACHE_PIN_MAGNITUDE
+#define CATALOGUE_PAGE_CACHE_PIN_MAGNITUDE 2.0f
+#endif
+
+#define CATALOGUE_PAGE_CACHE_BUCKETS 64
+
+struct CataloguePageCacheStats
+{
+    size_t budget_bytes;
+    size_t used_bytes;
+    size_t pages;
+    size_t pinned_pages;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+};
+
+/**
+ * @brief LRU cache of decoded catalogue blocks shared by all backends
+ *
+ * Records inside a block are delta-encoded, so reading one record means
+ * decoding the block up to it. The cache keeps recently used blocks fully
+ * decoded within a byte budget. Pages are keyed by the blob data, the full
+ * and the compact projection of a catalogue share them.
+ *
+ * Lookups are O(1) through a small hash table, the least recently used
+ * unpinned page is evicted first. Pinned pages (bright objects) use at most
+ * half of the budget and are never evicted. All methods lock, records are
+ * copied out so they stay valid after the page is evicted.
+ */
+class CataloguePageCache
+{
+  public:
+    static CataloguePageCache& getInstance();
+
+    /**
+     * @brief Change the byte budget, evicting pages until the cache fits
+     * @note Pinned pages are kept, 0 drops everything and disables caching
+     */
+    void setBudget(size_t bytes);
+
+    /**
+     * @brief Read one record of a projection through the cache
+     * @return false if index is out of range or the block is corrupt
+     */
+    bool getRecord(const CatalogueBlob& blob, bool compact, size_t index,
+                   CatalogueRecord& record);
+
+    /**
+     * @brief Load and pin every page holding an object brighter than magnitude
+     * @return Number of pages pinned
+     */
+    size_t pinBrightest(const CatalogueBlob& blob, float magnitude);
+
+    // Drop all pages of a blob, before its data goes away
+    void invalidate(const CatalogueBlob& blob);
+    void clear();
+
+    CataloguePageCacheStats getStats() const;
+    void resetStats();
+
+  private:
+    struct Page
+    {
+        // Blob data and block number identify the page
+        const uint8_t* data;
+        size_t block;
+        // LRU list, most recently used first
+        Page* prev;
+        Page* next;
+        Page* bucket_next;
+        size_t bytes;
+        uint16_t count;
+        bool pinned;
+        // Stored right after the page header
+        CatalogueRecord* records;
+    };
+
+    CataloguePageCache();
+
+    CataloguePageCache(const CataloguePageCache&) = delete;
+    CataloguePageCache& operator=(const CataloguePageCache&) = delete;
+
+    static size_t bucketOf(const uint8_t* data, size_t block);
+
+    Page* find(const CatalogueBlob& blob, size_t block);
+    Page* load(const CatalogueBlob& blob, size_t block);
+    // Read a record without the cache
+    static bool decodeRecord(const CatalogueBlob& blob, bool compact, size_t index,
+                             CatalogueRecord& record);
+    void touch(Page* page);
+    void unlink(Page* page);
+    void release(Page* page);
+    void evict(const Page* keep);
+
+    SemaphoreHandle_t _mutex;
+    Page* _buckets[CATALOGUE_PAGE_CACHE_BUCKETS];
+    Page* _head;
+    Page* _tail;
+    size_t _budget;
+    size_t _used;
+    size_t _pinned_bytes;
+    size_t _pages;
+    size_t _pinned_pages;
+    uint32_t _hits;
+    uint32_t _misses;
+    uint32_t _evictions;
+};
+
+#endif // CATALOGUE_PAGE_CACHE_H
@@ -0,0 +1,260 @@
+#include "catalogue_flash.h"
+#include "catalogue_partition.h"
+#include "uart.h"
+
+#define CATALOGUE_BUNDLE_MAGIC "OGCP"
+#define CATALOGUE_BUNDLE_VERSION 1
+#define CATALOGUE_BUNDLE_ENTRY_SIZE 12
+
+static uint16_t readU16(const uint8_t* p)
+{
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t readU32(const uint8_t* p)
+{
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) |
+           ((uint32_t) p[3] << 24);
+}
+
+// CRC-32 as used by zlib, nibble table to keep it small
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+        0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+CataloguePartition& CataloguePartition::getInstance()
+{
+    static CataloguePartition instance;
+    return instance;
+}
+
+CataloguePartition::CataloguePartition()
+    : _data(nullptr), _bundle_version(0), _bundle_size(0), _entry_count(0), _updating(false),
+      _update_expected(0), _update_written(0), _update_erased(0), _update_crc(0),
+      _update_error(nullptr)
+{
+}
+
+size_t CataloguePartition::getCapacity() const
+{
+    return catalogueFlashCapacity();
+}
+
+bool CataloguePartition::parseHeader(const uint8_t* data, BundleHeader& header) const
+{
+    if (memcmp(data, CATALOGUE_BUNDLE_MAGIC, 4) != 0 ||
+        readU16(data + 4) != CATALOGUE_BUNDLE_VERSION)
+        return false;
+
+    header.entries = readU16(data + 6);
+    header.version = readU32(data + 8);
+    header.size = readU32(data + 12);
+    header.crc = readU32(data + 16);
+    return header.size <= getCapacity() &&
+           header.size >= CATALOGUE_BUNDLE_HEADER_SIZE +
+                              (size_t) header.entries * CATALOGUE_BUNDLE_ENTRY_SIZE;
+}
+
+bool CataloguePartition::begin()
+{
+    _data = nullptr;
+
+    size_t capacity = getCapacity();
+    if (capacity < CATALOGUE_BUNDLE_HEADER_SIZE)
+    {
+        print_out("Error: %s", CATALOGUE_NO_PARTITION_ERROR);
+        print_out("Using the catalogues embedded in the firmware");
+        return false;
+    }
+
+    const uint8_t* data = catalogueFlashMap();
+    BundleHeader header;
+    if (data == nullptr || !parseHeader(data, header))
+    {
+        print_out("No catalogue bundle in partition");
+        return false;
+    }
+
+    const uint8_t* body = data + CATALOGUE_BUNDLE_HEADER_SIZE;
+    if (crc32Update(0, body, header.size - CATALOGUE_BUNDLE_HEADER_SIZE) != header.crc)
+    {
+        print_out("Error: Catalogue bundle checksum mismatch");
+        return false;
+    }
+
+    for (uint16_t i = 0; i < header.entries; i++)
+    {
+        const uint8_t* entry = body + i * CATALOGUE_BUNDLE_ENTRY_SIZE;
+        uint32_t offset = readU32(entry + 4);
+        uint32_t size = readU32(entry + 8);
+        if (offset < CATALOGUE_BUNDLE_HEADER_SIZE || offset > header.size ||
+            size > header.size - offset)
+        {
+            print_out("Error: Corrupt catalogue bundle directory");
+            return false;
+        }
+    }
+
+    _data = data;
+    _bundle_version = header.version;
+    _bundle_size = header.size;
+    _entry_count = header.entries;
+    print_out("Catalogue bundle version %u: %u catalogues, %u of %u bytes",
+              (unsigned) header.version, header.entries, (unsigned) header.size,
+              (unsigned) capacity);
+    return true;
+}
+
+bool CataloguePartition::findCatalogue(const char* tag, const uint8_t*& start,
+                                       const uint8_t*& end) const
+{
+    if (!isValid())
+        return false;
+
+    for (size_t i = 0; i < _entry_count; i++)
+    {
+        const uint8_t* entry =
+            _data + CATALOGUE_BUNDLE_HEADER_SIZE + i * CATALOGUE_BUNDLE_ENTRY_SIZE;
+        if (memcmp(entry, tag, 4) == 0)
+        {
+            start = _data + readU32(entry + 4);
+            end = start + readU32(entry + 8);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CataloguePartition::beginUpdate(size_t size)
+{
+    size_t capacity = getCapacity();
+    _updating = true;
+    _update_expected = size;
+    _update_written = 0;
+    _update_erased = 0;
+    _update_crc = 0;
+    _update_error = nullptr;
+
+    if (capacity == 0)
+    {
+        failUpdate(CATALOGUE_NO_PARTITION_ERROR);
+        return false;
+    }
+    if (size > capacity)
+    {
+        failUpdate("Bundle larger than the catalogue partition");
+        return false;
+    }
+
+    // Erasing the first sector invalidates the current bundle right away
+    if (!catalogueFlashErase(0, CATALOGUE_FLASH_SECTOR_SIZE))
+    {
+        failUpdate("Flash erase failed");
+        return false;
+    }
+    _update_erased = CATALOGUE_FLASH_SECTOR_SIZE;
+
+    print_out("Catalogue update started, %u bytes", (unsigned) size);
+    return true;
+}
+
+bool CataloguePartition::writeUpdate(const uint8_t* data, size_t len)
+{
+    if (!_updating || _update_error != nullptr)
+        return false;
+
+    if (_update_written + len > getCapacity())
+    {
+        failUpdate("Bundle larger than the catalogue partition");
+        return false;
+    }
+
+    // The header is kept in RAM and written last
+    while (len > 0 && _update_written < CATALOGUE_BUNDLE_HEADER_SIZE)
+    {
+        _update_header[_update_written++] = *data++;
+        len--;
+    }
+    if (len == 0)
+        return true;
+
+    while (_update_erased < _update_written + len)
+    {
+        if (!catalogueFlashErase(_update_erased, CATALOGUE_FLASH_SECTOR_SIZE))
+        {
+            failUpdate("Flash erase failed");
+            return false;
+        }
+        _update_erased += CATALOGUE_FLASH_SECTOR_SIZE;
+    }
+
+    if (!catalogueFlashWrite(_update_written, data, len))
+    {
+        failUpdate("Flash write failed");
+        return false;
+    }
+    _update_crc = crc32Update(_update_crc, data, len);
+    _update_written += len;
+    return true;
+}
+
+bool CataloguePartition::endUpdate()
+{
+    if (!_updating || _update_error != nullptr)
+        return false;
+
+    BundleHeader header;
+    if (_update_written < CATALOGUE_BUNDLE_HEADER_SIZE || !parseHeader(_update_header, header))
+    {
+        failUpdate("Not a catalogue bundle");
+        return false;
+    }
+    if (header.size != _update_written ||
+        (_update_expected != 0 && _update_expected != _update_written))
+    {
+        failUpdate("Incomplete bundle");
+        return false;
+    }
+    if (header.crc != _update_crc)
+    {
+        failUpdate("Bundle checksum mismatch");
+        return false;
+    }
+    if (!catalogueFlashWrite(0, _update_header, CATALOGUE_BUNDLE_HEADER_SIZE))
+    {
+        failUpdate("Flash write failed");
+        return false;
+    }
+
+    _updating = false;
+    print_out("Catalogue update complete: version %u, %u bytes", (unsigned) header.version,
+              (unsigned) _update_written);
+    return true;
+}
+
+void CataloguePartition::abortUpdate()
+{
+    if (_updating && _update_error == nullptr)
+        failUpdate("Upload aborted");
+}
+
+void CataloguePartition::failUpdate(const char* error)
+{
+    _updating = false;
+    _update_error = error;
+    print_out("Error: Catalogue update failed: %s", error);
+}
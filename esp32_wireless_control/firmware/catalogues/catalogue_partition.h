@@ -0,0 +1,136 @@
+/**
+ * @file catalogue_partition.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef CATALOGUE_PARTITION_H
+#define CATALOGUE_PARTITION_H
+
+#include <Arduino.h>
+
+// Versioned catalogue bundle ("OGCP") in the catalogue flash partition,
+// written by catalogue_bundle.py. See catalogue_bundle.py for the layout.
+
+#define CATALOGUE_BUNDLE_HEADER_SIZE 24
+
+#define CATALOGUE_NO_PARTITION_ERROR                                                        \
+    "No catalogue partition, flash the firmware over serial once to install the partition table"
+
+/**
+ * @brief Catalogue bundle in the "catalogue" data partition
+ *
+ * The partition is memory-mapped at boot, the catalogue blobs in it are
+ * read in place like the data embedded in the firmware image. A new bundle
+ * is written in a streaming fashion while it is uploaded, the header goes
+ * in last so an interrupted upload never leaves a valid looking bundle.
+ * The new bundle is used after a reboot.
+ */
+class CataloguePartition
+{
+  public:
+    static CataloguePartition& getInstance();
+
+    /**
+     * @brief Map the partition and validate the bundle in it
+     * @return false if there is no partition or no valid bundle
+     */
+    bool begin();
+
+    bool isValid() const
+    {
+        return _data != nullptr;
+    }
+    uint32_t getBundleVersion() const
+    {
+        return _bundle_version;
+    }
+    size_t getBundleSize() const
+    {
+        return _bundle_size;
+    }
+    size_t getEntryCount() const
+    {
+        return _entry_count;
+    }
+    size_t getCapacity() const;
+
+    /**
+     * @brief Whether the partition table has a catalogue partition
+     *
+     * OTA updates do not rewrite the partition table, a device that only got
+     * this firmware over the air still runs the table without the partition.
+     */
+    bool hasPartition() const
+    {
+        return getCapacity() > 0;
+    }
+
+    /**
+     * @brief Find a catalogue blob in the bundle
+     * @param tag 4-byte catalogue tag, e.g. "NGC2"
+     */
+    bool findCatalogue(const char* tag, const uint8_t*& start, const uint8_t*& end) const;
+
+    /**
+     * @brief Start writing a new bundle, the current one is invalid from now on
+     * @param size Expected bundle size, 0 if unknown
+     */
+    bool beginUpdate(size_t size);
+    bool writeUpdate(const uint8_t* data, size_t len);
+
+    /**
+     * @brief Validate the uploaded bundle and write its header
+     * @return true if the bundle is complete and valid
+     */
+    bool endUpdate();
+    void abortUpdate();
+
+    bool isUpdating() const
+    {
+        return _updating;
+    }
+    size_t getUpdateWritten() const
+    {
+        return _update_written;
+    }
+    const char* getUpdateError() const
+    {
+        return _update_error;
+    }
+
+  private:
+    CataloguePartition();
+
+    CataloguePartition(const CataloguePartition&) = delete;
+    CataloguePartition& operator=(const CataloguePartition&) = delete;
+
+    struct BundleHeader
+    {
+        uint32_t version;
+        uint32_t size;
+        uint32_t crc;
+        uint16_t entries;
+    };
+
+    // Checks magic, format version and size against the partition capacity
+    bool parseHeader(const uint8_t* data, BundleHeader& header) const;
+    void failUpdate(const char* error);
+
+    const uint8_t* _data;
+    uint32_t _bundle_version;
+    size_t _bundle_size;
+    size_t _entry_count;
+
+    bool _updating;
+    size_t _update_expected;
+    size_t _update_written;
+    size_t _update_erased;
+    uint32_t _update_crc;
+    uint8_t _update_header[CATALOGUE_BUNDLE_HEADER_SIZE];
+    const char* _update_error;
+};
+
+#endif // CATALOGUE_PARTITION_H
@@ -0,0 +1,130 @@
+#include <ctype.h>
+#include <string.h>
+
+#include "catalogue_query_cache.h"
+
+CatalogueQueryCache& CatalogueQueryCache::getInstance()
+{
+    static CatalogueQueryCache instance;
+    return instance;
+}
+
+CatalogueQueryCache::CatalogueQueryCache() : _clock(0), _hits(0), _misses(0)
+{
+    _mutex = xSemaphoreCreateMutex();
+    memset(_entries, 0, sizeof(_entries));
+}
+
+bool CatalogueQueryCache::normalize(const String& name, char* key)
+{
+    if (name.length() == 0 || name.length() >= CATALOGUE_QUERY_CACHE_NAME_SIZE)
+        return false;
+
+    const char* text = name.c_str();
+    size_t i = 0;
+    for (; text[i] != '\0'; i++)
+        key[i] = tolower((unsigned char) text[i]);
+    key[i] = '\0';
+    return true;
+}
+
+CatalogueQueryCache::Entry* CatalogueQueryCache::find(StarDatabaseType type, const char* key)
+{
+    for (size_t i = 0; i < CATALOGUE_QUERY_CACHE_ENTRIES; i++)
+    {
+        Entry& entry = _entries[i];
+        if (entry.type == type && entry.name[0] != '\0' && strcmp(entry.name, key) == 0)
+            return &entry;
+    }
+    return nullptr;
+}
+
+bool CatalogueQueryCache::lookup(StarDatabaseType type, const String& name,
+                                 StarDatabaseType& source, size_t& index)
+{
+    char key[CATALOGUE_QUERY_CACHE_NAME_SIZE];
+    if (CATALOGUE_QUERY_CACHE_ENTRIES == 0 || !normalize(name, key))
+        return false;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    Entry* entry = find(type, key);
+    if (entry != nullptr)
+    {
+        entry->used = ++_clock;
+        source = (StarDatabaseType) entry->source;
+        index = entry->index;
+        _hits++;
+    }
+    else
+    {
+        _misses++;
+    }
+
+    xSemaphoreGive(_mutex);
+    return entry != nullptr;
+}
+
+void CatalogueQueryCache::store(StarDatabaseType type, const String& name,
+                                StarDatabaseType source, size_t index)
+{
+    char key[CATALOGUE_QUERY_CACHE_NAME_SIZE];
+    if (CATALOGUE_QUERY_CACHE_ENTRIES == 0 || !normalize(name, key))
+        return;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    // Reuse the entry of the same search or replace the least recently used one
+    Entry* entry = find(type, key);
+    if (entry == nullptr)
+    {
+        entry = &_entries[0];
+        for (size_t i = 1; i < CATALOGUE_QUERY_CACHE_ENTRIES; i++)
+        {
+            if (_entries[i].used < entry->used)
+                entry = &_entries[i];
+        }
+        strcpy(entry->name, key);
+        entry->type = (uint8_t) type;
+    }
+    entry->source = (uint8_t) source;
+    entry->index = (uint32_t) index;
+    entry->used = ++_clock;
+
+    xSemaphoreGive(_mutex);
+}
+
+void CatalogueQueryCache::clear()
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    memset(_entries, 0, sizeof(_entries));
+    _clock = 0;
+    xSemaphoreGive(_mutex);
+}
+
+CatalogueQueryCacheStats CatalogueQueryCache::getStats() const
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    CatalogueQueryCacheStats stats;
+    stats.entries = 0;
+    for (size_t i = 0; i < CATALOGUE_QUERY_CACHE_ENTRIES; i++)
+    {
+        if (_entries[i].name[0] != '\0')
+            stats.entries++;
+    }
+    stats.capacity = CATALOGUE_QUERY_CACHE_ENTRIES;
+    stats.hits = _hits;
+    stats.misses = _misses;
+
+    xSemaphoreGive(_mutex);
+    return stats;
+}
+
+void CatalogueQueryCache::resetStats()
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _hits = 0;
+    _misses = 0;
+    xSemaphoreGive(_mutex);
+}
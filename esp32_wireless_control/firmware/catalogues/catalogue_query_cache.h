@@ -0,0 +1,90 @@
+/**
+ * @file catalogue_query_cache.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef CATALOGUE_QUERY_CACHE_H
+#define CATALOGUE_QUERY_CACHE_H
+
+#include <Arduino.h>
+
+#include "star_database_interface.h"
+
+// Remembered name searches, 0 disables the cache
+#ifndef CATALOGUE_QUERY_CACHE_ENTRIES
+#define CATALOGUE_QUERY_CACHE_ENTRIES 32
+#endif
+
+// Longer names are not cached
+#define CATALOGUE_QUERY_CACHE_NAME_SIZE 32
+
+struct CatalogueQueryCacheStats
+{
+    size_t entries;
+    size_t capacity;
+    uint32_t hits;
+    uint32_t misses;
+};
+
+/**
+ * @brief Small cache of exact name searches
+ *
+ * Keyed on the searched catalogue and the name, case-insensitive. An entry
+ * only stores where the object is (catalogue and index) or that no
+ * catalogue has it, the object itself is read again through the page
+ * cache. The catalogue is part of the key, so switching catalogues in the
+ * UI keeps the entries of the others. The least recently used entry is
+ * replaced first. All methods lock.
+ */
+class CatalogueQueryCache
+{
+  public:
+    static CatalogueQueryCache& getInstance();
+
+    /**
+     * @brief Look up a cached search
+     * @param source Catalogue holding the object, DB_NONE for a cached miss
+     * @return false if the search is not cached
+     */
+    bool lookup(StarDatabaseType type, const String& name, StarDatabaseType& source,
+                size_t& index);
+
+    // Remember the result of a search, source DB_NONE remembers a miss
+    void store(StarDatabaseType type, const String& name, StarDatabaseType source, size_t index);
+
+    // Drop all entries, before the catalogue data changes
+    void clear();
+
+    CatalogueQueryCacheStats getStats() const;
+    void resetStats();
+
+  private:
+    struct Entry
+    {
+        // Lower-case name, empty if the entry is unused
+        char name[CATALOGUE_QUERY_CACHE_NAME_SIZE];
+        uint8_t type;
+        uint8_t source;
+        uint32_t index;
+        uint32_t used;
+    };
+
+    CatalogueQueryCache();
+
+    CatalogueQueryCache(const CatalogueQueryCache&) = delete;
+    CatalogueQueryCache& operator=(const CatalogueQueryCache&) = delete;
+
+    static bool normalize(const String& name, char* key);
+    Entry* find(StarDatabaseType type, const char* key);
+
+    SemaphoreHandle_t _mutex;
+    Entry _entries[CATALOGUE_QUERY_CACHE_ENTRIES > 0 ? CATALOGUE_QUERY_CACHE_ENTRIES : 1];
+    uint32_t _clock;
+    uint32_t _hits;
+    uint32_t _misses;
+};
+
+#endif // CATALOGUE_QUERY_CACHE_H
@@ -0,0 +1,127 @@
+#include <Arduino.h>
+
+#include "catalogue_page_cache.h"
+#include "columnar_catalogue.h"
+#include "uart.h"
+
+ColumnarCatalogue::ColumnarCatalogue(const char* tag, const char* label) : _tag(tag), _label(label)
+{
+}
+
+ColumnarCatalogue::~ColumnarCatalogue()
+{
+    unloadDatabase();
+}
+
+bool ColumnarCatalogue::loadDatabase(const char* data, size_t len)
+{
+    if (!_blob.open(reinterpret_cast<const uint8_t*>(data), len, _tag))
+    {
+        print_out("Error: Invalid %s catalogue", _label);
+        return false;
+    }
+
+    print_out("%s loaded: %zu objects in %zu blocks", _label, getTotalObjectCount(),
+              _blob.getBlockCount());
+    return getTotalObjectCount() > 0;
+}
+
+bool ColumnarCatalogue::unloadDatabase()
+{
+    CataloguePageCache::getInstance().invalidate(_blob);
+    _blob.close();
+    return true;
+}
+
+bool ColumnarCatalogue::isLoaded() const
+{
+    return _blob.isOpen() && getTotalObjectCount() > 0;
+}
+
+size_t ColumnarCatalogue::getTotalObjectCount() const
+{
+    return _blob.getRecordCount(false);
+}
+
+bool ColumnarCatalogue::findByName(const String& name, StarUnifiedEntry& result) const
+{
+    size_t index;
+    if (_blob.findName(name.c_str(), false, false, index))
+    {
+        return findByIndex(index, result);
+    }
+
+    print_out("%s: Object '%s' not found in catalog", _label, name.c_str());
+    return false;
+}
+
+bool ColumnarCatalogue::findByNameFragment(const String& name_fragment,
+                                           StarUnifiedEntry& result) const
+{
+    size_t index;
+    if (_blob.findName(name_fragment.c_str(), true, false, index))
+    {
+        return findByIndex(index, result);
+    }
+
+    print_out("%s: Fragment '%s' not found in catalog", _label, name_fragment.c_str());
+    return false;
+}
+
+bool ColumnarCatalogue::findIndexByName(const String& name, size_t& index) const
+{
+    return _blob.findName(name.c_str(), false, false, index);
+}
+
+const CatalogueBlob& ColumnarCatalogue::getBlob() const
+{
+    return _blob;
+}
+
+bool ColumnarCatalogue::isCompactProjection() const
+{
+    return false;
+}
+
+size_t ColumnarCatalogue::visit(const CatalogueFilter& filter, uint16_t columns,
+                                const CatalogueRecordPredicate* predicate,
+                                CatalogueRecordVisitor& visitor) const
+{
+    return _blob.visit(false, filter, columns, predicate, visitor);
+}
+
+bool ColumnarCatalogue::findByIndex(size_t index, StarUnifiedEntry& result) const
+{
+    if (!isLoaded())
+    {
+        return false;
+    }
+
+    CatalogueRecord record;
+    if (!CataloguePageCache::getInstance().getRecord(_blob, false, index, record))
+    {
+        return false;
+    }
+
+    // Columns missing from the blob decode as empty strings and zeros
+    result.name = String(record.name);
+    result.type_str = String(record.type);
+    result.ra = skyAngleFromCatalogue(record.ra);
+    result.dec = skyAngleFromCatalogue(record.dec);
+    result.magnitude = record.magnitude();
+    result.constellation = String(record.constellation);
+    result.description = String(record.description);
+    result.spectral_type = String(record.spectral);
+    result.size_arcmin = record.sizeArcmin();
+    result.notes = result.description;
+    return true;
+}
+
+void ColumnarCatalogue::printDatabaseInfo() const
+{
+    print_out("=== %s Catalog Info ===", _label);
+    print_out("Total Objects: %zu", getTotalObjectCount());
+    print_out("Blocks: %zu (%zu bytes)", _blob.getBlockCount(), _blob.getDataSize());
+    print_out("Name index: %s", _blob.hasNameIndex() ? "Yes" : "No");
+    print_out("================================");
+}
@@ -0,0 +1,54 @@
+/**
+ * @file columnar_catalogue.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef COLUMNAR_CATALOGUE_H
+#define COLUMNAR_CATALOGUE_H
+
+#include <Arduino.h>
+
+#include "catalogue_blob.h"
+#include "star_database.h"
+
+/**
+ * @brief Backend for catalogues that need no conversion beyond the blob
+ *
+ * Every column present in the blob maps straight onto StarUnifiedEntry.
+ * Used for the Messier and Caldwell lists and for Hipparcos, which is
+ * large enough (100k+ stars) that it only fits in the catalogue partition.
+ */
+class ColumnarCatalogue : public StarDatabaseInterface
+{
+  public:
+    // tag is the 4-byte tag of the blob, label is used in log output
+    ColumnarCatalogue(const char* tag, const char* label);
+    virtual ~ColumnarCatalogue();
+
+    bool loadDatabase(const char* data, size_t len) override;
+    bool unloadDatabase() override;
+    bool isLoaded() const override;
+
+    bool findByName(const String& name, StarUnifiedEntry& result) const override;
+    bool findByNameFragment(const String& name_fragment, StarUnifiedEntry& result) const override;
+    bool findIndexByName(const String& name, size_t& index) const override;
+    bool findByIndex(size_t index, StarUnifiedEntry& result) const override;
+    const CatalogueBlob& getBlob() const override;
+    bool isCompactProjection() const override;
+    size_t visit(const CatalogueFilter& filter, uint16_t columns,
+                 const CatalogueRecordPredicate* predicate,
+                 CatalogueRecordVisitor& visitor) const override;
+
+    void printDatabaseInfo() const override;
+    size_t getTotalObjectCount() const override;
+
+  private:
+    const char* _tag;
+    const char* _label;
+    CatalogueBlob _blob;
+};
+
+#endif // COLUMNAR_CATALOGUE_H
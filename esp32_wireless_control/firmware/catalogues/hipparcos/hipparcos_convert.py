@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+Hipparcos catalogue to JSON/Binary converter
+
+Reads hip_main.dat of the Hipparcos main catalogue (CDS I/239). The file is
+not shipped with the firmware sources, download it from
+https://cdsarc.cds.unistra.fr/ftp/I/239/hip_main.dat and place it in sources/.
+
+Fields are separated by '|', the ones used here are:
+  H1  HIP number
+  H5  V magnitude
+  H8  RA in degrees, ICRS, epoch J1991.25
+  H9  Dec in degrees, ICRS, epoch J1991.25
+  H12 proper motion in RA * cos(Dec), mas/yr
+  H13 proper motion in Dec, mas/yr
+  H76 spectral type
+
+Positions are moved to J2000 with the proper motion. Stars down to
+--max-magnitude are kept, stars down to --compact-magnitude are flagged
+for the compact projection. The blob does not fit the firmware image, it
+goes into the catalogue partition bundle (../catalogue_bundle.py).
+"""
+
+import argparse
+import json
+import math
+import os
+import sys
+
+BASE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(BASE, '..'))
+from catalogue_blob import (write_catalogue_blob, turns_from_hours, turns_from_degrees,
+                            COL_MAG, COL_NAME, COL_TYPE, COL_SPECTRAL)
+
+# Years from the Hipparcos epoch J1991.25 to J2000
+EPOCH_YEARS = 8.75
+MAS_PER_DEGREE = 3600.0 * 1000.0
+
+
+def parse_hip_line(line):
+    """Parse one row of hip_main.dat, returns None for rows without a position or magnitude"""
+    fields = line.split('|')
+    if len(fields) < 77:
+        return None
+
+    try:
+        hip = int(fields[1])
+        vmag = float(fields[5])
+        ra = float(fields[8])
+        dec = float(fields[9])
+    except ValueError:
+        return None
+
+    pm_ra = float(fields[12]) if fields[12].strip() else 0.0
+    pm_dec = float(fields[13]) if fields[13].strip() else 0.0
+
+    # pmRA includes the cos(Dec) factor, undo it to get the change in RA
+    cos_dec = math.cos(math.radians(dec))
+    if cos_dec > 1e-6:
+        ra += pm_ra * EPOCH_YEARS / MAS_PER_DEGREE / cos_dec
+    dec += pm_dec * EPOCH_YEARS / MAS_PER_DEGREE
+
+    return {
+        'hip': hip,
+        'ra': (ra % 360.0) / 15.0,
+        'dec': max(-90.0, min(90.0, dec)),
+        'magnitude': vmag,
+        'spectral_type': fields[76].strip(),
+    }
+
+
+def read_hipparcos(input_path, max_magnitude):
+    stars = []
+    skipped = 0
+    with open(input_path, 'r', encoding='ascii', errors='ignore') as f:
+        for line in f:
+            star = parse_hip_line(line.rstrip('\r\n'))
+            if star is None:
+                skipped += 1
+            elif star['magnitude'] <= max_magnitude:
+                stars.append(star)
+
+    if skipped:
+        print(f'Skipped {skipped} rows without position or magnitude')
+
+    # RA order keeps the coordinate deltas within a block small
+    stars.sort(key=lambda star: star['ra'])
+    return stars
+
+
+def write_binary(stars, output_path, compact_magnitude):
+    records = []
+    for star in stars:
+        records.append({
+            'compact': star['magnitude'] <= compact_magnitude,
+            'ra': turns_from_hours(star['ra']),
+            'dec': turns_from_degrees(star['dec']),
+            'mag': star['magnitude'],
+            'name': f"HIP {star['hip']}",
+            'type': 'Star',
+            'spectral': star['spectral_type'],
+        })
+    return write_catalogue_blob(records, output_path, b'HIPP',
+                                [COL_MAG, COL_NAME, COL_TYPE, COL_SPECTRAL])
+
+
+def write_json(stars, output_path):
+    with open(output_path, 'w', encoding='utf-8') as out:
+        json.dump([{'name': f"HIP {star['hip']}", 'type': 'Star', 'ra': star['ra'],
+                    'dec': star['dec'], 'magnitude': star['magnitude'],
+                    'spectral_type': star['spectral_type']} for star in stars], out, indent=2)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert the Hipparcos catalogue to JSON/Binary format')
+    parser.add_argument('--input', default=os.path.join(BASE, 'sources', 'hip_main.dat'),
+                        help='hip_main.dat of CDS I/239 (default: sources/hip_main.dat)')
+    parser.add_argument('--output', help='Output file (default: converted/hipparcos.bin/.json)')
+    parser.add_argument('--max-magnitude', type=float, default=6.5,
+                        help='Faintest V magnitude kept (default: 6.5)')
+    parser.add_argument('--compact-magnitude', type=float, default=5.5,
+                        help='Faintest V magnitude of the compact projection (default: 5.5)')
+    parser.add_argument('--binary', action='store_true',
+                        help='Generate the block-compressed binary catalogue instead of JSON')
+    args = parser.parse_args()
+
+    if not os.path.exists(args.input):
+        print(f'Error: {args.input} not found, see the header of this script', file=sys.stderr)
+        return 1
+
+    stars = read_hipparcos(args.input, args.max_magnitude)
+    out_path = args.output or os.path.join(BASE, 'converted',
+                                           'hipparcos.bin' if args.binary else 'hipparcos.json')
+    os.makedirs(os.path.dirname(os.path.abspath(out_path)), exist_ok=True)
+
+    if args.binary:
+        stats = write_binary(stars, out_path, args.compact_magnitude)
+        print(f"Blocks: {stats['blocks']}, string table: {stats['string_table']} bytes, "
+              f"name index: {stats['name_index']} bytes")
+    else:
+        write_json(stars, out_path)
+    print(f'Generated {len(stars)} stars in {out_path} ({os.path.getsize(out_path)} bytes)')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -38,10 +38,38 @@ Object Types (from README):
 """
 
 import json
-import struct
 import os
+import sys
 import argparse
 
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+from catalogue_blob import (write_catalogue_blob, turns_from_hours, turns_from_degrees,
+                            common_name_aliases, COL_MAG, COL_SIZE, COL_NAME, COL_TYPE,
+                            COL_CONSTELLATION, COL_DESCRIPTION)
+
+def normalize_ngc_id(raw_id):
+    """NGC 2000.0 designation ('I 342', ' 224') to the converter form ('IC342', 'NGC224')"""
+    raw_id = raw_id.replace(' ', '')
+    if raw_id.startswith('I'):
+        return 'IC' + raw_id[1:]
+    if raw_id.isdigit():
+        return 'NGC' + raw_id
+    return raw_id
+
+def load_object_names(names_path):
+    """Parse names.dat, the common names and Messier numbers of each NGC/IC object in file order"""
+    names = {}
+    if not os.path.exists(names_path):
+        return names
+
+    with open(names_path, 'r', encoding='utf-8', errors='ignore') as f:
+        for line in f:
+            name = line[0:36].strip()
+            object_id = normalize_ngc_id(line[36:41].strip())
+            if name and object_id:
+                names.setdefault(object_id, []).append(name)
+    return names
+
 def parse_ngc_line(line):
     """Parse a single line from the NGC 2000.0 data file"""
     if len(line) < 99:
@@ -129,46 +157,31 @@ def parse_ngc_line(line):
         "description": description
     }
 
-def write_binary_format(objects, output_path, compact_format):
-    """Write NGC objects in custom binary format"""
-    with open(output_path, 'wb') as f:
-        # Write header
-        f.write(struct.pack('<I', len(objects)))  # Number of objects
-        f.write(b'NGC2' if not compact_format else b'NC2C')  # Magic number
-        f.write(struct.pack('<I', 1))  # Version
-
-        # Write object entries
-        for obj in objects:
-            if compact_format:
-                # Compact binary format: id (12s), type (4s), ra_deg (f), dec_deg (f), magnitude (f)
-                id_bytes = obj['id'][:11].ljust(11, '\0').encode('ascii')
-                id_bytes += b'\0'  # Ensure 12 bytes
-                f.write(id_bytes)
-                type_bytes = obj['type'][:3].ljust(3, '\0').encode('ascii')
-                type_bytes += b'\0'  # Ensure 4 bytes
-                f.write(type_bytes)
-                f.write(struct.pack('<f', float(obj['ra'] or 0)))
-                f.write(struct.pack('<f', float(obj['dec'] or 0)))
-                f.write(struct.pack('<f', float(obj.get('magnitude', 0) or 0)))
-                # Omit description, constellation, size_arcmin
-            else:
-                # Full binary format: id (12s), type (4s), ra_deg (f), dec_deg (f), constellation (3s), size_arcmin (f), magnitude (f), description (48s)
-                id_bytes = obj['id'][:11].ljust(11, '\0').encode('ascii')
-                id_bytes += b'\0'  # Ensure 12 bytes
-                f.write(id_bytes)
-                type_bytes = obj['type'][:3].ljust(3, '\0').encode('ascii')
-                type_bytes += b'\0'  # Ensure 4 bytes
-                f.write(type_bytes)
-                f.write(struct.pack('<f', float(obj['ra'] or 0)))
-                f.write(struct.pack('<f', float(obj['dec'] or 0)))
-                const = obj.get('constellation', '')[:3].ljust(3, '\0').encode('ascii')
-                f.write(const)
-                f.write(struct.pack('<f', float(obj.get('size_arcmin', 0) or 0)))
-                f.write(struct.pack('<f', float(obj.get('magnitude', 0) or 0)))
-                desc = obj.get('description', '')
-                desc_bytes = desc.encode('utf-8')[:47]
-                desc_bytes += b'\0' * (48 - len(desc_bytes))
-                f.write(desc_bytes)
+def write_binary_format(objects, output_path, object_names):
+    """Write NGC objects as a block-compressed catalogue blob (see catalogue_blob.py)
+
+    The compact projection only drops fields, so every object is flagged compact.
+    The names of names.dat ("M 31", "Great Nebula in Andromeda") become aliases.
+    """
+    records = []
+    for obj in objects:
+        aliases = []
+        for name in object_names.get(obj['id'], []):
+            aliases.extend(common_name_aliases(name))
+        records.append({
+            'compact': True,
+            'ra': turns_from_hours(float(obj['ra'] or 0)),
+            'dec': turns_from_degrees(float(obj['dec'] or 0)),
+            'mag': obj.get('magnitude', 0),
+            'size': obj.get('size_arcmin', 0),
+            'name': obj['id'],
+            'type': obj['type'],
+            'constellation': obj.get('constellation', ''),
+            'description': obj.get('description', ''),
+            'aliases': aliases,
+        })
+    columns = [COL_MAG, COL_SIZE, COL_NAME, COL_TYPE, COL_CONSTELLATION, COL_DESCRIPTION]
+    return write_catalogue_blob(records, output_path, b'NGC2', columns)
 
 def write_json_format(objects, output_path, compact_format):
     """Write NGC objects in JSON format with only the fields present in the binary format."""
@@ -228,7 +241,7 @@ def main():
     parser.add_argument('--compact', action='store_true', 
                        help='Generate compact format (reduced field names and quantized data)')
     parser.add_argument('--binary', action='store_true',
-                       help='Generate binary format instead of JSON')
+                       help='Generate block-compressed binary catalogue (full and compact) instead of JSON')
     parser.add_argument('--types', nargs='*', 
                        help='Object types to include (e.g., Gx OC Gb Pl)')
     parser.add_argument('--max-magnitude', type=float,
@@ -308,9 +321,14 @@ def main():
                 continue
 
     if args.binary:
-        suffix = "_compact" if args.compact else ""
-        out_path = os.path.join(base, f"converted/ngc2000{suffix}.bin")
-        write_binary_format(objects, out_path, args.compact)
+        # One blob serves both the full and the compact catalogue
+        if args.compact:
+            print("Note: the binary catalogue always contains the compact projection, ignoring --compact")
+        out_path = os.path.join(base, "converted/ngc2000.bin")
+        object_names = load_object_names(os.path.join(base, "sources/names.dat"))
+        stats = write_binary_format(objects, out_path, object_names)
+        print(f"Blocks: {stats['blocks']}, string table: {stats['string_table']} bytes, "
+              f"aliases: {stats['aliases']}")
     else:
         suffix = "_compact" if args.compact else ""
         out_path = os.path.join(base, f"converted/ngc2000{suffix}.json")
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""
+Object list converter shared by the Messier and Caldwell catalogues
+
+An object list names deep-sky objects by their NGC/IC designation, the
+position and the other fields are taken from NGC 2000.0 (ngc/sources). Objects
+that are not in NGC 2000.0 list all fields themselves. See the header of
+messier/sources/messier.dat for the list format.
+
+The output is the usual pair: an OGCB blob (catalogue_blob.py) for the
+firmware and a JSON twin with the NGC2000 field names for inspection and the
+host checks.
+"""
+
+import json
+import os
+import re
+import sys
+
+BASE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(BASE, 'ngc'))
+from catalogue_blob import (write_catalogue_blob, turns_from_hours, turns_from_degrees,
+                            common_name_aliases, COL_MAG, COL_SIZE, COL_NAME, COL_TYPE,
+                            COL_CONSTELLATION, COL_DESCRIPTION)
+from ngc2000_convert import parse_ngc_line, load_object_names
+
+NGC_SOURCE = os.path.join(BASE, 'ngc', 'sources', 'ngc2000.dat')
+NAMES_SOURCE = os.path.join(BASE, 'ngc', 'sources', 'names.dat')
+
+
+def load_ngc():
+    objects = {}
+    with open(NGC_SOURCE, 'r', encoding='utf-8', errors='ignore') as f:
+        for line in f:
+            obj = parse_ngc_line(line.rstrip('\r\n'))
+            # The first entry of a designation is the primary one
+            if obj['id'] and obj['ra'] is not None and obj['dec'] is not None:
+                objects.setdefault(obj['id'], obj)
+    return objects
+
+
+def load_common_names():
+    names = {}
+    for object_id, object_names in load_object_names(NAMES_SOURCE).items():
+        # names.dat also lists the Messier numbers, those are not common names
+        common = [name for name in object_names if not re.match(r'M\s*\d+$', name)]
+        if common:
+            names[object_id] = common[0]
+    return names
+
+
+def _aliases(object_id, common_name):
+    """NGC/IC id and common names of a list object, for the alias index"""
+    aliases = [object_id] if object_id else []
+    for name in common_name.split(','):
+        if name.strip():
+            aliases.extend(common_name_aliases(name.strip()))
+    return aliases
+
+
+def _sexagesimal(text, signed):
+    parts = text.split()
+    sign = -1.0 if signed and parts[0].startswith('-') else 1.0
+    return sign * (abs(float(parts[0])) + float(parts[1]) / 60.0)
+
+
+def _optional_float(text):
+    return float(text) if text.strip() else None
+
+
+def read_object_list(list_path):
+    """Resolve every row of an object list, returns objects in the NGC2000 JSON layout"""
+    ngc = load_ngc()
+    common_names = load_common_names()
+    objects = []
+
+    with open(list_path, 'r', encoding='utf-8') as f:
+        for line_num, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            fields = [field.strip() for field in line.split('|')]
+            if len(fields) != 9:
+                raise ValueError(f'{list_path}:{line_num}: expected 9 fields')
+            designation, object_id, obj_type, ra, dec, mag, size, constellation, name = fields
+
+            if object_id:
+                source = ngc.get(object_id)
+                if source is None:
+                    raise ValueError(f'{list_path}:{line_num}: {object_id} not in NGC 2000.0')
+                common_name = name or common_names.get(object_id, '')
+                objects.append({
+                    'id': designation,
+                    'type': source['type'],
+                    'ra': source['ra'],
+                    'dec': source['dec'],
+                    'constellation': source['constellation'],
+                    'size_arcmin': source['size_arcmin'] or 0,
+                    'magnitude': source['magnitude'] or 0,
+                    'description': f'{object_id}, {common_name}' if common_name else object_id,
+                    'aliases': _aliases(object_id, common_name),
+                })
+            else:
+                objects.append({
+                    'id': designation,
+                    'type': obj_type,
+                    'ra': _sexagesimal(ra, False),
+                    'dec': _sexagesimal(dec, True),
+                    'constellation': constellation,
+                    'size_arcmin': _optional_float(size) or 0,
+                    'magnitude': _optional_float(mag) or 0,
+                    'description': name,
+                    'aliases': _aliases('', name),
+                })
+
+    # RA order keeps the coordinate deltas within a block small
+    objects.sort(key=lambda obj: obj['ra'])
+    return objects
+
+
+def write_binary(objects, output_path, tag):
+    records = []
+    for obj in objects:
+        records.append({
+            'compact': True,
+            'ra': turns_from_hours(obj['ra']),
+            'dec': turns_from_degrees(obj['dec']),
+            'mag': obj['magnitude'],
+            'size': obj['size_arcmin'],
+            'name': obj['id'],
+            'type': obj['type'],
+            'constellation': obj['constellation'],
+            'description': obj['description'],
+            'aliases': obj['aliases'],
+        })
+    columns = [COL_MAG, COL_SIZE, COL_NAME, COL_TYPE, COL_CONSTELLATION, COL_DESCRIPTION]
+    return write_catalogue_blob(records, output_path, tag, columns)
+
+
+def write_json(objects, output_path):
+    # Aliases only go to the alias index of the binary catalogue
+    objects = [{key: value for key, value in obj.items() if key != 'aliases'} for obj in objects]
+    with open(output_path, 'w', encoding='utf-8') as out:
+        json.dump(objects, out, ensure_ascii=False, indent=2)
+
+
+def convert_object_list(list_path, tag, output_base, binary):
+    """Convert an object list to output_base.bin (binary) or output_base.json"""
+    objects = read_object_list(list_path)
+    if binary:
+        out_path = output_base + '.bin'
+        stats = write_binary(objects, out_path, tag)
+        print(f"Blocks: {stats['blocks']}, string table: {stats['string_table']} bytes, "
+              f"aliases: {stats['aliases']}")
+    else:
+        out_path = output_base + '.json'
+        write_json(objects, out_path)
+    print(f'Generated {len(objects)} objects in {out_path} ({os.path.getsize(out_path)} bytes)')
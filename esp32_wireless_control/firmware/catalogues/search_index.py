@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""
+Client-side search index writer
+
+Writes the names and J2000 positions of the catalogues embedded in the
+firmware as one gzip-compressed JSON file, embedded next to them and served
+by GET /catalogIndex. The web interface downloads it once, the browser
+caches it, and completes names locally instead of asking the tracker on
+every key press.
+
+Layout (JSON, gzip-compressed):
+
+  {"version": 1,
+   "catalogs": [
+     {"catalog": 1,         StarDatabaseType of the full catalogue
+      "compact": 2,         StarDatabaseType of the compact variant, or null
+      "names": [...],       in catalogue order, the index of /catalogBrowse
+      "ra": [...],          J2000 right ascension in seconds of time
+      "dec": [...],         J2000 declination in arcseconds
+      "mag": [...],         magnitude, null if unknown
+      "inCompact": "0110"}  per object, 1 if it is part of the compact variant
+   ]}
+
+The output is byte-for-byte reproducible (no time stamp in the gzip header),
+so the ETag of /catalogIndex only changes with the data.
+
+Usage:
+  python search_index.py ngc/converted/ngc2000.bin bsc5/converted/bsc5ra.bin \\
+      messier/converted/messier.bin caldwell/converted/caldwell.bin
+"""
+
+import argparse
+import gzip
+import json
+import sys
+
+from catalogue_blob import TURN, read_catalogue_blob
+
+INDEX_VERSION = 1
+
+# StarDatabaseType of the full and the compact catalogue by blob tag
+CATALOG_TYPES = {
+    b'NGC2': (1, 2),
+    b'BSC5': (3, 4),
+    b'MESS': (5, None),
+    b'CALD': (6, None),
+    b'HIPP': (7, None),
+}
+
+
+def catalog_entry(tag, records):
+    full, compact = CATALOG_TYPES[tag]
+    return {
+        'catalog': full,
+        'compact': compact,
+        'names': [rec.get('name', '') for rec in records],
+        'ra': [int(round(rec['ra'] * 86400 / TURN)) for rec in records],
+        'dec': [int(round(rec['dec'] * 1296000 / TURN)) for rec in records],
+        'mag': [round(rec['mag'], 2) if rec.get('mag') else None for rec in records],
+        'inCompact': ''.join('1' if rec['compact'] else '0' for rec in records),
+    }
+
+
+def write_search_index(blob_paths, output_path):
+    catalogs = []
+    for path in blob_paths:
+        with open(path, 'rb') as f:
+            tag, records = read_catalogue_blob(f.read())
+        if tag not in CATALOG_TYPES:
+            raise ValueError(f'Unknown catalogue {tag.decode()} in {path}')
+        catalogs.append(catalog_entry(tag, records))
+
+    text = json.dumps({'version': INDEX_VERSION, 'catalogs': catalogs}, separators=(',', ':'),
+                      ensure_ascii=False).encode('utf-8')
+    with open(output_path, 'wb') as f:
+        with gzip.GzipFile(filename='', mode='wb', fileobj=f, compresslevel=9, mtime=0) as out:
+            out.write(text)
+
+    with open(output_path, 'rb') as f:
+        size = len(f.read())
+    print(f'Search index: {sum(len(c["names"]) for c in catalogs)} objects, '
+          f'{len(text)} bytes JSON, {size} bytes gzip -> {output_path}')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Write the client-side search index')
+    parser.add_argument('blobs', nargs='+', help='OGCB blobs written by the converters')
+    parser.add_argument('--output', default='search_index.json.gz', help='Output file')
+    args = parser.parse_args()
+
+    try:
+        write_search_index(args.blobs, args.output)
+    except (OSError, ValueError) as e:
+        print(f'Error: {e}', file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
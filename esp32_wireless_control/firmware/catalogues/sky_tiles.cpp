@@ -0,0 +1,152 @@
+#include <string.h>
+
+#include "sky_tiles.h"
+#include "star_database_registry.h"
+
+static const char SKY_TILE_MAGIC[4] = {'O', 'G', 'T', 'L'};
+
+// Type strings of the catalogues, indexed by SkyTileType
+static const char* const type_names[] = {"", "Gx", "OC", "Gb", "Nb", "Pl", "C+N", "DN", "D*"};
+
+// Data tags by catalogue, 0 until computed
+static uint32_t data_tags[DB_COUNT];
+
+SkyTileEncoder::SkyTileEncoder(const CatalogueBlob& blob, bool compact)
+    : _blob(blob),
+      _cursor(blob, compact, (1 << COL_RA) | (1 << COL_DEC) | (1 << COL_MAG) | (1 << COL_TYPE)),
+      _used(0), _filter(), _count(0), _any_magnitude(true), _done(true)
+{
+}
+
+// First position of a band or sector. Boundaries are rounded up so that a
+// position is in the tile given by the formula in sky_tiles.h
+static int32_t tileStart(size_t step, size_t steps)
+{
+    return (int32_t) (((int64_t) step * CATALOGUE_TURN + steps - 1) / steps);
+}
+
+bool SkyTileEncoder::getTileFilter(size_t tile, CatalogueFilter& filter)
+{
+    if (tile >= SKY_TILE_COUNT)
+        return false;
+
+    size_t band = tile / SKY_TILE_RA_SECTORS;
+    size_t sector = tile % SKY_TILE_RA_SECTORS;
+    filter.ra_min = tileStart(sector, SKY_TILE_RA_SECTORS);
+    filter.ra_max = tileStart(sector + 1, SKY_TILE_RA_SECTORS) - 1;
+    // Bands cover half a turn of declination from the south pole
+    filter.dec_min = tileStart(band, 2 * SKY_TILE_DEC_BANDS) - CATALOGUE_TURN / 4;
+    filter.dec_max = band + 1 < SKY_TILE_DEC_BANDS
+                         ? tileStart(band + 1, 2 * SKY_TILE_DEC_BANDS) - CATALOGUE_TURN / 4 - 1
+                         : CATALOGUE_TURN / 4;
+    return true;
+}
+
+uint8_t SkyTileEncoder::getTypeCode(const char* type)
+{
+    for (size_t i = 0; i < sizeof(type_names) / sizeof(type_names[0]); i++)
+    {
+        if (strcmp(type, type_names[i]) == 0)
+            return (uint8_t) i;
+    }
+    return strcmp(type, "*") == 0 ? SKY_TILE_STAR : SKY_TILE_OTHER;
+}
+
+uint32_t SkyTileEncoder::getDataTag(StarDatabaseType type)
+{
+    if (type <= DB_NONE || type >= DB_COUNT)
+        return 0;
+    if (data_tags[type] != 0)
+        return data_tags[type];
+
+    const StarDatabase* db = StarDatabaseRegistry::getInstance().getDatabase(type);
+    const CatalogueBlob* blob = db != nullptr ? db->getBlob() : nullptr;
+    if (blob == nullptr || !blob->isOpen())
+        return 0;
+
+    const uint8_t* data = blob->getData();
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < blob->getDataSize(); i++)
+        hash = (hash ^ data[i]) * 16777619u;
+    data_tags[type] = hash != 0 ? hash : 1;
+    return data_tags[type];
+}
+
+bool SkyTileEncoder::begin(size_t tile, int16_t mag_max_centi)
+{
+    _done = true;
+    _count = 0;
+    _used = 0;
+    CatalogueFilter filter;
+    if (!_blob.isOpen() || !getTileFilter(tile, filter) || !_cursor.seek(0))
+        return false;
+    _any_magnitude = mag_max_centi == INT16_MAX;
+    filter.mag_max = mag_max_centi;
+    _filter = filter;
+
+    memcpy(_buffer, SKY_TILE_MAGIC, sizeof(SKY_TILE_MAGIC));
+    _buffer[4] = SKY_TILE_FORMAT_VERSION;
+    _buffer[5] = SKY_TILE_RECORD_SIZE;
+    _buffer[6] = (uint8_t) tile;
+    _buffer[7] = (uint8_t) (tile >> 8);
+    _used = SKY_TILE_HEADER_SIZE;
+    _done = false;
+    return true;
+}
+
+size_t SkyTileEncoder::next(const uint8_t*& data)
+{
+    // Only the blocks overlapping the tile are decoded, the cursor skips the others
+    CatalogueRecord record;
+    while (!_done && _used + SKY_TILE_RECORD_SIZE <= sizeof(_buffer))
+    {
+        if (!_cursor.next(record, _filter))
+            _done = true;
+        else if (record.mag_centi != 0 || _any_magnitude)
+            append(record);
+    }
+
+    data = _buffer;
+    size_t length = _used;
+    _used = 0;
+    return length;
+}
+
+size_t SkyTileEncoder::encode(size_t tile, int16_t mag_max_centi, SkyTileSink& sink)
+{
+    if (!begin(tile, mag_max_centi))
+        return 0;
+
+    for (;;)
+    {
+        const uint8_t* data;
+        size_t length = next(data);
+        if (length == 0 || !sink.write(data, length))
+            return _count;
+    }
+}
+
+void SkyTileEncoder::append(const CatalogueRecord& record)
+{
+    // 1/2^24 of a turn rounded to 1/2^16, RA wraps to 0 at the end of the turn
+    uint16_t ra = (uint16_t) ((record.ra + 128) >> 8);
+    int16_t dec = (int16_t) ((record.dec + 128) >> 8);
+    int32_t mag =
+        record.mag_centi >= 0 ? (record.mag_centi + 5) / 10 : (record.mag_centi - 5) / 10;
+    if (record.mag_centi == 0)
+        mag = SKY_TILE_NO_MAGNITUDE;
+    else if (mag >= SKY_TILE_NO_MAGNITUDE)
+        mag = SKY_TILE_NO_MAGNITUDE - 1;
+    else if (mag < INT8_MIN)
+        mag = INT8_MIN;
+
+    uint8_t* out = _buffer + _used;
+    out[0] = (uint8_t) ra;
+    out[1] = (uint8_t) (ra >> 8);
+    out[2] = (uint8_t) dec;
+    out[3] = (uint8_t) ((uint16_t) dec >> 8);
+    out[4] = (uint8_t) (int8_t) mag;
+    out[5] = getTypeCode(record.type);
+    _used += SKY_TILE_RECORD_SIZE;
+    _count++;
+}
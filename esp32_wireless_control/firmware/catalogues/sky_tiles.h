@@ -0,0 +1,143 @@
+/**
+ * @file sky_tiles.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef SKY_TILES_H
+#define SKY_TILES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "catalogue_blob.h"
+#include "star_database_interface.h"
+
+// Sky tiles for client-side chart rendering ("OGTL"). The sky is cut into
+// SKY_TILE_DEC_BANDS declination bands from south to north, each cut into
+// SKY_TILE_RA_SECTORS sectors of right ascension:
+//   tile = band * SKY_TILE_RA_SECTORS + sector
+//   band = floor((dec + 90) / 15), sector = floor(ra in hours)
+// The north pole belongs to the last band.
+//
+// Layout (all integers little-endian):
+//   Header (8 bytes)
+//      0  char[4]  magic "OGTL"
+//      4  uint8    format version
+//      5  uint8    record size
+//      6  uint16   tile
+//   Records, as many as fit the response
+//      uint16  RA, 1/65536 of a turn (~20 arcsec)
+//      int16   Dec, 1/65536 of a turn
+//      int8    magnitude in tenths, SKY_TILE_NO_MAGNITUDE if unknown
+//      uint8   SkyTileType
+#define SKY_TILE_RA_SECTORS 24
+#define SKY_TILE_DEC_BANDS 12
+#define SKY_TILE_COUNT (SKY_TILE_RA_SECTORS * SKY_TILE_DEC_BANDS)
+
+#define SKY_TILE_FORMAT_VERSION 1
+#define SKY_TILE_HEADER_SIZE 8
+#define SKY_TILE_RECORD_SIZE 6
+#define SKY_TILE_NO_MAGNITUDE INT8_MAX
+
+// Tiles are assembled in this buffer, one piece of the response at a time
+#define SKY_TILE_BUFFER_SIZE (SKY_TILE_HEADER_SIZE + 170 * SKY_TILE_RECORD_SIZE)
+
+// Object types of the catalogues, the order is part of the format
+enum SkyTileType
+{
+    SKY_TILE_STAR = 0,       // Stars and records without a type
+    SKY_TILE_GALAXY,         // Gx
+    SKY_TILE_OPEN_CLUSTER,   // OC
+    SKY_TILE_GLOBULAR,       // Gb
+    SKY_TILE_NEBULA,         // Nb
+    SKY_TILE_PLANETARY,      // Pl
+    SKY_TILE_CLUSTER_NEBULA, // C+N
+    SKY_TILE_DARK_NEBULA,    // DN
+    SKY_TILE_DOUBLE_STAR,    // D*
+    SKY_TILE_OTHER = 255
+};
+
+// Receives the bytes of a tile in order, return false to stop
+class SkyTileSink
+{
+  public:
+    virtual ~SkyTileSink()
+    {
+    }
+    virtual bool write(const uint8_t* data, size_t len) = 0;
+};
+
+/**
+ * @brief Encodes the records of a catalogue projection in one sky tile
+ *
+ * Only the blocks whose statistics overlap the tile are read. Position,
+ * magnitude and type are decoded from them and quantized straight into the
+ * send buffer, no other copy of a record is made. With a magnitude limit,
+ * fainter objects and objects without a magnitude are left out.
+ *
+ * A tile is encoded a buffer at a time: the cursor stays where the last
+ * piece ended, so the web server sends a piece before it encodes the next.
+ */
+class SkyTileEncoder
+{
+  public:
+    SkyTileEncoder(const CatalogueBlob& blob, bool compact);
+
+    /**
+     * @brief Start a tile, its header goes into the first piece
+     * @param mag_max_centi Faintest magnitude in hundredths, INT16_MAX for all objects
+     * @return false if the tile is out of range or the catalogue is not open
+     */
+    bool begin(size_t tile, int16_t mag_max_centi);
+
+    /**
+     * @brief Encode the next piece of the tile started by begin()
+     * @return Length of the piece at data, valid until the next call, 0 once the tile is complete
+     */
+    size_t next(const uint8_t*& data);
+
+    /**
+     * @brief Write the header and the records of a tile to the sink
+     * @param mag_max_centi Faintest magnitude in hundredths, INT16_MAX for all objects
+     * @return Number of records written
+     */
+    size_t encode(size_t tile, int16_t mag_max_centi, SkyTileSink& sink);
+
+    // Records of the tile encoded so far
+    size_t getCount() const
+    {
+        return _count;
+    }
+
+    // Filter selecting the records of a tile, false if tile is out of range
+    static bool getTileFilter(size_t tile, CatalogueFilter& filter);
+    static uint8_t getTypeCode(const char* type);
+
+    /**
+     * @brief Version of the data of a catalogue, for ETag headers
+     *
+     * FNV-1a of the whole blob, computed on first use and remembered until
+     * reboot (new catalogue data is only used after one). Used from the web
+     * server task only.
+     * @return 0 if the catalogue is not registered
+     */
+    static uint32_t getDataTag(StarDatabaseType type);
+
+  private:
+    void append(const CatalogueRecord& record);
+
+    const CatalogueBlob& _blob;
+    CatalogueCursor _cursor;
+    uint8_t _buffer[SKY_TILE_BUFFER_SIZE];
+    size_t _used;
+    // State of the tile being encoded
+    CatalogueFilter _filter;
+    size_t _count;
+    bool _any_magnitude;
+    bool _done;
+};
+
+#endif // SKY_TILES_H
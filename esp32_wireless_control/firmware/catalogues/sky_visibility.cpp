@@ -0,0 +1,179 @@
+#include <math.h>
+
+#include "apparent_place.h"
+#include "sky_visibility.h"
+#include "star_database_registry.h"
+
+// Precession since J2000 moves declinations by less than this
+#define SKY_VISIBILITY_DEC_MARGIN_DEG 1.0f
+// Sorts objects without magnitude after all others
+#define SKY_VISIBILITY_NO_MAGNITUDE_KEY 1000.0f
+
+SkyVisibility::SkyVisibility(const SkyVisibilityQuery& query) : _query(query)
+{
+    // Greenwich mean sidereal time (Meeus, Astronomical Algorithms, 12.4), once per query
+    double days = query.utc / 86400.0 + UNIX_EPOCH_JD - J2000_JD;
+    double t = days / DAYS_PER_CENTURY;
+    double gmst =
+        280.46061837 + 360.98564736629 * days + 0.000387933 * t * t - t * t * t / 38710000.0;
+    _sidereal_deg = fmod(gmst + query.longitude_deg, 360.0);
+    if (_sidereal_deg < 0.0)
+        _sidereal_deg += 360.0;
+
+    float lst = (float) (_sidereal_deg * DEG_TO_RAD);
+    float lat = query.latitude_deg * (float) DEG_TO_RAD;
+    float zenith[3] = {cosf(lat) * cosf(lst), cosf(lat) * sinf(lst), sinf(lat)};
+    float north[3] = {-sinf(lat) * cosf(lst), -sinf(lat) * sinf(lst), cosf(lat)};
+    float east[3] = {-sinf(lst), cosf(lst), 0.0f};
+
+    // The rotation takes J2000 to the equator of date, its transpose goes back
+    ApparentPlace& apparentPlace = ApparentPlace::getInstance();
+    apparentPlace.setEpoch(query.utc);
+    float rotation[3][3];
+    apparentPlace.getRotation(rotation);
+    for (int i = 0; i < 3; i++)
+    {
+        _zenith[i] = rotation[0][i] * zenith[0] + rotation[1][i] * zenith[1] +
+                     rotation[2][i] * zenith[2];
+        _north[i] =
+            rotation[0][i] * north[0] + rotation[1][i] * north[1] + rotation[2][i] * north[2];
+        _east[i] = rotation[0][i] * east[0] + rotation[1][i] * east[1] + rotation[2][i] * east[2];
+    }
+
+    _min_sin_altitude = sinf(query.min_altitude_deg * (float) DEG_TO_RAD);
+}
+
+void SkyVisibility::fromVector(const float v[3], float& altitude_deg, float& azimuth_deg) const
+{
+    float up = v[0] * _zenith[0] + v[1] * _zenith[1] + v[2] * _zenith[2];
+    float north = v[0] * _north[0] + v[1] * _north[1] + v[2] * _north[2];
+    float east = v[0] * _east[0] + v[1] * _east[1] + v[2] * _east[2];
+
+    // atan2 stays accurate close to the zenith, asin does not
+    altitude_deg = atan2f(up, sqrtf(north * north + east * east)) * (float) RAD_TO_DEG;
+    azimuth_deg = atan2f(east, north) * (float) RAD_TO_DEG;
+    if (azimuth_deg < 0.0f)
+        azimuth_deg += 360.0f;
+}
+
+void SkyVisibility::toHorizontal(int32_t ra, int32_t dec, float& altitude_deg,
+                                 float& azimuth_deg) const
+{
+    float v[3];
+    ApparentPlace::toVector(ra, dec, v);
+    fromVector(v, altitude_deg, azimuth_deg);
+}
+
+static float magnitudeKey(float magnitude)
+{
+    return magnitude == 0.0f ? SKY_VISIBILITY_NO_MAGNITUDE_KEY : magnitude;
+}
+
+bool SkyVisibility::isBetter(const SkyVisibleObject& a, const SkyVisibleObject& b) const
+{
+    if (_query.sort == SORT_BY_MAGNITUDE && magnitudeKey(a.magnitude) != magnitudeKey(b.magnitude))
+        return magnitudeKey(a.magnitude) < magnitudeKey(b.magnitude);
+    return a.altitude_deg > b.altitude_deg;
+}
+
+size_t SkyVisibility::find(SkyVisibleObject* results, size_t max_results) const
+{
+    size_t count = 0;
+    if (max_results == 0)
+        return 0;
+
+    for (size_t i = DB_NONE + 1; i < DB_COUNT; i++)
+    {
+        bool scanned = _query.catalogue == DB_NONE ? (i == DB_NGC2000 || i == DB_BSC5)
+                                                   : i == (size_t) _query.catalogue;
+        if (scanned)
+            scan((StarDatabaseType) i, results, max_results, count);
+    }
+    return count;
+}
+
+// Ranks the objects of one catalogue into the results of a query
+class SkyVisibilityScan : public CatalogueRecordVisitor
+{
+  public:
+    SkyVisibilityScan(const SkyVisibility& visibility, StarDatabaseType type,
+                      SkyVisibleObject* results, size_t max_results, size_t& count)
+        : _visibility(visibility), _type(type), _results(results), _max_results(max_results),
+          _count(count)
+    {
+    }
+
+    bool visit(size_t index, const CatalogueRecord& record) override
+    {
+        _visibility.consider(_type, index, record, _results, _max_results, _count);
+        return true;
+    }
+
+  private:
+    const SkyVisibility& _visibility;
+    StarDatabaseType _type;
+    SkyVisibleObject* _results;
+    size_t _max_results;
+    size_t& _count;
+};
+
+void SkyVisibility::scan(StarDatabaseType type, SkyVisibleObject* results, size_t max_results,
+                         size_t& count) const
+{
+    const StarDatabase* db = StarDatabaseRegistry::getInstance().getDatabase(type);
+    if (db == nullptr)
+        return;
+
+    // Objects outside this declination band never get above the limit
+    float dec_min = _query.latitude_deg - 90.0f + _query.min_altitude_deg;
+    float dec_max = _query.latitude_deg + 90.0f - _query.min_altitude_deg;
+    CatalogueFilter filter;
+    if (dec_min - SKY_VISIBILITY_DEC_MARGIN_DEG > -90.0f)
+        filter.dec_min = (int32_t) ((dec_min - SKY_VISIBILITY_DEC_MARGIN_DEG) *
+                                    (CATALOGUE_TURN / 360.0f));
+    if (dec_max + SKY_VISIBILITY_DEC_MARGIN_DEG < 90.0f)
+        filter.dec_max = (int32_t) ((dec_max + SKY_VISIBILITY_DEC_MARGIN_DEG) *
+                                    (CATALOGUE_TURN / 360.0f));
+    if (_query.max_magnitude < SKY_VISIBILITY_ANY_MAGNITUDE)
+        filter.mag_max = (int16_t) floorf(_query.max_magnitude * 100.0f);
+
+    // Only position and magnitude are decoded, names are read for the results only
+    SkyVisibilityScan visitor(*this, type, results, max_results, count);
+    db->visit(filter, (1 << COL_RA) | (1 << COL_DEC) | (1 << COL_MAG), nullptr, visitor);
+}
+
+void SkyVisibility::consider(StarDatabaseType type, size_t index, const CatalogueRecord& record,
+                             SkyVisibleObject* results, size_t max_results, size_t& count) const
+{
+    SkyVisibleObject candidate;
+    candidate.magnitude = record.magnitude();
+    if (record.mag_centi == 0 && _query.max_magnitude < SKY_VISIBILITY_ANY_MAGNITUDE)
+        return;
+
+    // Fainter than the faintest result, no need to compute the altitude
+    bool full = count == max_results;
+    if (full && _query.sort == SORT_BY_MAGNITUDE &&
+        magnitudeKey(candidate.magnitude) > magnitudeKey(results[count - 1].magnitude))
+        return;
+
+    float v[3];
+    ApparentPlace::toVector(skyAngleFromCatalogue(record.ra), skyAngleFromCatalogue(record.dec),
+                            v);
+    if (v[0] * _zenith[0] + v[1] * _zenith[1] + v[2] * _zenith[2] < _min_sin_altitude)
+        return;
+
+    candidate.source = type;
+    candidate.index = index;
+    fromVector(v, candidate.altitude_deg, candidate.azimuth_deg);
+    if (full && !isBetter(candidate, results[count - 1]))
+        return;
+
+    // Insert sorted, the worst result drops out once the list is full
+    size_t position = full ? count - 1 : count++;
+    while (position > 0 && isBetter(candidate, results[position - 1]))
+    {
+        results[position] = results[position - 1];
+        position--;
+    }
+    results[position] = candidate;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file sky_visibility.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef SKY_VISIBILITY_H
+#define SKY_VISIBILITY_H
+
+#include <Arduino.h>
+#include <time.h>
+
+#include "star_database_interface.h"
+
+// Largest number of objects one query returns
+#define SKY_VISIBILITY_MAX_RESULTS 100
+
+// Magnitude limit that keeps every object, those without a magnitude too
+#define SKY_VISIBILITY_ANY_MAGNITUDE 99.0f
+
+enum SkyVisibilitySort
+{
+    SORT_BY_ALTITUDE = 0, // Highest first
+    SORT_BY_MAGNITUDE     // Brightest first, objects without magnitude last
+};
+
+struct SkyVisibilityQuery
+{
+    time_t utc;
+    float latitude_deg;
+    float longitude_deg; // East positive
+    float min_altitude_deg;
+    // Fainter objects are skipped, objects without magnitude unless SKY_VISIBILITY_ANY_MAGNITUDE
+    float max_magnitude;
+    SkyVisibilitySort sort;
+    // Catalogue to scan, DB_NONE scans NGC 2000 and BSC5 (the other
+    // catalogues overlap them)
+    StarDatabaseType catalogue;
+};
+
+// One object above the horizon limit, fetch it with findByIndex() of the source
+struct SkyVisibleObject
+{
+    StarDatabaseType source;
+    size_t index;
+    float altitude_deg;
+    float azimuth_deg; // From north through east
+    float magnitude;   // 0 if the catalogue has none
+};
+
+/**
+ * @brief Lists the objects above the horizon for an observer and a time
+ *
+ * The zenith and the horizon north and east directions of date are rotated
+ * back to J2000 once per query (sidereal time plus ApparentPlace), so the
+ * altitude of an object is a dot product with its catalogue position. The
+ * scan decodes only position and magnitude of every record in single
+ * precision and skips blocks that are too faint or never rise above the
+ * limit. Good to ~0.01 deg, refraction is not applied.
+ *
+ * Sets the ApparentPlace epoch, used from the web server task only.
+ */
+class SkyVisibility
+{
+  public:
+    explicit SkyVisibility(const SkyVisibilityQuery& query);
+
+    /**
+     * @brief Scan the catalogues for the best objects by the sort order of the query
+     * @param results Sorted, best first
+     * @return Number of objects stored, at most max_results
+     */
+    size_t find(SkyVisibleObject* results, size_t max_results) const;
+
+    // Altitude and azimuth of a J2000 position (SKY_ANGLE_TURN units)
+    void toHorizontal(int32_t ra, int32_t dec, float& altitude_deg, float& azimuth_deg) const;
+
+    // Local sidereal time of the query in degrees
+    double getSiderealTime() const
+    {
+        return _sidereal_deg;
+    }
+
+  private:
+    void fromVector(const float v[3], float& altitude_deg, float& azimuth_deg) const;
+    bool isBetter(const SkyVisibleObject& a, const SkyVisibleObject& b) const;
+    void scan(StarDatabaseType type, SkyVisibleObject* results, size_t max_results,
+              size_t& count) const;
+    // Ranks one object of a scan into the results
+    void consider(StarDatabaseType type, size_t index, const CatalogueRecord& record,
+                  SkyVisibleObject* results, size_t max_results, size_t& count) const;
+
+    friend class SkyVisibilityScan;
+
+    SkyVisibilityQuery _query;
+    double _sidereal_deg;
+    float _min_sin_altitude;
+    // Horizon frame of date in J2000 coordinates
+    float _zenith[3];
+    float _north[3];
+    float _east[3];
+};
+
+#endif // SKY_VISIBILITY_H
@@ -1,9 +1,12 @@
 #include <Arduino.h>
+#include <ctype.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "bsc5/bsc5ra.h"
+#include "columnar_catalogue.h"
 #include "ngc/ngc2000.h"
 
 #include "star_database.h"
@@ -14,13 +17,23 @@ StarDatabase::StarDatabase(StarDatabaseType db_type, const uint8_t* start, const
 {
     switch (db_type)
     {
+        // Full and compact variants are projections of the same catalogue blob
         case DB_NGC2000:
         case DB_NGC2000_COMPACT:
-            _backend = new NGC2000(start, end);
+            _backend = new NGC2000(start, end, db_type == DB_NGC2000_COMPACT);
             break;
         case DB_BSC5:
         case DB_BSC5_COMPACT:
-            _backend = new BSC5(start, end);
+            _backend = new BSC5(start, end, db_type == DB_BSC5_COMPACT);
+            break;
+        case DB_MESSIER:
+            _backend = new ColumnarCatalogue("MESS", "Messier");
+            break;
+        case DB_CALDWELL:
+            _backend = new ColumnarCatalogue("CALD", "Caldwell");
+            break;
+        case DB_HIPPARCOS:
+            _backend = new ColumnarCatalogue("HIPP", "Hipparcos");
             break;
         default:
             print_out("Error: Unsupported database type %d", db_type);
@@ -28,40 +41,6 @@ StarDatabase::StarDatabase(StarDatabaseType db_type, const uint8_t* start, const
     }
 }
 
-// Pagination interface
-bool StarDatabase::loadPage(size_t page_index, size_t page_size)
-{
-    if (_backend)
-        return _backend->loadPage(page_index, page_size);
-    return false;
-}
-
-bool StarDatabase::isPageLoaded(size_t page_index) const
-{
-    if (_backend)
-        return _backend->isPageLoaded(page_index);
-    return false;
-}
-
-size_t StarDatabase::getCurrentPageCount() const
-{
-    if (_backend)
-        return _backend->getCurrentPageCount();
-    return 0;
-}
-
-size_t StarDatabase::getPageSize() const
-{
-    if (_backend)
-        return _backend->getPageSize();
-    return 0;
-}
-
-void StarDatabase::clearLoadedPages()
-{
-    if (_backend)
-        _backend->clearLoadedPages();
-}
 StarDatabase::~StarDatabase()
 {
     delete _backend;
@@ -93,25 +72,56 @@ bool StarDatabase::isLoaded() const
 
 bool StarDatabase::findByName(const String& name, StarUnifiedEntry& result) const
 {
-    if (_backend)
-        return _backend->findByName(name, result);
+    if (_backend && _backend->findByName(name, result))
+    {
+        result.source_db = _db_type;
+        return true;
+    }
     return false;
 }
 
 bool StarDatabase::findByNameFragment(const String& name_fragment, StarUnifiedEntry& result) const
 {
-    if (_backend)
-        return _backend->findByNameFragment(name_fragment, result);
+    if (_backend && _backend->findByNameFragment(name_fragment, result))
+    {
+        result.source_db = _db_type;
+        return true;
+    }
     return false;
 }
 
 bool StarDatabase::findByIndex(size_t index, StarUnifiedEntry& result) const
 {
-    if (_backend)
-        return _backend->findByIndex(index, result);
+    if (_backend && _backend->findByIndex(index, result))
+    {
+        result.source_db = _db_type;
+        return true;
+    }
     return false;
 }
 
+bool StarDatabase::findIndexByName(const String& name, size_t& index) const
+{
+    return _backend && _backend->findIndexByName(name, index);
+}
+
+const CatalogueBlob* StarDatabase::getBlob() const
+{
+    return _backend ? &_backend->getBlob() : nullptr;
+}
+
+bool StarDatabase::isCompactProjection() const
+{
+    return _backend && _backend->isCompactProjection();
+}
+
+size_t StarDatabase::visit(const CatalogueFilter& filter, uint16_t columns,
+                           const CatalogueRecordPredicate* predicate,
+                           CatalogueRecordVisitor& visitor) const
+{
+    return _backend ? _backend->visit(filter, columns, predicate, visitor) : 0;
+}
+
 size_t StarDatabase::getTotalObjectCount() const
 {
     if (_backend)
@@ -125,13 +135,45 @@ void StarDatabase::printDatabaseInfo() const
         _backend->printDatabaseInfo();
 }
 
+bool catalogueNameEquals(const char* name, size_t len, const char* search)
+{
+    size_t i = 0;
+    for (; i < len && name[i] != '\0'; i++)
+    {
+        if (search[i] == '\0' ||
+            tolower((unsigned char) name[i]) != tolower((unsigned char) search[i]))
+            return false;
+    }
+    return search[i] == '\0';
+}
+
+bool catalogueNameContains(const char* name, size_t len, const char* fragment)
+{
+    size_t fragment_len = strlen(fragment);
+    size_t name_len = strnlen(name, len);
+
+    if (fragment_len == 0)
+        return true;
+
+    for (size_t start = 0; start + fragment_len <= name_len; start++)
+    {
+        size_t i = 0;
+        while (i < fragment_len &&
+               tolower((unsigned char) name[start + i]) == tolower((unsigned char) fragment[i]))
+            i++;
+        if (i == fragment_len)
+            return true;
+    }
+    return false;
+}
+
 void StarUnifiedEntry::print() const
 {
     print_out("=== Object Information ===");
     print_out("Name: %s", name.c_str());
     print_out("Type: %s", type_str.c_str());
-    print_out("Right Ascension: %.6f hours", ra_hours);
-    print_out("Declination: %.6f degrees", dec_deg);
+    print_out("Right Ascension: %.6f hours", raHours());
+    print_out("Declination: %.6f degrees", decDegrees());
 
     if (constellation.length() > 0)
         print_out("Constellation: %s", constellation.c_str());
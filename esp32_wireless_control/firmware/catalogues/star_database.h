@@ -10,7 +10,6 @@
 #define STAR_DATABASE_H
 
 #include <Arduino.h>
-#include <ArduinoJson.h>
 
 #include "star_database_interface.h"
 
@@ -46,17 +45,23 @@ class StarDatabase
     virtual bool findByName(const String& name, StarUnifiedEntry& result) const;
     virtual bool findByNameFragment(const String& name_fragment, StarUnifiedEntry& result) const;
     virtual bool findByIndex(size_t index, StarUnifiedEntry& result) const;
+    virtual bool findIndexByName(const String& name, size_t& index) const;
+    // nullptr without a backend
+    virtual const CatalogueBlob* getBlob() const;
+    virtual bool isCompactProjection() const;
+    // See StarDatabaseInterface::visit(), visits nothing without a backend
+    virtual size_t visit(const CatalogueFilter& filter, uint16_t columns,
+                         const CatalogueRecordPredicate* predicate,
+                         CatalogueRecordVisitor& visitor) const;
 
     // Information methods
     virtual size_t getTotalObjectCount() const;
     virtual void printDatabaseInfo() const;
-
-    // Pagination interface
-    virtual bool loadPage(size_t page_index, size_t page_size = 32);
-    virtual bool isPageLoaded(size_t page_index) const;
-    virtual size_t getCurrentPageCount() const;
-    virtual size_t getPageSize() const;
-    virtual void clearLoadedPages();
 };
 
+// Case-insensitive name matching on raw catalogue bytes (no String allocation).
+// `name` does not need to be null-terminated, `len` bytes are compared.
+bool catalogueNameEquals(const char* name, size_t len, const char* search);
+bool catalogueNameContains(const char* name, size_t len, const char* fragment);
+
 #endif // STAR_DATABASE_H
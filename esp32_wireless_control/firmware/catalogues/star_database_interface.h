@@ -10,6 +10,32 @@
 #define STAR_DATABASE_INTERFACE_H
 
 #include <WString.h>
+#include <stdint.h>
+
+#include "catalogue_blob.h"
+
+// Positions are fixed point, 2^31 units per turn (~0.0006 arcsec). The
+// ESP32 FPU is single precision only, positions stay in integers and
+// float math from the catalogue blob to the API response.
+#define SKY_ANGLE_BITS 31
+#define SKY_ANGLE_TURN (1LL << SKY_ANGLE_BITS)
+
+// Catalogue blob coordinates (CATALOGUE_TURN units) to SKY_ANGLE_TURN units
+inline int32_t skyAngleFromCatalogue(int32_t angle)
+{
+    return angle * (int32_t) (SKY_ANGLE_TURN / CATALOGUE_TURN);
+}
+
+// Seconds of time and arcseconds as reported by the API, truncated
+inline int32_t skyAngleToSeconds(int32_t ra)
+{
+    return (int32_t) ((int64_t) ra * 86400 / SKY_ANGLE_TURN);
+}
+
+inline int32_t skyAngleToArcseconds(int32_t dec)
+{
+    return (int32_t) ((int64_t) dec * 1296000 / SKY_ANGLE_TURN);
+}
 
 // Database types
 enum StarDatabaseType
@@ -19,6 +45,10 @@ enum StarDatabaseType
     DB_NGC2000_COMPACT, // Compact NGC2000 format
     DB_BSC5,            // Bright Star Catalog 5th edition
     DB_BSC5_COMPACT,    // Compact BSC5 format
+    DB_MESSIER,         // Messier list
+    DB_CALDWELL,        // Caldwell list
+    DB_HIPPARCOS,       // Hipparcos subset, catalogue partition only
+    DB_COUNT
 };
 
 // Unified object entry for search results
@@ -26,8 +56,8 @@ struct StarUnifiedEntry
 {
     String name;
     String type_str;
-    double ra_hours;
-    double dec_deg;
+    int32_t ra;  // Right ascension, [0, SKY_ANGLE_TURN)
+    int32_t dec; // Declination, [-SKY_ANGLE_TURN / 4, SKY_ANGLE_TURN / 4]
     float magnitude;
     String constellation;
     String description;
@@ -42,8 +72,28 @@ struct StarUnifiedEntry
 
     // Utility methods
     void print() const;
+
+    float raHours() const
+    {
+        return ra * (24.0f / SKY_ANGLE_TURN);
+    }
+    float decDegrees() const
+    {
+        return dec * (360.0f / SKY_ANGLE_TURN);
+    }
+    int32_t raSeconds() const
+    {
+        return skyAngleToSeconds(ra);
+    }
+    int32_t decArcseconds() const
+    {
+        return skyAngleToArcseconds(dec);
+    }
 };
 
+// Catalogue backends are loaded once and are read-only afterwards.
+// All const methods read straight from the embedded data and keep no
+// mutable state, so they may be called from several tasks at once.
 class StarDatabaseInterface
 {
   public:
@@ -57,15 +107,28 @@ class StarDatabaseInterface
     virtual bool findByNameFragment(const String& name_fragment,
                                     StarUnifiedEntry& result) const = 0;
     virtual bool findByIndex(size_t index, StarUnifiedEntry& result) const = 0;
+    // Index of the first object with this exact name, for batch lookups
+    virtual bool findIndexByName(const String& name, size_t& index) const = 0;
+    // Blob backing the objects and whether they are its compact projection,
+    // scans over every object decode it directly with a CatalogueCursor
+    virtual const CatalogueBlob& getBlob() const = 0;
+    virtual bool isCompactProjection() const = 0;
+    /**
+     * @brief Visit the objects matching a filter and a predicate, without allocating
+     *
+     * The visitor gets the index of each object and a CatalogueRecord with
+     * the requested columns, strings point into the catalogue data. Return
+     * false from the visitor to stop. Lookups that need a StarUnifiedEntry
+     * fetch it with findByIndex() for the objects they keep.
+     * @param columns Columns read by predicate and visitor, see CatalogueColumn
+     * @param predicate nullptr accepts every object of the filter
+     * @return Number of objects visited
+     */
+    virtual size_t visit(const CatalogueFilter& filter, uint16_t columns,
+                         const CatalogueRecordPredicate* predicate,
+                         CatalogueRecordVisitor& visitor) const = 0;
     virtual size_t getTotalObjectCount() const = 0;
     virtual void printDatabaseInfo() const = 0;
-
-    // Pagination support for memory optimization
-    virtual bool loadPage(size_t page_index, size_t page_size = 32) = 0;
-    virtual bool isPageLoaded(size_t page_index) const = 0;
-    virtual size_t getCurrentPageCount() const = 0;
-    virtual size_t getPageSize() const = 0;
-    virtual void clearLoadedPages() = 0;
 };
 
 #endif // STAR_DATABASE_INTERFACE_H
@@ -0,0 +1,260 @@
+/**
+ * @file star_database_registry.cpp
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#include <strings.h>
+
+#include "catalogue_page_cache.h"
+#include "catalogue_query_cache.h"
+#include "star_database_registry.h"
+#include "uart.h"
+
+StarDatabaseRegistry& StarDatabaseRegistry::getInstance()
+{
+    static StarDatabaseRegistry instance;
+    return instance;
+}
+
+StarDatabaseRegistry::StarDatabaseRegistry() : _suspended(false), _readers(0)
+{
+    _mutex = xSemaphoreCreateMutex();
+    for (size_t i = 0; i < DB_COUNT; i++)
+        _databases[i] = nullptr;
+}
+
+bool StarDatabaseRegistry::registerDatabase(StarDatabaseType type, const uint8_t* start,
+                                            const uint8_t* end)
+{
+    if (type <= DB_NONE || type >= DB_COUNT)
+    {
+        print_out("Error: Unsupported database type %d", type);
+        return false;
+    }
+
+    if (_databases[type] != nullptr)
+    {
+        print_out("Error: Database type %d already registered", type);
+        return false;
+    }
+
+    StarDatabase* db = new StarDatabase(type, start, end);
+    if (!db->loadDatabase((const char*) start, end - start))
+    {
+        print_out("Error: Failed to load database type %d", type);
+        delete db;
+        return false;
+    }
+
+    _databases[type] = db;
+    return true;
+}
+
+const StarDatabase* StarDatabaseRegistry::getDatabase(StarDatabaseType type) const
+{
+    if (_suspended || type <= DB_NONE || type >= DB_COUNT)
+        return nullptr;
+    return _databases[type];
+}
+
+bool StarDatabaseRegistry::findByName(StarDatabaseType type, const String& name,
+                                      StarUnifiedEntry& result) const
+{
+    Reader reader;
+    if (!reader.isOpen() || type < DB_NONE || type >= DB_COUNT)
+        return false;
+
+    // Repeated searches, hits and misses alike, skip the name lookup
+    CatalogueQueryCache& cache = CatalogueQueryCache::getInstance();
+    StarDatabaseType source = DB_NONE;
+    size_t index = 0;
+    if (!cache.lookup(type, name, source, index))
+    {
+        for (size_t i = DB_NONE + 1; i < DB_COUNT && source == DB_NONE; i++)
+        {
+            if (isSearched(type, i) && _databases[i]->findIndexByName(name, index))
+                source = (StarDatabaseType) i;
+        }
+        if (source == DB_NONE)
+            findIndexByDesignation(type, name, source, index);
+        cache.store(type, name, source, index);
+    }
+
+    const StarDatabase* db = getDatabase(source);
+    return db != nullptr && db->findByIndex(index, result);
+}
+
+bool StarDatabaseRegistry::findByNameFragment(StarDatabaseType type, const String& name_fragment,
+                                              StarUnifiedEntry& result) const
+{
+    Reader reader;
+    if (!reader.isOpen())
+        return false;
+    if (type != DB_NONE)
+    {
+        const StarDatabase* db = getDatabase(type);
+        return db != nullptr && db->findByNameFragment(name_fragment, result);
+    }
+
+    for (size_t i = DB_NONE + 1; i < DB_COUNT; i++)
+    {
+        if (_databases[i] == nullptr || isCompactVariant((StarDatabaseType) i))
+            continue;
+        if (_databases[i]->findByNameFragment(name_fragment, result))
+            return true;
+    }
+    return false;
+}
+
+size_t StarDatabaseRegistry::findBatch(StarBatchEntry* entries, size_t count) const
+{
+    for (size_t n = 0; n < count; n++)
+        entries[n].source = DB_NONE;
+    Reader reader;
+    if (!reader.isOpen())
+        return 0;
+
+    size_t found = 0;
+    for (size_t i = DB_NONE + 1; i < DB_COUNT && found < count; i++)
+    {
+        if (_databases[i] == nullptr)
+            continue;
+
+        StarDatabaseType type = (StarDatabaseType) i;
+        for (size_t n = 0; n < count; n++)
+        {
+            StarBatchEntry& entry = entries[n];
+            if (entry.source != DB_NONE ||
+                (entry.catalogue != type && (entry.catalogue != DB_NONE || isCompactVariant(type))))
+                continue;
+            if (_databases[i]->findIndexByName(entry.name, entry.index))
+            {
+                entry.source = type;
+                found++;
+            }
+        }
+    }
+
+    for (size_t n = 0; n < count && found < count; n++)
+    {
+        StarBatchEntry& entry = entries[n];
+        if (entry.source == DB_NONE &&
+            findIndexByDesignation(entry.catalogue, entry.name, entry.source, entry.index))
+            found++;
+    }
+    return found;
+}
+
+bool StarDatabaseRegistry::findIndexByDesignation(StarDatabaseType type, const String& name,
+                                                  StarDatabaseType& source, size_t& index) const
+{
+    char key[CATALOGUE_DESIGNATION_KEY_SIZE];
+    if (!catalogueDesignationKey(name.c_str(), key, sizeof(key)))
+        return false;
+
+    // The key as a name first ("m 31" is M31, "NGC 0224" is NGC224), then as an alias
+    // ("Andromeda"). A key that only differs in case was already searched as a name.
+    for (int pass = strcasecmp(key, name.c_str()) == 0 ? 1 : 0; pass < 2; pass++)
+    {
+        for (size_t i = DB_NONE + 1; i < DB_COUNT; i++)
+        {
+            if (!isSearched(type, i))
+                continue;
+            const CatalogueBlob* blob = _databases[i]->getBlob();
+            bool compact = _databases[i]->isCompactProjection();
+            if (blob != nullptr && (pass == 0 ? blob->findName(key, false, compact, index)
+                                              : blob->findAlias(key, compact, index)))
+            {
+                source = (StarDatabaseType) i;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool StarDatabaseRegistry::isSearched(StarDatabaseType type, size_t i) const
+{
+    return _databases[i] != nullptr &&
+           (type == DB_NONE ? !isCompactVariant((StarDatabaseType) i) : (size_t) type == i);
+}
+
+size_t StarDatabaseRegistry::getDatabaseCount() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < DB_COUNT; i++)
+    {
+        if (_databases[i] != nullptr)
+            count++;
+    }
+    return count;
+}
+
+void StarDatabaseRegistry::printRegistryInfo() const
+{
+    print_out("=== Star Database Registry ===");
+    print_out("Registered catalogues: %zu", getDatabaseCount());
+    for (size_t i = 0; i < DB_COUNT; i++)
+    {
+        if (_databases[i] != nullptr)
+            _databases[i]->printDatabaseInfo();
+    }
+    print_out("==============================");
+}
+
+StarDatabaseRegistry::Reader::Reader() : _open(StarDatabaseRegistry::getInstance().beginRead())
+{
+}
+
+StarDatabaseRegistry::Reader::~Reader()
+{
+    if (_open)
+        StarDatabaseRegistry::getInstance().endRead();
+}
+
+bool StarDatabaseRegistry::beginRead() const
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    bool open = !_suspended;
+    if (open)
+        _readers++;
+    xSemaphoreGive(_mutex);
+    return open;
+}
+
+void StarDatabaseRegistry::endRead() const
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _readers--;
+    xSemaphoreGive(_mutex);
+}
+
+void StarDatabaseRegistry::suspend()
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _suspended = true;
+    size_t readers = _readers;
+    xSemaphoreGive(_mutex);
+
+    // No reader starts any more, the ones in flight finish on the old data
+    while (readers > 0)
+    {
+        vTaskDelay(1);
+        xSemaphoreTake(_mutex, portMAX_DELAY);
+        readers = _readers;
+        xSemaphoreGive(_mutex);
+    }
+
+    // Cached pages point into the data that is about to be overwritten
+    CataloguePageCache::getInstance().clear();
+    CatalogueQueryCache::getInstance().clear();
+    print_out("Star database lookups suspended");
+}
+
+bool StarDatabaseRegistry::isCompactVariant(StarDatabaseType type)
+{
+    return type == DB_NGC2000_COMPACT || type == DB_BSC5_COMPACT;
+}
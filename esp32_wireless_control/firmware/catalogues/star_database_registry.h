@@ -0,0 +1,154 @@
+/**
+ * @file star_database_registry.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef STAR_DATABASE_REGISTRY_H
+#define STAR_DATABASE_REGISTRY_H
+
+#include <Arduino.h>
+
+#include "star_database.h"
+
+// One name of a batch lookup
+struct StarBatchEntry
+{
+    String name;
+    // Catalogue to search, DB_NONE searches all catalogues
+    StarDatabaseType catalogue;
+    // Catalogue and index of the object, source is DB_NONE if it was not found
+    StarDatabaseType source;
+    size_t index;
+};
+
+/**
+ * @brief Holds every embedded catalogue as a read-only StarDatabase instance
+ *
+ * All catalogues are registered once at boot (before any task that searches
+ * is started) and are never unloaded or swapped afterwards. Lookups only use
+ * const methods of the backends and may run from several tasks. The catalogue
+ * data itself is read without locking, the shared CataloguePageCache and
+ * CatalogueQueryCache are guarded by their own mutex. A catalogue update
+ * suspends the registry instead, the new data is registered after a reboot.
+ */
+class StarDatabaseRegistry
+{
+  public:
+    static StarDatabaseRegistry& getInstance();
+
+    /**
+     * @brief Register and load a catalogue from embedded data
+     * @note Must be called from setup() before the searching tasks start
+     * @return true if the catalogue could be loaded
+     */
+    bool registerDatabase(StarDatabaseType type, const uint8_t* start, const uint8_t* end);
+
+    /**
+     * @brief Get a registered catalogue
+     * @return nullptr if the type is unknown or was not registered
+     */
+    const StarDatabase* getDatabase(StarDatabaseType type) const;
+
+    /**
+     * @brief Search by exact name, other designation or common name
+     *
+     * The exact name is searched first. Names that are not found are
+     * normalized (see catalogueDesignationKey()) and looked up as a name and
+     * then in the alias indexes, so "m 31", "Andromeda" and "alf Ori" are
+     * found as well. Every step is an indexed lookup per catalogue.
+     * @param type Catalogue to search, DB_NONE searches all catalogues in one query
+     * @note Results and misses are remembered by CatalogueQueryCache
+     */
+    bool findByName(StarDatabaseType type, const String& name, StarUnifiedEntry& result) const;
+
+    /**
+     * @brief Search by name fragment
+     * @param type Catalogue to search, DB_NONE searches all catalogues in one query
+     */
+    bool findByNameFragment(StarDatabaseType type, const String& name_fragment,
+                            StarUnifiedEntry& result) const;
+
+    /**
+     * @brief Resolve a list of names, each with its own catalogue
+     *
+     * Every catalogue is visited once and resolves all names still missing
+     * that ask for it, in the same order as findByName(DB_NONE) searches.
+     * Names still missing after that are looked up by designation like
+     * findByName() does. Only locations are stored, fetch the objects with
+     * findByIndex() of the source catalogue.
+     * @return Number of names found
+     */
+    size_t findBatch(StarBatchEntry* entries, size_t count) const;
+
+    size_t getDatabaseCount() const;
+    void printRegistryInfo() const;
+
+    /**
+     * @brief Stop serving lookups while the catalogue data is rewritten
+     *
+     * Waits for the lookups and Reader sections in flight to end, the data
+     * can be erased once it returns.
+     * @note Lookups fail until reboot, the registered data is no longer valid
+     */
+    void suspend();
+    bool isSuspended() const
+    {
+        return _suspended;
+    }
+
+    /**
+     * @brief Marks a section reading catalogue data, suspend() waits for it to end
+     *
+     * Lookups of the registry take one by themselves. Code reading a blob of
+     * getDatabase() outside the web server task (which runs the upload) must
+     * hold one for as long as it reads.
+     */
+    class Reader
+    {
+      public:
+        Reader();
+        ~Reader();
+
+        // false if the registry is suspended, nothing may be read then
+        bool isOpen() const
+        {
+            return _open;
+        }
+
+      private:
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        bool _open;
+    };
+
+  private:
+    StarDatabaseRegistry();
+
+    StarDatabaseRegistry(const StarDatabaseRegistry&) = delete;
+    StarDatabaseRegistry& operator=(const StarDatabaseRegistry&) = delete;
+
+    // Compact variants hold a subset of their full catalogue, searching
+    // "all catalogues" skips them to avoid scanning the same objects twice
+    static bool isCompactVariant(StarDatabaseType type);
+    // Whether catalogue i is searched for a lookup in type
+    bool isSearched(StarDatabaseType type, size_t i) const;
+    // Designation key of a name as a name and as an alias, in the order of all catalogues
+    bool findIndexByDesignation(StarDatabaseType type, const String& name,
+                                StarDatabaseType& source, size_t& index) const;
+
+    // Count a reader in, false once suspended
+    bool beginRead() const;
+    void endRead() const;
+
+    StarDatabase* _databases[DB_COUNT];
+    volatile bool _suspended;
+    // Guards _suspended against _readers, not the catalogue data
+    SemaphoreHandle_t _mutex;
+    mutable size_t _readers;
+};
+
+#endif // STAR_DATABASE_REGISTRY_H
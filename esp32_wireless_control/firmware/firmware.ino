@@ -8,7 +8,8 @@
 #include <string.h>
 
 #include "axis.h"
-#include "catalogues/star_database.h"
+#include "catalogues/catalogue_partition.h"
+#include "catalogues/star_database_registry.h"
 #include "commands.h"
 #include "common_strings.h"
 #include "configs/config.h"
@@ -25,7 +26,6 @@
 SerialTerminal term(CLI_NEWLINE_CHAR, CLI_DELIMITER_CHAR);
 WebServer server(WEBSERVER_PORT);
 Languages language = EN;
-StarDatabase* starDatabase = nullptr;
 Intervalometer* intervalometer = nullptr;
 
 void uartTask(void* pvParameters);
@@ -34,81 +34,74 @@ void webserverTask(void* pvParameters);
 void intervalometerTask(void* pvParameters);
 void systemShutdown();
 
-extern const uint8_t _interface_index_html_start[] asm("_binary_interface_index_html_start");
-extern const uint8_t _interface_index_html_end[] asm("_binary_interface_index_html_end");
-
 extern const uint8_t _catalogues_ngc_converted_ngc2000_bin_start[] asm(
     "_binary_catalogues_ngc_converted_ngc2000_bin_start");
 extern const uint8_t _catalogues_ngc_converted_ngc2000_bin_end[] asm(
     "_binary_catalogues_ngc_converted_ngc2000_bin_end");
 
-extern const uint8_t _catalogues_ngc_converted_ngc2000_compact_bin_start[] asm(
-    "_binary_catalogues_ngc_converted_ngc2000_compact_bin_start");
-extern const uint8_t _catalogues_ngc_converted_ngc2000_compact_bin_end[] asm(
-    "_binary_catalogues_ngc_converted_ngc2000_compact_bin_end");
-
 extern const uint8_t _catalogues_bsc5_converted_bsc5ra_bin_start[] asm(
     "_binary_catalogues_bsc5_converted_bsc5ra_bin_start");
 extern const uint8_t _catalogues_bsc5_converted_bsc5ra_bin_end[] asm(
     "_binary_catalogues_bsc5_converted_bsc5ra_bin_end");
 
-extern const uint8_t _catalogues_bsc5_converted_bsc5ra_compact_bin_start[] asm(
-    "_binary_catalogues_bsc5_converted_bsc5ra_compact_bin_start");
-extern const uint8_t _catalogues_bsc5_converted_bsc5ra_compact_bin_end[] asm(
-    "_binary_catalogues_bsc5_converted_bsc5ra_compact_bin_end");
-
-StarDatabase* handleStarDatabase(StarDatabaseType type)
+extern const uint8_t _catalogues_messier_converted_messier_bin_start[] asm(
+    "_binary_catalogues_messier_converted_messier_bin_start");
+extern const uint8_t _catalogues_messier_converted_messier_bin_end[] asm(
+    "_binary_catalogues_messier_converted_messier_bin_end");
+
+extern const uint8_t _catalogues_caldwell_converted_caldwell_bin_start[] asm(
+    "_binary_catalogues_caldwell_converted_caldwell_bin_start");
+extern const uint8_t _catalogues_caldwell_converted_caldwell_bin_end[] asm(
+    "_binary_catalogues_caldwell_converted_caldwell_bin_end");
+
+// Register a catalogue from the partition, falling back to the data embedded in the
+// firmware if the partition holds no usable copy (e.g. a bundle in an older format).
+// Catalogues without embedded data (start == nullptr) only come from the partition.
+static void registerCatalogue(StarDatabaseType type, StarDatabaseType compact_type,
+                              const char* tag, const uint8_t* start, const uint8_t* end)
 {
-    StarDatabase* db = nullptr;
-    const uint8_t* bin_start = nullptr;
-    const uint8_t* bin_end = nullptr;
-    size_t len = 0;
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    const uint8_t* part_start;
+    const uint8_t* part_end;
 
-    if (starDatabase != nullptr && starDatabase->getDatabaseType() == type)
-        return starDatabase; // Return existing instance if already loaded
-
-    if (starDatabase != nullptr)
+    if (CataloguePartition::getInstance().findCatalogue(tag, part_start, part_end) &&
+        registry.registerDatabase(type, part_start, part_end))
     {
-        starDatabase->unloadDatabase();
-        delete starDatabase;
-        starDatabase = nullptr;
+        start = part_start;
+        end = part_end;
     }
-
-    switch (type)
+    else if (start == nullptr || !registry.registerDatabase(type, start, end))
     {
-        case DB_NGC2000:
-            bin_start = _catalogues_ngc_converted_ngc2000_bin_start;
-            bin_end = _catalogues_ngc_converted_ngc2000_bin_end;
-            len = bin_end - bin_start;
-            break;
-        case DB_NGC2000_COMPACT:
-            bin_start = _catalogues_ngc_converted_ngc2000_compact_bin_start;
-            bin_end = _catalogues_ngc_converted_ngc2000_compact_bin_end;
-            len = bin_end - bin_start;
-            break;
-        case DB_BSC5:
-            bin_start = _catalogues_bsc5_converted_bsc5ra_bin_start;
-            bin_end = _catalogues_bsc5_converted_bsc5ra_bin_end;
-            len = bin_end - bin_start;
-            break;
-        case DB_BSC5_COMPACT:
-            bin_start = _catalogues_bsc5_converted_bsc5ra_compact_bin_start;
-            bin_end = _catalogues_bsc5_converted_bsc5ra_compact_bin_end;
-            len = bin_end - bin_start;
-            break;
-        default:
-            print_out("Error: Unsupported database type %d", type);
-            return nullptr;
+        return;
     }
 
-    db = new StarDatabase(type, bin_start, bin_end);
-    if (!db->loadDatabase((const char*) bin_start, len))
-    {
-        delete db;
-        return nullptr;
-    }
+    // Each blob holds the full catalogue and its compact projection
+    if (compact_type != DB_NONE)
+        registry.registerDatabase(compact_type, start, end);
+}
 
-    return db;
+void registerStarDatabases()
+{
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    CataloguePartition::getInstance().begin();
+
+    // Catalogues in the partition take precedence over the embedded ones
+    registerCatalogue(DB_NGC2000, DB_NGC2000_COMPACT, "NGC2",
+                      _catalogues_ngc_converted_ngc2000_bin_start,
+                      _catalogues_ngc_converted_ngc2000_bin_end);
+    registerCatalogue(DB_BSC5, DB_BSC5_COMPACT, "BSC5",
+                      _catalogues_bsc5_converted_bsc5ra_bin_start,
+                      _catalogues_bsc5_converted_bsc5ra_bin_end);
+    registerCatalogue(DB_MESSIER, DB_NONE, "MESS",
+                      _catalogues_messier_converted_messier_bin_start,
+                      _catalogues_messier_converted_messier_bin_end);
+    registerCatalogue(DB_CALDWELL, DB_NONE, "CALD",
+                      _catalogues_caldwell_converted_caldwell_bin_start,
+                      _catalogues_caldwell_converted_caldwell_bin_end);
+    // Too large for the firmware image, only available from an uploaded bundle
+    registerCatalogue(DB_HIPPARCOS, DB_NONE, "HIPP", nullptr, nullptr);
+
+    print_out("Star databases registered: %zu", registry.getDatabaseCount());
 }
 
 String getChipID()
@@ -294,6 +287,9 @@ void setup()
     digitalWrite(EN12_n, LOW);
     // handleExposureSettings();
 
+    // Load all catalogues once, they are read-only from here on
+    registerStarDatabases();
+
     // Initialize Wifi and web server
     setupWireless();
 
@@ -350,6 +346,7 @@ void webserverTask(void* pvParameters)
     for (;;)
     {
         server.handleClient();
+        ApiHandler::getInstance().loop();
         vTaskDelay(1);
     }
 }
@@ -86,6 +86,14 @@ class Intervalometer
         return currentMode;
     }
 
+    /**
+     * @brief Get the mode a preset holds, without loading it
+     */
+    Mode getPresetMode(uint8_t preset) const
+    {
+        return static_cast<Mode>(presets[preset].mode);
+    }
+
     /**
      * @brief Set current mode
      */
@@ -6,14 +6,19 @@
 #include <uart.h>
 
 #include "../../configs/config.h"
+#include "../../website/api_handler.h"
+#include "../../website/embedded_asset.h"
 #include "../../website/website_strings.h"
 #include "freertos/idf_additions.h"
 #include "ota_handler.h"
 
 extern void systemShutdown();
 
-extern const uint8_t _interface_ota_html_start[] asm("_binary_interface_ota_html_start");
-extern const uint8_t _interface_ota_html_end[] asm("_binary_interface_ota_html_end");
+// Minified and compressed by shared/web_assets.py
+extern const uint8_t _interface_dist_ota_html_gz_start[] asm(
+    "_binary_interface_dist_ota_html_gz_start");
+extern const uint8_t _interface_dist_ota_html_gz_end[] asm(
+    "_binary_interface_dist_ota_html_gz_end");
 
 // Constants
 constexpr const char* OTAHandler::GITHUB_API_URL;
@@ -87,8 +92,16 @@ void OTAHandler::handleOTAPage()
         return;
 
     resetOTAState();
-    size_t htmlSize = _interface_ota_html_end - _interface_ota_html_start;
-    _server->send_P(200, MIME_TYPE_HTML, (const char*) _interface_ota_html_start, htmlSize);
+    ApiHandler& api = ApiHandler::getInstance();
+    if (!api.hasTransferRoom())
+        return;
+    static EmbeddedAsset page(_interface_dist_ota_html_gz_start, _interface_dist_ota_html_gz_end);
+    if (page.sendValidators(_server, "no-cache"))
+        return;
+
+    _server->sendHeader("Content-Encoding", "gzip");
+    // Sent in the background like the main page, a slow link holds up no other request
+    api.sendInBackground(200, MIME_TYPE_HTML, page.getData(), page.getLength());
 }
 
 void OTAHandler::handleOTAUpload()
@@ -141,7 +141,8 @@ const char* const chineseLangHTMLStrings[numberOfHTMLStrings] PROGMEM = {
     "微调",           // STR_TUNE_RATE
     "预设速率",       // STR_RATE_PRESET
     "保存速率",       // STR_SAVE_RATE_PRESET
-    "加载速率"        // STR_LOAD_RATE_PRESET
+    "加载速率",       // STR_LOAD_RATE_PRESET
+    "所有星表"        // STR_STAR_CATALOG_ALL
 };
 
 #endif
@@ -143,7 +143,8 @@ const char* const germanLangHTMLStrings[numberOfHTMLStrings] PROGMEM = {
     "Feinabstimmung",                                     // STR_TUNE_RATE
     "Voreinstellungsrate",                                // STR_RATE_PRESET
     "Rate speichern",                                     // STR_SAVE_RATE_PRESET
-    "Rate laden"                                          // STR_LOAD_RATE_PRESET
+    "Rate laden",                                         // STR_LOAD_RATE_PRESET
+    "Alle Kataloge"                                       // STR_STAR_CATALOG_ALL
 };
 
 #endif
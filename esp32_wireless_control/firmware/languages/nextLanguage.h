@@ -4,7 +4,9 @@
 #include <pgmspace.h>
 
 /*Use this template to add an additional lamguage.
-After finishing adjust web_languages.h and .cpp to include the new language
+After finishing adjust web_languages.h and .cpp to include the new language.
+The web interface is translated at build time (shared/web_assets.py), also add
+interface/dist/index_<code>.html.gz to platformio.ini and ApiHandler::handleRoot
 */
 
 const char* const nextLanguageStrings[LANG_COUNT] PROGMEM = {
@@ -144,7 +146,8 @@ const char* const nextLangHTMLStrings[numberOfHTMLStrings] PROGMEM = {
     "", // STR_TUNE_RATE
     "", // STR_RATE_PRESET
     "", // STR_SAVE_RATE_PRESET
-    ""  // STR_LOAD_RATE_PRESET
+    "", // STR_LOAD_RATE_PRESET
+    ""  // STR_STAR_CATALOG_ALL
 };
 
 #endif
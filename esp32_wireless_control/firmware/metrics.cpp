@@ -0,0 +1,315 @@
+/**
+ * @file metrics.cpp
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "catalogues/catalogue_page_cache.h"
+#include "catalogues/catalogue_query_cache.h"
+#include "metrics.h"
+#include "uart.h"
+
+Metrics metrics;
+
+static const uint32_t latencyBucketsUs[METRICS_LATENCY_BUCKET_COUNT] = METRICS_LATENCY_BUCKETS_US;
+static const char* const motionKindNames[MOTION_KIND_COUNT] = {"slew", "goto"};
+
+#if configUSE_TRACE_FACILITY == 1
+// Only the web server task writes the metrics, so one sample serves every scrape
+static TaskStatus_t taskStates[METRICS_MAX_TASKS];
+static UBaseType_t taskCount = 0;
+static decltype(TaskStatus_t::ulRunTimeCounter) taskRunTime = 0;
+#endif
+
+// Collects lines and hands them to the sink in METRICS_BUFFER_SIZE pieces
+class MetricsWriter
+{
+  public:
+    MetricsWriter(MetricsSink& sink) : _sink(sink), _used(0)
+    {
+    }
+
+    ~MetricsWriter()
+    {
+        flush();
+    }
+
+    // HELP and TYPE lines, once before the samples of a metric
+    void family(const char* name, const char* type, const char* help)
+    {
+        line("# HELP %s %s\n", name, help);
+        line("# TYPE %s %s\n", name, type);
+    }
+
+    // Formatted straight into the buffer, a line that does not fit behind the text already
+    // there is formatted again after a flush. A cut line would make the whole scrape invalid.
+    void line(const char* format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(_buffer + _used, sizeof(_buffer) - _used, format, args);
+        va_end(args);
+        if (len < 0)
+            return;
+        if (_used + len < sizeof(_buffer))
+        {
+            _used += len;
+            return;
+        }
+
+        flush();
+        va_start(args, format);
+        len = vsnprintf(_buffer, sizeof(_buffer), format, args);
+        va_end(args);
+        configASSERT(len >= 0 && (size_t) len < sizeof(_buffer));
+        _used = len;
+    }
+
+    void flush()
+    {
+        if (_used > 0)
+            _sink.write(_buffer, _used);
+        _used = 0;
+    }
+
+  private:
+    MetricsSink& _sink;
+    char _buffer[METRICS_BUFFER_SIZE];
+    size_t _used;
+};
+
+Metrics::Metrics()
+    : _steps(0), _motions(), _motion_ms(), _motion_kind(0), _motion_start(0), _uart_lines(0),
+      _uart_full(0), _routes(), _route_count(0)
+{
+}
+
+void Metrics::beginMotion(MotionKind kind)
+{
+    endMotion();
+    _motions[kind].fetch_add(1, std::memory_order_relaxed);
+    _motion_kind.store(kind, std::memory_order_relaxed);
+    uint32_t now = millis();
+    _motion_start.store(now != 0 ? now : 1, std::memory_order_relaxed);
+}
+
+void IRAM_ATTR Metrics::endMotion()
+{
+    // The step ISR and a task may stop the same motion, only one of them gets the start
+    uint32_t start = _motion_start.exchange(0, std::memory_order_relaxed);
+    if (start == 0)
+        return;
+    uint32_t kind = _motion_kind.load(std::memory_order_relaxed);
+    _motion_ms[kind].fetch_add(millis() - start, std::memory_order_relaxed);
+}
+
+size_t Metrics::addRoute(const char* uri)
+{
+    // A path registered for several methods shares its histogram
+    for (size_t i = 0; i < _route_count; i++)
+    {
+        if (strcmp(_routes[i].uri, uri) == 0)
+            return i;
+    }
+    if (_route_count == METRICS_MAX_ROUTES)
+        return METRICS_MAX_ROUTES;
+
+    _routes[_route_count].uri = uri;
+    return _route_count++;
+}
+
+void Metrics::recordRequest(size_t route, uint32_t micros)
+{
+    if (route >= _route_count)
+        return;
+
+    Route& entry = _routes[route];
+    entry.count++;
+    entry.sum_us += micros;
+    for (size_t i = 0; i < METRICS_LATENCY_BUCKET_COUNT; i++)
+    {
+        if (micros <= latencyBucketsUs[i])
+        {
+            entry.buckets[i]++;
+            break;
+        }
+    }
+}
+
+size_t Metrics::getPartCount() const
+{
+    // The head, one part per route and the parts after them
+    return 1 + _route_count + PART_COUNT;
+}
+
+void Metrics::write(MetricsSink& sink) const
+{
+    for (size_t part = 0; part < getPartCount(); part++)
+        writePart(part, sink);
+}
+
+void Metrics::writePart(size_t part, MetricsSink& sink) const
+{
+    MetricsWriter out(sink);
+    if (part == 0)
+    {
+        writeHead(out);
+        return;
+    }
+    if (part <= _route_count)
+    {
+        writeRoute(out, _routes[part - 1]);
+        return;
+    }
+
+    switch (part - 1 - _route_count)
+    {
+        case PART_UART:
+            writeUart(out);
+            break;
+        case PART_HEAP:
+            writeHeap(out);
+            break;
+        case PART_TASK_STACKS:
+            writeTasks(out, true);
+            break;
+        case PART_TASK_CPU:
+            writeTasks(out, false);
+            break;
+        default:
+            break;
+    }
+}
+
+void Metrics::writeHead(MetricsWriter& out) const
+{
+    out.family("ogstartracker_uptime_seconds", "gauge", "Time since boot");
+    out.line("ogstartracker_uptime_seconds %.3f\n", esp_timer_get_time() / 1000000.0);
+
+    // Motion
+    out.family("ogstartracker_steps_total", "counter", "Step pulses issued to the RA motor");
+    out.line("ogstartracker_steps_total %lu\n",
+             (unsigned long) _steps.load(std::memory_order_relaxed));
+    out.family("ogstartracker_motions_total", "counter", "Slews and gotos started");
+    for (size_t i = 0; i < MOTION_KIND_COUNT; i++)
+        out.line("ogstartracker_motions_total{kind=\"%s\"} %lu\n", motionKindNames[i],
+                 (unsigned long) _motions[i].load(std::memory_order_relaxed));
+    out.family("ogstartracker_motion_seconds_total", "counter",
+               "Duration of the slews and gotos that ended");
+    for (size_t i = 0; i < MOTION_KIND_COUNT; i++)
+        out.line("ogstartracker_motion_seconds_total{kind=\"%s\"} %.3f\n", motionKindNames[i],
+                 _motion_ms[i].load(std::memory_order_relaxed) / 1000.0);
+
+    // HTTP, the samples of each route follow in a part of their own
+    out.family("ogstartracker_http_request_duration_seconds", "histogram",
+               "Time spent in the request handler per route");
+}
+
+void Metrics::writeRoute(MetricsWriter& out, const Route& route) const
+{
+    // Routes without requests are left out
+    if (route.count == 0)
+        return;
+    uint32_t cumulative = 0;
+    for (size_t b = 0; b < METRICS_LATENCY_BUCKET_COUNT; b++)
+    {
+        cumulative += route.buckets[b];
+        out.line("ogstartracker_http_request_duration_seconds_bucket{route=\"%s\",le=\"%g\"} "
+                 "%lu\n",
+                 route.uri, latencyBucketsUs[b] / 1000000.0, (unsigned long) cumulative);
+    }
+    out.line("ogstartracker_http_request_duration_seconds_bucket{route=\"%s\",le=\"+Inf\"} "
+             "%lu\n",
+             route.uri, (unsigned long) route.count);
+    out.line("ogstartracker_http_request_duration_seconds_sum{route=\"%s\"} %.6f\n", route.uri,
+             route.sum_us / 1000000.0);
+    out.line("ogstartracker_http_request_duration_seconds_count{route=\"%s\"} %lu\n", route.uri,
+             (unsigned long) route.count);
+}
+
+void Metrics::writeUart(MetricsWriter& out) const
+{
+    // UART, print_out() waits for room instead of dropping a line
+    out.family("ogstartracker_uart_queue_depth", "gauge", "Lines waiting for the UART");
+    out.line("ogstartracker_uart_queue_depth %u\n", (unsigned) uart_queue_depth());
+    out.family("ogstartracker_uart_queue_capacity", "gauge", "Lines the UART queue holds");
+    out.line("ogstartracker_uart_queue_capacity %u\n", (unsigned) UART_QUEUE_LENGTH);
+    out.family("ogstartracker_uart_lines_total", "counter", "Lines queued for the UART");
+    out.line("ogstartracker_uart_lines_total %lu\n",
+             (unsigned long) _uart_lines.load(std::memory_order_relaxed));
+    out.family("ogstartracker_uart_queue_full_total", "counter",
+               "Lines that found the UART queue full and blocked the caller");
+    out.line("ogstartracker_uart_queue_full_total %lu\n",
+             (unsigned long) _uart_full.load(std::memory_order_relaxed));
+
+    // Catalogue caches, GET /catalogCache?reset=1 resets these counters
+    CataloguePageCacheStats pages = CataloguePageCache::getInstance().getStats();
+    CatalogueQueryCacheStats queries = CatalogueQueryCache::getInstance().getStats();
+    out.family("ogstartracker_catalogue_cache_hits_total", "counter",
+               "Lookups answered by a catalogue cache");
+    out.line("ogstartracker_catalogue_cache_hits_total{cache=\"page\"} %lu\n",
+             (unsigned long) pages.hits);
+    out.line("ogstartracker_catalogue_cache_hits_total{cache=\"query\"} %lu\n",
+             (unsigned long) queries.hits);
+    out.family("ogstartracker_catalogue_cache_misses_total", "counter",
+               "Lookups a catalogue cache could not answer");
+    out.line("ogstartracker_catalogue_cache_misses_total{cache=\"page\"} %lu\n",
+             (unsigned long) pages.misses);
+    out.line("ogstartracker_catalogue_cache_misses_total{cache=\"query\"} %lu\n",
+             (unsigned long) queries.misses);
+    out.family("ogstartracker_catalogue_cache_evictions_total", "counter",
+               "Decoded pages dropped to stay within the budget");
+    out.line("ogstartracker_catalogue_cache_evictions_total %lu\n",
+             (unsigned long) pages.evictions);
+    out.family("ogstartracker_catalogue_cache_bytes", "gauge", "Bytes held by decoded pages");
+    out.line("ogstartracker_catalogue_cache_bytes %u\n", (unsigned) pages.used_bytes);
+}
+
+void Metrics::writeHeap(MetricsWriter& out) const
+{
+    out.family("ogstartracker_heap_size_bytes", "gauge", "Size of the heap");
+    out.line("ogstartracker_heap_size_bytes %u\n", (unsigned) ESP.getHeapSize());
+    out.family("ogstartracker_heap_free_bytes", "gauge", "Free heap");
+    out.line("ogstartracker_heap_free_bytes %u\n", (unsigned) ESP.getFreeHeap());
+    out.family("ogstartracker_heap_min_free_bytes", "gauge", "Lowest free heap since boot");
+    out.line("ogstartracker_heap_min_free_bytes %u\n", (unsigned) ESP.getMinFreeHeap());
+    out.family("ogstartracker_heap_largest_block_bytes", "gauge",
+               "Largest block that can be allocated");
+    out.line("ogstartracker_heap_largest_block_bytes %u\n", (unsigned) ESP.getMaxAllocHeap());
+}
+
+void Metrics::writeTasks(MetricsWriter& out, bool stacks) const
+{
+#if configUSE_TRACE_FACILITY == 1
+    // uxTaskGetSystemState() fills in all tasks or none, with more than METRICS_MAX_TASKS the
+    // task metrics are left out instead of failing the scrape
+    if (stacks)
+    {
+        taskCount = uxTaskGetSystemState(taskStates, METRICS_MAX_TASKS, &taskRunTime);
+        out.family("ogstartracker_task_stack_high_water_bytes", "gauge",
+                   "Least stack a task had left since it started");
+        for (UBaseType_t i = 0; i < taskCount; i++)
+            out.line("ogstartracker_task_stack_high_water_bytes{task=\"%s\"} %u\n",
+                     taskStates[i].pcTaskName, (unsigned) taskStates[i].usStackHighWaterMark);
+        return;
+    }
+#if configGENERATE_RUN_TIME_STATS == 1
+    // Share of one core since boot, the idle task of each core shows what is left
+    out.family("ogstartracker_task_cpu_ratio", "gauge", "Share of a core a task used since boot");
+    for (UBaseType_t i = 0; taskRunTime > 0 && i < taskCount; i++)
+        out.line("ogstartracker_task_cpu_ratio{task=\"%s\"} %.4f\n", taskStates[i].pcTaskName,
+                 (double) taskStates[i].ulRunTimeCounter / taskRunTime);
+#endif
+#else
+    (void) out;
+    (void) stacks;
+#endif
+}
@@ -0,0 +1,146 @@
+/**
+ * @file metrics.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Routes with their own latency histogram, routes registered later are not counted
+#define METRICS_MAX_ROUTES 48
+// Upper bounds of the request latency buckets in microseconds, +Inf follows
+#define METRICS_LATENCY_BUCKETS_US {1000, 5000, 10000, 25000, 50000, 100000, 250000, 1000000}
+#define METRICS_LATENCY_BUCKET_COUNT 8
+// Exposition text is assembled in this buffer and handed to the sink whenever it fills up
+#define METRICS_BUFFER_SIZE 512
+// Most text a part written by Metrics::writePart() produces
+#define METRICS_PART_SIZE 2048
+// Tasks with stack and CPU figures, the firmware and the Arduino core run about 16
+#define METRICS_MAX_TASKS 24
+
+enum MotionKind
+{
+    MOTION_SLEW = 0,
+    MOTION_GOTO, // gotoRA and pans, both end when the target count is reached
+    MOTION_KIND_COUNT
+};
+
+class MetricsWriter;
+
+// Receives the exposition text in order
+class MetricsSink
+{
+  public:
+    virtual ~MetricsSink()
+    {
+    }
+    virtual void write(const char* text, size_t len) = 0;
+};
+
+/**
+ * @class Metrics
+ * @brief Counters and gauges exported as Prometheus text by GET /metrics
+ *
+ * Counting is cheap enough for release builds and the step ISR: a counter
+ * is a 32 bit atomic increased with a relaxed fetch_add, no lock is taken
+ * and nothing is formatted until the metrics are read. Counters wrap at
+ * 2^32, which Prometheus treats as a reset. Request histograms are only
+ * written by the web server task, which also reads them, so they are plain
+ * integers. Heap, task, UART queue and catalogue cache figures are sampled
+ * when written.
+ */
+class Metrics
+{
+  public:
+    Metrics();
+
+    // Called by the step ISR once per step pulse
+    void countStep()
+    {
+        _steps.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // A slew or goto starts, one still running is ended first
+    void beginMotion(MotionKind kind);
+    // The running motion stopped, also in the axis ISRs through Axis::stopSlew(). Without one
+    // nothing happens.
+    void endMotion();
+
+    // A line was queued for the UART, full if it had to wait for room
+    void countUartLine(bool full)
+    {
+        _uart_lines.fetch_add(1, std::memory_order_relaxed);
+        if (full)
+            _uart_full.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Give a route its histogram
+     * @return Index for recordRequest(), METRICS_MAX_ROUTES once all are taken
+     */
+    size_t addRoute(const char* uri);
+
+    // Time a handler of the route took, web server task only
+    void recordRequest(size_t route, uint32_t micros);
+
+    // Write all metrics in the Prometheus text format (version 0.0.4)
+    void write(MetricsSink& sink) const;
+
+    /**
+     * @brief Write one part of the metrics, at most METRICS_PART_SIZE bytes
+     *
+     * Writing the parts from 0 to getPartCount() - 1 in order gives the text
+     * of write(), so /metrics can be sent a few parts at a time from a small
+     * buffer. The part with the task stacks samples the tasks, the part
+     * after it reports their CPU use from the same sample.
+     */
+    void writePart(size_t part, MetricsSink& sink) const;
+    size_t getPartCount() const;
+
+  private:
+    struct Route
+    {
+        const char* uri;
+        uint32_t count;
+        uint32_t buckets[METRICS_LATENCY_BUCKET_COUNT];
+        uint64_t sum_us;
+    };
+
+    std::atomic<uint32_t> _steps;
+    std::atomic<uint32_t> _motions[MOTION_KIND_COUNT];
+    std::atomic<uint32_t> _motion_ms[MOTION_KIND_COUNT];
+    std::atomic<uint32_t> _motion_kind;
+    // millis() at the start of the running motion, 0 without one
+    std::atomic<uint32_t> _motion_start;
+    std::atomic<uint32_t> _uart_lines;
+    std::atomic<uint32_t> _uart_full;
+
+    // Parts following the one per route
+    enum Part
+    {
+        PART_UART = 0, // UART queue and catalogue caches
+        PART_HEAP,
+        PART_TASK_STACKS,
+        PART_TASK_CPU,
+        PART_COUNT
+    };
+
+    void writeHead(MetricsWriter& out) const;
+    void writeRoute(MetricsWriter& out, const Route& route) const;
+    void writeUart(MetricsWriter& out) const;
+    void writeHeap(MetricsWriter& out) const;
+    void writeTasks(MetricsWriter& out, bool stacks) const;
+
+    Route _routes[METRICS_MAX_ROUTES];
+    size_t _route_count;
+};
+
+extern Metrics metrics;
+
+#endif // METRICS_H
@@ -0,0 +1,218 @@
+"""
+Web asset pipeline
+
+Minifies the pages of the web interface and compresses them with gzip into
+interface/dist, where they are embedded from. The firmware serves them as
+they are with Content-Encoding: gzip.
+
+index.html is written once per entry of Languages (website/web_languages.h)
+as index_<code>.html.gz: the %STR_...% placeholders outside of scripts are
+replaced by the strings of languages/*.h and the strings are put in the
+page as pageLanguage for the scripts, so the page needs no /langstrings
+request. Adding a language means adding its page to platformio.ini and to
+ApiHandler::handleRoot.
+
+Minifying is kept safe for hand-written pages: indentation, blank lines,
+HTML and CSS comments and whole-line // comments in scripts are removed,
+every line break stays (no reliance on semicolons). The output is
+reproducible (no time stamp in the gzip header).
+
+Runs as a PlatformIO pre-script before every build, or by hand:
+  python shared/web_assets.py [--output interface/dist]
+"""
+
+import argparse
+import gzip
+import html
+import json
+import os
+import re
+import sys
+
+LANGUAGE_PAGE = 'interface/index.html'
+PAGES = ['interface/ota.html']
+OUTPUT_DIR = 'interface/dist'
+LANGUAGES_HEADER = 'website/web_languages.h'
+LANGUAGES_SOURCE = 'website/web_languages.cpp'
+LANGUAGES_DIR = 'languages'
+
+BLOCK_RE = re.compile(r'(<script[^>]*>|<style[^>]*>|</script>|</style>)', re.IGNORECASE)
+C_TOKEN_RE = re.compile(r'"(?:[^"\\]|\\.)*"|//[^\n]*|/\*.*?\*/|,', re.DOTALL)
+C_ARRAY_RE = re.compile(r'const\s+char\s*\*\s*const\s+(\w+)\s*\[[^\]]*\]\s*(?:PROGMEM\s*)?=\s*'
+                        r'\{(.*?)\};', re.DOTALL)
+C_ESCAPES = {'n': '\n', 't': '\t', 'r': '\r', '"': '"', "'": "'", '\\': '\\', '?': '?'}
+
+
+def minify_html(text):
+    text = re.sub(r'<!--(?!\[).*?-->', '', text, flags=re.DOTALL)
+    lines = []
+    block = None
+    for part in BLOCK_RE.split(text):
+        tag = part.lower()
+        if tag.startswith('<script') or tag.startswith('<style'):
+            block = 'script' if tag.startswith('<script') else 'style'
+        elif tag in ('</script>', '</style>'):
+            block = None
+        elif block == 'style':
+            part = re.sub(r'/\*.*?\*/', '', part, flags=re.DOTALL)
+        for line in part.split('\n'):
+            line = line.strip()
+            if not line or (block == 'script' and line.startswith('//')):
+                continue
+            lines.append(line)
+    return '\n'.join(lines) + '\n'
+
+
+def parse_c_string(literal):
+    text = literal[1:-1]
+    return re.sub(r'\\(.)', lambda m: C_ESCAPES.get(m.group(1), m.group(1)), text)
+
+
+def read_string_arrays(path):
+    """String arrays of a C++ file by name, adjacent literals joined"""
+    with open(path, encoding='utf-8') as f:
+        source = f.read()
+    arrays = {}
+    for name, body in C_ARRAY_RE.findall(source):
+        items = []
+        current = None
+        for token in C_TOKEN_RE.findall(body):
+            if token == ',':
+                if current is not None:
+                    items.append(current)
+                current = None
+            elif token.startswith('"'):
+                current = (current or '') + parse_c_string(token)
+        if current is not None:
+            items.append(current)
+        arrays[name] = items
+    return arrays
+
+
+def read_identifiers(source, pattern):
+    match = re.search(pattern, source, re.DOTALL)
+    if not match:
+        raise ValueError(f'{pattern} not found')
+    body = re.sub(r'//[^\n]*', '', match.group(1))
+    return [name.strip() for name in body.split(',') if name.strip()]
+
+
+def read_languages(project_dir):
+    """Code, names and HTML strings per Languages entry, and the placeholders"""
+    with open(os.path.join(project_dir, LANGUAGES_HEADER), encoding='utf-8') as f:
+        codes = read_identifiers(f.read(), r'enum\s+Languages\s*\{(.*?)\}')
+    codes = codes[:codes.index('LANG_COUNT')]
+
+    source_path = os.path.join(project_dir, LANGUAGES_SOURCE)
+    with open(source_path, encoding='utf-8') as f:
+        source = f.read()
+    names_arrays = read_identifiers(source, r'languageNames\[LANG_COUNT\]\s*=\s*\{(.*?)\};')
+    html_arrays = read_identifiers(source, r'languageHTMLStrings\[LANG_COUNT\]\s*=\s*\{(.*?)\};')
+    placeholders = read_string_arrays(source_path)['HTMLplaceHolders']
+
+    arrays = {}
+    languages_dir = os.path.join(project_dir, LANGUAGES_DIR)
+    for name in sorted(os.listdir(languages_dir)):
+        if name.endswith('.h'):
+            arrays.update(read_string_arrays(os.path.join(languages_dir, name)))
+
+    languages = []
+    for index, code in enumerate(codes):
+        strings = arrays[html_arrays[index]]
+        if len(strings) != len(placeholders):
+            raise ValueError(f'{html_arrays[index]} has {len(strings)} strings, '
+                             f'{len(placeholders)} expected')
+        languages.append((code.lower(), arrays[names_arrays[index]], strings))
+    return languages, placeholders
+
+
+def render_language(page, index, names, strings, placeholders):
+    """Page with the placeholders of one language filled in"""
+    parts = []
+    block = False
+    for part in BLOCK_RE.split(page):
+        tag = part.lower()
+        if tag.startswith('<script') or tag.startswith('<style'):
+            block = True
+        elif tag in ('</script>', '</style>'):
+            block = False
+        elif not block:
+            # Scripts look strings up by placeholder, only markup is translated
+            for placeholder, text in zip(placeholders, strings):
+                part = part.replace(placeholder, html.escape(text))
+        parts.append(part)
+    page = ''.join(parts)
+
+    title = strings[placeholders.index('%STR_TITLE%')]
+    page = re.sub(r'<title>.*?</title>', lambda m: f'<title>{html.escape(title)}</title>', page,
+                  count=1)
+    data = json.dumps({'lang': index, 'langNames': names,
+                       'strings': dict(zip(placeholders, strings))},
+                      ensure_ascii=False, separators=(',', ':')).replace('</', '<\\/')
+    script = page.lower().index('<script')
+    return page[:script] + f'<script>var pageLanguage = {data};</script>\n' + page[script:]
+
+
+def read_page(project_dir, path):
+    with open(os.path.join(project_dir, path), encoding='utf-8') as f:
+        return f.read().replace('\r\n', '\n')
+
+
+def write_asset(output, text):
+    data = gzip.compress(text.encode('utf-8'), compresslevel=9, mtime=0)
+    # Unchanged output keeps its time stamp, nothing is embedded again
+    if os.path.exists(output):
+        with open(output, 'rb') as f:
+            if f.read() == data:
+                return len(data)
+    with open(output, 'wb') as f:
+        f.write(data)
+    return len(data)
+
+
+def build_assets(project_dir, output_dir):
+    os.makedirs(output_dir, exist_ok=True)
+
+    for path in PAGES:
+        page = read_page(project_dir, path)
+        output = os.path.join(output_dir, os.path.basename(path) + '.gz')
+        size = write_asset(output, minify_html(page))
+        print(f'Web asset: {path} {len(page.encode("utf-8"))} bytes -> {output} {size} bytes')
+
+    # Translated after minifying, the strings go in as they are
+    page = read_page(project_dir, LANGUAGE_PAGE)
+    minified = minify_html(page)
+    languages, placeholders = read_languages(project_dir)
+    for index, (code, names, strings) in enumerate(languages):
+        base = os.path.splitext(os.path.basename(LANGUAGE_PAGE))[0]
+        output = os.path.join(output_dir, f'{base}_{code}.html.gz')
+        size = write_asset(output, render_language(minified, index, names, strings, placeholders))
+        print(f'Web asset: {LANGUAGE_PAGE} ({code}) {len(page.encode("utf-8"))} bytes -> '
+              f'{output} {size} bytes')
+
+
+def main():
+    project_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description='Minify and compress the web interface')
+    parser.add_argument('--output', default=os.path.join(project_dir, OUTPUT_DIR),
+                        help='Output directory')
+    args = parser.parse_args()
+
+    try:
+        build_assets(project_dir, args.output)
+    except (OSError, ValueError) as e:
+        print(f'Error: {e}', file=sys.stderr)
+        return 1
+    return 0
+
+
+try:
+    Import("env")
+except NameError:
+    # Run by hand, not by PlatformIO
+    if __name__ == '__main__':
+        sys.exit(main())
+else:
+    # SCons runs the script without __file__
+    project_dir = env.subst("$PROJECT_DIR")
+    build_assets(project_dir, os.path.join(project_dir, OUTPUT_DIR))
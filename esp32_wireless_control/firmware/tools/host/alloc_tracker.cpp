@@ -0,0 +1,106 @@
+#include <malloc.h>
+
+#include "alloc_tracker.h"
+
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void __libc_free(void* ptr);
+}
+
+static AllocStats stats = {};
+static size_t fail_from = 0;
+
+static bool failing(size_t size)
+{
+    return fail_from != 0 && size >= fail_from;
+}
+
+static void trackAdd(void* ptr)
+{
+    size_t size = malloc_usable_size(ptr);
+    stats.bytes_allocated += size;
+    stats.current_bytes += size;
+    if (stats.current_bytes > stats.peak_bytes)
+        stats.peak_bytes = stats.current_bytes;
+}
+
+static void trackRemove(void* ptr)
+{
+    stats.current_bytes -= malloc_usable_size(ptr);
+}
+
+extern "C" void* malloc(size_t size)
+{
+    if (failing(size))
+        return nullptr;
+    void* ptr = __libc_malloc(size);
+    if (ptr)
+    {
+        stats.allocations++;
+        trackAdd(ptr);
+    }
+    return ptr;
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+    if (failing(count * size))
+        return nullptr;
+    void* ptr = __libc_calloc(count, size);
+    if (ptr)
+    {
+        stats.allocations++;
+        trackAdd(ptr);
+    }
+    return ptr;
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+    if (ptr == nullptr)
+        return malloc(size);
+    if (size == 0)
+    {
+        free(ptr);
+        return nullptr;
+    }
+
+    if (failing(size))
+        return nullptr;
+    size_t old_size = malloc_usable_size(ptr);
+    void* new_ptr = __libc_realloc(ptr, size);
+    if (new_ptr)
+    {
+        stats.reallocations++;
+        stats.current_bytes -= old_size;
+        trackAdd(new_ptr);
+    }
+    return new_ptr;
+}
+
+extern "C" void free(void* ptr)
+{
+    if (ptr == nullptr)
+        return;
+    stats.frees++;
+    trackRemove(ptr);
+    __libc_free(ptr);
+}
+
+AllocStats AllocTracker::snapshot()
+{
+    return stats;
+}
+
+void AllocTracker::resetPeak()
+{
+    stats.peak_bytes = stats.current_bytes;
+}
+
+void AllocTracker::failFrom(size_t bytes)
+{
+    fail_from = bytes;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file alloc_tracker.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct AllocStats
+{
+    uint64_t allocations;     // malloc/calloc/realloc(nullptr) calls
+    uint64_t reallocations;   // realloc of an existing block
+    uint64_t frees;           // free of a non-null block
+    uint64_t bytes_allocated; // Total usable bytes handed out
+    size_t current_bytes;     // Usable bytes currently live
+    size_t peak_bytes;        // Highest current_bytes since the last resetPeak()
+};
+
+/**
+ * @brief Counts every heap allocation of the host process
+ *
+ * malloc/calloc/realloc/free are wrapped around the glibc allocator, so
+ * String, std::vector and operator new are all covered without touching the
+ * code under test. Linux/glibc only, single threaded use.
+ */
+class AllocTracker
+{
+  public:
+    static AllocStats snapshot();
+
+    // Start a new peak measurement from the current live heap size
+    static void resetPeak();
+
+    // Let allocations of at least bytes fail like on a fragmented heap, 0 turns it off
+    static void failFrom(size_t bytes);
+};
+
+#endif // ALLOC_TRACKER_H
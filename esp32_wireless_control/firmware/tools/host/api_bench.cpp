@@ -0,0 +1,1437 @@
+/**
+ * @file api_bench.cpp
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ *
+ * Host-side load test of the web API.
+ *
+ * Registers the endpoints of ApiHandler and OTAHandler on a mock WebServer
+ * and calls their handlers directly, with the arguments a browser would
+ * send, recording the response. The catalogues are uploaded into an
+ * emulated catalogue partition and loaded like setup() does, the RA axis is
+ * the real one with its step timers run by the host, the intervalometer is
+ * simulated (intervalometer_host.cpp) and OTA updates are only counted
+ * (ota_handler_host.cpp).
+ *
+ * Every registered route is first called with valid and invalid requests
+ * and its status checked. Then a seeded load generator replays web UI
+ * traffic: status and position polling, event streams, slew touches,
+ * searches, sky tiles and catalogue pages, with the occasional page load,
+ * goto or capture in between. Per route it reports the latency, heap
+ * allocations and String churn of a request.
+ *
+ * Usage: api_bench [-v] [-n requests] [-r seed] [catalogues directory]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <poll.h>
+#include <signal.h>
+#include <regex>
+#include <set>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include <ArduinoJson.h>
+#include <WebServer.h>
+#include <esp32-hal-timer.h>
+
+#include "alloc_tracker.h"
+#include "axis.h"
+#include "catalogue_flash_host.h"
+#include "catalogues/catalogue_partition.h"
+#include "catalogues/sky_tiles.h"
+#include "catalogues/sky_visibility.h"
+#include "catalogues/star_database_registry.h"
+#include "eeprom_manager.h"
+#include "functions/intervalometer/intervalometer.h"
+#include "functions/ota/ota_handler.h"
+#include "tracking_rates.h"
+#include "uart.h"
+#include "website/api_handler.h"
+#include "website/event_stream.h"
+#include "website/web_languages.h"
+#include "website/website_strings.h"
+
+#define PARTITION_CAPACITY 0x60000
+#define BUNDLE_FILE "catalogue_bundle.bin"
+#define SEARCH_INDEX_FILE "search_index.json.gz"
+
+#define DEFAULT_REQUESTS 20000
+#define DEFAULT_SEED 1
+// Event streams the generator keeps open, the oldest is closed to open another
+#define OPEN_EVENT_STREAMS (EVENT_STREAM_MAX_CLIENTS - 1)
+// Longest wait for a body written after the handler returned
+#define DRAIN_TIMEOUT_MS 2000
+#define UTC_NOW "2025-06-01T22:00:00.000Z"
+// Send buffer of the stalled subscriber, the kernel raises it to its minimum of a few KB
+#define STALLED_SEND_BUFFER 1024
+// Events of the stalled subscriber check, enough to fill its send buffer
+#define STALLED_EVENTS 32
+#define STALLED_EVENT_SIZE 512
+// A publish that waited for the stalled client would take the write timeout of 1 s
+#define STALLED_MAX_PUBLISH_US 20000
+// Clients downloading large responses at the same time in the slow client check
+#define SLOW_CLIENT_COUNTS {1, 5, 10}
+// Bytes a second a slow client reads, a phone at the edge of the access point
+#define SLOW_CLIENT_RATE 32768
+// Send buffer of a connection, TCP_SND_BUF of lwIP in arduino-esp32
+#define SLOW_CLIENT_SEND_BUFFER 5744
+#define SLOW_CLIENT_RUN_MS 2000
+// Control requests come this often, a slew button pressed again and again
+#define CONTROL_INTERVAL_MS 5
+// A control request that waited for a download would take as long as the download
+#define CONTROL_MAX_P99_US 20000
+// Names of the batch a slow client requests, the most the firmware accepts
+#define SLOW_CLIENT_BATCH_NAMES 64
+
+// The objects of firmware.ino, the web API refers to them
+Languages language = EN;
+Intervalometer* intervalometer = nullptr;
+
+static size_t shutdowns = 0;
+
+// Rebooting is the last step of an update, here it is only counted
+void systemShutdown()
+{
+    shutdowns++;
+}
+
+struct RouteStats
+{
+    std::string route;
+    uint64_t allocations;
+    uint64_t bytes_allocated;
+    uint64_t string_constructions;
+    uint64_t string_allocations;
+    size_t peak_bytes; // Largest heap growth during a single request
+    std::vector<double> latencies_us;
+};
+
+static bool verbose = false;
+static WebServer server(WEBSERVER_PORT);
+static std::map<std::string, RouteStats> route_stats;
+static std::set<std::string> reached_routes;
+static size_t mismatches = 0;
+
+static bool readFile(const std::string& path, std::string& out)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static double percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t) (p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+static const char* methodName(HTTPMethod method)
+{
+    return method == HTTP_POST ? "POST" : "GET";
+}
+
+static HostRequest get(const char* uri, const HostFields& args = HostFields())
+{
+    HostRequest request;
+    request.method = HTTP_GET;
+    request.uri = uri;
+    request.args = args;
+    return request;
+}
+
+static HostRequest post(const char* uri, const std::string& body)
+{
+    HostRequest request;
+    request.method = HTTP_POST;
+    request.uri = uri;
+    request.body = body;
+    return request;
+}
+
+static const char* findField(const HostFields& fields, const char* name)
+{
+    for (const auto& field : fields)
+    {
+        if (strcasecmp(field.first.c_str(), name) == 0)
+            return field.second.c_str();
+    }
+    return nullptr;
+}
+
+// Read what the handler left on the connection. Background transfers are
+// written by ApiHandler::loop(), so it runs until the expected length arrived.
+static size_t drainPeer(int peer, size_t expected, std::string* data = nullptr)
+{
+    char buffer[4096];
+    size_t received = 0;
+    unsigned long last = millis();
+    for (;;)
+    {
+        ssize_t len = recv(peer, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (len > 0)
+        {
+            received += len;
+            if (data != nullptr)
+                data->append(buffer, len);
+            last = millis();
+            continue;
+        }
+        if (len == 0 || received >= expected || millis() - last > DRAIN_TIMEOUT_MS)
+            return received;
+        ApiHandler::getInstance().loop();
+        struct pollfd fd = {peer, POLLIN, 0};
+        poll(&fd, 1, 1);
+    }
+}
+
+/**
+ * @brief Read a response a background transfer wrote on the connection
+ *
+ * The handler sent nothing through the server, TransferQueue wrote the
+ * status line, the headers and the chunked body itself.
+ * @return false if the response is malformed or cut short
+ */
+static bool parseResponse(const std::string& raw, HostResponse& response)
+{
+    size_t head_end = raw.find("\r\n\r\n");
+    if (raw.compare(0, 9, "HTTP/1.1 ") != 0 || head_end == std::string::npos)
+        return false;
+    response.code = atoi(raw.c_str() + 9);
+
+    bool chunked = false;
+    for (size_t line = raw.find("\r\n") + 2; line < head_end + 2;)
+    {
+        size_t end = raw.find("\r\n", line);
+        size_t colon = raw.find(':', line);
+        if (colon == std::string::npos || colon > end)
+            return false;
+        std::string name = raw.substr(line, colon - line);
+        std::string value = raw.substr(colon + 2, end - colon - 2);
+        if (strcasecmp(name.c_str(), "Content-Type") == 0)
+            response.type = value;
+        else
+            response.headers.push_back({name, value});
+        chunked |= strcasecmp(name.c_str(), "Transfer-Encoding") == 0 && value == "chunked";
+        line = end + 2;
+    }
+    if (!chunked)
+        return false;
+
+    // Chunks up to the last one, nothing may follow it
+    response.body.clear();
+    for (size_t at = head_end + 4;;)
+    {
+        size_t end = raw.find("\r\n", at);
+        if (end == std::string::npos)
+            return false;
+        size_t size = strtoul(raw.substr(at, end - at).c_str(), nullptr, 16);
+        at = end + 2;
+        if (size == 0)
+            return raw.size() == at + 2 && raw.compare(at, 2, "\r\n") == 0;
+        if (raw.size() < at + size + 2 || raw.compare(at + size, 2, "\r\n") != 0)
+            return false;
+        response.body.append(raw, at, size);
+        at += size + 2;
+    }
+}
+
+static void reportMismatch(const HostRequest& request, const std::string& why);
+
+/**
+ * @brief Run one request and add it to the statistics of its route
+ *
+ * The time and allocations cover the handler and the mock connection it
+ * writes to, not the bytes written after it returned. A response left to a
+ * background transfer is read from the connection into response.
+ */
+static void call(const HostRequest& request, HostResponse& response, bool keep_peer = false)
+{
+    std::string route = std::string(methodName(request.method)) + " " + request.uri;
+    RouteStats& stats = route_stats[route];
+    stats.route = route;
+
+    AllocTracker::resetPeak();
+    AllocStats before = AllocTracker::snapshot();
+    StringStats strings_before = stringStats;
+    auto start = std::chrono::steady_clock::now();
+    bool matched = server.request(request, response);
+    auto end = std::chrono::steady_clock::now();
+    AllocStats after = AllocTracker::snapshot();
+
+    stats.latencies_us.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    stats.allocations += after.allocations - before.allocations;
+    stats.bytes_allocated += after.bytes_allocated - before.bytes_allocated;
+    stats.string_constructions += stringStats.constructions - strings_before.constructions;
+    stats.string_allocations += stringStats.heap_allocations - strings_before.heap_allocations;
+    stats.peak_bytes = std::max(stats.peak_bytes, after.peak_bytes - before.current_bytes);
+    if (matched)
+        reached_routes.insert(route);
+
+    if (response.peer >= 0 && !keep_peer && response.code == 0)
+    {
+        // Nothing went through the server, the response is written from loop() or there is none
+        std::string raw;
+        drainPeer(response.peer, SIZE_MAX, &raw);
+        close(response.peer);
+        response.peer = -1;
+        if (!raw.empty() && !parseResponse(raw, response))
+            reportMismatch(request, "response cut short (" + raw.substr(0, 80) + ")");
+    }
+    else if (response.peer >= 0 && !keep_peer)
+    {
+        // A body announced but not sent through the server follows on the connection
+        size_t expected = 0;
+        if (response.content_length != CONTENT_LENGTH_NOT_SET &&
+            response.content_length != CONTENT_LENGTH_UNKNOWN &&
+            response.content_length > response.body.size())
+            expected = response.content_length - response.body.size();
+        drainPeer(response.peer, expected);
+        close(response.peer);
+        response.peer = -1;
+    }
+}
+
+static void reportMismatch(const HostRequest& request, const std::string& why)
+{
+    mismatches++;
+    fflush(stdout);
+    fprintf(stderr, "%s %s: %s\n", methodName(request.method), request.uri.c_str(), why.c_str());
+}
+
+// Call a route and check the status, the response is returned for further checks
+static HostResponse expect(const HostRequest& request, int code)
+{
+    HostResponse response;
+    call(request, response);
+    if (response.code != code)
+    {
+        reportMismatch(request, "status " + std::to_string(response.code) + ", expected " +
+                                    std::to_string(code) + " (" + response.body.substr(0, 80) +
+                                    ")");
+    }
+    return response;
+}
+
+static void expectBody(const HostRequest& request, const HostResponse& response,
+                       const char* text)
+{
+    if (response.body.find(text) == std::string::npos)
+        reportMismatch(request, std::string("response lacks ") + text);
+}
+
+static void expectJson(const HostRequest& request, const HostResponse& response,
+                       const char* member)
+{
+    JsonDocument doc;
+    if (deserializeJson(doc, String(response.body.c_str())) != DeserializationError::Ok ||
+        doc[member].isNull())
+        reportMismatch(request, std::string("no JSON with ") + member);
+}
+
+// A JSON array of count flat objects that all have the members
+static void expectObjects(const HostRequest& request, const HostResponse& response, size_t count,
+                          const std::vector<const char*>& members)
+{
+    const std::string& body = response.body;
+    size_t objects = std::count(body.begin(), body.end(), '{');
+    if (body.empty() || body.front() != '[' || body.back() != ']' || objects != count ||
+        (size_t) std::count(body.begin(), body.end(), '}') != count)
+    {
+        reportMismatch(request, "no JSON array of " + std::to_string(count) + " objects");
+        return;
+    }
+
+    for (const char* member : members)
+    {
+        std::string key = std::string("\"") + member + "\":";
+        size_t found = 0;
+        for (size_t at = body.find(key); at != std::string::npos; at = body.find(key, at + 1))
+            found++;
+        if (found != count)
+            reportMismatch(request, std::string("objects without ") + member);
+    }
+}
+
+// Every line must parse as Prometheus text (version 0.0.4), a scraper rejects the whole scrape
+// over a single bad line. Samples need a TYPE line of their family before them.
+static void expectPrometheus(const HostRequest& request, const HostResponse& response)
+{
+    static const std::regex comment("# (HELP|TYPE) ([a-zA-Z_:][a-zA-Z0-9_:]*) (.*)");
+    static const std::regex sample("([a-zA-Z_:][a-zA-Z0-9_:]*)"
+                                   "(\\{[a-zA-Z_][a-zA-Z0-9_]*=\"[^\"\\\\]*\""
+                                   "(,[a-zA-Z_][a-zA-Z0-9_]*=\"[^\"\\\\]*\")*\\})? "
+                                   "([-+]?[0-9.eE+-]+|[-+]Inf|NaN)");
+    static const std::regex type("counter|gauge|histogram|summary|untyped");
+
+    const std::string& body = response.body;
+    if (body.empty() || body.back() != '\n')
+    {
+        reportMismatch(request, "metrics do not end with a newline");
+        return;
+    }
+    std::map<std::string, std::string> types;
+    size_t start = 0;
+    while (start < body.size())
+    {
+        size_t end = body.find('\n', start);
+        std::string line = body.substr(start, end - start);
+        start = end + 1;
+
+        std::smatch match;
+        if (std::regex_match(line, match, comment))
+        {
+            if (match[1] == "TYPE" && !std::regex_match(match[3].str(), type))
+                reportMismatch(request, "bad metric type: " + line);
+            else if (match[1] == "TYPE")
+                types[match[2]] = match[3];
+            continue;
+        }
+        if (!std::regex_match(line, match, sample))
+        {
+            reportMismatch(request, "bad metrics line: " + line);
+            continue;
+        }
+
+        std::string name = match[1];
+        std::string family = std::regex_replace(name, std::regex("_(bucket|sum|count)$"), "");
+        if (types.count(name) == 0 && types[family] != "histogram")
+            reportMismatch(request, "metric without a TYPE line: " + line);
+    }
+}
+
+static size_t countEvents(const std::string& stream)
+{
+    size_t count = 0;
+    for (size_t at = stream.find("data: "); at != std::string::npos;
+         at = stream.find("data: ", at + 1))
+        count++;
+    return count;
+}
+
+static String paddedState(int number, size_t padding)
+{
+    return "{\"n\":" + String(number) + ",\"pad\":\"" + String(std::string(padding, 'x').c_str()) +
+           "\"}";
+}
+
+/**
+ * @brief A subscriber that stops reading holds up neither the server task nor the others
+ *
+ * The stalled client misses events while its socket is full, gets the current
+ * state once it reads again and is dropped when only part of an event fits.
+ */
+static void runStalledSubscriber()
+{
+    HostRequest request = get("/events");
+    int reader[2];
+    int stalled[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, reader) != 0 ||
+        socketpair(AF_UNIX, SOCK_STREAM, 0, stalled) != 0)
+    {
+        reportMismatch(request, "no socket pair");
+        return;
+    }
+    int size = STALLED_SEND_BUFFER;
+    setsockopt(stalled[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+    EventStream stream;
+    WiFiClient reading_client(reader[0]);
+    WiFiClient stalled_client(stalled[0]);
+    stream.subscribe(reading_client, "{}");
+    stream.subscribe(stalled_client, "{}");
+
+    std::string received;
+    std::string missed;
+    double slowest_us = 0.0;
+    for (int i = 0; i < STALLED_EVENTS; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        stream.publish(paddedState(i, STALLED_EVENT_SIZE));
+        auto end = std::chrono::steady_clock::now();
+        slowest_us =
+            std::max(slowest_us, std::chrono::duration<double, std::micro>(end - start).count());
+        drainPeer(reader[1], 0, &received);
+    }
+    drainPeer(stalled[1], 0, &missed);
+
+    if (slowest_us > STALLED_MAX_PUBLISH_US)
+        reportMismatch(request, "publish waited " + std::to_string((int) slowest_us) + " us");
+    if (countEvents(received) != STALLED_EVENTS + 1)
+        reportMismatch(request, "reading subscriber lost events");
+    if (countEvents(missed) >= STALLED_EVENTS + 1)
+        reportMismatch(request, "stalled subscriber never missed an event");
+
+    // Reading again, the stalled client catches up with the current state
+    missed.clear();
+    stream.publish(paddedState(STALLED_EVENTS - 1, STALLED_EVENT_SIZE));
+    drainPeer(stalled[1], 0, &missed);
+    if (missed.find("\"n\":" + std::to_string(STALLED_EVENTS - 1)) == std::string::npos)
+        reportMismatch(request, "stalled subscriber did not catch up");
+
+    // An event larger than the send buffer only fits in part, that client has to go
+    stream.publish(paddedState(STALLED_EVENTS, STALLED_SEND_BUFFER * 16));
+    drainPeer(reader[1], 0, &received);
+    if (stream.getClientCount() != 1)
+        reportMismatch(request, "stalled subscriber kept after a partial event");
+    if (countEvents(received) != STALLED_EVENTS + 2)
+        reportMismatch(request, "reading subscriber lost the large event");
+
+    close(reader[1]);
+    close(stalled[1]);
+}
+
+// The intervalometer arguments of the capture page
+static HostFields captureArgs(const char* mode, const char* preset)
+{
+    return {{CAPTURE_MODE, "0"},     {EXPOSURE_TIME, "2"},  {EXPOSURES, "3"},
+            {PREDELAY, "1"},         {DELAY, "1"},          {FRAMES, "1"},
+            {PAN_ANGLE, "0"},        {PAN_DIRECTION, "1"},  {CONTINUOUS_PAN, "0"},
+            {ENABLE_TRACKING, "1"},  {DITHER_CHOICE, "1"},  {DITHER_FREQUENCY, "2"},
+            {FOCAL_LENGTH, "50"},    {PIXEL_SIZE, "400"},   {MODE, mode},
+            {PRESET, preset}};
+}
+
+/**
+ * @brief Call every route with valid and invalid requests and check the answers
+ *
+ * POST /catalogUpload suspends the catalogues and reboots, it is called
+ * last by runUploadCheck().
+ */
+static void runCoverage(const std::string& search_index)
+{
+    HostRequest request;
+    HostResponse response;
+
+    // Web interface and OTA page, revalidated by ETag
+    request = get("/");
+    response = expect(request, 200);
+    const char* etag = findField(response.headers, "ETag");
+    if (etag == nullptr)
+    {
+        reportMismatch(request, "no ETag");
+    }
+    else
+    {
+        request.headers = {{"If-None-Match", etag}};
+        expect(request, 304);
+    }
+    expect(get("/ota"), 200);
+    expect(get("/setlang", {{"lang", "2"}}), 200);
+    expect(get("/getlang"), 200);
+    expect(get("/langstrings"), 200);
+    expect(get("/setlang", {{"lang", "0"}}), 200);
+
+    // Tracking, slews and gotos
+    expect(get("/on", {{TRACKING_SPEED, "0"}, {DIRECTION, "1"}}), 200);
+    hostTimersRun();
+    expect(get("/startslew", {{SPEED, "50"}, {DIRECTION, "0"}}), 200);
+    delay(5);
+    hostTimersRun();
+    expect(get("/stopslew"), 200);
+    expect(get("/setPosition", {{"currentRA", "3600"}}), 200);
+    request = get("/getCurrentPosition",
+                  {{UTC_TIME, UTC_NOW}, {"timezone", "0"}, {"longitude", "11.5"}});
+    expectJson(request, expect(request, 200), "ra");
+    expect(get("/gotoRA", {{"currentRA", "3600"}, {"targetRA", "7200"}, {SPEED, "100"}}), 200);
+    hostTimersRun();
+    expect(get("/abort-goto-ra"), 200);
+    expect(get("/off"), 200);
+
+    // Tracking rates
+    expect(get("/getTrackingRates", {{"type", "1"}}), 200);
+    expect(get("/saveTrackingRatePreset",
+               {{PRESET, "1"}, {TRACKING_TYPE, "0"}, {CUSTOM_RATE, "0"}}),
+           200);
+    request = get("/loadTrackingRatePreset", {{PRESET, "1"}});
+    expectJson(request, expect(request, 200), "trackingRateType");
+    expect(get("/loadTrackingRatePreset", {{PRESET, "9"}}), 400);
+
+    // Intervalometer
+    expect(get("/setCurrent", captureArgs("save", "1")), 200);
+    request = get("/readPreset", {{PRESET, "1"}});
+    expectBody(request, expect(request, 200), "\"exposures\":3");
+    expect(get("/setCurrent", captureArgs("start", "1")), 200);
+    expect(get("/status"), 200);
+    request = get("/state");
+    expectBody(request, expect(request, 200), "\"totalExposures\":3");
+    expect(get("/abort"), 200);
+
+    // Command lists, checked before anything runs
+    request = post("/commands", "{\"commands\":[{\"command\":\"on\",\"direction\":1},"
+                                "{\"command\":\"startslew\",\"direction\":1,\"speed\":8},"
+                                "{\"command\":\"stopslew\"},{\"command\":\"off\"}]}");
+    expectBody(request, expect(request, 200), "\"completed\":4");
+    expect(post("/commands", "{\"commands\":[{\"command\":\"fly\"}]}"), 400);
+    // Preset 1 is a long exposure, tracking is followed through the list
+    request = post("/commands", "{\"commands\":[{\"command\":\"on\",\"direction\":1},"
+                                "{\"command\":\"off\"},"
+                                "{\"command\":\"startCapture\",\"preset\":1}]}");
+    expectBody(request, expect(request, 400), "\"index\":2");
+    request = get("/state");
+    expectBody(request, expect(request, 200), "\"tracking\":0,");
+    request = post("/commands", "{\"commands\":[{\"command\":\"on\",\"direction\":1},"
+                                "{\"command\":\"startCapture\",\"preset\":1},"
+                                "{\"command\":\"abort\"},{\"command\":\"off\"}]}");
+    expectBody(request, expect(request, 200), "\"completed\":4");
+    expect(post("/commands", "{\"commands\":"), 400);
+
+    // Status
+    request = get("/state");
+    expectJson(request, expect(request, 200), "state");
+    expectJson(get("/version"), expect(get("/version"), 200), "version");
+    request = get("/events", {{UTC_TIME, UTC_NOW}});
+    call(request, response, true);
+    std::string stream;
+    drainPeer(response.peer, 1, &stream);
+    if (response.code != 0 || stream.find("text/event-stream") == std::string::npos ||
+        stream.find("data: {") == std::string::npos)
+        reportMismatch(request, "no event stream");
+    close(response.peer);
+    request = get("/metrics");
+    response = expect(request, 200);
+    expectBody(request, response,
+               "ogstartracker_http_request_duration_seconds_count{route=\"/state\"} 3");
+    expectPrometheus(request, response);
+
+    // Catalogues
+    request = get("/starSearch", {{STAR_CATALOG, "0"}, {STAR_NAME, "M31"}});
+    expectJson(request, expect(request, 200), "name");
+    expect(get("/starSearch", {{STAR_CATALOG, "0"}, {STAR_NAME, "Nonexistent 99"}}), 404);
+    expect(get("/starSearch", {{STAR_CATALOG, "0"}}), 400);
+    expect(get("/starSearch", {{STAR_CATALOG, "99"}, {STAR_NAME, "M31"}}), 400);
+    request = post("/starBatch",
+                   "{\"names\":[\"M31\",\"Vega\",{\"name\":\"M42\",\"starCatalog\":5},"
+                   "\"Nonexistent 99\",\"Odd \\\"quote\"],\"utcTime\":\"" UTC_NOW "\"}");
+    response = expect(request, 200);
+    expectObjects(request, response, 5, {"query", "found"});
+    expectBody(request, response, "\"query\":\"Vega\",\"name\":\"VEGA\"");
+    // The query goes back as sent, escaped for JSON
+    expectBody(request, response, "\"query\":\"Odd \\\"quote\"");
+    expect(post("/starBatch", "{\"names\":[]}"), 400);
+    expect(post("/starBatch", "[1,"), 400);
+    request = get("/visibleObjects", {{LATITUDE, "48.1"},
+                                      {LONGITUDE, "11.6"},
+                                      {UTC_TIME, UTC_NOW},
+                                      {STAR_CATALOG, "1"},
+                                      {RESULT_LIMIT, "10"}});
+    expectObjects(request, expect(request, 200), 10,
+                  {"name", "ra", "dec", "altitude", "azimuth", "type", "magnitude",
+                   "constellation", "catalog"});
+    expect(get("/visibleObjects", {{LATITUDE, "48.1"}}), 400);
+    // No heap for the result list is an answer, not an abort
+    AllocTracker::failFrom(sizeof(SkyVisibleObject) * SKY_VISIBILITY_MAX_RESULTS);
+    expect(get("/visibleObjects", {{LATITUDE, "48.1"},
+                                   {LONGITUDE, "11.6"},
+                                   {UTC_TIME, UTC_NOW},
+                                   {RESULT_LIMIT, "100"}}),
+           503);
+    AllocTracker::failFrom(0);
+    request = get("/catalogBrowse", {{STAR_CATALOG, "3"}, {SORT_ORDER, "magnitude"},
+                                     {RESULT_LIMIT, "20"}});
+    expectJson(request, expect(request, 200), "objects");
+    expect(get("/catalogBrowse", {{STAR_CATALOG, "3"}, {SORT_ORDER, "colour"}}), 400);
+    request = get("/catalogFilter", {{STAR_CATALOG, "1"}, {OBJECT_TYPE, "Gx"},
+                                     {MAX_MAGNITUDE, "11"}, {RESULT_LIMIT, "20"}});
+    expectJson(request, expect(request, 200), "objects");
+    expect(get("/catalogFilter", {{STAR_CATALOG, "42"}}), 400);
+    request = get("/skyTile", {{STAR_CATALOG, "3"}, {SKY_TILE, "0"}});
+    response = expect(request, 200);
+    etag = findField(response.headers, "ETag");
+    if (etag != nullptr)
+    {
+        request.headers = {{"If-None-Match", etag}};
+        expect(request, 304);
+    }
+    expect(get("/skyTile", {{STAR_CATALOG, "3"}, {SKY_TILE, "100000"}}), 400);
+    // The sources of generated responses hold a buffer of 1 KB or more each
+    AllocTracker::failFrom(1024);
+    expect(get("/catalogBrowse", {{STAR_CATALOG, "3"}}), 503);
+    expect(get("/catalogFilter", {{STAR_CATALOG, "1"}, {OBJECT_TYPE, "Gx"}}), 503);
+    expect(get("/skyTile", {{STAR_CATALOG, "3"}, {SKY_TILE, "1"}}), 503);
+    expect(get("/metrics"), 503);
+    AllocTracker::failFrom(0);
+    expect(get("/catalogCache"), 200);
+    expect(get("/catalogCache", {{"reset", "1"}}), 200);
+    request = get("/catalogInfo");
+    expectJson(request, expect(request, 200), "catalogues");
+
+    // The search index goes out in the background, whole or in ranges
+    request = get("/catalogIndex");
+    call(request, response, true);
+    std::string index;
+    drainPeer(response.peer, search_index.size(), &index);
+    close(response.peer);
+    if (response.code != 200 || index != search_index)
+        reportMismatch(request, "search index differs from " SEARCH_INDEX_FILE);
+    request.headers = {{"Range", "bytes=100-199"}};
+    call(request, response, true);
+    index.clear();
+    drainPeer(response.peer, 100, &index);
+    close(response.peer);
+    if (response.code != 206 || index != search_index.substr(100, 100))
+        reportMismatch(request, "range differs from " SEARCH_INDEX_FILE);
+    request.headers = {{"Range", "bytes=99999999-"}};
+    expect(request, 416);
+
+    // Clients that stop reading hold every transfer, a large response is refused at once
+    // instead of waiting for them and the rest of the API answers as usual
+    std::vector<int> stalled;
+    server.setSendBuffer(STALLED_SEND_BUFFER);
+    for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; i++)
+    {
+        call(get("/catalogIndex"), response, true);
+        stalled.push_back(response.peer);
+    }
+    server.setSendBuffer(0);
+    ApiHandler::getInstance().loop();
+    for (const char* uri : {"/", "/ota", "/catalogIndex", "/metrics"})
+    {
+        request = get(uri);
+        response = expect(request, 503);
+        if (findField(response.headers, "Retry-After") == nullptr)
+            reportMismatch(request, "busy without Retry-After");
+    }
+    expect(get("/catalogBrowse", {{STAR_CATALOG, "3"}}), 503);
+    expect(get("/state"), 200);
+    for (int peer : stalled)
+        close(peer);
+    ApiHandler::getInstance().loop();
+    expect(get("/catalogBrowse", {{STAR_CATALOG, "3"}}), 200);
+
+    // OTA, the host has no internet connection and writes no flash
+    request = get("/checkversion");
+    expectJson(request, expect(request, 200), "currentVersion");
+    expect(get("/downloadupdate"), 400);
+    expect(get("/downloadupdate", {{"url", "http://localhost/firmware.bin"}}), 200);
+    request = get("/otastatus");
+    expectBody(request, expect(request, 200), "\"error\":true");
+    request = post("/update", "");
+    request.upload.assign(3 * HTTP_UPLOAD_BUFLEN + 100, '\x5a');
+    size_t before = shutdowns;
+    expectBody(request, expect(request, 200), "Success");
+    if (shutdowns != before + 1)
+        reportMismatch(request, "no restart after the update");
+    request = get("/otastatus");
+    expectBody(request, expect(request, 200), "\"complete\":true");
+}
+
+static bool installBundle(const std::string& bundle);
+
+// The catalogue bundle uploaded through the API is stored and the device restarts. A
+// broken upload restarts it as well, the catalogues were suspended when it started.
+// Without a catalogue partition (a partition table from before it, kept by OTA
+// updates) the upload is refused and the device keeps running.
+static void runUploadCheck(const std::string& bundle)
+{
+    HostRequest request = post("/catalogUpload", "");
+    request.upload = bundle;
+    size_t before = shutdowns;
+    catalogueFlashHostReset(0);
+    CataloguePartition::getInstance().begin();
+    expectBody(request, expect(request, 409), "No catalogue partition");
+    request = get("/catalogInfo");
+    expectBody(request, expect(request, 200), "\"partition\":false");
+    if (shutdowns != before || !installBundle(bundle))
+        reportMismatch(request, "restart without a catalogue partition");
+
+    request = post("/catalogUpload", "");
+    request.upload = bundle.substr(0, bundle.size() / 2);
+    expect(request, 400);
+    if (shutdowns != before + 1)
+        reportMismatch(request, "no restart after a broken upload");
+
+    request.upload = bundle;
+    expect(request, 200);
+    if (shutdowns != before + 2 || !CataloguePartition::getInstance().begin())
+        reportMismatch(request, "bundle not installed");
+}
+
+// Seeded so two runs replay the same requests, the parameters of Numerical Recipes
+class Random
+{
+  public:
+    explicit Random(uint32_t seed) : _state(seed)
+    {
+    }
+
+    uint32_t next(uint32_t range)
+    {
+        _state = _state * 1664525u + 1013904223u;
+        return (_state >> 8) % range;
+    }
+
+  private:
+    uint32_t _state;
+};
+
+enum TrafficKind
+{
+    TRAFFIC_STATUS,
+    TRAFFIC_STATE,
+    TRAFFIC_POSITION,
+    TRAFFIC_SEARCH,
+    TRAFFIC_BATCH,
+    TRAFFIC_VISIBLE,
+    TRAFFIC_BROWSE,
+    TRAFFIC_FILTER,
+    TRAFFIC_TILE,
+    TRAFFIC_SLEW,
+    TRAFFIC_TRACKING,
+    TRAFFIC_GOTO,
+    TRAFFIC_CAPTURE,
+    TRAFFIC_COMMANDS,
+    TRAFFIC_EVENTS,
+    TRAFFIC_PAGE,
+    TRAFFIC_INDEX,
+    TRAFFIC_METRICS,
+    TRAFFIC_KIND_COUNT
+};
+
+// Share of the requests per kind, mostly the polling of open pages
+static const uint32_t trafficWeights[TRAFFIC_KIND_COUNT] = {
+    300, // /status, browsers without EventSource poll it twice a second
+    60,  // /state
+    150, // /getCurrentPosition, once a second while a position is entered
+    120, // /starSearch while typing
+    15,  // /starBatch
+    30,  // /visibleObjects
+    30,  // /catalogBrowse
+    20,  // /catalogFilter
+    60,  // /skyTile, half of them revalidated
+    80,  // /startslew and /stopslew
+    10,  // /on and /off
+    10,  // /gotoRA and /abort-goto-ra
+    10,  // /setCurrent and /abort
+    10,  // /commands
+    10,  // /events
+    5,   // /, revalidated after the first load
+    5,   // /catalogIndex
+    5,   // /metrics
+};
+
+static const char* const searchNames[] = {
+    "M31",    "M42",     "M 1",        "NGC 224", "NGC 7000", "C 14",  "Vega",
+    "Sirius", "alf Ori", "Andromeda",  "HR 424",  "Orion",    "And",   "Cyg",
+    "M",      "NGC 70",  "Betelgeuse", "Deneb",   "M 45",     "Nope 1"};
+
+static const char* const batchBodies[] = {
+    "{\"names\":[\"M31\",\"M42\",\"M45\",\"M13\",\"M57\",\"M27\"]}",
+    "{\"names\":[\"Vega\",\"Deneb\",\"Altair\",\"Polaris\"],\"starCatalog\":3}",
+    "{\"names\":[\"NGC 224\",{\"name\":\"C 14\",\"starCatalog\":6},\"Nope 1\"]}"};
+
+struct LoadState
+{
+    bool slewing;
+    bool tracking;
+    bool going;
+    bool capturing;
+    std::string page_etag;
+    std::map<std::string, std::string> tile_etags;
+    std::vector<int> event_peers;
+};
+
+// Drop what the event streams received, the browser would parse it
+static void readEventStreams(LoadState& state)
+{
+    for (int peer : state.event_peers)
+        drainPeer(peer, 0);
+}
+
+static bool acceptable(const HostResponse& response)
+{
+    switch (response.code)
+    {
+        case 200:
+        case 204: // /status without a message
+        case 206:
+        case 304:
+        case 404: // Searches for names that do not exist
+        case 409: // A command list refused while a capture runs
+            return true;
+        default:
+            return false;
+    }
+}
+
+static HostRequest nextRequest(Random& random, LoadState& state, TrafficKind kind)
+{
+    char text[32];
+    switch (kind)
+    {
+        case TRAFFIC_STATUS:
+            return get("/status");
+        case TRAFFIC_STATE:
+            return get("/state");
+        case TRAFFIC_POSITION:
+            return get("/getCurrentPosition",
+                       {{UTC_TIME, UTC_NOW}, {"timezone", "-120"}, {"longitude", "11.58"}});
+        case TRAFFIC_SEARCH:
+            snprintf(text, sizeof(text), "%u", random.next(DB_HIPPARCOS));
+            return get("/starSearch",
+                       {{STAR_CATALOG, text},
+                        {STAR_NAME, searchNames[random.next(sizeof(searchNames) /
+                                                            sizeof(searchNames[0]))]},
+                        {UTC_TIME, UTC_NOW}});
+        case TRAFFIC_BATCH:
+            return post("/starBatch",
+                        batchBodies[random.next(sizeof(batchBodies) / sizeof(batchBodies[0]))]);
+        case TRAFFIC_VISIBLE:
+            return get("/visibleObjects", {{LATITUDE, "48.14"},
+                                           {LONGITUDE, "11.58"},
+                                           {UTC_TIME, UTC_NOW},
+                                           {STAR_CATALOG, random.next(2) ? "1" : "3"},
+                                           {MIN_ALTITUDE, "15"},
+                                           {RESULT_LIMIT, "20"}});
+        case TRAFFIC_BROWSE:
+            snprintf(text, sizeof(text), "%u", random.next(10) * 50);
+            return get("/catalogBrowse", {{STAR_CATALOG, random.next(2) ? "1" : "3"},
+                                          {SORT_ORDER, random.next(2) ? "magnitude" : "ra"},
+                                          {RESULT_OFFSET, text}});
+        case TRAFFIC_FILTER:
+            return get("/catalogFilter",
+                       {{STAR_CATALOG, "1"},
+                        {OBJECT_TYPE, random.next(2) ? "Gx" : "OC"},
+                        {MAX_MAGNITUDE, "10"},
+                        {RESULT_LIMIT, "20"}});
+        case TRAFFIC_TILE:
+        {
+            snprintf(text, sizeof(text), "%u", random.next(SKY_TILE_COUNT));
+            HostRequest request = get("/skyTile", {{STAR_CATALOG, "3"}, {SKY_TILE, text}});
+            auto etag = state.tile_etags.find(text);
+            if (etag != state.tile_etags.end() && random.next(2))
+                request.headers = {{"If-None-Match", etag->second}};
+            return request;
+        }
+        case TRAFFIC_SLEW:
+            state.slewing = !state.slewing;
+            if (!state.slewing)
+                return get("/stopslew");
+            snprintf(text, sizeof(text), "%u", 2 + random.next(MAX_CUSTOM_SLEW_RATE - 2));
+            return get("/startslew", {{SPEED, text}, {DIRECTION, random.next(2) ? "1" : "0"}});
+        case TRAFFIC_TRACKING:
+            state.tracking = !state.tracking;
+            return state.tracking ? get("/on", {{TRACKING_SPEED, "0"}, {DIRECTION, "1"}})
+                                  : get("/off");
+        case TRAFFIC_GOTO:
+            state.going = !state.going;
+            return state.going ? get("/gotoRA", {{"currentRA", "3600"},
+                                                 {"targetRA", random.next(2) ? "5400" : "1800"},
+                                                 {SPEED, "100"}})
+                               : get("/abort-goto-ra");
+        case TRAFFIC_CAPTURE:
+            state.capturing = !state.capturing;
+            return state.capturing ? get("/setCurrent", captureArgs("start", "0"))
+                                   : get("/abort");
+        case TRAFFIC_COMMANDS:
+            return post("/commands",
+                        "{\"commands\":[{\"command\":\"setPosition\",\"currentRA\":3600},"
+                        "{\"command\":\"loadTrackingRatePreset\",\"preset\":1},"
+                        "{\"command\":\"on\",\"direction\":1}]}");
+        case TRAFFIC_EVENTS:
+            return get("/events", {{UTC_TIME, UTC_NOW}});
+        case TRAFFIC_PAGE:
+        {
+            HostRequest request = get("/");
+            if (!state.page_etag.empty())
+                request.headers = {{"If-None-Match", state.page_etag}};
+            return request;
+        }
+        case TRAFFIC_INDEX:
+            return get("/catalogIndex");
+        case TRAFFIC_METRICS:
+        default:
+            return get("/metrics");
+    }
+}
+
+// A touch on a slew button while the axis already slews, or an abort after the goto has
+// ended, is ignored by the handler without an answer
+static bool ignoredTouch(const HostRequest& request, const HostResponse& response)
+{
+    return response.code == 0 && (request.uri == "/startslew" || request.uri == "/abort-goto-ra");
+}
+
+static void runLoad(size_t count, uint32_t seed, size_t& rejected, size_t& unanswered)
+{
+    Random random(seed);
+    LoadState state = {false, false, false, false, "", {}, {}};
+    uint32_t total_weight = 0;
+    for (uint32_t weight : trafficWeights)
+        total_weight += weight;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t pick = random.next(total_weight);
+        size_t kind = 0;
+        while (pick >= trafficWeights[kind])
+            pick -= trafficWeights[kind++];
+
+        // A page going away closes its stream, the handler finds the slot free again
+        if (kind == TRAFFIC_EVENTS && state.event_peers.size() == OPEN_EVENT_STREAMS)
+        {
+            close(state.event_peers.front());
+            state.event_peers.erase(state.event_peers.begin());
+        }
+
+        HostRequest request = nextRequest(random, state, (TrafficKind) kind);
+        HostResponse response;
+        call(request, response, kind == TRAFFIC_EVENTS);
+
+        if (kind == TRAFFIC_EVENTS && response.peer >= 0)
+        {
+            if (response.code == 0)
+                state.event_peers.push_back(response.peer);
+            else
+                close(response.peer);
+        }
+        else if (ignoredTouch(request, response))
+        {
+            unanswered++;
+        }
+        else if (!acceptable(response))
+        {
+            rejected++;
+            if (verbose)
+                fprintf(stderr, "%s %s: status %d (%s)\n", methodName(request.method),
+                        request.uri.c_str(), response.code, response.body.substr(0, 80).c_str());
+        }
+
+        const char* etag = findField(response.headers, "ETag");
+        if (etag != nullptr && kind == TRAFFIC_PAGE)
+            state.page_etag = etag;
+        if (etag != nullptr && kind == TRAFFIC_TILE)
+            state.tile_etags[request.args[1].second] = etag;
+
+        // What the tracker does between requests
+        hostTimersRun();
+        ApiHandler::getInstance().loop();
+        readEventStreams(state);
+    }
+
+    for (int peer : state.event_peers)
+        close(peer);
+}
+
+// Requests the slow clients repeat, the large responses of the web interface
+static HostRequest slowDownload(size_t n)
+{
+    static std::string batch;
+    if (batch.empty())
+    {
+        batch = "{\"names\":[";
+        for (size_t i = 1; i <= SLOW_CLIENT_BATCH_NAMES; i++)
+            batch += (i > 1 ? ",\"M" : "\"M") + std::to_string(i) + "\"";
+        batch += "]}";
+    }
+
+    switch (n % 8)
+    {
+        case 0:
+            return get("/");
+        case 1:
+            return get("/catalogIndex");
+        case 2:
+            return get("/catalogBrowse", {{STAR_CATALOG, "1"}, {RESULT_LIMIT, "1000"}});
+        case 3:
+            return get("/catalogFilter", {{STAR_CATALOG, "1"}, {RESULT_LIMIT, "1000"}});
+        case 4:
+            return get("/skyTile", {{STAR_CATALOG, "1"}, {SKY_TILE, "150"}});
+        case 5:
+            return post("/starBatch", batch);
+        case 6:
+            return get("/ota");
+        default:
+            return get("/metrics");
+    }
+}
+
+struct SlowClient
+{
+    int peer;
+    bool generated; // The response is written by a background transfer, chunked
+    size_t expected;
+    std::string raw;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point retry;
+    bool waiting; // A request is queued
+    size_t downloads;
+};
+
+struct SlowClientResult
+{
+    size_t clients;
+    std::vector<double> latencies_us;
+    std::vector<double> loop_us; // ApiHandler::loop() passes that sent something
+    size_t downloads;
+    size_t busy;
+    size_t bytes;
+};
+
+/**
+ * @brief Time control requests while clients on slow links download large responses
+ *
+ * Replays the web server task: one request per WebServer::handleClient(),
+ * then ApiHandler::loop(). Each slow client reads SLOW_CLIENT_RATE bytes a
+ * second from a connection with the send buffer of lwIP and requests the
+ * next response once one is complete, a 503 is retried after Retry-After.
+ * A control request (/stopslew) arrives every CONTROL_INTERVAL_MS, its
+ * latency runs from its arrival to the end of its handler and includes the
+ * pass of loop() it arrived in.
+ */
+static SlowClientResult runSlowClients(size_t clients)
+{
+    typedef std::chrono::steady_clock Clock;
+    SlowClientResult result = {clients, {}, {}, 0, 0, 0};
+    std::vector<SlowClient> slow(clients);
+    // Queued requests in arrival order, SIZE_MAX for a control request
+    std::deque<std::pair<size_t, Clock::time_point>> queued;
+
+    server.setSendBuffer(SLOW_CLIENT_SEND_BUFFER);
+    Clock::time_point start = Clock::now();
+    Clock::time_point next_control = start;
+    for (size_t i = 0; i < clients; i++)
+        slow[i] = {-1, false, 0, "", start, start, false, i};
+
+    for (;;)
+    {
+        Clock::time_point now = Clock::now();
+        if (now - start >= std::chrono::milliseconds(SLOW_CLIENT_RUN_MS))
+            break;
+
+        // Clients
+        // A control request arriving during the last pass waited from its arrival on
+        while (now >= next_control)
+        {
+            queued.push_back({SIZE_MAX, next_control});
+            next_control += std::chrono::milliseconds(CONTROL_INTERVAL_MS);
+        }
+        for (size_t i = 0; i < clients; i++)
+        {
+            SlowClient& client = slow[i];
+            if (client.peer < 0 && !client.waiting && now >= client.retry)
+            {
+                client.waiting = true;
+                queued.push_back({i, now});
+            }
+        }
+
+        // WebServer::handleClient()
+        if (!queued.empty())
+        {
+            std::pair<size_t, Clock::time_point> next = queued.front();
+            queued.pop_front();
+            HostResponse response;
+            if (next.first == SIZE_MAX)
+            {
+                server.request(get("/stopslew"), response);
+                result.latencies_us.push_back(
+                    std::chrono::duration<double, std::micro>(Clock::now() - next.second)
+                        .count());
+                close(response.peer);
+            }
+            else
+            {
+                SlowClient& client = slow[next.first];
+                HostRequest request = slowDownload(client.downloads);
+                server.request(request, response);
+                client.waiting = false;
+                if (response.code == 503)
+                {
+                    result.busy++;
+                    client.retry = Clock::now() + std::chrono::seconds(1);
+                    close(response.peer);
+                }
+                else if (response.code != 0 && response.code != 200)
+                {
+                    reportMismatch(request, "status " + std::to_string(response.code));
+                    close(response.peer);
+                }
+                else
+                {
+                    client.peer = response.peer;
+                    client.generated = response.code == 0;
+                    client.expected = response.content_length;
+                    client.raw.clear();
+                    client.started = Clock::now();
+                }
+            }
+        }
+
+        Clock::time_point loop_start = Clock::now();
+        ApiHandler::getInstance().loop();
+        double loop_us =
+            std::chrono::duration<double, std::micro>(Clock::now() - loop_start).count();
+        if (loop_us >= 1.0)
+            result.loop_us.push_back(loop_us);
+
+        // Each client reads what its link carried since its response started
+        now = Clock::now();
+        for (size_t i = 0; i < clients; i++)
+        {
+            SlowClient& client = slow[i];
+            if (client.peer < 0)
+                continue;
+            double seconds = std::chrono::duration<double>(now - client.started).count();
+            size_t allowed = (size_t) (seconds * SLOW_CLIENT_RATE);
+            if (allowed <= client.raw.size())
+                continue;
+            char buffer[4096];
+            ssize_t len = recv(client.peer, buffer,
+                               std::min(sizeof(buffer), allowed - client.raw.size()), MSG_DONTWAIT);
+            if (len > 0)
+            {
+                client.raw.append(buffer, len);
+                result.bytes += len;
+                continue;
+            }
+            if (len < 0)
+                continue;
+
+            // Complete, or cut short
+            HostRequest request = slowDownload(client.downloads);
+            HostResponse response;
+            if (client.generated ? !parseResponse(client.raw, response)
+                                 : client.raw.size() != client.expected)
+                reportMismatch(request, "slow download cut short");
+            close(client.peer);
+            client.peer = -1;
+            client.downloads++;
+            result.downloads++;
+        }
+    }
+
+    // Downloads still running are given up
+    for (SlowClient& client : slow)
+    {
+        if (client.peer >= 0)
+            close(client.peer);
+    }
+    ApiHandler::getInstance().loop();
+    server.setSendBuffer(0);
+    return result;
+}
+
+static void printSlowClients(const std::vector<SlowClientResult>& results)
+{
+    printf("\nSlow clients: /stopslew every %d ms while each client downloads at %d KB/s\n",
+           CONTROL_INTERVAL_MS, SLOW_CLIENT_RATE / 1024);
+    printf("%-8s %8s %9s %9s %9s %9s %10s %10s %9s %6s %8s\n", "Clients", "Control", "mean[us]",
+           "p50[us]", "p99[us]", "max[us]", "loop p99", "loop max", "Downloads", "Busy", "KB/s");
+    for (const SlowClientResult& result : results)
+    {
+        double total = 0.0;
+        for (double value : result.latencies_us)
+            total += value;
+        size_t count = result.latencies_us.size();
+        printf("%-8zu %8zu %9.2f %9.2f %9.2f %9.2f %10.2f %10.2f %9zu %6zu %8.1f\n",
+               result.clients, count, count ? total / count : 0.0,
+               percentile(result.latencies_us, 0.5), percentile(result.latencies_us, 0.99),
+               percentile(result.latencies_us, 1.0), percentile(result.loop_us, 0.99),
+               percentile(result.loop_us, 1.0), result.downloads, result.busy,
+               result.bytes / 1024.0 / (SLOW_CLIENT_RUN_MS / 1000.0));
+    }
+}
+
+static void printResults()
+{
+    std::vector<const RouteStats*> results;
+    for (const auto& entry : route_stats)
+    {
+        if (!entry.second.latencies_us.empty())
+            results.push_back(&entry.second);
+    }
+    std::sort(results.begin(), results.end(), [](const RouteStats* a, const RouteStats* b) {
+        return a->latencies_us.size() > b->latencies_us.size();
+    });
+
+    printf("\n%-28s %6s %9s %9s %9s %9s %9s %9s %9s %9s %8s\n", "Route", "Count", "mean[us]",
+           "p50[us]", "p99[us]", "max[us]", "allocs/r", "bytes/r", "Str/r", "Sheap/r",
+           "peak[B]");
+    for (const RouteStats* route : results)
+    {
+        size_t count = route->latencies_us.size();
+        double total = 0.0;
+        for (double value : route->latencies_us)
+            total += value;
+        double per_request = count ? 1.0 / count : 0.0;
+
+        printf("%-28s %6zu %9.2f %9.2f %9.2f %9.2f %9.2f %9.1f %9.2f %9.2f %8zu\n",
+               route->route.c_str(), count, total * per_request,
+               percentile(route->latencies_us, 0.5), percentile(route->latencies_us, 0.99),
+               percentile(route->latencies_us, 1.0), route->allocations * per_request,
+               route->bytes_allocated * per_request, route->string_constructions * per_request,
+               route->string_allocations * per_request, route->peak_bytes);
+    }
+}
+
+// Load the catalogues from the partition like registerStarDatabases() in firmware.ino
+static void registerCatalogue(StarDatabaseType type, StarDatabaseType compact_type,
+                              const char* tag)
+{
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    const uint8_t* start;
+    const uint8_t* end;
+    if (!CataloguePartition::getInstance().findCatalogue(tag, start, end) ||
+        !registry.registerDatabase(type, start, end))
+    {
+        fprintf(stderr, "Failed to load %s from the partition\n", tag);
+        mismatches++;
+        return;
+    }
+    if (compact_type != DB_NONE)
+        registry.registerDatabase(compact_type, start, end);
+}
+
+static bool installBundle(const std::string& bundle)
+{
+    CataloguePartition& partition = CataloguePartition::getInstance();
+    catalogueFlashHostReset(PARTITION_CAPACITY);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(bundle.data());
+    if (!partition.beginUpdate(0))
+        return false;
+    for (size_t pos = 0; pos < bundle.size(); pos += HTTP_UPLOAD_BUFLEN)
+    {
+        if (!partition.writeUpdate(data + pos,
+                                   std::min<size_t>(HTTP_UPLOAD_BUFLEN, bundle.size() - pos)))
+            return false;
+    }
+    return partition.endUpdate() && partition.begin();
+}
+
+int main(int argc, char** argv)
+{
+    std::string directory = "../../catalogues";
+    size_t requests = DEFAULT_REQUESTS;
+    uint32_t seed = DEFAULT_SEED;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-v") == 0)
+            verbose = true;
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            requests = strtoul(argv[++i], nullptr, 0);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            seed = strtoul(argv[++i], nullptr, 0);
+        else
+            directory = argv[i];
+    }
+    directory += "/";
+
+    std::string bundle;
+    std::string search_index;
+    if (!readFile(directory + BUNDLE_FILE, bundle) ||
+        !readFile(directory + SEARCH_INDEX_FILE, search_index))
+    {
+        fprintf(stderr, "Cannot read %s or %s in %s\n", BUNDLE_FILE, SEARCH_INDEX_FILE,
+                directory.c_str());
+        return 2;
+    }
+
+    print_out_enabled = verbose;
+    // A write to a closed mock connection fails like on lwIP instead of ending the process
+    signal(SIGPIPE, SIG_IGN);
+
+    // setup() and the start of loop() in firmware.ino, without WiFi and tasks
+    if (!installBundle(bundle))
+    {
+        fprintf(stderr, "Bundle upload failed\n");
+        return 1;
+    }
+    registerCatalogue(DB_NGC2000, DB_NGC2000_COMPACT, "NGC2");
+    registerCatalogue(DB_BSC5, DB_BSC5_COMPACT, "BSC5");
+    registerCatalogue(DB_MESSIER, DB_NONE, "MESS");
+    registerCatalogue(DB_CALDWELL, DB_NONE, "CALD");
+    // The committed bundle has no Hipparcos catalogue, the firmware goes without it as well
+
+    EepromManager::begin(512);
+    intervalometer = new Intervalometer(INTERV_PIN);
+    intervalometer->readPresetsFromEEPROM();
+    OTAHandler::getInstance().init(&server);
+    ApiHandler::getInstance().init(&server);
+    ApiHandler::getInstance().registerEndpoints();
+    trackingRates.readTrackingRatePresetsFromEEPROM();
+    ra_axis.startTracking(ra_axis.rate.tracking, ra_axis.direction.tracking);
+
+    runCoverage(search_index);
+    runStalledSubscriber();
+    printf("Coverage: %zu routes, %zu reached, %zu mismatches\n", server.getRouteCount(),
+           reached_routes.size(), mismatches);
+    printResults();
+
+    route_stats.clear();
+    size_t rejected = 0;
+    size_t unanswered = 0;
+    // The latencies would otherwise show up as heap growth of the firmware
+    for (size_t i = 0; i < server.getRouteCount(); i++)
+    {
+        std::string route =
+            std::string(methodName(server.getRouteMethod(i))) + " " + server.getRouteUri(i);
+        route_stats[route].latencies_us.reserve(requests);
+    }
+    AllocStats heap_before = AllocTracker::snapshot();
+    auto load_start = std::chrono::steady_clock::now();
+    runLoad(requests, seed, rejected, unanswered);
+    auto load_end = std::chrono::steady_clock::now();
+    AllocStats heap_after = AllocTracker::snapshot();
+
+    double handler_us = 0.0;
+    for (const auto& entry : route_stats)
+    {
+        for (double value : entry.second.latencies_us)
+            handler_us += value;
+    }
+    double wall_s = std::chrono::duration<double>(load_end - load_start).count();
+    printf("\nLoad: %zu requests (seed %u) in %.2f s, %.0f requests/s in the handlers, "
+           "%zu unanswered, %zu rejected, heap %+lld bytes\n",
+           requests, (unsigned) seed, wall_s, handler_us > 0 ? requests / (handler_us / 1e6) : 0,
+           unanswered, rejected,
+           (long long) heap_after.current_bytes - (long long) heap_before.current_bytes);
+    printResults();
+    mismatches += rejected;
+
+    std::vector<SlowClientResult> slow_results;
+    for (size_t clients : SLOW_CLIENT_COUNTS)
+    {
+        slow_results.push_back(runSlowClients(clients));
+        if (percentile(slow_results.back().latencies_us, 0.99) > CONTROL_MAX_P99_US)
+        {
+            fprintf(stderr, "Control requests waited for %zu slow clients\n", clients);
+            mismatches++;
+        }
+    }
+    printSlowClients(slow_results);
+
+    // Suspends the catalogues, nothing may query them afterwards
+    runUploadCheck(bundle);
+
+    for (size_t i = 0; i < server.getRouteCount(); i++)
+    {
+        std::string route =
+            std::string(methodName(server.getRouteMethod(i))) + " " + server.getRouteUri(i);
+        if (reached_routes.count(route) == 0)
+        {
+            fprintf(stderr, "%s was never called\n", route.c_str());
+            mismatches++;
+        }
+    }
+
+    printf("\n%s: %zu mismatches\n", mismatches == 0 ? "PASSED" : "FAILED", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
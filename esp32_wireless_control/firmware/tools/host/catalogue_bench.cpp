@@ -0,0 +1,1770 @@
+/**
+ * @file catalogue_bench.cpp
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ *
+ * Host-side correctness and performance harness for the star catalogues.
+ *
+ * Uploads the catalogue bundle into an emulated catalogue partition, loads
+ * the catalogues from it through StarDatabaseRegistry and checks every
+ * lookup by index, name and name fragment against the JSON twins written by
+ * the same converters. For every query type it reports
+ * latency, heap allocations per query and the peak heap use.
+ *
+ * The coordinate pipeline is timed against the double precision path it
+ * replaced and its error checked against a double precision reference.
+ *
+ * With -s the Hipparcos backend is loaded from a large (synthetic) blob and
+ * checked for lookups and position/magnitude filters at 100k+ objects.
+ *
+ * Usage: catalogue_bench [-v] [-b cache budget bytes] [-s scale blob] [catalogues directory]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <strings.h>
+#include <vector>
+
+#include "alloc_tracker.h"
+#include "catalogues/apparent_place.h"
+#include "catalogues/catalogue_attribute_query.h"
+#include "catalogues/catalogue_browser.h"
+#include "catalogue_flash_host.h"
+#include "catalogues/catalogue_page_cache.h"
+#include "catalogues/catalogue_partition.h"
+#include "catalogues/catalogue_query_cache.h"
+#include "catalogues/sky_tiles.h"
+#include "catalogues/sky_visibility.h"
+#include "catalogues/star_database_registry.h"
+#include "json_reader.h"
+#include "uart.h"
+
+#define POSITION_TOLERANCE_ARCSEC 0.5
+#define MAGNITUDE_TOLERANCE 0.006
+#define SIZE_TOLERANCE_ARCMIN 0.051
+#define MISS_QUERIES 200
+// Smallest allocation that fails in the low heap phase, below the size of any page
+#define LOW_HEAP_FAIL_FROM 256
+// Names per batch lookup, the limit of POST /starBatch
+#define BATCH_SIZE 64
+// Repeated searches of a few names through the query cache
+#define REPEAT_NAMES 8
+#define REPEAT_ROUNDS 50
+#define MAX_REPORTED_MISMATCHES 20
+
+// Scale checks: every n-th object is looked up by name, fragment scans read all names
+#define SCALE_NAME_STRIDE 97
+#define SCALE_FRAGMENT_QUERIES 20
+#define SCALE_FILTER_QUERIES 200
+
+// Meeus, Astronomical Algorithms, examples 21.b and 23.a: theta Persei on
+// 2028 Nov 13.19 TD, J2000 position with proper motion applied, apparent
+// place without aberration
+#define REFERENCE_EPOCH 1857702816
+#define REFERENCE_RA_J2000 (41.054063 / 15.0)
+#define REFERENCE_DEC_J2000 49.227750
+#define REFERENCE_RA_APPARENT ((41.547214 + 15.843 / 3600.0) / 15.0)
+#define REFERENCE_DEC_APPARENT (49.348483 + 6.218 / 3600.0)
+// A leap day past the 32 bit time_t range
+#define REFERENCE_UTC_2040 "2040-02-29T12:00:00"
+#define REFERENCE_UTC_2040_SECONDS 2214129600LL
+#define APPARENT_TOLERANCE_ARCSEC 1.0
+
+// Conversion throughput, every position of the full catalogues per round
+#define COORDINATE_ROUNDS 20
+#define COORDINATE_TOLERANCE_ARCSEC 0.1
+
+// "What's up now" listings, checked against a double precision scan
+#define VISIBILITY_TOLERANCE_DEG 0.01
+#define VISIBILITY_ROUNDS 5
+
+// Catalogue browsing, pages chained with "after" and one page at an offset
+#define BROWSE_PAGE_SIZE 50
+#define BROWSE_OFFSET 100
+
+// Sky tiles, every tile without and with a magnitude limit (hundredths)
+#define TILE_MAGNITUDE_LIMIT 500
+
+// Attribute queries are paged through in pages of this size
+#define ATTRIBUTE_PAGE_SIZE 20
+
+// Size of the catalogue partition in partitions_ota_catalogue_4MB.csv
+#define PARTITION_CAPACITY 0x60000
+// HTTP_UPLOAD_BUFLEN of the arduino-esp32 WebServer
+#define UPLOAD_CHUNK_SIZE 1436
+#define BUNDLE_FILE "catalogue_bundle.bin"
+
+struct CatalogueCase
+{
+    StarDatabaseType type;
+    const char* label;
+    const char* tag;
+    const char* blob;
+    const char* json;
+};
+
+static const CatalogueCase catalogue_cases[] = {
+    {DB_NGC2000, "NGC2000", "NGC2", "ngc/converted/ngc2000.bin", "ngc/converted/ngc2000.json"},
+    {DB_NGC2000_COMPACT, "NGC2000 compact", "NGC2", "ngc/converted/ngc2000.bin",
+     "ngc/converted/ngc2000_compact.json"},
+    {DB_BSC5, "BSC5", "BSC5", "bsc5/converted/bsc5ra.bin", "bsc5/converted/bsc5ra.json"},
+    {DB_BSC5_COMPACT, "BSC5 compact", "BSC5", "bsc5/converted/bsc5ra.bin",
+     "bsc5/converted/bsc5ra_compact.json"},
+    {DB_MESSIER, "Messier", "MESS", "messier/converted/messier.bin",
+     "messier/converted/messier.json"},
+    {DB_CALDWELL, "Caldwell", "CALD", "caldwell/converted/caldwell.bin",
+     "caldwell/converted/caldwell.json"},
+};
+
+// What the firmware should return for a JSON twin entry
+struct ExpectedEntry
+{
+    std::string name;
+    std::string type;
+    double ra_hours;
+    double dec_deg;
+    double magnitude;
+    std::string constellation;
+    double size_arcmin;
+    std::string spectral_type;
+    std::string description;
+};
+
+struct PhaseStats
+{
+    const char* catalogue;
+    const char* query;
+    size_t hits;
+    size_t misses;
+    size_t mismatches;
+    uint64_t allocations;
+    uint64_t bytes_allocated;
+    size_t peak_bytes; // Largest heap growth during a single query
+    std::vector<double> latencies_us;
+};
+
+static bool verbose = false;
+static size_t reported_mismatches = 0;
+
+static bool readFile(const std::string& path, std::string& out)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static std::string toLower(const std::string& text)
+{
+    std::string lower(text);
+    for (char& c : lower)
+        c = tolower((unsigned char) c);
+    return lower;
+}
+
+static ExpectedEntry expectedFromJson(StarDatabaseType type, const JsonValue& obj)
+{
+    ExpectedEntry e = {};
+    switch (type)
+    {
+        // The object lists use the NGC2000 JSON layout
+        case DB_MESSIER:
+        case DB_CALDWELL:
+        case DB_NGC2000:
+            e.constellation = obj.getString("constellation");
+            e.size_arcmin = obj.getNumber("size_arcmin");
+            e.description = obj.getString("description");
+            // fall through
+        case DB_NGC2000_COMPACT:
+            e.name = obj.getString("id");
+            e.type = obj.getString("type");
+            e.ra_hours = obj.getNumber("ra");
+            e.dec_deg = obj.getNumber("dec");
+            e.magnitude = obj.getNumber("magnitude");
+            break;
+        case DB_BSC5:
+            e.spectral_type = obj.getString("spectral_type");
+            // fall through
+        case DB_BSC5_COMPACT:
+            e.name = obj.getString("name");
+            e.type = "Star";
+            e.ra_hours = obj.getNumber("sra0") * 12.0 / M_PI;
+            e.dec_deg = obj.getNumber("sdec0") * 180.0 / M_PI;
+            e.magnitude = obj.getNumber("mag");
+            break;
+        default:
+            break;
+    }
+    return e;
+}
+
+static double hoursOf(int32_t ra)
+{
+    return ra * (24.0 / SKY_ANGLE_TURN);
+}
+
+static double degreesOf(int32_t dec)
+{
+    return dec * (360.0 / SKY_ANGLE_TURN);
+}
+
+static bool compareEntry(const ExpectedEntry& e, const StarUnifiedEntry& r, std::string& why)
+{
+    double dra = fabs(hoursOf(r.ra) - e.ra_hours);
+    dra = fmin(dra, 24.0 - dra) * 15.0 * 3600.0;
+    double ddec = fabs(degreesOf(r.dec) - e.dec_deg) * 3600.0;
+
+    if (e.name != r.name.c_str())
+        why = "name '" + std::string(r.name.c_str()) + "'";
+    else if (e.type != r.type_str.c_str())
+        why = "type '" + std::string(r.type_str.c_str()) + "'";
+    else if (dra > POSITION_TOLERANCE_ARCSEC || ddec > POSITION_TOLERANCE_ARCSEC)
+        why = "position off by " + std::to_string(dra) + "/" + std::to_string(ddec) + " arcsec";
+    else if (fabs(r.magnitude - e.magnitude) > MAGNITUDE_TOLERANCE)
+        why = "magnitude " + std::to_string(r.magnitude);
+    else if (e.constellation != r.constellation.c_str())
+        why = "constellation '" + std::string(r.constellation.c_str()) + "'";
+    else if (fabs(r.size_arcmin - e.size_arcmin) > SIZE_TOLERANCE_ARCMIN)
+        why = "size " + std::to_string(r.size_arcmin);
+    else if (e.spectral_type != r.spectral_type.c_str())
+        why = "spectral type '" + std::string(r.spectral_type.c_str()) + "'";
+    else if (e.description != r.description.c_str())
+        why = "description '" + std::string(r.description.c_str()) + "'";
+    else
+        return true;
+    return false;
+}
+
+static void reportMismatch(PhaseStats& phase, const std::string& query, const std::string& why)
+{
+    phase.mismatches++;
+    if (verbose || reported_mismatches < MAX_REPORTED_MISMATCHES)
+        printf("MISMATCH %s %s [%s]: %s\n", phase.catalogue, phase.query, query.c_str(),
+               why.c_str());
+    reported_mismatches++;
+}
+
+static PhaseStats beginPhase(const char* catalogue, const char* query, size_t expected_queries)
+{
+    PhaseStats phase = {};
+    phase.catalogue = catalogue;
+    phase.query = query;
+    // Reserve up front so bookkeeping does not show up in the heap numbers
+    phase.latencies_us.reserve(expected_queries);
+    return phase;
+}
+
+// Runs one query and accounts its latency and heap use to the phase
+template <typename Query> static bool measure(PhaseStats& phase, Query query)
+{
+    AllocTracker::resetPeak();
+    AllocStats before = AllocTracker::snapshot();
+    auto start = std::chrono::steady_clock::now();
+    bool hit = query();
+    auto end = std::chrono::steady_clock::now();
+    AllocStats after = AllocTracker::snapshot();
+
+    phase.latencies_us.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    phase.allocations += after.allocations - before.allocations;
+    phase.bytes_allocated += after.bytes_allocated - before.bytes_allocated;
+    phase.peak_bytes = std::max(phase.peak_bytes, after.peak_bytes - before.current_bytes);
+    if (hit)
+        phase.hits++;
+    else
+        phase.misses++;
+    return hit;
+}
+
+static size_t firstMatch(const std::vector<ExpectedEntry>& entries, const std::string& search,
+                         bool fragment)
+{
+    std::string needle = toLower(search);
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        std::string name = toLower(entries[i].name);
+        if (fragment ? name.find(needle) != std::string::npos : name == needle)
+            return i;
+    }
+    return entries.size();
+}
+
+static std::string fragmentOf(const std::string& name)
+{
+    return name.size() >= 4 ? name.substr(1, name.size() - 2) : name;
+}
+
+static void runCatalogue(const StarDatabase& db, const char* label, StarDatabaseType type,
+                         const std::vector<ExpectedEntry>& entries,
+                         std::vector<PhaseStats>& results)
+{
+    std::string why;
+
+    if (db.getTotalObjectCount() != entries.size())
+    {
+        PhaseStats phase = beginPhase(label, "count", 0);
+        reportMismatch(phase, "", "firmware has " + std::to_string(db.getTotalObjectCount()) +
+                                      " objects, JSON " + std::to_string(entries.size()));
+        results.push_back(phase);
+    }
+
+    PhaseStats by_index = beginPhase(label, "index", entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        StarUnifiedEntry result;
+        bool hit = measure(by_index, [&]() { return db.findByIndex(i, result); });
+        if (!hit)
+            reportMismatch(by_index, std::to_string(i), "not found");
+        else if (result.source_db != type)
+            reportMismatch(by_index, std::to_string(i), "wrong source catalogue");
+        else if (!compareEntry(entries[i], result, why))
+            reportMismatch(by_index, std::to_string(i), why);
+    }
+    results.push_back(by_index);
+
+    PhaseStats by_name = beginPhase(label, "name", entries.size());
+    for (const ExpectedEntry& entry : entries)
+    {
+        StarUnifiedEntry result;
+        String name(entry.name.c_str());
+        // Names are matched case-insensitively, the first match wins
+        size_t expected = firstMatch(entries, entry.name, false);
+        if (!measure(by_name, [&]() { return db.findByName(name, result); }))
+            reportMismatch(by_name, entry.name, "not found");
+        else if (!compareEntry(entries[expected], result, why))
+            reportMismatch(by_name, entry.name, why);
+    }
+    results.push_back(by_name);
+
+    PhaseStats by_fragment = beginPhase(label, "fragment", entries.size());
+    for (const ExpectedEntry& entry : entries)
+    {
+        StarUnifiedEntry result;
+        std::string fragment = fragmentOf(entry.name);
+        String search(fragment.c_str());
+        size_t expected = firstMatch(entries, fragment, true);
+        if (!measure(by_fragment, [&]() { return db.findByNameFragment(search, result); }))
+            reportMismatch(by_fragment, fragment, "not found");
+        else if (!compareEntry(entries[expected], result, why))
+            reportMismatch(by_fragment, fragment, why);
+    }
+    results.push_back(by_fragment);
+
+    PhaseStats missing = beginPhase(label, "miss", MISS_QUERIES);
+    for (int i = 0; i < MISS_QUERIES; i++)
+    {
+        StarUnifiedEntry result;
+        char name[24];
+        snprintf(name, sizeof(name), "NoSuchObject%03d", i);
+        String search(name);
+        if (measure(missing, [&]() { return db.findByName(search, result); }))
+            reportMismatch(missing, name, "unexpected hit " + std::string(result.name.c_str()));
+    }
+    results.push_back(missing);
+}
+
+// Lookups by index with no heap for a page, the page cache must decode the record directly
+static void runLowHeap(const std::vector<std::vector<ExpectedEntry>>& expected,
+                       std::vector<PhaseStats>& results)
+{
+    CataloguePageCache& cache = CataloguePageCache::getInstance();
+    size_t budget = cache.getStats().budget_bytes;
+    cache.setBudget(0);
+    cache.setBudget(budget);
+    size_t pinned = cache.getStats().pages;
+
+    size_t queries = 0;
+    for (const std::vector<ExpectedEntry>& entries : expected)
+        queries += entries.size();
+
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    PhaseStats phase = beginPhase("all", "low heap", queries);
+    std::string why;
+    AllocTracker::failFrom(LOW_HEAP_FAIL_FROM);
+    for (size_t c = 0; c < expected.size(); c++)
+    {
+        const StarDatabase* db = registry.getDatabase(catalogue_cases[c].type);
+        for (size_t i = 0; i < expected[c].size(); i++)
+        {
+            StarUnifiedEntry result;
+            if (!measure(phase, [&]() { return db->findByIndex(i, result); }))
+                reportMismatch(phase, std::to_string(i), "not found");
+            else if (!compareEntry(expected[c][i], result, why))
+                reportMismatch(phase, std::to_string(i), why);
+        }
+    }
+    AllocTracker::failFrom(0);
+
+    if (cache.getStats().pages != pinned)
+        reportMismatch(phase, "", "pages were loaded");
+    results.push_back(phase);
+}
+
+// Cases searched by DB_NONE, in registration order
+static std::vector<size_t> fullCatalogues(size_t count)
+{
+    std::vector<size_t> full;
+    for (size_t i = 0; i < count; i++)
+    {
+        StarDatabaseType type = catalogue_cases[i].type;
+        if (type != DB_NGC2000_COMPACT && type != DB_BSC5_COMPACT)
+            full.push_back(i);
+    }
+    return full;
+}
+
+// First catalogue in search order that holds the name, and the matching entry
+static bool findOwner(const std::vector<std::vector<ExpectedEntry>>& expected,
+                      const std::vector<size_t>& search, const std::string& name, size_t& owner,
+                      size_t& match)
+{
+    for (size_t candidate : search)
+    {
+        match = firstMatch(expected[candidate], name, false);
+        if (match < expected[candidate].size())
+        {
+            owner = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void runAllCatalogues(const std::vector<std::vector<ExpectedEntry>>& expected,
+                             std::vector<PhaseStats>& results)
+{
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    std::vector<size_t> full = fullCatalogues(expected.size());
+    std::string why;
+
+    size_t total = 0;
+    for (size_t list : full)
+        total += expected[list].size();
+
+    PhaseStats phase = beginPhase("All catalogues", "name", total);
+    for (size_t list : full)
+    {
+        for (const ExpectedEntry& entry : expected[list])
+        {
+            StarUnifiedEntry result;
+            String name(entry.name.c_str());
+            size_t owner = 0;
+            size_t match = 0;
+            findOwner(expected, full, entry.name, owner, match);
+
+            if (!measure(phase, [&]() { return registry.findByName(DB_NONE, name, result); }))
+                reportMismatch(phase, entry.name, "not found");
+            else if (result.source_db != catalogue_cases[owner].type)
+                reportMismatch(phase, entry.name, "wrong source catalogue");
+            else if (!compareEntry(expected[owner][match], result, why))
+                reportMismatch(phase, entry.name, why);
+        }
+    }
+    results.push_back(phase);
+}
+
+// Every name of every catalogue in batches like POST /starBatch, every third name asks for
+// its own catalogue and every batch has a name that does not exist
+static void runBatch(const std::vector<std::vector<ExpectedEntry>>& expected,
+                     std::vector<PhaseStats>& results)
+{
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    std::vector<size_t> full = fullCatalogues(expected.size());
+    std::vector<StarBatchEntry> batch;
+    std::vector<size_t> batch_lists;
+    std::string why;
+
+    std::vector<std::pair<size_t, size_t>> names;
+    for (size_t list = 0; list < expected.size(); list++)
+    {
+        for (size_t i = 0; i < expected[list].size(); i++)
+            names.emplace_back(list, i);
+    }
+
+    PhaseStats phase = beginPhase("All catalogues", "batch", names.size() / BATCH_SIZE + 1);
+    for (size_t first = 0; first < names.size(); first += BATCH_SIZE - 1)
+    {
+        batch.clear();
+        batch_lists.clear();
+        for (size_t n = first; n < names.size() && n < first + BATCH_SIZE - 1; n++)
+        {
+            size_t list = names[n].first;
+            bool own = n % 3 == 0 || std::find(full.begin(), full.end(), list) == full.end();
+            batch.push_back({expected[list][names[n].second].name.c_str(),
+                             own ? catalogue_cases[list].type : DB_NONE, DB_NONE, 0});
+            batch_lists.push_back(own ? list : expected.size());
+        }
+        batch.push_back({"NoSuchObject", DB_NONE, DB_NONE, 0});
+        batch_lists.push_back(expected.size());
+
+        std::vector<StarUnifiedEntry> found(batch.size());
+        measure(phase, [&]() {
+            registry.findBatch(batch.data(), batch.size());
+            for (size_t n = 0; n < batch.size(); n++)
+            {
+                const StarDatabase* db = registry.getDatabase(batch[n].source);
+                if (db != nullptr)
+                    db->findByIndex(batch[n].index, found[n]);
+            }
+            return true;
+        });
+
+        for (size_t n = 0; n < batch.size(); n++)
+        {
+            std::string name = batch[n].name.c_str();
+            std::vector<size_t> search = full;
+            if (batch_lists[n] < expected.size())
+                search.assign(1, batch_lists[n]);
+            size_t owner = 0;
+            size_t match = 0;
+            if (!findOwner(expected, search, name, owner, match))
+            {
+                if (batch[n].source != DB_NONE)
+                    reportMismatch(phase, name,
+                                   "unexpected hit " + std::string(found[n].name.c_str()));
+            }
+            else if (batch[n].source != catalogue_cases[owner].type)
+                reportMismatch(phase, name, "wrong source catalogue");
+            else if (!compareEntry(expected[owner][match], found[n], why))
+                reportMismatch(phase, name, why);
+        }
+    }
+    results.push_back(phase);
+}
+
+// A few names searched over and over like the web UI does, half of them in their own catalogue
+static void runRepeated(const std::vector<std::vector<ExpectedEntry>>& expected,
+                        std::vector<PhaseStats>& results)
+{
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    std::vector<size_t> full = fullCatalogues(expected.size());
+    std::string why;
+
+    struct RepeatQuery
+    {
+        std::string name;
+        StarDatabaseType type;
+        std::vector<size_t> search;
+    };
+    std::vector<RepeatQuery> queries;
+    for (size_t q = 0; q < REPEAT_NAMES; q++)
+    {
+        size_t list = full[q % full.size()];
+        const ExpectedEntry& entry = expected[list][q * 7 % expected[list].size()];
+        if (q % 2 == 0)
+            queries.push_back({entry.name, DB_NONE, full});
+        else
+            queries.push_back({entry.name, catalogue_cases[list].type, {list}});
+    }
+    queries.push_back({"NoSuchObject", DB_NONE, full});
+
+    CatalogueQueryCache::getInstance().resetStats();
+    PhaseStats phase = beginPhase("All catalogues", "repeat", queries.size() * REPEAT_ROUNDS);
+    for (int round = 0; round < REPEAT_ROUNDS; round++)
+    {
+        for (const RepeatQuery& query : queries)
+        {
+            StarUnifiedEntry result;
+            String name(query.name.c_str());
+            size_t owner = 0;
+            size_t match = 0;
+            bool exists = findOwner(expected, query.search, query.name, owner, match);
+            bool hit =
+                measure(phase, [&]() { return registry.findByName(query.type, name, result); });
+
+            if (hit != exists)
+                reportMismatch(phase, query.name, hit ? "unexpected hit" : "not found");
+            else if (hit && result.source_db != catalogue_cases[owner].type)
+                reportMismatch(phase, query.name, "wrong source catalogue");
+            else if (hit && !compareEntry(expected[owner][match], result, why))
+                reportMismatch(phase, query.name, why);
+        }
+    }
+    results.push_back(phase);
+
+    CatalogueQueryCacheStats stats = CatalogueQueryCache::getInstance().getStats();
+    printf("Query cache: %zu/%zu entries, %u hits, %u misses over the repeated searches\n",
+           stats.entries, stats.capacity, stats.hits, stats.misses);
+}
+
+struct AliasCase
+{
+    const char* search;
+    StarDatabaseType type;
+    StarDatabaseType source; // DB_NONE if the search must not find anything
+    const char* name;
+};
+
+// Designations and common names from the alias indexes written by the converters
+static const AliasCase alias_cases[] = {
+    {"M 31", DB_NONE, DB_MESSIER, "M31"},
+    {"messier 042", DB_NONE, DB_MESSIER, "M42"},
+    {"Caldwell 14", DB_NONE, DB_CALDWELL, "C14"},
+    {"NGC 0224", DB_NONE, DB_NGC2000, "NGC224"},
+    {"ngc 224", DB_MESSIER, DB_MESSIER, "M31"},
+    {"Andromeda", DB_NONE, DB_NGC2000, "NGC224"},
+    {"Andromeda", DB_MESSIER, DB_MESSIER, "M31"},
+    {"Great Nebula in Orion", DB_NONE, DB_NGC2000, "NGC1976"},
+    {"Crab", DB_NONE, DB_MESSIER, "M1"},
+    {"Pleiades", DB_NONE, DB_MESSIER, "M45"},
+    {"Whirlpool Galaxy", DB_NONE, DB_MESSIER, "M51"},
+    {"alf Ori", DB_NONE, DB_BSC5, "BETELGEUSE"},
+    {"Alpha CMa", DB_NONE, DB_BSC5, "SIRIUS"},
+    {"alpha  cen", DB_NONE, DB_BSC5, "Rigel Kentaurus"},
+    {"alf Ori", DB_BSC5_COMPACT, DB_BSC5_COMPACT, "BETELGEUSE"},
+    {"HR 424", DB_NONE, DB_BSC5, "POLARIS"},
+    {"BS 2491", DB_NONE, DB_BSC5, "SIRIUS"},
+    {"Cynosura", DB_NONE, DB_BSC5, "POLARIS"},
+    {"4 Cet", DB_NONE, DB_BSC5, "4 Cet in Psc"},
+    {"25 Tau", DB_NONE, DB_BSC5, "ALCYONE"},
+    {"alf Xyz", DB_NONE, DB_NONE, ""},
+    {"M 999", DB_NONE, DB_NONE, ""},
+    {"Andromeda", DB_BSC5, DB_NONE, ""},
+};
+
+struct DesignationKeyCase
+{
+    const char* text;
+    const char* key; // nullptr if there is no key
+};
+
+static const DesignationKeyCase designation_key_cases[] = {
+    {"M 031", "m31"},
+    {"Alpha  Ori", "alfori"},
+    {"Barnard's Galaxy", "barnardsgalaxy"},
+    {"m 0", "m0"},
+    {"  -- ", nullptr},
+    {"abcdefghijklmnopqrstuvwxyz 0123456789", nullptr},
+};
+
+static void runAliases(std::vector<PhaseStats>& results)
+{
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    size_t count = sizeof(alias_cases) / sizeof(alias_cases[0]);
+    PhaseStats phase = beginPhase("Aliases", "designation", count);
+
+    for (const DesignationKeyCase& c : designation_key_cases)
+    {
+        char key[CATALOGUE_DESIGNATION_KEY_SIZE];
+        bool found = catalogueDesignationKey(c.text, key, sizeof(key));
+        if (found != (c.key != nullptr) || (found && strcmp(key, c.key) != 0))
+            reportMismatch(phase, c.text, "designation key " + std::string(found ? key : "none"));
+    }
+
+    // Every search once without the query cache, these are the lookups that miss the name index
+    CatalogueQueryCache::getInstance().clear();
+    for (const AliasCase& c : alias_cases)
+    {
+        StarUnifiedEntry result;
+        String search(c.search);
+        bool hit = measure(phase, [&]() { return registry.findByName(c.type, search, result); });
+        if (hit != (c.source != DB_NONE))
+            reportMismatch(phase, c.search, hit ? "unexpected hit" : "not found");
+        else if (hit && (result.source_db != c.source || strcmp(result.name.c_str(), c.name) != 0))
+            reportMismatch(phase, c.search, "found " + std::string(result.name.c_str()));
+    }
+    results.push_back(phase);
+}
+
+static void runApparentPlace(const std::vector<ExpectedEntry>& entries,
+                             std::vector<PhaseStats>& results)
+{
+    ApparentPlace& apparent = ApparentPlace::getInstance();
+    PhaseStats phase = beginPhase("Apparent place", "convert", entries.size() + 1);
+    time_t utc = 0;
+    if (!ApparentPlace::parseUtc(REFERENCE_UTC_2040, utc) ||
+        (long long) utc != REFERENCE_UTC_2040_SECONDS)
+        reportMismatch(phase, REFERENCE_UTC_2040, "parsed as " + std::to_string((long long) utc));
+    apparent.setEpoch((time_t) REFERENCE_EPOCH);
+
+    int32_t ra = (int32_t) llround(REFERENCE_RA_J2000 / 24.0 * SKY_ANGLE_TURN);
+    int32_t dec = (int32_t) llround(REFERENCE_DEC_J2000 / 360.0 * SKY_ANGLE_TURN);
+    measure(phase, [&]() {
+        apparent.apply(ra, dec);
+        return true;
+    });
+    double dra =
+        (hoursOf(ra) - REFERENCE_RA_APPARENT) * 15.0 * 3600.0 * cos(degreesOf(dec) * M_PI / 180.0);
+    double ddec = (degreesOf(dec) - REFERENCE_DEC_APPARENT) * 3600.0;
+    if (fabs(dra) > APPARENT_TOLERANCE_ARCSEC || fabs(ddec) > APPARENT_TOLERANCE_ARCSEC)
+        reportMismatch(phase, "theta Persei",
+                       "off by " + std::to_string(dra) + "/" + std::to_string(ddec) + " arcsec");
+
+    for (const ExpectedEntry& entry : entries)
+    {
+        int32_t entry_ra = (int32_t) llround(entry.ra_hours / 24.0 * SKY_ANGLE_TURN);
+        int32_t entry_dec = (int32_t) llround(entry.dec_deg / 360.0 * SKY_ANGLE_TURN);
+        measure(phase, [&]() {
+            apparent.apply(entry_ra, entry_dec);
+            return true;
+        });
+    }
+    results.push_back(phase);
+}
+
+// The conversion as it was with double positions: double in and out, float
+// math inside and asin for the declination
+static void legacyApply(const float rotation[3][3], double& ra_hours, double& dec_deg)
+{
+    float ra = (float) ra_hours * (float) (M_PI / 12.0);
+    float dec = (float) dec_deg * (float) (M_PI / 180.0);
+    float cos_dec = cosf(dec);
+    float v[3] = {cos_dec * cosf(ra), cos_dec * sinf(ra), sinf(dec)};
+
+    float x = rotation[0][0] * v[0] + rotation[0][1] * v[1] + rotation[0][2] * v[2];
+    float y = rotation[1][0] * v[0] + rotation[1][1] * v[1] + rotation[1][2] * v[2];
+    float s = rotation[2][0] * v[0] + rotation[2][1] * v[1] + rotation[2][2] * v[2];
+
+    float ra_out = atan2f(y, x) * (float) (12.0 / M_PI);
+    if (ra_out < 0.0f)
+        ra_out += 24.0f;
+    ra_hours = ra_out;
+    dec_deg = asinf(fmaxf(-1.0f, fminf(1.0f, s))) * (float) (180.0 / M_PI);
+}
+
+// Same rotation in double precision, hours and degrees
+static void referenceApply(const float rotation[3][3], double& ra_hours, double& dec_deg)
+{
+    double ra = ra_hours * M_PI / 12.0;
+    double dec = dec_deg * M_PI / 180.0;
+    double v[3] = {cos(dec) * cos(ra), cos(dec) * sin(ra), sin(dec)};
+    double out[3];
+    for (int row = 0; row < 3; row++)
+        out[row] = rotation[row][0] * v[0] + rotation[row][1] * v[1] + rotation[row][2] * v[2];
+
+    ra_hours = atan2(out[1], out[0]) * 12.0 / M_PI;
+    if (ra_hours < 0.0)
+        ra_hours += 24.0;
+    dec_deg = atan2(out[2], hypot(out[0], out[1])) * 180.0 / M_PI;
+}
+
+// Distance on the sky in arcsec, small angles
+static double separationArcsec(double ra1, double dec1, double ra2, double dec2)
+{
+    double dra = fabs(ra1 - ra2);
+    dra = fmin(dra, 24.0 - dra) * 15.0 * cos(dec2 * M_PI / 180.0);
+    return hypot(dra, dec1 - dec2) * 3600.0;
+}
+
+static void runCoordinates(std::vector<PhaseStats>& results)
+{
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    ApparentPlace& apparent = ApparentPlace::getInstance();
+    apparent.setEpoch((time_t) REFERENCE_EPOCH);
+    float rotation[3][3];
+    apparent.getRotation(rotation);
+
+    std::vector<int32_t> ra;
+    std::vector<int32_t> dec;
+    for (size_t i : fullCatalogues(sizeof(catalogue_cases) / sizeof(catalogue_cases[0])))
+    {
+        const StarDatabase* db = registry.getDatabase(catalogue_cases[i].type);
+        StarUnifiedEntry entry;
+        for (size_t index = 0; db->findByIndex(index, entry); index++)
+        {
+            ra.push_back(entry.ra);
+            dec.push_back(entry.dec);
+        }
+    }
+    // Plus a sweep to the poles, the catalogues hold few objects there
+    for (int32_t step = -90; step <= 90; step++)
+    {
+        ra.push_back((int32_t) (step + 90) * (int32_t) (SKY_ANGLE_TURN / 181));
+        dec.push_back((int32_t) (step * (SKY_ANGLE_TURN / 4) / 90 * 999 / 1000));
+    }
+
+    size_t count = ra.size();
+    PhaseStats legacy = beginPhase("Coordinates", "double", COORDINATE_ROUNDS);
+    PhaseStats fixed = beginPhase("Coordinates", "fixed", COORDINATE_ROUNDS);
+    StarUnifiedEntry position;
+    long long checksum = 0;
+    for (int round = 0; round < COORDINATE_ROUNDS; round++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++)
+        {
+            double ra_hours = ra[i] * (24.0 / SKY_ANGLE_TURN);
+            double dec_deg = dec[i] * (360.0 / SKY_ANGLE_TURN);
+            legacyApply(rotation, ra_hours, dec_deg);
+            checksum += (long long) (ra_hours * 3600.0) + (long long) (dec_deg * 3600.0);
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++)
+        {
+            position.ra = ra[i];
+            position.dec = dec[i];
+            apparent.apply(position.ra, position.dec);
+            checksum += position.raSeconds() + position.decArcseconds();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        legacy.latencies_us.push_back(
+            std::chrono::duration<double, std::micro>(middle - start).count() / count);
+        fixed.latencies_us.push_back(
+            std::chrono::duration<double, std::micro>(end - middle).count() / count);
+    }
+    legacy.hits = fixed.hits = count * COORDINATE_ROUNDS;
+
+    double legacy_error = 0.0;
+    double fixed_error = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        double ref_ra = hoursOf(ra[i]);
+        double ref_dec = degreesOf(dec[i]);
+        referenceApply(rotation, ref_ra, ref_dec);
+
+        double legacy_ra = hoursOf(ra[i]);
+        double legacy_dec = degreesOf(dec[i]);
+        legacyApply(rotation, legacy_ra, legacy_dec);
+        legacy_error =
+            fmax(legacy_error, separationArcsec(legacy_ra, legacy_dec, ref_ra, ref_dec));
+
+        int32_t fixed_ra = ra[i];
+        int32_t fixed_dec = dec[i];
+        apparent.apply(fixed_ra, fixed_dec);
+        double error =
+            separationArcsec(hoursOf(fixed_ra), degreesOf(fixed_dec), ref_ra, ref_dec);
+        fixed_error = fmax(fixed_error, error);
+        if (error > COORDINATE_TOLERANCE_ARCSEC)
+            reportMismatch(fixed, std::to_string(ra[i]) + "/" + std::to_string(dec[i]),
+                           "off by " + std::to_string(error) + " arcsec");
+    }
+
+    // Best round, the others are slowed down by whatever else runs on the host
+    double legacy_rate =
+        1.0 / *std::min_element(legacy.latencies_us.begin(), legacy.latencies_us.end());
+    double fixed_rate =
+        1.0 / *std::min_element(fixed.latencies_us.begin(), fixed.latencies_us.end());
+    printf("Coordinates: %zu positions, double path %.2f M/s (max error %.3f arcsec), "
+           "fixed point path %.2f M/s (max error %.3f arcsec), checksum %lld\n",
+           count, legacy_rate, legacy_error, fixed_rate, fixed_error, checksum);
+
+    results.push_back(legacy);
+    results.push_back(fixed);
+}
+
+struct VisibilityCase
+{
+    const char* label;
+    double latitude;
+    double longitude;
+    time_t utc;
+    double min_altitude;
+    double max_magnitude;
+    SkyVisibilitySort sort;
+    size_t limit;
+};
+
+static const VisibilityCase visibility_cases[] = {
+    {"Munich, altitude", 48.14, 11.58, 1763330400, 0.0, SKY_VISIBILITY_ANY_MAGNITUDE,
+     SORT_BY_ALTITUDE, 20},
+    {"Munich, bright", 48.14, 11.58, 1763330400, 20.0, 4.0, SORT_BY_MAGNITUDE, 100},
+    {"Sydney, altitude", -33.87, 151.21, 1767225600, 30.0, SKY_VISIBILITY_ANY_MAGNITUDE,
+     SORT_BY_ALTITUDE, 100},
+    {"Equator, magnitude", 0.0, -78.5, 1751328000, 10.0, SKY_VISIBILITY_ANY_MAGNITUDE,
+     SORT_BY_MAGNITUDE, 50},
+    {"North pole", 89.9, 0.0, 1763330400, 0.0, 6.0, SORT_BY_ALTITUDE, 100},
+};
+
+struct VisibilityReference
+{
+    StarDatabaseType source;
+    size_t index;
+    double altitude;
+    double azimuth;
+    double magnitude;
+};
+
+// Textbook altitude and azimuth from hour angle, double precision
+static void referenceHorizontal(const VisibilityCase& c, int32_t ra, int32_t dec,
+                                double& altitude, double& azimuth)
+{
+    double days = c.utc / 86400.0 + UNIX_EPOCH_JD - J2000_JD;
+    double t = days / DAYS_PER_CENTURY;
+    double gmst =
+        280.46061837 + 360.98564736629 * days + 0.000387933 * t * t - t * t * t / 38710000.0;
+    double hour_angle = (gmst + c.longitude) * M_PI / 180.0 - hoursOf(ra) * M_PI / 12.0;
+    double lat = c.latitude * M_PI / 180.0;
+    double delta = degreesOf(dec) * M_PI / 180.0;
+
+    altitude = asin(sin(lat) * sin(delta) + cos(lat) * cos(delta) * cos(hour_angle));
+    azimuth = atan2(-cos(delta) * sin(hour_angle),
+                    cos(lat) * sin(delta) - sin(lat) * cos(delta) * cos(hour_angle));
+    altitude *= 180.0 / M_PI;
+    azimuth = fmod(azimuth * 180.0 / M_PI + 360.0, 360.0);
+}
+
+static bool betterReference(const VisibilityCase& c, const VisibilityReference& a,
+                            const VisibilityReference& b)
+{
+    double key_a = a.magnitude == 0.0 ? 1000.0 : a.magnitude;
+    double key_b = b.magnitude == 0.0 ? 1000.0 : b.magnitude;
+    if (c.sort == SORT_BY_MAGNITUDE && key_a != key_b)
+        return key_a < key_b;
+    return a.altitude > b.altitude;
+}
+
+static void runVisibility(std::vector<PhaseStats>& results)
+{
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    const StarDatabaseType scanned[] = {DB_NGC2000, DB_BSC5};
+    PhaseStats phase = beginPhase("Visibility", "scan",
+                                  VISIBILITY_ROUNDS * (sizeof(visibility_cases) /
+                                                       sizeof(visibility_cases[0])));
+    std::vector<SkyVisibleObject> found(SKY_VISIBILITY_MAX_RESULTS);
+
+    for (const VisibilityCase& c : visibility_cases)
+    {
+        SkyVisibilityQuery query;
+        query.utc = c.utc;
+        query.latitude_deg = (float) c.latitude;
+        query.longitude_deg = (float) c.longitude;
+        query.min_altitude_deg = (float) c.min_altitude;
+        query.max_magnitude = (float) c.max_magnitude;
+        query.sort = c.sort;
+        query.catalogue = DB_NONE;
+
+        // Every object of NGC 2000 and BSC5 in double precision
+        ApparentPlace& apparent = ApparentPlace::getInstance();
+        apparent.setEpoch(c.utc);
+        std::vector<VisibilityReference> expected;
+        for (StarDatabaseType type : scanned)
+        {
+            const StarDatabase* db = registry.getDatabase(type);
+            StarUnifiedEntry entry;
+            for (size_t index = 0; db->findByIndex(index, entry); index++)
+            {
+                bool known = entry.magnitude != 0.0f;
+                if (c.max_magnitude < SKY_VISIBILITY_ANY_MAGNITUDE &&
+                    (!known || entry.magnitude > c.max_magnitude))
+                    continue;
+                apparent.apply(entry);
+                VisibilityReference r = {type, index, 0.0, 0.0, entry.magnitude};
+                referenceHorizontal(c, entry.ra, entry.dec, r.altitude, r.azimuth);
+                if (r.altitude >= c.min_altitude)
+                    expected.push_back(r);
+            }
+        }
+        std::stable_sort(expected.begin(), expected.end(),
+                         [&](const VisibilityReference& a, const VisibilityReference& b) {
+                             return betterReference(c, a, b);
+                         });
+
+        size_t count = 0;
+        for (int round = 0; round < VISIBILITY_ROUNDS; round++)
+        {
+            measure(phase, [&]() {
+                count = SkyVisibility(query).find(found.data(), c.limit);
+                return count > 0;
+            });
+        }
+
+        if (count != std::min(c.limit, expected.size()))
+        {
+            reportMismatch(phase, c.label,
+                           std::to_string(count) + " objects, expected " +
+                               std::to_string(std::min(c.limit, expected.size())));
+            continue;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            // Near ties may swap places, the sort key at every rank must agree
+            const SkyVisibleObject& object = found[i];
+            const VisibilityReference& rank = expected[i];
+            auto same = [&](const VisibilityReference& r) {
+                return r.source == object.source && r.index == object.index;
+            };
+            auto match = std::find_if(expected.begin(), expected.end(), same);
+            std::string why;
+            if (match == expected.end())
+                why = "object " + std::to_string(object.index) + " is below the limit";
+            else if (fabs(match->altitude - object.altitude_deg) > VISIBILITY_TOLERANCE_DEG)
+                why = "altitude " + std::to_string(object.altitude_deg) + ", expected " +
+                      std::to_string(match->altitude);
+            else if (fabs(match->altitude) < 89.0 &&
+                     fabs(remainder(match->azimuth - object.azimuth_deg, 360.0)) *
+                             cos(match->altitude * M_PI / 180.0) >
+                         VISIBILITY_TOLERANCE_DEG)
+                why = "azimuth " + std::to_string(object.azimuth_deg) + ", expected " +
+                      std::to_string(match->azimuth);
+            else if (c.sort == SORT_BY_MAGNITUDE ? object.magnitude != (float) rank.magnitude
+                                                 : fabs(object.altitude_deg - rank.altitude) >
+                                                       VISIBILITY_TOLERANCE_DEG)
+                why = "rank " + std::to_string(i) + " holds object " +
+                      std::to_string(object.index) + " instead of " + std::to_string(rank.index);
+            if (!why.empty())
+                reportMismatch(phase, c.label, why);
+        }
+        if (verbose)
+            printf("Visibility %s: %zu of %zu objects above the limit\n", c.label, count,
+                   expected.size());
+    }
+    results.push_back(phase);
+}
+
+// Collects the visited indices, the buffer is reserved up front
+class IndexCollector : public CatalogueRecordVisitor
+{
+  public:
+    std::vector<size_t> indices;
+
+    bool visit(size_t index, const CatalogueRecord& record) override
+    {
+        (void) record;
+        indices.push_back(index);
+        return true;
+    }
+};
+
+// Every record of a projection ordered like CatalogueBrowser does it
+static std::vector<size_t> sortedIndices(const CatalogueBlob& blob, bool compact,
+                                         CatalogueSortKey key)
+{
+    struct Entry
+    {
+        CatalogueRecord record;
+        size_t index;
+    };
+    std::vector<Entry> entries;
+    CatalogueCursor cursor(blob, compact);
+    CatalogueRecord record;
+    while (cursor.next(record))
+        entries.push_back({record, cursor.index()});
+
+    auto value = [&](const CatalogueRecord& r) -> int64_t {
+        if (key == SORT_KEY_MAGNITUDE)
+            return r.mag_centi == 0 ? INT32_MAX : r.mag_centi;
+        if (key == SORT_KEY_RA)
+            return r.ra;
+        return key == SORT_KEY_DEC ? r.dec : 0;
+    };
+    std::sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+        int order = key == SORT_KEY_NAME ? strcasecmp(a.record.name, b.record.name) : 0;
+        if (order != 0)
+            return order < 0;
+        if (value(a.record) != value(b.record))
+            return value(a.record) < value(b.record);
+        return a.index < b.index;
+    });
+
+    std::vector<size_t> indices;
+    for (const Entry& entry : entries)
+        indices.push_back(entry.index);
+    return indices;
+}
+
+static void runBrowse(std::vector<PhaseStats>& results)
+{
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    const StarDatabaseType browsed[] = {DB_NGC2000, DB_NGC2000_COMPACT, DB_BSC5};
+    PhaseStats by_after = beginPhase("Browse", "page", 0);
+    PhaseStats by_offset = beginPhase("Browse", "offset", 0);
+    PhaseStats whole = beginPhase("Browse", "all", 0);
+
+    for (StarDatabaseType type : browsed)
+    {
+        const StarDatabase* db = registry.getDatabase(type);
+        for (int k = 0; k < SORT_KEY_COUNT; k++)
+        {
+            CatalogueSortKey key = (CatalogueSortKey) k;
+            CatalogueBrowser browser(*db->getBlob(), db->isCompactProjection(), key);
+            std::vector<size_t> expected =
+                sortedIndices(*db->getBlob(), db->isCompactProjection(), key);
+            std::string label = std::to_string(type) + "/" + CatalogueBrowser::getKeyName(key);
+
+            // Page by page, each continuing after the last index of the previous one
+            IndexCollector collector;
+            collector.indices.reserve(expected.size());
+            size_t count = 0;
+            measure(by_after, [&]() {
+                count = browser.browse(0, BROWSE_PAGE_SIZE, collector);
+                return count > 0;
+            });
+            while (count == BROWSE_PAGE_SIZE)
+            {
+                size_t after = collector.indices.back();
+                measure(by_after, [&]() {
+                    count = browser.browseAfter(after, BROWSE_PAGE_SIZE, collector);
+                    return count > 0;
+                });
+            }
+            if (collector.indices != expected)
+                reportMismatch(by_after, label, "pages differ from a full sort");
+
+            IndexCollector at_offset;
+            at_offset.indices.reserve(BROWSE_PAGE_SIZE);
+            measure(by_offset, [&]() {
+                return browser.browse(BROWSE_OFFSET, BROWSE_PAGE_SIZE, at_offset) > 0;
+            });
+            size_t end = std::min(expected.size(), (size_t) (BROWSE_OFFSET + BROWSE_PAGE_SIZE));
+            if (!std::equal(at_offset.indices.begin(), at_offset.indices.end(),
+                            expected.begin() + BROWSE_OFFSET, expected.begin() + end) ||
+                at_offset.indices.size() != end - BROWSE_OFFSET)
+                reportMismatch(by_offset, label, "page differs from a full sort");
+
+            // The whole catalogue as one page needs no more memory than a small one
+            IndexCollector all;
+            all.indices.reserve(expected.size());
+            measure(whole, [&]() { return browser.browse(0, expected.size(), all) > 0; });
+            if (all.indices != expected)
+                reportMismatch(whole, label, "single page differs from a full sort");
+        }
+    }
+    results.push_back(by_after);
+    results.push_back(by_offset);
+    results.push_back(whole);
+}
+
+// Collects the bytes of a tile, the buffer is reserved up front
+class TileCollector : public SkyTileSink
+{
+  public:
+    std::vector<uint8_t> bytes;
+
+    bool write(const uint8_t* data, size_t len) override
+    {
+        bytes.insert(bytes.end(), data, data + len);
+        return true;
+    }
+};
+
+// Tile records of a projection, from a plain decode and the format description
+static std::vector<std::vector<uint8_t>> referenceTiles(const CatalogueBlob& blob, bool compact,
+                                                        int16_t mag_max)
+{
+    std::vector<std::vector<uint8_t>> tiles(SKY_TILE_COUNT);
+    CatalogueCursor cursor(blob, compact);
+    CatalogueRecord record;
+    while (cursor.next(record))
+    {
+        if (mag_max != INT16_MAX && (record.mag_centi == 0 || record.mag_centi > mag_max))
+            continue;
+
+        // floor((dec + 90) / 15) and floor(ra in hours) in integers, objects close to a
+        // boundary (IC 2479 at +30 deg) must land on the same side as in the firmware
+        int64_t dec_turns = (int64_t) (record.dec + CATALOGUE_TURN / 4) * 24;
+        int band = std::min((int) (dec_turns / CATALOGUE_TURN), SKY_TILE_DEC_BANDS - 1);
+        int sector = (int) ((int64_t) record.ra * 24 / CATALOGUE_TURN);
+        int ra = (int) floor(record.ra / 256.0 + 0.5) & 0xFFFF;
+        int dec = (int) floor(record.dec / 256.0 + 0.5);
+        long mag = record.mag_centi == 0 ? SKY_TILE_NO_MAGNITUDE : lround(record.mag_centi / 10.0);
+        mag = std::max(std::min(mag, (long) SKY_TILE_NO_MAGNITUDE), (long) INT8_MIN);
+        if (record.mag_centi != 0 && mag == SKY_TILE_NO_MAGNITUDE)
+            mag--;
+
+        std::vector<uint8_t>& tile = tiles[band * SKY_TILE_RA_SECTORS + sector];
+        tile.push_back(ra & 0xFF);
+        tile.push_back(ra >> 8);
+        tile.push_back(dec & 0xFF);
+        tile.push_back((dec >> 8) & 0xFF);
+        tile.push_back((uint8_t) mag);
+        tile.push_back(SkyTileEncoder::getTypeCode(record.type));
+    }
+    return tiles;
+}
+
+static void runTiles(std::vector<PhaseStats>& results)
+{
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    const StarDatabaseType tiled[] = {DB_NGC2000, DB_NGC2000_COMPACT, DB_BSC5};
+    PhaseStats all = beginPhase("Tiles", "all", 0);
+    PhaseStats limited = beginPhase("Tiles", "magnitude", 0);
+
+    for (StarDatabaseType type : tiled)
+    {
+        const StarDatabase* db = registry.getDatabase(type);
+        const CatalogueBlob& blob = *db->getBlob();
+        std::string label = std::to_string(type);
+
+        uint32_t tag = SkyTileEncoder::getDataTag(type);
+        if (tag == 0 || tag != SkyTileEncoder::getDataTag(type))
+            reportMismatch(all, label, "no stable data tag");
+
+        for (int16_t mag_max : {(int16_t) INT16_MAX, (int16_t) TILE_MAGNITUDE_LIMIT})
+        {
+            PhaseStats& phase = mag_max == INT16_MAX ? all : limited;
+            std::vector<std::vector<uint8_t>> expected =
+                referenceTiles(blob, db->isCompactProjection(), mag_max);
+            SkyTileEncoder encoder(blob, db->isCompactProjection());
+            TileCollector collector;
+            collector.bytes.reserve(SKY_TILE_HEADER_SIZE + blob.getRecordCount(false) *
+                                                                SKY_TILE_RECORD_SIZE);
+            size_t total = 0;
+            for (size_t tile = 0; tile < SKY_TILE_COUNT; tile++)
+            {
+                collector.bytes.clear();
+                size_t count = 0;
+                measure(phase, [&]() {
+                    count = encoder.encode(tile, mag_max, collector);
+                    return true;
+                });
+                total += count;
+
+                const uint8_t header[SKY_TILE_HEADER_SIZE] = {
+                    'O', 'G', 'T', 'L', SKY_TILE_FORMAT_VERSION, SKY_TILE_RECORD_SIZE,
+                    (uint8_t) tile, (uint8_t) (tile >> 8)};
+                std::string query = label + "/" + std::to_string(tile);
+                if (collector.bytes.size() != SKY_TILE_HEADER_SIZE + count * SKY_TILE_RECORD_SIZE ||
+                    memcmp(collector.bytes.data(), header, SKY_TILE_HEADER_SIZE) != 0)
+                    reportMismatch(phase, query, "bad header or length");
+                else if (!std::equal(collector.bytes.begin() + SKY_TILE_HEADER_SIZE,
+                                     collector.bytes.end(), expected[tile].begin(),
+                                     expected[tile].end()))
+                    reportMismatch(phase, query, "records differ from a plain decode");
+            }
+
+            size_t expected_total = 0;
+            for (const std::vector<uint8_t>& tile : expected)
+                expected_total += tile.size() / SKY_TILE_RECORD_SIZE;
+            if (total != expected_total ||
+                (mag_max == INT16_MAX && total != blob.getRecordCount(db->isCompactProjection())))
+                reportMismatch(phase, label, "tiles do not cover every record once");
+        }
+    }
+    if (SkyTileEncoder::getDataTag(DB_NGC2000) == SkyTileEncoder::getDataTag(DB_BSC5))
+        reportMismatch(all, "tag", "NGC 2000 and BSC5 share a data tag");
+
+    results.push_back(all);
+    results.push_back(limited);
+}
+
+struct AttributeCase
+{
+    StarDatabaseType catalogue;
+    const char* type;
+    const char* constellation;
+    int16_t mag_min; // Hundredths
+    int16_t mag_max;
+    uint16_t size_min; // Tenths of an arcminute
+    uint16_t size_max;
+};
+
+#define ANY_MAG INT16_MIN, INT16_MAX
+#define ANY_SIZE 0, UINT16_MAX
+
+static const AttributeCase attribute_cases[] = {
+    {DB_NGC2000, nullptr, nullptr, ANY_MAG, ANY_SIZE},
+    {DB_NGC2000, "Gx", nullptr, ANY_MAG, ANY_SIZE},
+    {DB_NGC2000, "oc", nullptr, INT16_MIN, 700, ANY_SIZE},
+    {DB_NGC2000, nullptr, "SGR", ANY_MAG, ANY_SIZE},
+    {DB_NGC2000, "Nb", nullptr, ANY_MAG, 50, UINT16_MAX},
+    {DB_NGC2000, "Gx", "Leo", INT16_MIN, 1100, 50, UINT16_MAX},
+    {DB_NGC2000, "Pl", nullptr, 800, 1200, 0, 20},
+    {DB_NGC2000, "Xx", nullptr, ANY_MAG, ANY_SIZE},
+    {DB_NGC2000_COMPACT, "Gb", nullptr, INT16_MIN, 900, ANY_SIZE},
+    {DB_NGC2000_COMPACT, nullptr, "Ori", ANY_MAG, 100, UINT16_MAX},
+    {DB_BSC5, nullptr, nullptr, INT16_MIN, 200, ANY_SIZE},
+    {DB_BSC5, "Gx", nullptr, ANY_MAG, ANY_SIZE},
+    {DB_BSC5_COMPACT, nullptr, nullptr, 300, 350, ANY_SIZE},
+    {DB_MESSIER, "Gx", nullptr, INT16_MIN, 1000, ANY_SIZE},
+    {DB_MESSIER, nullptr, "Sgr", ANY_MAG, 100, 600},
+    {DB_CALDWELL, nullptr, nullptr, ANY_MAG, 300, UINT16_MAX},
+    {DB_CALDWELL, nullptr, nullptr, 500, 400, ANY_SIZE},
+};
+
+// Page through an attribute query and check every page against a plain decode
+static void checkAttributes(PhaseStats& phase, const CatalogueBlob& blob, bool compact,
+                            const CatalogueAttributeQuery& query, const std::string& label)
+{
+    std::vector<size_t> expected;
+    CatalogueCursor cursor(blob, compact);
+    CatalogueRecord record;
+    while (cursor.next(record))
+    {
+        bool mag = !query.hasMagnitude() || (record.mag_centi != 0 &&
+                                              record.mag_centi >= query.mag_min &&
+                                              record.mag_centi <= query.mag_max);
+        bool size = !query.hasSize() || (record.size_decimin != 0 &&
+                                          record.size_decimin >= query.size_min &&
+                                          record.size_decimin <= query.size_max);
+        bool type = query.type == nullptr || strcasecmp(record.type, query.type) == 0;
+        bool constellation = query.constellation == nullptr ||
+                             strcasecmp(record.constellation, query.constellation) == 0;
+        if (mag && size && type && constellation)
+            expected.push_back(cursor.index());
+    }
+
+    CatalogueAttributeScan scan(blob, compact, query);
+    IndexCollector collector;
+    collector.indices.reserve(expected.size());
+    size_t offset = 0;
+    for (;;)
+    {
+        size_t total = 0;
+        size_t count = 0;
+        measure(phase, [&]() {
+            count = scan.run(offset, ATTRIBUTE_PAGE_SIZE, collector, total);
+            return total > 0;
+        });
+        if (total != expected.size())
+        {
+            reportMismatch(phase, label, std::to_string(total) + " matches, scan found " +
+                                             std::to_string(expected.size()));
+            return;
+        }
+        offset += count;
+        if (count < ATTRIBUTE_PAGE_SIZE)
+            break;
+    }
+    if (collector.indices != expected)
+        reportMismatch(phase, label, "pages differ from a plain decode");
+
+    // Pages continued after the last index visit the same records
+    IndexCollector keyset;
+    keyset.indices.reserve(expected.size());
+    size_t total = 0;
+    size_t count = scan.run(0, ATTRIBUTE_PAGE_SIZE, keyset, total);
+    while (count == ATTRIBUTE_PAGE_SIZE)
+        count = scan.runAfter(keyset.indices.back(), ATTRIBUTE_PAGE_SIZE, keyset);
+    if (keyset.indices != expected)
+        reportMismatch(phase, label, "continued pages differ from a plain decode");
+}
+
+static void runAttributes(std::vector<PhaseStats>& results)
+{
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    PhaseStats phase = beginPhase("Attributes", "page", 0);
+    for (const AttributeCase& c : attribute_cases)
+    {
+        const StarDatabase* db = registry.getDatabase(c.catalogue);
+        CatalogueAttributeQuery query;
+        query.type = c.type;
+        query.constellation = c.constellation;
+        query.mag_min = c.mag_min;
+        query.mag_max = c.mag_max;
+        query.size_min = c.size_min;
+        query.size_max = c.size_max;
+        std::string label = std::to_string(c.catalogue) + "/" + (c.type ? c.type : "") + "/" +
+                            (c.constellation ? c.constellation : "");
+        checkAttributes(phase, *db->getBlob(), db->isCompactProjection(), query, label);
+    }
+    results.push_back(phase);
+}
+
+static bool sameRecord(const CatalogueRecord& e, const StarUnifiedEntry& r, std::string& why)
+{
+    if (strcmp(e.name, r.name.c_str()) != 0)
+        why = "name '" + std::string(r.name.c_str()) + "'";
+    else if (r.ra != skyAngleFromCatalogue(e.ra) || r.dec != skyAngleFromCatalogue(e.dec))
+        why = "position " + std::to_string(r.ra) + "/" + std::to_string(r.dec);
+    else if (r.magnitude != e.magnitude())
+        why = "magnitude " + std::to_string(r.magnitude);
+    else if (strcmp(e.spectral, r.spectral_type.c_str()) != 0)
+        why = "spectral type '" + std::string(r.spectral_type.c_str()) + "'";
+    else
+        return true;
+    return false;
+}
+
+// Counts the records of a visit
+class RecordCounter : public CatalogueRecordVisitor
+{
+  public:
+    size_t count = 0;
+
+    bool visit(size_t index, const CatalogueRecord& record) override
+    {
+        (void) index;
+        (void) record;
+        count++;
+        return true;
+    }
+};
+
+// Run a filter through the block statistics and check it against a scan of all records
+static void runFilter(PhaseStats& phase, const StarDatabase& db,
+                      const std::vector<CatalogueRecord>& records, const CatalogueFilter& filter,
+                      size_t& blocks_read)
+{
+    const CatalogueBlob& blob = *db.getBlob();
+    RecordCounter counter;
+    measure(phase, [&]() { return db.visit(filter, 0, nullptr, counter) > 0; });
+    size_t found = counter.count;
+
+    size_t expected = 0;
+    for (const CatalogueRecord& record : records)
+        expected += filter.matches(record) ? 1 : 0;
+    for (size_t block = blob.findMatchingBlock(0, filter); block < blob.getBlockCount();
+         block = blob.findMatchingBlock(block + 1, filter))
+        blocks_read++;
+
+    if (found != expected)
+        reportMismatch(phase, std::to_string(filter.ra_min) + "/" + std::to_string(filter.dec_min),
+                       std::to_string(found) + " matches, scan found " + std::to_string(expected));
+}
+
+// Lookups and filters on a catalogue with 100k+ objects, checked against a plain decode
+static bool runScale(const std::string& data, std::vector<PhaseStats>& results)
+{
+    const uint8_t* start = reinterpret_cast<const uint8_t*>(data.data());
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    CatalogueBlob blob;
+    if (!blob.open(start, data.size(), "HIPP") ||
+        !registry.registerDatabase(DB_HIPPARCOS, start, start + data.size()))
+    {
+        fprintf(stderr, "Failed to load the scale catalogue\n");
+        return false;
+    }
+
+    const StarDatabase* db = registry.getDatabase(DB_HIPPARCOS);
+    std::vector<CatalogueRecord> records;
+    records.reserve(blob.getRecordCount(false));
+    CatalogueCursor cursor(blob, false);
+    CatalogueRecord record;
+    while (cursor.next(record))
+        records.push_back(record);
+
+    printf("Scale catalogue: %zu objects, %zu bytes blob, %zu blocks\n", records.size(),
+           data.size(), blob.getBlockCount());
+
+    const char* label = "Hipparcos scale";
+    std::string why;
+    PhaseStats by_index = beginPhase(label, "index", records.size());
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        StarUnifiedEntry result;
+        if (!measure(by_index, [&]() { return db->findByIndex(i, result); }))
+            reportMismatch(by_index, std::to_string(i), "not found");
+        else if (!sameRecord(records[i], result, why))
+            reportMismatch(by_index, std::to_string(i), why);
+    }
+    results.push_back(by_index);
+
+    // Names are unique, every lookup has to find the record it was taken from
+    PhaseStats by_name = beginPhase(label, "name", records.size() / SCALE_NAME_STRIDE + 1);
+    for (size_t i = 0; i < records.size(); i += SCALE_NAME_STRIDE)
+    {
+        StarUnifiedEntry result;
+        String name(records[i].name);
+        if (!measure(by_name, [&]() { return db->findByName(name, result); }))
+            reportMismatch(by_name, records[i].name, "not found");
+        else if (!sameRecord(records[i], result, why))
+            reportMismatch(by_name, records[i].name, why);
+    }
+    results.push_back(by_name);
+
+    PhaseStats missing = beginPhase(label, "miss", MISS_QUERIES);
+    for (int i = 0; i < MISS_QUERIES; i++)
+    {
+        StarUnifiedEntry result;
+        char name[24];
+        snprintf(name, sizeof(name), "HIP 9%07d", i);
+        String search(name);
+        if (measure(missing, [&]() { return db->findByName(search, result); }))
+            reportMismatch(missing, name, "unexpected hit " + std::string(result.name.c_str()));
+    }
+    results.push_back(missing);
+
+    PhaseStats by_fragment = beginPhase(label, "fragment", SCALE_FRAGMENT_QUERIES);
+    for (size_t q = 0; q < SCALE_FRAGMENT_QUERIES; q++)
+    {
+        StarUnifiedEntry result;
+        const CatalogueRecord& source = records[q * records.size() / SCALE_FRAGMENT_QUERIES];
+        std::string fragment = fragmentOf(source.name);
+        String search(fragment.c_str());
+        size_t expected = 0;
+        while (strstr(toLower(records[expected].name).c_str(), toLower(fragment).c_str()) ==
+               nullptr)
+            expected++;
+        if (!measure(by_fragment, [&]() { return db->findByNameFragment(search, result); }))
+            reportMismatch(by_fragment, fragment, "not found");
+        else if (!sameRecord(records[expected], result, why))
+            reportMismatch(by_fragment, fragment, why);
+    }
+    results.push_back(by_fragment);
+
+    // Every name holding a fragment, a scan of all names through a predicate
+    PhaseStats by_predicate = beginPhase(label, "predicate", SCALE_FRAGMENT_QUERIES);
+    for (size_t q = 0; q < SCALE_FRAGMENT_QUERIES; q++)
+    {
+        const CatalogueRecord& source = records[q * records.size() / SCALE_FRAGMENT_QUERIES];
+        std::string fragment = fragmentOf(source.name);
+        size_t expected = 0;
+        for (const CatalogueRecord& r : records)
+            expected += strstr(toLower(r.name).c_str(), toLower(fragment).c_str()) ? 1 : 0;
+
+        CatalogueNamePredicate predicate(fragment.c_str(), true);
+        RecordCounter counter;
+        measure(by_predicate, [&]() {
+            return db->visit(CatalogueFilter(), 1 << COL_NAME, &predicate, counter) > 0;
+        });
+        if (counter.count != expected)
+            reportMismatch(by_predicate, fragment,
+                           std::to_string(counter.count) + " matches, scan found " +
+                               std::to_string(expected));
+    }
+    results.push_back(by_predicate);
+
+    // One hour of RA by ten degrees of declination, spread over the sky
+    PhaseStats region = beginPhase(label, "region", SCALE_FILTER_QUERIES);
+    size_t region_blocks = 0;
+    for (int q = 0; q < SCALE_FILTER_QUERIES; q++)
+    {
+        CatalogueFilter filter;
+        filter.ra_min = (int32_t) ((q * 7919L) % CATALOGUE_TURN);
+        filter.ra_max = (filter.ra_min + CATALOGUE_TURN / 24) % CATALOGUE_TURN;
+        filter.dec_min = (int32_t) ((q % 16) * (CATALOGUE_TURN / 36) - CATALOGUE_TURN / 4);
+        filter.dec_max = filter.dec_min + CATALOGUE_TURN / 36;
+        runFilter(region, *db, records, filter, region_blocks);
+    }
+    results.push_back(region);
+
+    // Naked eye stars, the magnitude limit moves from 1 to 6
+    PhaseStats bright = beginPhase(label, "magnitude", SCALE_FILTER_QUERIES);
+    size_t bright_blocks = 0;
+    for (int q = 0; q < SCALE_FILTER_QUERIES; q++)
+    {
+        CatalogueFilter filter;
+        filter.mag_max = (int16_t) (100 + q * 500 / SCALE_FILTER_QUERIES);
+        runFilter(bright, *db, records, filter, bright_blocks);
+    }
+    results.push_back(bright);
+
+    // Stars by type and magnitude, the type string is resolved once per query
+    PhaseStats attributes = beginPhase(label, "attribute", 0);
+    for (int16_t mag_max : {450, 550, 650})
+    {
+        CatalogueAttributeQuery query;
+        query.type = "star";
+        query.mag_max = mag_max;
+        checkAttributes(attributes, blob, false, query, std::to_string(mag_max));
+    }
+    results.push_back(attributes);
+
+    // Whole sky visibility listings over every star, the first case of each hemisphere
+    PhaseStats visible = beginPhase(label, "visible", VISIBILITY_ROUNDS * 2);
+    std::vector<SkyVisibleObject> found(SKY_VISIBILITY_MAX_RESULTS);
+    for (int q = 0; q < VISIBILITY_ROUNDS * 2; q++)
+    {
+        const VisibilityCase& c = visibility_cases[q % 2 == 0 ? 0 : 2];
+        SkyVisibilityQuery query = {c.utc, (float) c.latitude, (float) c.longitude, 0.0f,
+                                    (float) c.max_magnitude, c.sort, DB_HIPPARCOS};
+        measure(visible, [&]() { return SkyVisibility(query).find(found.data(), c.limit) > 0; });
+    }
+    results.push_back(visible);
+
+    printf("Blocks decoded per filter: region %.1f, magnitude %.1f of %zu\n",
+           (double) region_blocks / SCALE_FILTER_QUERIES,
+           (double) bright_blocks / SCALE_FILTER_QUERIES, blob.getBlockCount());
+    return true;
+}
+
+// Stream the first length bytes of a bundle through the update API like POST /catalogUpload
+static bool uploadBundle(const std::string& bundle, size_t length)
+{
+    CataloguePartition& partition = CataloguePartition::getInstance();
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(bundle.data());
+    if (!partition.beginUpdate(0))
+        return false;
+    for (size_t pos = 0; pos < length; pos += UPLOAD_CHUNK_SIZE)
+    {
+        if (!partition.writeUpdate(data + pos, std::min<size_t>(UPLOAD_CHUNK_SIZE, length - pos)))
+            return false;
+    }
+    return partition.endUpdate();
+}
+
+// Install the bundle in the emulated partition, broken uploads must leave no valid bundle
+static bool installBundle(const std::string& bundle)
+{
+    CataloguePartition& partition = CataloguePartition::getInstance();
+    catalogueFlashHostReset(PARTITION_CAPACITY);
+
+    if (uploadBundle(bundle, bundle.size() / 2) || partition.begin())
+    {
+        fprintf(stderr, "Truncated bundle upload was accepted\n");
+        return false;
+    }
+
+    std::string corrupt = bundle;
+    corrupt[corrupt.size() / 2] ^= 0x01;
+    if (uploadBundle(corrupt, corrupt.size()) || partition.begin())
+    {
+        fprintf(stderr, "Corrupt bundle upload was accepted\n");
+        return false;
+    }
+
+    if (!uploadBundle(bundle, bundle.size()) || !partition.begin())
+    {
+        fprintf(stderr, "Bundle upload failed: %s\n",
+                partition.getUpdateError() ? partition.getUpdateError() : "invalid bundle");
+        return false;
+    }
+    return true;
+}
+
+static double percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t) (p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+static void printResults(const std::vector<PhaseStats>& results)
+{
+    printf("\n%-16s %-9s %6s %5s %5s %9s %9s %9s %9s %9s %9s %8s\n", "Catalogue", "Query",
+           "Count", "Miss", "Bad", "mean[us]", "p50[us]", "p99[us]", "max[us]", "allocs/q",
+           "bytes/q", "peak[B]");
+    for (const PhaseStats& phase : results)
+    {
+        size_t count = phase.latencies_us.size();
+        double total = 0.0;
+        for (double value : phase.latencies_us)
+            total += value;
+        double per_query = count ? 1.0 / count : 0.0;
+
+        printf("%-16s %-9s %6zu %5zu %5zu %9.2f %9.2f %9.2f %9.2f %9.2f %9.1f %8zu\n",
+               phase.catalogue, phase.query, count, phase.misses, phase.mismatches,
+               total * per_query, percentile(phase.latencies_us, 0.5),
+               percentile(phase.latencies_us, 0.99), percentile(phase.latencies_us, 1.0),
+               phase.allocations * per_query, phase.bytes_allocated * per_query,
+               phase.peak_bytes);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string directory = "../../catalogues";
+    std::string scale_path;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-v") == 0)
+            verbose = true;
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+            CataloguePageCache::getInstance().setBudget(strtoul(argv[++i], nullptr, 0));
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            scale_path = argv[++i];
+        else
+            directory = argv[i];
+    }
+    directory += "/";
+
+    // Converter output, the catalogues in the bundle must match it byte for byte
+    std::vector<std::string> blobs(sizeof(catalogue_cases) / sizeof(catalogue_cases[0]));
+    std::vector<std::vector<ExpectedEntry>> expected(blobs.size());
+    std::string bundle;
+    if (!readFile(directory + BUNDLE_FILE, bundle))
+    {
+        fprintf(stderr, "Cannot read %s in %s\n", BUNDLE_FILE, directory.c_str());
+        return 2;
+    }
+
+    for (size_t i = 0; i < blobs.size(); i++)
+    {
+        const CatalogueCase& c = catalogue_cases[i];
+        std::string json_text;
+        std::string error;
+        JsonValue json;
+        if (!readFile(directory + c.blob, blobs[i]) || !readFile(directory + c.json, json_text))
+        {
+            fprintf(stderr, "Cannot read %s or %s in %s\n", c.blob, c.json, directory.c_str());
+            return 2;
+        }
+        if (!JsonValue::parse(json_text, json, error) || json.type != JsonValue::JSON_ARRAY)
+        {
+            fprintf(stderr, "Cannot parse %s: %s\n", c.json, error.c_str());
+            return 2;
+        }
+        for (const JsonValue& obj : json.items)
+            expected[i].push_back(expectedFromJson(c.type, obj));
+    }
+
+    print_out_enabled = verbose;
+
+    if (!installBundle(bundle))
+        return 1;
+    CataloguePartition& partition = CataloguePartition::getInstance();
+    printf("Catalogue partition: bundle version %u, %zu of %zu bytes, broken uploads rejected\n",
+           (unsigned) partition.getBundleVersion(), partition.getBundleSize(),
+           partition.getCapacity());
+
+    StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+    AllocStats before_load = AllocTracker::snapshot();
+    auto load_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < blobs.size(); i++)
+    {
+        // Projections of the same catalogue share one blob in the bundle, as in firmware.ino
+        const uint8_t* start;
+        const uint8_t* end;
+        if (!partition.findCatalogue(catalogue_cases[i].tag, start, end) ||
+            (size_t) (end - start) != blobs[i].size() ||
+            memcmp(start, blobs[i].data(), blobs[i].size()) != 0)
+        {
+            fprintf(stderr, "%s in %s differs from %s\n", catalogue_cases[i].tag, BUNDLE_FILE,
+                    catalogue_cases[i].blob);
+            return 1;
+        }
+        if (!registry.registerDatabase(catalogue_cases[i].type, start, end))
+        {
+            fprintf(stderr, "Failed to load %s\n", catalogue_cases[i].label);
+            return 1;
+        }
+    }
+    auto load_end = std::chrono::steady_clock::now();
+    AllocStats after_load = AllocTracker::snapshot();
+
+    printf("Loaded %zu catalogues in %.1f us: %llu allocations, %zu bytes resident heap\n",
+           registry.getDatabaseCount(),
+           std::chrono::duration<double, std::micro>(load_end - load_start).count(),
+           (unsigned long long) (after_load.allocations - before_load.allocations),
+           after_load.current_bytes - before_load.current_bytes);
+    for (size_t i = 0; i < blobs.size(); i++)
+        printf("  %-16s %6zu objects, %6zu bytes blob\n", catalogue_cases[i].label,
+               expected[i].size(), blobs[i].size());
+
+    std::vector<PhaseStats> results;
+    for (size_t i = 0; i < blobs.size(); i++)
+    {
+        const StarDatabase* db = registry.getDatabase(catalogue_cases[i].type);
+        runCatalogue(*db, catalogue_cases[i].label, catalogue_cases[i].type, expected[i],
+                     results);
+    }
+    runAllCatalogues(expected, results);
+    runBatch(expected, results);
+    runRepeated(expected, results);
+    runAliases(results);
+    runApparentPlace(expected[0], results);
+    runCoordinates(results);
+    runVisibility(results);
+    runBrowse(results);
+    runTiles(results);
+    runAttributes(results);
+    runLowHeap(expected, results);
+
+    // Registered last so the DB_NONE checks above cover only the converted catalogues
+    std::string scale;
+    if (!scale_path.empty())
+    {
+        if (!readFile(scale_path, scale))
+        {
+            fprintf(stderr, "Cannot read %s\n", scale_path.c_str());
+            return 2;
+        }
+        if (!runScale(scale, results))
+            return 1;
+    }
+
+    printResults(results);
+
+    CataloguePageCacheStats cache = CataloguePageCache::getInstance().getStats();
+    printf("\nPage cache: %zu/%zu bytes in %zu pages (%zu pinned), %u hits, %u misses, "
+           "%u evictions\n",
+           cache.used_bytes, cache.budget_bytes, cache.pages, cache.pinned_pages, cache.hits,
+           cache.misses, cache.evictions);
+
+    size_t mismatches = 0;
+    for (const PhaseStats& phase : results)
+        mismatches += phase.mismatches;
+    printf("\n%s: %zu mismatches\n", mismatches ? "FAILED" : "PASSED", mismatches);
+    return mismatches ? 1 : 0;
+}
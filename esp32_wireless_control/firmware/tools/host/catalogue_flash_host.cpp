@@ -0,0 +1,41 @@
+#include <string.h>
+#include <vector>
+
+#include "catalogue_flash_host.h"
+
+static std::vector<uint8_t> partition;
+
+void catalogueFlashHostReset(size_t capacity)
+{
+    partition.assign(capacity, 0xFF);
+}
+
+size_t catalogueFlashCapacity()
+{
+    return partition.size();
+}
+
+const uint8_t* catalogueFlashMap()
+{
+    return partition.empty() ? nullptr : partition.data();
+}
+
+bool catalogueFlashErase(size_t offset, size_t length)
+{
+    if (offset % CATALOGUE_FLASH_SECTOR_SIZE != 0 || length % CATALOGUE_FLASH_SECTOR_SIZE != 0 ||
+        offset + length > partition.size())
+        return false;
+
+    memset(partition.data() + offset, 0xFF, length);
+    return true;
+}
+
+bool catalogueFlashWrite(size_t offset, const uint8_t* data, size_t length)
+{
+    if (offset + length > partition.size())
+        return false;
+
+    for (size_t i = 0; i < length; i++)
+        partition[offset + i] &= data[i];
+    return true;
+}
@@ -0,0 +1,25 @@
+/**
+ * @file catalogue_flash_host.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef CATALOGUE_FLASH_HOST_H
+#define CATALOGUE_FLASH_HOST_H
+
+#include <stddef.h>
+
+#include "catalogues/catalogue_flash.h"
+
+/**
+ * @brief Replace the emulated catalogue partition with an erased one
+ * @param capacity Partition size in bytes, 0 emulates a partition table without it
+ *
+ * The host partition lives in RAM and behaves like NOR flash: erases must be
+ * sector aligned and set all bits, writes can only clear bits.
+ */
+void catalogueFlashHostReset(size_t capacity);
+
+#endif // CATALOGUE_FLASH_HOST_H
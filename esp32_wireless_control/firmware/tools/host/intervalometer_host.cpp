@@ -0,0 +1,181 @@
+/**
+ * @file intervalometer_host.cpp
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ *
+ * Simulated Intervalometer for the host, replaces intervalometer.cpp and the
+ * modes. No task runs and no trigger pin is driven: the state of a capture
+ * follows from the time since startCapture() and the settings, with one
+ * second of the sequence lasting HOST_CAPTURE_MS_PER_SECOND. Presets are
+ * kept in the emulated EEPROM like on the target.
+ */
+
+#include "configs/config.h"
+#include "eeprom_manager.h"
+#include "functions/intervalometer/intervalometer.h"
+#include "uart.h"
+
+// A 30 s exposure takes 300 ms
+#define HOST_CAPTURE_MS_PER_SECOND 10
+
+struct CaptureSimulation
+{
+    bool started;
+    bool aborted;
+    TickType_t start;
+};
+
+// There is one intervalometer, like on the target
+static CaptureSimulation capture = {false, false, 0};
+
+// Position in the sequence, in simulated seconds since the start
+struct CaptureProgress
+{
+    IntervalometerMode::State state;
+    uint16_t exposure;
+    uint16_t taken;
+};
+
+static CaptureProgress captureProgress(const IntervalometerMode::Settings& settings)
+{
+    if (!capture.started || capture.aborted)
+        return {IntervalometerMode::State::Inactive, 0, 0};
+
+    uint32_t elapsed = (xTaskGetTickCount() - capture.start) / HOST_CAPTURE_MS_PER_SECOND;
+    if (elapsed < settings.preDelay)
+        return {IntervalometerMode::State::PreDelay, 1, 0};
+
+    uint32_t cycle = settings.exposureTime + settings.delayTime;
+    uint32_t index = cycle > 0 ? (elapsed - settings.preDelay) / cycle : settings.exposures;
+    if (index >= settings.exposures)
+        return {IntervalometerMode::State::Complete, settings.exposures, settings.exposures};
+
+    uint32_t offset = (elapsed - settings.preDelay) % cycle;
+    if (offset < settings.exposureTime)
+        return {IntervalometerMode::State::Capture, (uint16_t) (index + 1), (uint16_t) index};
+
+    bool dither = settings.dither && settings.ditherFrequency > 0 &&
+                  (index + 1) % settings.ditherFrequency == 0;
+    return {dither ? IntervalometerMode::State::Dither : IntervalometerMode::State::Delay,
+            (uint16_t) (index + 1), (uint16_t) (index + 1)};
+}
+
+Intervalometer::Intervalometer(uint8_t triggerPinArg)
+    : triggerPin(triggerPinArg), currentMode(Mode::LongExposureStill),
+      currentErrorMessage(ERR_MSG_NONE), activeMode(nullptr)
+{
+    currentSettings = Settings();
+}
+
+Intervalometer::~Intervalometer()
+{
+    capture = {false, false, 0};
+}
+
+void Intervalometer::startCapture()
+{
+    if (isActive())
+    {
+        print_out("ERROR: Capture already active");
+        return;
+    }
+
+    capture = {true, false, xTaskGetTickCount()};
+    print_out("Capture started successfully");
+}
+
+void Intervalometer::abortCapture()
+{
+    if (capture.started)
+        capture.aborted = true;
+}
+
+bool Intervalometer::isActive() const
+{
+    IntervalometerMode::State state = captureProgress(currentSettings).state;
+    return state != IntervalometerMode::State::Inactive &&
+           state != IntervalometerMode::State::Complete;
+}
+
+void Intervalometer::cleanup()
+{
+    if (capture.started && !isActive())
+        capture = {false, false, 0};
+}
+
+IntervalometerMode* Intervalometer::createModeInstance()
+{
+    return nullptr;
+}
+
+uint16_t Intervalometer::getCurrentExposure() const
+{
+    return captureProgress(currentSettings).exposure;
+}
+
+uint16_t Intervalometer::getExposuresTaken() const
+{
+    return captureProgress(currentSettings).taken;
+}
+
+TickType_t Intervalometer::getStartCaptureTickCount() const
+{
+    return capture.started ? capture.start : 0;
+}
+
+TickType_t Intervalometer::getCaptureDurationTickCount() const
+{
+    if (!capture.started)
+        return 0;
+    uint32_t seconds = currentSettings.preDelay +
+                       (uint32_t) currentSettings.exposures *
+                           (currentSettings.exposureTime + currentSettings.delayTime);
+    return seconds * HOST_CAPTURE_MS_PER_SECOND;
+}
+
+IntervalometerMode::State Intervalometer::getState() const
+{
+    return captureProgress(currentSettings).state;
+}
+
+void Intervalometer::setSettings(const Settings& settings)
+{
+    currentSettings = settings;
+}
+
+void Intervalometer::saveSettingsToPreset(uint8_t preset)
+{
+    if (preset >= 10)
+    {
+        print_out("ERROR: Invalid preset number: %d", preset);
+        return;
+    }
+
+    currentSettings.mode = static_cast<uint8_t>(currentMode);
+    presets[preset] = currentSettings;
+    savePresetsToEEPROM();
+}
+
+void Intervalometer::readSettingsFromPreset(uint8_t preset)
+{
+    if (preset >= 10)
+    {
+        print_out("ERROR: Invalid preset number: %d", preset);
+        return;
+    }
+
+    currentSettings = presets[preset];
+    currentMode = static_cast<Mode>(currentSettings.mode);
+}
+
+void Intervalometer::savePresetsToEEPROM()
+{
+    EepromManager::writePresets(PRESETS_EEPROM_START_LOCATION, presets);
+}
+
+void Intervalometer::readPresetsFromEEPROM()
+{
+    EepromManager::readPresets(PRESETS_EEPROM_START_LOCATION, presets);
+}
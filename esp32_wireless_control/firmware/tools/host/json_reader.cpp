@@ -0,0 +1,279 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_reader.h"
+
+namespace
+{
+
+class JsonParser
+{
+  public:
+    JsonParser(const std::string& text) : _text(text), _pos(0)
+    {
+    }
+
+    bool parseDocument(JsonValue& out, std::string& error)
+    {
+        if (!parseValue(out))
+        {
+            error = _error.empty() ? "Unexpected input" : _error;
+            error += " at offset " + std::to_string(_pos);
+            return false;
+        }
+        skipWhitespace();
+        if (_pos != _text.size())
+        {
+            error = "Trailing data at offset " + std::to_string(_pos);
+            return false;
+        }
+        return true;
+    }
+
+  private:
+    void skipWhitespace()
+    {
+        while (_pos < _text.size() && strchr(" \t\r\n", _text[_pos]) != nullptr)
+            _pos++;
+    }
+
+    bool consume(char c)
+    {
+        skipWhitespace();
+        if (_pos < _text.size() && _text[_pos] == c)
+        {
+            _pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeWord(const char* word)
+    {
+        size_t len = strlen(word);
+        if (_text.compare(_pos, len, word) != 0)
+            return false;
+        _pos += len;
+        return true;
+    }
+
+    bool parseValue(JsonValue& out)
+    {
+        skipWhitespace();
+        if (_pos >= _text.size())
+            return false;
+
+        char c = _text[_pos];
+        if (c == '{')
+            return parseObject(out);
+        if (c == '[')
+            return parseArray(out);
+        if (c == '"')
+        {
+            out.type = JsonValue::JSON_STRING;
+            return parseString(out.string);
+        }
+        if (consumeWord("true") || consumeWord("false"))
+        {
+            out.type = JsonValue::JSON_BOOL;
+            out.number = c == 't' ? 1.0 : 0.0;
+            return true;
+        }
+        if (consumeWord("null"))
+        {
+            out.type = JsonValue::JSON_NULL;
+            return true;
+        }
+        return parseNumber(out);
+    }
+
+    bool parseObject(JsonValue& out)
+    {
+        out.type = JsonValue::JSON_OBJECT;
+        _pos++;
+        if (consume('}'))
+            return true;
+
+        do
+        {
+            std::string key;
+            skipWhitespace();
+            if (!parseString(key) || !consume(':'))
+                return false;
+            out.members.emplace_back(key, JsonValue());
+            if (!parseValue(out.members.back().second))
+                return false;
+        } while (consume(','));
+
+        return consume('}');
+    }
+
+    bool parseArray(JsonValue& out)
+    {
+        out.type = JsonValue::JSON_ARRAY;
+        _pos++;
+        if (consume(']'))
+            return true;
+
+        do
+        {
+            out.items.emplace_back();
+            if (!parseValue(out.items.back()))
+                return false;
+        } while (consume(','));
+
+        return consume(']');
+    }
+
+    bool parseNumber(JsonValue& out)
+    {
+        const char* start = _text.c_str() + _pos;
+        char* end;
+        out.number = strtod(start, &end);
+        if (end == start)
+            return false;
+        out.type = JsonValue::JSON_NUMBER;
+        _pos += end - start;
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, unsigned long cp)
+    {
+        if (cp < 0x80)
+        {
+            out += (char) cp;
+        }
+        else if (cp < 0x800)
+        {
+            out += (char) (0xC0 | (cp >> 6));
+            out += (char) (0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            out += (char) (0xE0 | (cp >> 12));
+            out += (char) (0x80 | ((cp >> 6) & 0x3F));
+            out += (char) (0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            out += (char) (0xF0 | (cp >> 18));
+            out += (char) (0x80 | ((cp >> 12) & 0x3F));
+            out += (char) (0x80 | ((cp >> 6) & 0x3F));
+            out += (char) (0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool parseHex4(unsigned long& value)
+    {
+        if (_pos + 4 > _text.size())
+            return false;
+        std::string hex = _text.substr(_pos, 4);
+        char* end;
+        value = strtoul(hex.c_str(), &end, 16);
+        if (end != hex.c_str() + 4)
+            return false;
+        _pos += 4;
+        return true;
+    }
+
+    bool parseString(std::string& out)
+    {
+        if (_pos >= _text.size() || _text[_pos] != '"')
+            return false;
+        _pos++;
+
+        while (_pos < _text.size())
+        {
+            char c = _text[_pos++];
+            if (c == '"')
+                return true;
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+            if (_pos >= _text.size())
+                break;
+
+            char escape = _text[_pos++];
+            switch (escape)
+            {
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                {
+                    unsigned long cp;
+                    if (!parseHex4(cp))
+                        return false;
+                    // Surrogate pair
+                    if (cp >= 0xD800 && cp < 0xDC00 && _text.compare(_pos, 2, "\\u") == 0)
+                    {
+                        unsigned long low;
+                        _pos += 2;
+                        if (!parseHex4(low))
+                            return false;
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    out += escape;
+                    break;
+            }
+        }
+
+        _error = "Unterminated string";
+        return false;
+    }
+
+    const std::string& _text;
+    size_t _pos;
+    std::string _error;
+};
+
+} // namespace
+
+bool JsonValue::parse(const std::string& text, JsonValue& out, std::string& error)
+{
+    out = JsonValue();
+    JsonParser parser(text);
+    return parser.parseDocument(out, error);
+}
+
+const JsonValue* JsonValue::get(const char* key) const
+{
+    if (type != JSON_OBJECT)
+        return nullptr;
+    for (const auto& member : members)
+    {
+        if (member.first == key)
+            return &member.second;
+    }
+    return nullptr;
+}
+
+double JsonValue::getNumber(const char* key, double fallback) const
+{
+    const JsonValue* value = get(key);
+    return value && value->type == JSON_NUMBER ? value->number : fallback;
+}
+
+std::string JsonValue::getString(const char* key) const
+{
+    const JsonValue* value = get(key);
+    return value && value->type == JSON_STRING ? value->string : std::string();
+}
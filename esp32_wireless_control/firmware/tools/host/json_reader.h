@@ -0,0 +1,54 @@
+/**
+ * @file json_reader.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Small JSON reader for the JSON twins of the converted catalogues
+ *
+ * Covers the full JSON grammar the converters emit (objects, arrays,
+ * strings with escapes, numbers, true/false/null). Not meant for untrusted
+ * input or for use on the target.
+ */
+class JsonValue
+{
+  public:
+    enum Type
+    {
+        JSON_NULL,
+        JSON_BOOL,
+        JSON_NUMBER,
+        JSON_STRING,
+        JSON_ARRAY,
+        JSON_OBJECT
+    };
+
+    JsonValue() : type(JSON_NULL), number(0.0)
+    {
+    }
+
+    static bool parse(const std::string& text, JsonValue& out, std::string& error);
+
+    // Object member lookup, nullptr if missing or not an object
+    const JsonValue* get(const char* key) const;
+    double getNumber(const char* key, double fallback = 0.0) const;
+    std::string getString(const char* key) const;
+
+    Type type;
+    double number;
+    std::string string;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+};
+
+#endif // JSON_READER_H
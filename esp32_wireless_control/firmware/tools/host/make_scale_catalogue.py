@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+"""
+Synthetic Hipparcos-shaped catalogue for the scale checks of catalogue_bench
+
+Writes a hip_main.dat lookalike with a fixed seed and converts it with
+catalogues/hipparcos/hipparcos_convert.py, so the blob goes through the
+same converter as the real catalogue. Stars are spread uniformly over the
+sky with a magnitude distribution that grows towards faint stars.
+
+Usage:
+  python3 make_scale_catalogue.py build/scale_hip_main.dat build/scale_hipparcos.bin
+"""
+
+import argparse
+import math
+import os
+import random
+import subprocess
+import sys
+
+BASE = os.path.dirname(os.path.abspath(__file__))
+CONVERTER = os.path.join(BASE, '..', '..', 'catalogues', 'hipparcos', 'hipparcos_convert.py')
+SPECTRAL_TYPES = ['O9V', 'B2III', 'A0V', 'A5m', 'F2IV', 'F8V', 'G2V', 'G8III', 'K0III',
+                  'K5V', 'M0III', 'M4.5V']
+
+
+def write_source(path, count, seed):
+    rng = random.Random(seed)
+    with open(path, 'w', encoding='ascii') as f:
+        for hip in range(1, count + 1):
+            fields = [''] * 78
+            fields[0] = 'H'
+            fields[1] = f'{hip:12d}'
+            # Star counts roughly triple per magnitude, skew towards the faint end
+            fields[5] = f'{3.0 + math.log(1.0 + rng.random() * 19682.0, 3.0):5.2f}'
+            fields[8] = f'{rng.uniform(0.0, 360.0):12.8f}'
+            fields[9] = f'{math.degrees(math.asin(rng.uniform(-1.0, 1.0))):+12.8f}'
+            fields[12] = f'{rng.gauss(0.0, 50.0):8.2f}'
+            fields[13] = f'{rng.gauss(0.0, 50.0):8.2f}'
+            fields[76] = rng.choice(SPECTRAL_TYPES)
+            f.write('|'.join(fields) + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Write the synthetic scale catalogue')
+    parser.add_argument('source', help='Synthetic hip_main.dat to write')
+    parser.add_argument('output', help='Catalogue blob to write')
+    parser.add_argument('--count', type=int, default=120000, help='Number of stars')
+    parser.add_argument('--seed', type=int, default=1989, help='Random seed')
+    args = parser.parse_args()
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.source)), exist_ok=True)
+    write_source(args.source, args.count, args.seed)
+    return subprocess.call([sys.executable, CONVERTER, '--input', args.source, '--output',
+                            args.output, '--max-magnitude', '99', '--binary'])
+
+
+if __name__ == '__main__':
+    sys.exit(main())
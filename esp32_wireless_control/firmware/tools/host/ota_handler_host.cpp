@@ -0,0 +1,174 @@
+/**
+ * @file ota_handler_host.cpp
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ *
+ * OTAHandler for the host, replaces ota_handler.cpp. The requests and
+ * responses are those of the target, but an upload is only counted and
+ * never written to flash, and the host has no internet connection: the
+ * version check answers with that error and a download fails at once.
+ */
+
+#include <ArduinoJson.h>
+#include <uart.h>
+
+#include "configs/config.h"
+#include "functions/ota/ota_handler.h"
+#include "website/api_handler.h"
+#include "website/embedded_asset.h"
+#include "website/website_strings.h"
+
+extern void systemShutdown();
+
+// Minified and compressed by shared/web_assets.py
+extern const uint8_t _interface_dist_ota_html_gz_start[] asm(
+    "_binary_interface_dist_ota_html_gz_start");
+extern const uint8_t _interface_dist_ota_html_gz_end[] asm(
+    "_binary_interface_dist_ota_html_gz_end");
+
+OTAHandler& OTAHandler::getInstance()
+{
+    static OTAHandler instance;
+    return instance;
+}
+
+void OTAHandler::init(WebServer* server)
+{
+    _server = server;
+    resetOTAState();
+}
+
+void OTAHandler::resetOTAState()
+{
+    otaActive = false;
+    otaComplete = false;
+    otaError = false;
+    otaBytesWritten = 0;
+    otaTotalBytes = 0;
+}
+
+void OTAHandler::rebootWithDelay(int delaySeconds)
+{
+    for (int i = delaySeconds; i > 0; i--)
+    {
+        _server->handleClient();
+        vTaskDelay(1000);
+    }
+    systemShutdown();
+}
+
+String OTAHandler::getCurrentVersion()
+{
+#ifdef BUILD_VERSION
+    return String(BUILD_VERSION);
+#else
+    return String("v") + String(INTERNAL_VERSION);
+#endif
+}
+
+String OTAHandler::getCurrentBuildDate()
+{
+    return String(__DATE__) + " " + String(__TIME__);
+}
+
+void OTAHandler::handleOTAPage()
+{
+    if (!_server)
+        return;
+
+    resetOTAState();
+    ApiHandler& api = ApiHandler::getInstance();
+    if (!api.hasTransferRoom())
+        return;
+    static EmbeddedAsset page(_interface_dist_ota_html_gz_start, _interface_dist_ota_html_gz_end);
+    if (page.sendValidators(_server, "no-cache"))
+        return;
+    _server->sendHeader("Content-Encoding", "gzip");
+    // Sent in the background like the main page, a slow link holds up no other request
+    api.sendInBackground(200, MIME_TYPE_HTML, page.getData(), page.getLength());
+}
+
+void OTAHandler::handleOTAUpload()
+{
+    HTTPUpload& upload = _server->upload();
+    if (upload.status == UPLOAD_FILE_START)
+    {
+        _updating = true;
+        _updateProgress = 0;
+        resetOTAState();
+        otaActive = true;
+    }
+    else if (upload.status == UPLOAD_FILE_WRITE)
+    {
+        _updateProgress += upload.currentSize;
+        otaBytesWritten += upload.currentSize;
+        if (upload.totalSize > 0)
+            otaTotalBytes = upload.totalSize;
+    }
+    else if (upload.status == UPLOAD_FILE_END)
+    {
+        otaTotalBytes = upload.totalSize;
+        otaBytesWritten = upload.totalSize;
+        _updating = false;
+        otaActive = false;
+        otaComplete = !otaError;
+    }
+    else if (upload.status == UPLOAD_FILE_ABORTED)
+    {
+        otaError = true;
+        _updating = false;
+        otaActive = false;
+    }
+}
+
+void OTAHandler::handleOTAComplete()
+{
+    _server->send(200, MIME_TYPE_TEXT, otaError ? "Update Failed" : "Update Success! Rebooting...");
+    if (!otaError && otaComplete)
+        rebootWithDelay();
+}
+
+void OTAHandler::handleCheckVersion()
+{
+    if (!_server)
+        return;
+
+    JsonDocument doc;
+    doc["currentVersion"] = getCurrentVersion();
+    doc["buildDate"] = getCurrentBuildDate();
+    doc["error"] = "No internet connection";
+
+    String response;
+    serializeJson(doc, response);
+    _server->send(200, MIME_APPLICATION_JSON, response);
+}
+
+void OTAHandler::handleDownloadUpdate()
+{
+    if (!_server->hasArg("url"))
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Missing URL parameter");
+        return;
+    }
+
+    _server->send(200, MIME_TYPE_TEXT, "Starting download...");
+    resetOTAState();
+    otaError = true;
+}
+
+void OTAHandler::handleOTAStatus()
+{
+    JsonDocument doc;
+    doc["active"] = otaActive;
+    doc["complete"] = otaComplete;
+    doc["error"] = otaError;
+    doc["bytesWritten"] = (unsigned long) otaBytesWritten;
+    doc["totalBytes"] = (unsigned long) otaTotalBytes;
+    doc["percent"] = otaTotalBytes > 0 ? (otaBytesWritten * 100) / otaTotalBytes : 0;
+
+    String response;
+    serializeJson(doc, response);
+    _server->send(200, MIME_APPLICATION_JSON, response);
+}
@@ -0,0 +1,40 @@
+/**
+ * @file EEPROM.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+// EEPROM emulation kept in RAM, starts erased (0xFF) and is lost at exit
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HOST_EEPROM_SIZE 4096
+
+class EEPROMClass
+{
+  public:
+    EEPROMClass();
+
+    bool begin(size_t size);
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    bool commit();
+    size_t length()
+    {
+        return _size;
+    }
+
+  private:
+    uint8_t _data[HOST_EEPROM_SIZE];
+    size_t _size;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // HOST_EEPROM_H
@@ -0,0 +1,16 @@
+/**
+ * @file ErriezSerialTerminal.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef HOST_ERRIEZ_SERIAL_TERMINAL_H
+#define HOST_ERRIEZ_SERIAL_TERMINAL_H
+
+// The serial console is not built on the host, commands.h only needs the name
+
+class SerialTerminal;
+
+#endif // HOST_ERRIEZ_SERIAL_TERMINAL_H
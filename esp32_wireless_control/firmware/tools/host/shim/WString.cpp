@@ -0,0 +1,333 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "WString.h"
+
+StringStats stringStats;
+
+String::String(const char* cstr) : _heap(nullptr), _cap(SSO_SIZE - 1), _len(0)
+{
+    stringStats.constructions++;
+    _sso[0] = '\0';
+    if (cstr)
+        assign(cstr, strlen(cstr));
+}
+
+String::String(const char* cstr, unsigned int length)
+    : _heap(nullptr), _cap(SSO_SIZE - 1), _len(0)
+{
+    stringStats.constructions++;
+    _sso[0] = '\0';
+    if (cstr)
+        assign(cstr, length);
+}
+
+String::String(const String& str) : _heap(nullptr), _cap(SSO_SIZE - 1), _len(0)
+{
+    stringStats.constructions++;
+    stringStats.copies++;
+    _sso[0] = '\0';
+    assign(str.buffer(), str._len);
+}
+
+String::String(String&& str) : _heap(str._heap), _cap(str._cap), _len(str._len)
+{
+    stringStats.constructions++;
+    memcpy(_sso, str._sso, SSO_SIZE);
+    str._heap = nullptr;
+    str._cap = SSO_SIZE - 1;
+    str._len = 0;
+    str._sso[0] = '\0';
+}
+
+String::String(char c) : String(&c, 1)
+{
+}
+
+String::String(int value, unsigned char base) : String((long) value, base)
+{
+}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long) value, base)
+{
+}
+
+String::String(long value, unsigned char base) : String((long long) value, base)
+{
+}
+
+String::String(unsigned long value, unsigned char base) : String((unsigned long long) value, base)
+{
+}
+
+String::String(long long value, unsigned char base)
+    : _heap(nullptr), _cap(SSO_SIZE - 1), _len(0)
+{
+    stringStats.constructions++;
+    char buf[2 + 8 * sizeof(long long)];
+    if (base == 10)
+        snprintf(buf, sizeof(buf), "%lld", value);
+    else
+        snprintf(buf, sizeof(buf), base == 16 ? "%llx" : "%llo", value);
+    _sso[0] = '\0';
+    assign(buf, strlen(buf));
+}
+
+String::String(unsigned long long value, unsigned char base)
+    : _heap(nullptr), _cap(SSO_SIZE - 1), _len(0)
+{
+    stringStats.constructions++;
+    char buf[1 + 8 * sizeof(unsigned long long)];
+    snprintf(buf, sizeof(buf), base == 16 ? "%llx" : (base == 8 ? "%llo" : "%llu"), value);
+    _sso[0] = '\0';
+    assign(buf, strlen(buf));
+}
+
+String::String(float value, unsigned int decimal_places) : String((double) value, decimal_places)
+{
+}
+
+String::String(double value, unsigned int decimal_places)
+    : _heap(nullptr), _cap(SSO_SIZE - 1), _len(0)
+{
+    stringStats.constructions++;
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int) decimal_places, value);
+    _sso[0] = '\0';
+    assign(buf, strlen(buf));
+}
+
+String::~String()
+{
+    release();
+}
+
+String& String::operator=(const String& rhs)
+{
+    stringStats.copies++;
+    if (this != &rhs)
+        assign(rhs.buffer(), rhs._len);
+    return *this;
+}
+
+String& String::operator=(String&& rhs)
+{
+    if (this != &rhs)
+    {
+        release();
+        _heap = rhs._heap;
+        _cap = rhs._cap;
+        _len = rhs._len;
+        memcpy(_sso, rhs._sso, SSO_SIZE);
+        rhs._heap = nullptr;
+        rhs._cap = SSO_SIZE - 1;
+        rhs._len = 0;
+        rhs._sso[0] = '\0';
+    }
+    return *this;
+}
+
+String& String::operator=(const char* cstr)
+{
+    if (cstr)
+        assign(cstr, strlen(cstr));
+    else
+        assign("", 0);
+    return *this;
+}
+
+bool String::reserve(unsigned int size)
+{
+    if (size <= _cap)
+        return true;
+
+    // Same growth policy as arduino-esp32: round up to 16 bytes
+    unsigned int new_size = (size + 16) & ~0xf;
+    char* heap = (char*) (isSSO() ? malloc(new_size) : realloc(_heap, new_size));
+    if (heap == nullptr)
+        return false;
+    stringStats.heap_allocations++;
+    if (isSSO())
+        memcpy(heap, _sso, _len + 1);
+    _heap = heap;
+    _cap = new_size - 1;
+    return true;
+}
+
+void String::assign(const char* cstr, unsigned int length)
+{
+    if (!reserve(length))
+        return;
+    memmove(buffer(), cstr, length);
+    buffer()[length] = '\0';
+    _len = length;
+}
+
+void String::release()
+{
+    free(_heap);
+    _heap = nullptr;
+    _cap = SSO_SIZE - 1;
+    _len = 0;
+    _sso[0] = '\0';
+}
+
+bool String::concat(const String& str)
+{
+    return concat(str.buffer(), str._len);
+}
+
+bool String::concat(const char* cstr)
+{
+    return cstr && concat(cstr, strlen(cstr));
+}
+
+bool String::concat(const char* cstr, unsigned int length)
+{
+    if (!reserve(_len + length))
+        return false;
+    memmove(buffer() + _len, cstr, length);
+    _len += length;
+    buffer()[_len] = '\0';
+    return true;
+}
+
+bool String::concat(char c)
+{
+    return concat(&c, 1);
+}
+
+String operator+(const String& lhs, const String& rhs)
+{
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const String& lhs, const char* rhs)
+{
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const char* lhs, const String& rhs)
+{
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+int String::compareTo(const String& str) const
+{
+    return strcmp(buffer(), str.buffer());
+}
+
+bool String::equals(const String& str) const
+{
+    return _len == str._len && memcmp(buffer(), str.buffer(), _len) == 0;
+}
+
+bool String::equals(const char* cstr) const
+{
+    return strcmp(buffer(), cstr ? cstr : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String& str) const
+{
+    return _len == str._len && strcasecmp(buffer(), str.buffer()) == 0;
+}
+
+bool String::startsWith(const String& prefix) const
+{
+    return prefix._len <= _len && memcmp(buffer(), prefix.buffer(), prefix._len) == 0;
+}
+
+bool String::endsWith(const String& suffix) const
+{
+    return suffix._len <= _len &&
+           memcmp(buffer() + _len - suffix._len, suffix.buffer(), suffix._len) == 0;
+}
+
+char String::charAt(unsigned int index) const
+{
+    return index < _len ? buffer()[index] : '\0';
+}
+
+int String::indexOf(char c, unsigned int from) const
+{
+    if (from >= _len)
+        return -1;
+    const char* found = strchr(buffer() + from, c);
+    return found ? (int) (found - buffer()) : -1;
+}
+
+int String::indexOf(const String& str, unsigned int from) const
+{
+    if (from > _len)
+        return -1;
+    const char* found = strstr(buffer() + from, str.buffer());
+    return found ? (int) (found - buffer()) : -1;
+}
+
+String String::substring(unsigned int begin) const
+{
+    return substring(begin, _len);
+}
+
+String String::substring(unsigned int begin, unsigned int end) const
+{
+    if (begin > end)
+    {
+        unsigned int tmp = begin;
+        begin = end;
+        end = tmp;
+    }
+    if (begin >= _len)
+        return String();
+    if (end > _len)
+        end = _len;
+    return String(buffer() + begin, end - begin);
+}
+
+void String::toLowerCase()
+{
+    for (unsigned int i = 0; i < _len; i++)
+        buffer()[i] = tolower((unsigned char) buffer()[i]);
+}
+
+void String::toUpperCase()
+{
+    for (unsigned int i = 0; i < _len; i++)
+        buffer()[i] = toupper((unsigned char) buffer()[i]);
+}
+
+void String::trim()
+{
+    unsigned int begin = 0;
+    while (begin < _len && isspace((unsigned char) buffer()[begin]))
+        begin++;
+    unsigned int end = _len;
+    while (end > begin && isspace((unsigned char) buffer()[end - 1]))
+        end--;
+    memmove(buffer(), buffer() + begin, end - begin);
+    _len = end - begin;
+    buffer()[_len] = '\0';
+}
+
+long String::toInt() const
+{
+    return atol(buffer());
+}
+
+float String::toFloat() const
+{
+    return (float) atof(buffer());
+}
+
+double String::toDouble() const
+{
+    return atof(buffer());
+}
@@ -0,0 +1,162 @@
+/**
+ * @file WString.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Host stand-in for the Arduino String class
+ *
+ * Only the subset used by the firmware sources built on the host. Storage
+ * follows arduino-esp32: strings of up to 14 characters live inline (SSO),
+ * longer ones in a heap buffer rounded up to 16 bytes. This keeps the
+ * allocation counts of the host harness representative of the target.
+ */
+class String
+{
+  public:
+    String(const char* cstr = "");
+    String(const char* cstr, unsigned int length);
+    String(const String& str);
+    String(String&& str);
+    explicit String(char c);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimal_places = 2);
+    explicit String(double value, unsigned int decimal_places = 2);
+    ~String();
+
+    String& operator=(const String& rhs);
+    String& operator=(String&& rhs);
+    String& operator=(const char* cstr);
+
+    bool reserve(unsigned int size);
+    unsigned int length() const
+    {
+        return _len;
+    }
+    bool isEmpty() const
+    {
+        return _len == 0;
+    }
+    const char* c_str() const
+    {
+        return buffer();
+    }
+
+    bool concat(const String& str);
+    bool concat(const char* cstr);
+    bool concat(const char* cstr, unsigned int length);
+    bool concat(char c);
+    String& operator+=(const String& rhs)
+    {
+        concat(rhs);
+        return *this;
+    }
+    String& operator+=(const char* cstr)
+    {
+        concat(cstr);
+        return *this;
+    }
+    String& operator+=(char c)
+    {
+        concat(c);
+        return *this;
+    }
+
+    friend String operator+(const String& lhs, const String& rhs);
+    friend String operator+(const String& lhs, const char* rhs);
+    friend String operator+(const char* lhs, const String& rhs);
+
+    int compareTo(const String& str) const;
+    bool equals(const String& str) const;
+    bool equals(const char* cstr) const;
+    bool equalsIgnoreCase(const String& str) const;
+    bool startsWith(const String& prefix) const;
+    bool endsWith(const String& suffix) const;
+    bool operator==(const String& rhs) const
+    {
+        return equals(rhs);
+    }
+    bool operator==(const char* cstr) const
+    {
+        return equals(cstr);
+    }
+    bool operator!=(const String& rhs) const
+    {
+        return !equals(rhs);
+    }
+    bool operator!=(const char* cstr) const
+    {
+        return !equals(cstr);
+    }
+    bool operator<(const String& rhs) const
+    {
+        return compareTo(rhs) < 0;
+    }
+
+    char charAt(unsigned int index) const;
+    char operator[](unsigned int index) const
+    {
+        return charAt(index);
+    }
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& str, unsigned int from = 0) const;
+    String substring(unsigned int begin) const;
+    String substring(unsigned int begin, unsigned int end) const;
+
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+  private:
+    // arduino-esp32 keeps 15 bytes inline on the 32-bit target
+    static const unsigned int SSO_SIZE = 15;
+
+    bool isSSO() const
+    {
+        return _heap == nullptr;
+    }
+    char* buffer()
+    {
+        return isSSO() ? _sso : _heap;
+    }
+    const char* buffer() const
+    {
+        return isSSO() ? _sso : _heap;
+    }
+    void assign(const char* cstr, unsigned int length);
+    void release();
+
+    char _sso[SSO_SIZE];
+    char* _heap;
+    unsigned int _cap;
+    unsigned int _len;
+};
+
+// Host only, String churn seen by the harnesses. Not part of the Arduino API.
+struct StringStats
+{
+    uint64_t constructions;    // Strings created, copies and moves included
+    uint64_t copies;           // Copy constructions and copy assignments
+    uint64_t heap_allocations; // Buffers allocated or grown on the heap
+};
+
+extern StringStats stringStats;
+
+#endif // HOST_WSTRING_H
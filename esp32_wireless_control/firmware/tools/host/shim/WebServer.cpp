@@ -0,0 +1,233 @@
+#include <fcntl.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+
+#include "WebServer.h"
+
+WebServer::WebServer(int)
+    : _request(nullptr), _response(nullptr), _content_length(CONTENT_LENGTH_NOT_SET),
+      _send_buffer(0), _upload()
+{
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler)
+{
+    on(uri, method, handler, THandlerFunction());
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler,
+                   THandlerFunction upload)
+{
+    _routes.push_back({uri.c_str(), method, handler, upload});
+}
+
+void WebServer::collectHeaders(const char* headerKeys[], const size_t headerKeysCount)
+{
+    _collected.assign(headerKeys, headerKeys + headerKeysCount);
+}
+
+String WebServer::arg(const String& name) const
+{
+    for (int i = 0; i < args(); i++)
+    {
+        if (argName(i) == name)
+            return arg(i);
+    }
+    return String();
+}
+
+String WebServer::arg(int i) const
+{
+    if (_request == nullptr || i < 0 || i >= args())
+        return String();
+    if ((size_t) i == _request->args.size())
+        return String(_request->body.c_str(), _request->body.size());
+    return String(_request->args[i].second.c_str());
+}
+
+String WebServer::argName(int i) const
+{
+    if (_request == nullptr || i < 0 || i >= args())
+        return String();
+    // A body that is not a form comes last as "plain", like on the target
+    if ((size_t) i == _request->args.size())
+        return String("plain");
+    return String(_request->args[i].first.c_str());
+}
+
+int WebServer::args() const
+{
+    if (_request == nullptr)
+        return 0;
+    return _request->args.size() + (_request->body.empty() ? 0 : 1);
+}
+
+bool WebServer::hasArg(const String& name) const
+{
+    for (int i = 0; i < args(); i++)
+    {
+        if (argName(i) == name)
+            return true;
+    }
+    return false;
+}
+
+String WebServer::header(const String& name) const
+{
+    if (_request == nullptr)
+        return String();
+
+    // Headers that were not asked for by collectHeaders() are dropped while parsing
+    bool collected = false;
+    for (const std::string& key : _collected)
+        collected = collected || strcasecmp(key.c_str(), name.c_str()) == 0;
+    if (!collected)
+        return String();
+
+    for (const auto& field : _request->headers)
+    {
+        if (strcasecmp(field.first.c_str(), name.c_str()) == 0)
+            return String(field.second.c_str());
+    }
+    return String();
+}
+
+String WebServer::uri() const
+{
+    return _request != nullptr ? String(_request->uri.c_str()) : String();
+}
+
+void WebServer::send(int code, const char* content_type, const String& content)
+{
+    record(code, content_type, content.c_str(), content.length());
+}
+
+void WebServer::send(int code, const char* content_type, const char* content)
+{
+    record(code, content_type, content, strlen(content));
+}
+
+void WebServer::send(int code, const String& content_type, const String& content)
+{
+    record(code, content_type.c_str(), content.c_str(), content.length());
+}
+
+void WebServer::send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength)
+{
+    record(code, content_type, content, contentLength);
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first)
+{
+    std::pair<std::string, std::string> field(name.c_str(), value.c_str());
+    if (first)
+        _pending_headers.insert(_pending_headers.begin(), field);
+    else
+        _pending_headers.push_back(field);
+}
+
+void WebServer::setContentLength(const size_t contentLength)
+{
+    _content_length = contentLength;
+}
+
+void WebServer::sendContent(const String& content)
+{
+    sendContent(content.c_str(), content.length());
+}
+
+void WebServer::sendContent(const char* content, size_t contentLength)
+{
+    // The empty chunk that ends a chunked response adds nothing
+    if (_response != nullptr)
+        _response->body.append(content, contentLength);
+}
+
+bool WebServer::request(const HostRequest& request, HostResponse& response)
+{
+    response = HostResponse();
+    const Route* match = nullptr;
+    for (const Route& route : _routes)
+    {
+        if (route.uri == request.uri &&
+            (route.method == HTTP_ANY || route.method == request.method))
+        {
+            match = &route;
+            break;
+        }
+    }
+    if (match == nullptr)
+    {
+        response.code = 404;
+        response.type = "text/plain";
+        response.body = "Not found: " + request.uri;
+        return false;
+    }
+
+    // The server end does not block, writes wait in WiFiClient::write() with a timeout
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        return false;
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    if (_send_buffer > 0)
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &_send_buffer, sizeof(_send_buffer));
+    _client = WiFiClient(fds[0]);
+    response.peer = fds[1];
+
+    _request = &request;
+    _response = &response;
+    _pending_headers.clear();
+    _content_length = CONTENT_LENGTH_NOT_SET;
+
+    if (match->upload && !request.upload.empty())
+        runUpload(*match);
+    match->handler();
+
+    // The server lets go of the connection, copies the handler kept stay open
+    _client = WiFiClient();
+    _request = nullptr;
+    _response = nullptr;
+    return true;
+}
+
+void WebServer::runUpload(const Route& route)
+{
+    const std::string& data = _request->upload;
+    _upload.filename = "upload.bin";
+    _upload.name = "file";
+    _upload.type = "application/octet-stream";
+    _upload.totalSize = 0;
+    _upload.currentSize = 0;
+    _upload.status = UPLOAD_FILE_START;
+    route.upload();
+
+    for (size_t pos = 0; pos < data.size(); pos += HTTP_UPLOAD_BUFLEN)
+    {
+        size_t len = data.size() - pos < HTTP_UPLOAD_BUFLEN ? data.size() - pos
+                                                             : HTTP_UPLOAD_BUFLEN;
+        memcpy(_upload.buf, data.data() + pos, len);
+        _upload.currentSize = len;
+        _upload.totalSize += len;
+        _upload.status = UPLOAD_FILE_WRITE;
+        route.upload();
+    }
+
+    _upload.currentSize = 0;
+    _upload.status = UPLOAD_FILE_END;
+    route.upload();
+}
+
+void WebServer::record(int code, const char* content_type, const char* content, size_t length)
+{
+    if (_response == nullptr || _response->sends++ > 0)
+        return;
+
+    _response->code = code;
+    _response->type = content_type != nullptr ? content_type : "text/html";
+    _response->headers.swap(_pending_headers);
+    _response->content_length = _content_length;
+    _response->body.assign(content, length);
+    _pending_headers.clear();
+    _content_length = CONTENT_LENGTH_NOT_SET;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file WebServer.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef HOST_WEB_SERVER_H
+#define HOST_WEB_SERVER_H
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+enum HTTPMethod
+{
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+};
+
+enum HTTPUploadStatus
+{
+    UPLOAD_FILE_START,
+    UPLOAD_FILE_WRITE,
+    UPLOAD_FILE_END,
+    UPLOAD_FILE_ABORTED
+};
+
+#define HTTP_UPLOAD_BUFLEN 1436
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+#define CONTENT_LENGTH_NOT_SET ((size_t) -2)
+
+struct HTTPUpload
+{
+    HTTPUploadStatus status;
+    String filename;
+    String name;
+    String type;
+    size_t totalSize;
+    size_t currentSize;
+    uint8_t buf[HTTP_UPLOAD_BUFLEN];
+};
+
+typedef std::vector<std::pair<std::string, std::string>> HostFields;
+
+// A request as the harness hands it to the server
+struct HostRequest
+{
+    HTTPMethod method;
+    std::string uri;
+    HostFields args;    // Query or form arguments, in order
+    HostFields headers; // Only the collected ones reach the handler
+    std::string body;   // POST body, the "plain" argument
+    std::string upload; // File of a multipart upload, sent in HTTP_UPLOAD_BUFLEN chunks
+};
+
+// What the handler answered
+struct HostResponse
+{
+    int code = 0;                                   // 0 if the handler sent nothing
+    std::string type;                               // Content-Type
+    HostFields headers;                             // Headers sent with the response
+    std::string body;                               // Body written through the server
+    size_t content_length = CONTENT_LENGTH_NOT_SET; // As set by setContentLength()
+    size_t sends = 0;                               // send() calls, the first one counts
+    // Client end of the connection, the handler may keep writing to it after it returned
+    // (background transfers, event streams). The caller closes it, -1 if no route matched.
+    int peer = -1;
+};
+
+/**
+ * @brief Stand-in for the arduino-esp32 WebServer that runs handlers on demand
+ *
+ * Nothing listens: request() matches a route like the WebServer does,
+ * hands the handler a fresh connection (a socket pair) and records the
+ * status, headers and body it sends. The handler-facing API is the subset
+ * of WebServer the firmware uses, with the same behaviour for arguments,
+ * collected headers, chunked responses and multipart uploads.
+ */
+class WebServer
+{
+  public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    explicit WebServer(int port = 80);
+
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler,
+            THandlerFunction upload);
+    void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+    void handleClient()
+    {
+    }
+
+    String arg(const String& name) const;
+    String arg(int i) const;
+    String argName(int i) const;
+    int args() const;
+    bool hasArg(const String& name) const;
+    String header(const String& name) const;
+    HTTPMethod method() const
+    {
+        return _request != nullptr ? _request->method : HTTP_ANY;
+    }
+    String uri() const;
+    WiFiClient& client()
+    {
+        return _client;
+    }
+    HTTPUpload& upload()
+    {
+        return _upload;
+    }
+
+    void send(int code, const char* content_type = nullptr, const String& content = String(""));
+    void send(int code, const char* content_type, const char* content);
+    void send(int code, const String& content_type, const String& content);
+    void send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength);
+    void sendHeader(const String& name, const String& value, bool first = false);
+    void setContentLength(const size_t contentLength);
+    void sendContent(const String& content);
+    void sendContent(const char* content, size_t contentLength);
+
+    // Host only: run the handler of the route, false if none matched (404 is recorded)
+    bool request(const HostRequest& request, HostResponse& response);
+    // Host only: send buffer of the server end of later connections, 0 for the system default
+    void setSendBuffer(int bytes)
+    {
+        _send_buffer = bytes;
+    }
+    // Host only: the registered routes, for checking that a harness reached all of them
+    size_t getRouteCount() const
+    {
+        return _routes.size();
+    }
+    const char* getRouteUri(size_t i) const
+    {
+        return _routes[i].uri.c_str();
+    }
+    HTTPMethod getRouteMethod(size_t i) const
+    {
+        return _routes[i].method;
+    }
+
+  private:
+    struct Route
+    {
+        std::string uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+        THandlerFunction upload;
+    };
+
+    void runUpload(const Route& route);
+    void record(int code, const char* content_type, const char* content, size_t length);
+
+    std::vector<Route> _routes;
+    std::vector<std::string> _collected;
+    const HostRequest* _request;
+    HostResponse* _response;
+    HostFields _pending_headers;
+    size_t _content_length;
+    int _send_buffer;
+    WiFiClient _client;
+    HTTPUpload _upload;
+};
+
+#endif // HOST_WEB_SERVER_H
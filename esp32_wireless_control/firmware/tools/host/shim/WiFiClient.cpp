@@ -0,0 +1,64 @@
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "WiFiClient.h"
+
+WiFiClient::Socket::~Socket()
+{
+    close(fd);
+}
+
+WiFiClient::WiFiClient()
+{
+}
+
+WiFiClient::WiFiClient(int fd) : _socket(std::make_shared<Socket>(fd))
+{
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size)
+{
+    if (!_socket)
+        return 0;
+
+    size_t written = 0;
+    while (written < size)
+    {
+        ssize_t sent = send(_socket->fd, buf + written, size - written, MSG_NOSIGNAL);
+        if (sent > 0)
+        {
+            written += sent;
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            pollfd ready = {_socket->fd, POLLOUT, 0};
+            if (poll(&ready, 1, HOST_CLIENT_WRITE_TIMEOUT_MS) > 0)
+                continue;
+        }
+        break;
+    }
+    return written;
+}
+
+uint8_t WiFiClient::connected()
+{
+    if (!_socket)
+        return 0;
+
+    char c;
+    ssize_t peeked = recv(_socket->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    return peeked > 0 || (peeked < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+}
+
+void WiFiClient::stop()
+{
+    _socket.reset();
+}
+
+int WiFiClient::fd() const
+{
+    return _socket ? _socket->fd : -1;
+}
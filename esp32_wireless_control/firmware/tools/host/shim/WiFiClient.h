@@ -0,0 +1,51 @@
+/**
+ * @file WiFiClient.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef HOST_WIFI_CLIENT_H
+#define HOST_WIFI_CLIENT_H
+
+// Connection of a request on the host, one end of a socket pair whose other
+// end is read by the harness. As in arduino-esp32, copies share the socket:
+// stop() lets go of this copy and the socket closes with the last one.
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+// A write waits this long for room before it gives up, like a stuck client on the target
+#define HOST_CLIENT_WRITE_TIMEOUT_MS 1000
+
+class WiFiClient
+{
+  public:
+    WiFiClient();
+    // Takes over the socket
+    explicit WiFiClient(int fd);
+
+    // Blocks until all is written, the peer is gone or the timeout passed
+    size_t write(const uint8_t* buf, size_t size);
+    // The socket is open and the peer has not closed its end
+    uint8_t connected();
+    void stop();
+    int fd() const;
+
+  private:
+    struct Socket
+    {
+        explicit Socket(int fd) : fd(fd)
+        {
+        }
+        ~Socket();
+
+        int fd;
+    };
+
+    std::shared_ptr<Socket> _socket;
+};
+
+#endif // HOST_WIFI_CLIENT_H
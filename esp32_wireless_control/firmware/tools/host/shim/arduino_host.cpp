@@ -0,0 +1,262 @@
+#include <chrono>
+#include <malloc.h>
+#include <mutex>
+#include <stdarg.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "esp32-hal-timer.h"
+#include "esp_timer.h"
+#include "soc/gpio_struct.h"
+#include "uart.h"
+
+bool print_out_enabled = true;
+
+EspClass ESP;
+EEPROMClass EEPROM;
+gpio_dev_t GPIO;
+
+static const std::chrono::steady_clock::time_point boot_time = std::chrono::steady_clock::now();
+
+unsigned long millis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - boot_time)
+        .count();
+}
+
+unsigned long micros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - boot_time)
+        .count();
+}
+
+void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+int64_t esp_timer_get_time()
+{
+    return micros();
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t, uint8_t)
+{
+}
+
+int digitalRead(uint8_t)
+{
+    return LOW;
+}
+
+static uint32_t minFreeHeap = UINT32_MAX;
+
+// The arena grows on demand, its size is what the process has taken so far
+uint32_t EspClass::getHeapSize()
+{
+    struct mallinfo2 info = mallinfo2();
+    return (uint32_t) (info.arena + info.hblkhd);
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+    struct mallinfo2 info = mallinfo2();
+    uint32_t free = (uint32_t) info.fordblks;
+    if (free < minFreeHeap)
+        minFreeHeap = free;
+    return free;
+}
+
+uint32_t EspClass::getMinFreeHeap()
+{
+    getFreeHeap();
+    return minFreeHeap;
+}
+
+uint32_t EspClass::getMaxAllocHeap()
+{
+    // Larger blocks are mapped, glibc has no figure for the largest free chunk
+    return getFreeHeap();
+}
+
+EEPROMClass::EEPROMClass() : _size(0)
+{
+    memset(_data, 0xFF, sizeof(_data));
+}
+
+bool EEPROMClass::begin(size_t size)
+{
+    _size = size < sizeof(_data) ? size : sizeof(_data);
+    return true;
+}
+
+uint8_t EEPROMClass::read(int address)
+{
+    return address >= 0 && (size_t) address < _size ? _data[address] : 0;
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+    if (address >= 0 && (size_t) address < _size)
+        _data[address] = value;
+}
+
+bool EEPROMClass::commit()
+{
+    return true;
+}
+
+struct hw_timer_t
+{
+    uint32_t frequency;
+    uint64_t alarm;
+    bool running;
+    uint64_t start_us;
+    uint64_t fired;
+    void (*isr)();
+};
+
+// Function-local so timers of global objects can be created before main()
+static std::vector<hw_timer_t*>& hostTimers()
+{
+    static std::vector<hw_timer_t*> timers;
+    return timers;
+}
+
+hw_timer_t* timerBegin(uint32_t frequency)
+{
+    hw_timer_t* timer = new hw_timer_t{frequency, 0, false, 0, 0, nullptr};
+    hostTimers().push_back(timer);
+    return timer;
+}
+
+void timerAttachInterrupt(hw_timer_t* timer, void (*isr)())
+{
+    timer->isr = isr;
+}
+
+void timerAlarm(hw_timer_t* timer, uint64_t alarm_value, bool, uint64_t)
+{
+    timer->alarm = alarm_value;
+}
+
+void timerStart(hw_timer_t* timer)
+{
+    if (!timer->running)
+        timerRestart(timer);
+    timer->running = true;
+}
+
+void timerStop(hw_timer_t* timer)
+{
+    timer->running = false;
+}
+
+void timerRestart(hw_timer_t* timer)
+{
+    timer->start_us = micros();
+    timer->fired = 0;
+}
+
+void timerWrite(hw_timer_t* timer, uint64_t)
+{
+    timerRestart(timer);
+}
+
+size_t hostTimersRun()
+{
+    size_t calls = 0;
+    uint64_t now = micros();
+    for (hw_timer_t* timer : hostTimers())
+    {
+        if (!timer->running || timer->alarm == 0 || timer->isr == nullptr)
+            continue;
+
+        uint64_t ticks = (now - timer->start_us) * timer->frequency / 1000000;
+        uint64_t due = ticks / timer->alarm;
+        uint64_t limit = timer->fired + HOST_TIMER_MAX_CATCH_UP;
+        // The ISR may stop or restart its own timer
+        while (timer->running && timer->fired < due && timer->fired < limit)
+        {
+            timer->fired++;
+            timer->isr();
+            calls++;
+        }
+        if (timer->running && timer->fired < due)
+            timer->fired = due;
+    }
+    return calls;
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return (TickType_t) millis();
+}
+
+void vTaskDelay(TickType_t)
+{
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t,
+                                   TaskHandle_t*, BaseType_t)
+{
+    return pdFAIL;
+}
+
+void vTaskDelete(TaskHandle_t)
+{
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return new std::mutex();
+}
+
+int xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t)
+{
+    static_cast<std::mutex*>(semaphore)->lock();
+    return pdTRUE;
+}
+
+int xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    static_cast<std::mutex*>(semaphore)->unlock();
+    return pdTRUE;
+}
+
+void print_out(const char* format, ...)
+{
+    if (!print_out_enabled)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+}
+
+void print_out_nonl(const char* format, ...)
+{
+    if (!print_out_enabled)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+UBaseType_t uart_queue_depth()
+{
+    return 0;
+}
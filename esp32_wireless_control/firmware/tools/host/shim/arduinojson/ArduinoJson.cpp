@@ -0,0 +1,605 @@
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ArduinoJson.h"
+
+namespace ArduinoJson
+{
+
+const JsonNode* JsonNode::member(const char* key) const
+{
+    if (type != OBJECT)
+        return nullptr;
+    for (const auto& entry : members)
+    {
+        if (entry.first == key)
+            return entry.second;
+    }
+    return nullptr;
+}
+
+size_t JsonVariantConst::size() const
+{
+    if (_node == nullptr)
+        return 0;
+    if (_node->type == JsonNode::ARRAY)
+        return _node->items.size();
+    return _node->type == JsonNode::OBJECT ? _node->members.size() : 0;
+}
+
+JsonVariantConst JsonVariantConst::operator[](const char* key) const
+{
+    return JsonVariantConst(_node != nullptr ? _node->member(key) : nullptr);
+}
+
+JsonVariantConst JsonVariantConst::operator[](size_t index) const
+{
+    return JsonArrayConst(_node)[index];
+}
+
+JsonVariantConst::operator JsonArrayConst() const
+{
+    return JsonArrayConst(_node);
+}
+
+JsonVariantConst::operator JsonObjectConst() const
+{
+    return JsonObjectConst(_node);
+}
+
+void setJsonValue(JsonNode& node, bool value)
+{
+    node = JsonNode();
+    node.type = JsonNode::BOOLEAN;
+    node.boolean = value;
+}
+
+void setJsonValue(JsonNode& node, double value)
+{
+    node = JsonNode();
+    node.type = JsonNode::REAL;
+    node.real = value;
+}
+
+void setJsonValue(JsonNode& node, const char* value)
+{
+    node = JsonNode();
+    if (value == nullptr)
+        return;
+    node.type = JsonNode::STRING;
+    node.string = value;
+}
+
+void setJsonValue(JsonNode& node, const String& value)
+{
+    setJsonValue(node, value.c_str());
+}
+
+JsonNode& MemberProxy::node()
+{
+    // Writing a member turns null into an object, as ArduinoJson does
+    if (_parent->type != JsonNode::OBJECT)
+    {
+        *_parent = JsonNode();
+        _parent->type = JsonNode::OBJECT;
+    }
+    for (auto& entry : _parent->members)
+    {
+        if (entry.first == _key)
+            return *entry.second;
+    }
+    JsonNode* node = _doc->newNode();
+    _parent->members.emplace_back(_key, node);
+    return *node;
+}
+
+MemberProxy MemberProxy::operator[](const char* key)
+{
+    return MemberProxy(_doc, &node(), key);
+}
+
+JsonDocument::JsonDocument()
+{
+    clear();
+}
+
+void JsonDocument::clear()
+{
+    _nodes.clear();
+    _nodes.emplace_back();
+    _root = &_nodes.back();
+}
+
+JsonNode* JsonDocument::newNode()
+{
+    // A deque keeps the nodes in place as it grows
+    _nodes.emplace_back();
+    return &_nodes.back();
+}
+
+const char* DeserializationError::c_str() const
+{
+    static const char* const names[] = {"Ok",       "EmptyInput", "IncompleteInput",
+                                        "InvalidInput", "NoMemory", "TooDeep"};
+    return names[_code];
+}
+
+// Appends to the String in small pieces, as the String writer of ArduinoJson
+class JsonWriter
+{
+  public:
+    JsonWriter(String& out) : _out(out), _used(0), _length(0)
+    {
+    }
+
+    ~JsonWriter()
+    {
+        flush();
+    }
+
+    void write(const char* text, size_t len)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            if (_used == sizeof(_buffer))
+                flush();
+            _buffer[_used++] = text[i];
+        }
+        _length += len;
+    }
+
+    void write(const char* text)
+    {
+        write(text, strlen(text));
+    }
+
+    void flush()
+    {
+        if (_used > 0)
+            _out.concat(_buffer, _used);
+        _used = 0;
+    }
+
+    size_t length() const
+    {
+        return _length;
+    }
+
+  private:
+    String& _out;
+    char _buffer[32];
+    size_t _used;
+    size_t _length;
+};
+
+static void writeString(JsonWriter& out, const std::string& text)
+{
+    out.write("\"");
+    for (unsigned char c : text)
+    {
+        char escaped[8];
+        switch (c)
+        {
+            case '"':
+                out.write("\\\"");
+                break;
+            case '\\':
+                out.write("\\\\");
+                break;
+            case '\b':
+                out.write("\\b");
+                break;
+            case '\f':
+                out.write("\\f");
+                break;
+            case '\n':
+                out.write("\\n");
+                break;
+            case '\r':
+                out.write("\\r");
+                break;
+            case '\t':
+                out.write("\\t");
+                break;
+            default:
+                if (c < 0x20)
+                {
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out.write(escaped);
+                }
+                else
+                {
+                    out.write((const char*) &c, 1);
+                }
+                break;
+        }
+    }
+    out.write("\"");
+}
+
+// Shortest form that reads back as the value, a float stays a float
+static void writeReal(JsonWriter& out, const JsonNode& node)
+{
+    if (!isfinite(node.real))
+    {
+        out.write("null");
+        return;
+    }
+
+    char number[32];
+    int digits = node.single ? 6 : 15;
+    int max_digits = node.single ? 9 : 17;
+    for (; digits <= max_digits; digits++)
+    {
+        snprintf(number, sizeof(number), "%.*g", digits, node.real);
+        double value = strtod(number, nullptr);
+        if (node.single ? (float) value == (float) node.real : value == node.real)
+            break;
+    }
+    out.write(number);
+}
+
+static void writeNode(JsonWriter& out, const JsonNode& node)
+{
+    char number[32];
+    switch (node.type)
+    {
+        case JsonNode::NUL:
+            out.write("null");
+            break;
+        case JsonNode::BOOLEAN:
+            out.write(node.boolean ? "true" : "false");
+            break;
+        case JsonNode::INTEGER:
+            snprintf(number, sizeof(number), "%lld", (long long) node.integer);
+            out.write(number);
+            break;
+        case JsonNode::REAL:
+            writeReal(out, node);
+            break;
+        case JsonNode::STRING:
+            writeString(out, node.string);
+            break;
+        case JsonNode::ARRAY:
+            out.write("[");
+            for (size_t i = 0; i < node.items.size(); i++)
+            {
+                if (i > 0)
+                    out.write(",");
+                writeNode(out, *node.items[i]);
+            }
+            out.write("]");
+            break;
+        case JsonNode::OBJECT:
+            out.write("{");
+            for (size_t i = 0; i < node.members.size(); i++)
+            {
+                if (i > 0)
+                    out.write(",");
+                writeString(out, node.members[i].first);
+                out.write(":");
+                writeNode(out, *node.members[i].second);
+            }
+            out.write("}");
+            break;
+    }
+}
+
+size_t serializeJson(const JsonDocument& doc, String& out)
+{
+    out = "";
+    JsonWriter writer(out);
+    writeNode(writer, *doc.root());
+    writer.flush();
+    return writer.length();
+}
+
+class JsonParser
+{
+  public:
+    JsonParser(JsonDocument& doc, const char* text, size_t length)
+        : _doc(doc), _pos(text), _end(text + length)
+    {
+    }
+
+    DeserializationError parse()
+    {
+        skipSpace();
+        if (_pos == _end)
+            return DeserializationError::EmptyInput;
+        return parseValue(*_doc.root(), 0);
+    }
+
+  private:
+    void skipSpace()
+    {
+        while (_pos < _end && (*_pos == ' ' || *_pos == '\t' || *_pos == '\n' || *_pos == '\r'))
+            _pos++;
+    }
+
+    bool literal(const char* word)
+    {
+        size_t len = strlen(word);
+        if ((size_t) (_end - _pos) < len || strncmp(_pos, word, len) != 0)
+            return false;
+        _pos += len;
+        return true;
+    }
+
+    DeserializationError parseValue(JsonNode& node, int depth)
+    {
+        skipSpace();
+        if (_pos == _end)
+            return DeserializationError::IncompleteInput;
+
+        switch (*_pos)
+        {
+            case '{':
+                return parseObject(node, depth + 1);
+            case '[':
+                return parseArray(node, depth + 1);
+            case '"':
+                node.type = JsonNode::STRING;
+                return parseString(node.string);
+            case 't':
+                setJsonValue(node, true);
+                return literal("true") ? DeserializationError::Ok
+                                       : DeserializationError::InvalidInput;
+            case 'f':
+                setJsonValue(node, false);
+                return literal("false") ? DeserializationError::Ok
+                                        : DeserializationError::InvalidInput;
+            case 'n':
+                node = JsonNode();
+                return literal("null") ? DeserializationError::Ok
+                                       : DeserializationError::InvalidInput;
+            default:
+                return parseNumber(node);
+        }
+    }
+
+    DeserializationError parseObject(JsonNode& node, int depth)
+    {
+        if (depth > HOST_JSON_NESTING_LIMIT)
+            return DeserializationError::TooDeep;
+        node = JsonNode();
+        node.type = JsonNode::OBJECT;
+        _pos++;
+        skipSpace();
+        if (_pos < _end && *_pos == '}')
+        {
+            _pos++;
+            return DeserializationError::Ok;
+        }
+
+        for (;;)
+        {
+            skipSpace();
+            if (_pos == _end)
+                return DeserializationError::IncompleteInput;
+            std::string key;
+            if (*_pos != '"')
+                return DeserializationError::InvalidInput;
+            DeserializationError error = parseString(key);
+            if (error)
+                return error;
+            skipSpace();
+            if (_pos == _end)
+                return DeserializationError::IncompleteInput;
+            if (*_pos++ != ':')
+                return DeserializationError::InvalidInput;
+
+            JsonNode* value = _doc.newNode();
+            node.members.emplace_back(key, value);
+            error = parseValue(*value, depth);
+            if (error)
+                return error;
+
+            skipSpace();
+            if (_pos == _end)
+                return DeserializationError::IncompleteInput;
+            char c = *_pos++;
+            if (c == '}')
+                return DeserializationError::Ok;
+            if (c != ',')
+                return DeserializationError::InvalidInput;
+        }
+    }
+
+    DeserializationError parseArray(JsonNode& node, int depth)
+    {
+        if (depth > HOST_JSON_NESTING_LIMIT)
+            return DeserializationError::TooDeep;
+        node = JsonNode();
+        node.type = JsonNode::ARRAY;
+        _pos++;
+        skipSpace();
+        if (_pos < _end && *_pos == ']')
+        {
+            _pos++;
+            return DeserializationError::Ok;
+        }
+
+        for (;;)
+        {
+            JsonNode* item = _doc.newNode();
+            node.items.push_back(item);
+            DeserializationError error = parseValue(*item, depth);
+            if (error)
+                return error;
+
+            skipSpace();
+            if (_pos == _end)
+                return DeserializationError::IncompleteInput;
+            char c = *_pos++;
+            if (c == ']')
+                return DeserializationError::Ok;
+            if (c != ',')
+                return DeserializationError::InvalidInput;
+        }
+    }
+
+    bool parseHex(uint32_t& value)
+    {
+        if (_end - _pos < 4)
+            return false;
+        value = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            char c = *_pos++;
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+                value |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                value |= c - 'A' + 10;
+            else
+                return false;
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t code)
+    {
+        if (code < 0x80)
+        {
+            out += (char) code;
+        }
+        else if (code < 0x800)
+        {
+            out += (char) (0xC0 | (code >> 6));
+            out += (char) (0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000)
+        {
+            out += (char) (0xE0 | (code >> 12));
+            out += (char) (0x80 | ((code >> 6) & 0x3F));
+            out += (char) (0x80 | (code & 0x3F));
+        }
+        else
+        {
+            out += (char) (0xF0 | (code >> 18));
+            out += (char) (0x80 | ((code >> 12) & 0x3F));
+            out += (char) (0x80 | ((code >> 6) & 0x3F));
+            out += (char) (0x80 | (code & 0x3F));
+        }
+    }
+
+    DeserializationError parseString(std::string& out)
+    {
+        _pos++;
+        while (_pos < _end && *_pos != '"')
+        {
+            char c = *_pos++;
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+            if (_pos == _end)
+                return DeserializationError::IncompleteInput;
+
+            uint32_t code;
+            switch (*_pos++)
+            {
+                case '"':
+                    out += '"';
+                    break;
+                case '\\':
+                    out += '\\';
+                    break;
+                case '/':
+                    out += '/';
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                    if (!parseHex(code))
+                        return DeserializationError::InvalidInput;
+                    // A surrogate pair encodes one code point above the BMP
+                    if (code >= 0xD800 && code < 0xDC00 && _end - _pos >= 6 && _pos[0] == '\\' &&
+                        _pos[1] == 'u')
+                    {
+                        uint32_t low;
+                        _pos += 2;
+                        if (!parseHex(low) || low < 0xDC00 || low >= 0xE000)
+                            return DeserializationError::InvalidInput;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, code);
+                    break;
+                default:
+                    return DeserializationError::InvalidInput;
+            }
+        }
+        if (_pos == _end)
+            return DeserializationError::IncompleteInput;
+        _pos++;
+        return DeserializationError::Ok;
+    }
+
+    DeserializationError parseNumber(JsonNode& node)
+    {
+        const char* start = _pos;
+        bool real = false;
+        while (_pos < _end && (isdigit((unsigned char) *_pos) || strchr("+-.eE", *_pos)))
+        {
+            real = real || *_pos == '.' || *_pos == 'e' || *_pos == 'E';
+            _pos++;
+        }
+        if (_pos == start)
+            return DeserializationError::InvalidInput;
+
+        std::string text(start, _pos);
+        char* end;
+        if (!real)
+        {
+            errno = 0;
+            long long value = strtoll(text.c_str(), &end, 10);
+            if (*end == '\0' && errno == 0)
+            {
+                setJsonValue(node, value);
+                return DeserializationError::Ok;
+            }
+        }
+        double value = strtod(text.c_str(), &end);
+        if (*end != '\0')
+            return DeserializationError::InvalidInput;
+        setJsonValue(node, value);
+        return DeserializationError::Ok;
+    }
+
+    JsonDocument& _doc;
+    const char* _pos;
+    const char* _end;
+};
+
+DeserializationError deserializeJson(JsonDocument& doc, const String& input)
+{
+    doc.clear();
+    JsonParser parser(doc, input.c_str(), input.length());
+    DeserializationError error = parser.parse();
+    if (error)
+        doc.clear();
+    return error;
+}
+
+} // namespace ArduinoJson
@@ -0,0 +1,481 @@
+/**
+ * @file ArduinoJson.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef HOST_ARDUINOJSON_H
+#define HOST_ARDUINOJSON_H
+
+// The part of the ArduinoJson 7 API the web API uses, for host builds without the
+// library (platformio.ini pins 7.2.1). Output is the same compact JSON. Values are nodes on the standard heap rather
+// than in the memory pool of ArduinoJson, so allocation counts differ from the target.
+
+#include <deque>
+#include <limits>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "WString.h"
+
+namespace ArduinoJson
+{
+
+// Nesting accepted by deserializeJson(), as ARDUINOJSON_DEFAULT_NESTING_LIMIT
+#define HOST_JSON_NESTING_LIMIT 10
+
+struct JsonNode
+{
+    enum Type
+    {
+        NUL,
+        BOOLEAN,
+        INTEGER,
+        REAL,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    Type type = NUL;
+    bool boolean = false;
+    int64_t integer = 0;
+    double real = 0.0;
+    bool single = false; // real came from a float, printed with float precision
+    std::string string;
+    std::vector<JsonNode*> items;
+    std::vector<std::pair<std::string, JsonNode*>> members;
+
+    const JsonNode* member(const char* key) const;
+};
+
+class JsonDocument;
+class JsonArrayConst;
+class JsonObjectConst;
+
+// is<T>() and as<T>() per target type
+template <typename T, typename Enable = void> struct JsonConverter;
+
+class JsonVariantConst
+{
+  public:
+    JsonVariantConst(const JsonNode* node = nullptr) : _node(node)
+    {
+    }
+
+    bool isNull() const
+    {
+        return _node == nullptr || _node->type == JsonNode::NUL;
+    }
+    template <typename T> bool is() const
+    {
+        return _node != nullptr && JsonConverter<T>::is(*_node);
+    }
+    template <typename T> T as() const
+    {
+        return JsonConverter<T>::as(_node);
+    }
+    template <typename T> T operator|(T fallback) const
+    {
+        return is<T>() ? as<T>() : fallback;
+    }
+    const char* operator|(const char* fallback) const
+    {
+        return is<const char*>() ? as<const char*>() : fallback;
+    }
+
+    size_t size() const;
+    JsonVariantConst operator[](const char* key) const;
+    JsonVariantConst operator[](size_t index) const;
+    operator JsonArrayConst() const;
+    operator JsonObjectConst() const;
+
+    const JsonNode* node() const
+    {
+        return _node;
+    }
+
+  private:
+    const JsonNode* _node;
+};
+
+class JsonArrayConst
+{
+  public:
+    JsonArrayConst(const JsonNode* node = nullptr)
+        : _node(node != nullptr && node->type == JsonNode::ARRAY ? node : nullptr)
+    {
+    }
+
+    size_t size() const
+    {
+        return _node != nullptr ? _node->items.size() : 0;
+    }
+    JsonVariantConst operator[](size_t index) const
+    {
+        return JsonVariantConst(index < size() ? _node->items[index] : nullptr);
+    }
+
+  private:
+    const JsonNode* _node;
+};
+
+class JsonObjectConst
+{
+  public:
+    JsonObjectConst(const JsonNode* node = nullptr)
+        : _node(node != nullptr && node->type == JsonNode::OBJECT ? node : nullptr)
+    {
+    }
+
+    size_t size() const
+    {
+        return _node != nullptr ? _node->members.size() : 0;
+    }
+    JsonVariantConst operator[](const char* key) const
+    {
+        return JsonVariantConst(_node != nullptr ? _node->member(key) : nullptr);
+    }
+
+  private:
+    const JsonNode* _node;
+};
+
+// Store a value in a node, the node keeps no reference to it
+void setJsonValue(JsonNode& node, bool value);
+void setJsonValue(JsonNode& node, double value);
+void setJsonValue(JsonNode& node, const char* value);
+void setJsonValue(JsonNode& node, const String& value);
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value>::type setJsonValue(JsonNode& node, T value)
+{
+    node = JsonNode();
+    node.type = JsonNode::INTEGER;
+    node.integer = (int64_t) value;
+}
+inline void setJsonValue(JsonNode& node, float value)
+{
+    setJsonValue(node, (double) value);
+    node.single = true;
+}
+
+class JsonArray;
+
+// doc["key"], the member is created when written
+class MemberProxy
+{
+  public:
+    MemberProxy(JsonDocument* doc, JsonNode* parent, const char* key)
+        : _doc(doc), _parent(parent), _key(key)
+    {
+    }
+
+    template <typename T> MemberProxy& operator=(const T& value)
+    {
+        setJsonValue(node(), value);
+        return *this;
+    }
+    MemberProxy& operator=(const char* value)
+    {
+        setJsonValue(node(), value);
+        return *this;
+    }
+
+    MemberProxy operator[](const char* key);
+    // Replace the member by an empty array or object
+    template <typename T> T to();
+
+    JsonVariantConst value() const
+    {
+        return JsonVariantConst(_parent->member(_key));
+    }
+    bool isNull() const
+    {
+        return value().isNull();
+    }
+    template <typename T> bool is() const
+    {
+        return value().is<T>();
+    }
+    template <typename T> T as() const
+    {
+        return value().as<T>();
+    }
+    template <typename T> T operator|(T fallback) const
+    {
+        return value() | fallback;
+    }
+    const char* operator|(const char* fallback) const
+    {
+        return value() | fallback;
+    }
+    operator JsonVariantConst() const
+    {
+        return value();
+    }
+    operator JsonArrayConst() const
+    {
+        return JsonArrayConst(value().node());
+    }
+    operator JsonObjectConst() const
+    {
+        return JsonObjectConst(value().node());
+    }
+
+  private:
+    JsonNode& node();
+
+    JsonDocument* _doc;
+    JsonNode* _parent;
+    const char* _key;
+};
+
+class JsonObject
+{
+  public:
+    JsonObject(JsonDocument* doc = nullptr, JsonNode* node = nullptr) : _doc(doc), _node(node)
+    {
+    }
+
+    MemberProxy operator[](const char* key)
+    {
+        return MemberProxy(_doc, _node, key);
+    }
+
+  private:
+    JsonDocument* _doc;
+    JsonNode* _node;
+};
+
+class JsonArray
+{
+  public:
+    JsonArray(JsonDocument* doc = nullptr, JsonNode* node = nullptr) : _doc(doc), _node(node)
+    {
+    }
+
+    size_t size() const
+    {
+        return _node != nullptr ? _node->items.size() : 0;
+    }
+    // Append an empty object, only JsonObject is supported
+    template <typename T> T add();
+
+  private:
+    JsonDocument* _doc;
+    JsonNode* _node;
+};
+
+class JsonDocument
+{
+  public:
+    JsonDocument();
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+    MemberProxy operator[](const char* key)
+    {
+        return MemberProxy(this, _root, key);
+    }
+    JsonVariantConst operator[](const char* key) const
+    {
+        return JsonVariantConst(_root->member(key));
+    }
+    // Release all values, the document is null again
+    void clear();
+
+    const JsonNode* root() const
+    {
+        return _root;
+    }
+    JsonNode* root()
+    {
+        return _root;
+    }
+    JsonNode* newNode();
+
+  private:
+    std::deque<JsonNode> _nodes;
+    JsonNode* _root;
+};
+
+template <> inline JsonArray MemberProxy::to<JsonArray>()
+{
+    JsonNode& array = node();
+    array = JsonNode();
+    array.type = JsonNode::ARRAY;
+    return JsonArray(_doc, &array);
+}
+
+template <> inline JsonObject MemberProxy::to<JsonObject>()
+{
+    JsonNode& object = node();
+    object = JsonNode();
+    object.type = JsonNode::OBJECT;
+    return JsonObject(_doc, &object);
+}
+
+template <> inline JsonObject JsonArray::add<JsonObject>()
+{
+    JsonNode* object = _doc->newNode();
+    object->type = JsonNode::OBJECT;
+    _node->items.push_back(object);
+    return JsonObject(_doc, object);
+}
+
+template <typename T>
+struct JsonConverter<T, typename std::enable_if<std::is_integral<T>::value &&
+                                                !std::is_same<T, bool>::value>::type>
+{
+    static bool is(const JsonNode& node)
+    {
+        return node.type == JsonNode::INTEGER &&
+               node.integer >= (int64_t) std::numeric_limits<T>::min() &&
+               (node.integer < 0 ||
+                (uint64_t) node.integer <= (uint64_t) std::numeric_limits<T>::max());
+    }
+    static T as(const JsonNode* node)
+    {
+        if (node == nullptr)
+            return 0;
+        if (node->type == JsonNode::REAL)
+            return (T) node->real;
+        if (node->type == JsonNode::BOOLEAN)
+            return node->boolean;
+        return node->type == JsonNode::INTEGER ? (T) node->integer : 0;
+    }
+};
+
+template <> struct JsonConverter<bool>
+{
+    static bool is(const JsonNode& node)
+    {
+        return node.type == JsonNode::BOOLEAN;
+    }
+    static bool as(const JsonNode* node)
+    {
+        return node != nullptr && node->type == JsonNode::BOOLEAN && node->boolean;
+    }
+};
+
+template <typename T>
+struct JsonConverter<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static bool is(const JsonNode& node)
+    {
+        return node.type == JsonNode::INTEGER || node.type == JsonNode::REAL;
+    }
+    static T as(const JsonNode* node)
+    {
+        if (node == nullptr)
+            return 0;
+        return node->type == JsonNode::REAL ? (T) node->real
+               : node->type == JsonNode::INTEGER ? (T) node->integer
+                                                 : 0;
+    }
+};
+
+template <> struct JsonConverter<const char*>
+{
+    static bool is(const JsonNode& node)
+    {
+        return node.type == JsonNode::STRING;
+    }
+    static const char* as(const JsonNode* node)
+    {
+        return node != nullptr && node->type == JsonNode::STRING ? node->string.c_str()
+                                                                 : nullptr;
+    }
+};
+
+template <> struct JsonConverter<String>
+{
+    static bool is(const JsonNode& node)
+    {
+        return node.type == JsonNode::STRING;
+    }
+    static String as(const JsonNode* node)
+    {
+        const char* text = JsonConverter<const char*>::as(node);
+        return text != nullptr ? String(text) : String("null");
+    }
+};
+
+template <> struct JsonConverter<JsonArrayConst>
+{
+    static bool is(const JsonNode& node)
+    {
+        return node.type == JsonNode::ARRAY;
+    }
+    static JsonArrayConst as(const JsonNode* node)
+    {
+        return JsonArrayConst(node);
+    }
+};
+
+template <> struct JsonConverter<JsonObjectConst>
+{
+    static bool is(const JsonNode& node)
+    {
+        return node.type == JsonNode::OBJECT;
+    }
+    static JsonObjectConst as(const JsonNode* node)
+    {
+        return JsonObjectConst(node);
+    }
+};
+
+class DeserializationError
+{
+  public:
+    enum Code
+    {
+        Ok,
+        EmptyInput,
+        IncompleteInput,
+        InvalidInput,
+        NoMemory,
+        TooDeep
+    };
+
+    DeserializationError(Code code = Ok) : _code(code)
+    {
+    }
+
+    Code code() const
+    {
+        return _code;
+    }
+    const char* c_str() const;
+    explicit operator bool() const
+    {
+        return _code != Ok;
+    }
+    friend bool operator==(const DeserializationError& lhs, Code rhs)
+    {
+        return lhs._code == rhs;
+    }
+    friend bool operator!=(const DeserializationError& lhs, Code rhs)
+    {
+        return lhs._code != rhs;
+    }
+
+  private:
+    Code _code;
+};
+
+// Compact JSON, out is replaced. Returns the length written.
+size_t serializeJson(const JsonDocument& doc, String& out);
+DeserializationError deserializeJson(JsonDocument& doc, const String& input);
+
+} // namespace ArduinoJson
+
+using namespace ArduinoJson;
+
+#endif // HOST_ARDUINOJSON_H
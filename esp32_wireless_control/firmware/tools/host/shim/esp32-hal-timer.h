@@ -0,0 +1,35 @@
+/**
+ * @file esp32-hal-timer.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef HOST_ESP32_HAL_TIMER_H
+#define HOST_ESP32_HAL_TIMER_H
+
+// Hardware timers of the arduino-esp32 3.x API on the host. Nothing runs by
+// itself: hostTimersRun() calls the ISRs of the alarms that came due since
+// the last call, in the caller's thread, as if they had interrupted it.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Most ISR calls per timer and hostTimersRun(), a timer further behind skips the rest
+#define HOST_TIMER_MAX_CATCH_UP 100000
+
+struct hw_timer_t;
+
+hw_timer_t* timerBegin(uint32_t frequency);
+void timerAttachInterrupt(hw_timer_t* timer, void (*isr)());
+void timerAlarm(hw_timer_t* timer, uint64_t alarm_value, bool autoreload, uint64_t reload_count);
+void timerStart(hw_timer_t* timer);
+void timerStop(hw_timer_t* timer);
+void timerRestart(hw_timer_t* timer);
+void timerWrite(hw_timer_t* timer, uint64_t value);
+
+// Host only: run the ISRs that are due, returns the number of calls
+size_t hostTimersRun();
+
+#endif // HOST_ESP32_HAL_TIMER_H
@@ -0,0 +1,17 @@
+/**
+ * @file esp_timer.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <stdint.h>
+
+// Microseconds since start
+int64_t esp_timer_get_time();
+
+#endif // HOST_ESP_TIMER_H
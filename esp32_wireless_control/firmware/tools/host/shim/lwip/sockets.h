@@ -0,0 +1,16 @@
+/**
+ * @file sockets.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+// lwIP offers the BSD socket API, the host has it natively
+
+#include <sys/socket.h>
+
+#endif // HOST_LWIP_SOCKETS_H
@@ -0,0 +1,23 @@
+/**
+ * @file pgmspace.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef HOST_PGMSPACE_H
+#define HOST_PGMSPACE_H
+
+// Flash is memory mapped on the ESP32 as on the host, PROGMEM data is read directly
+
+#include <stdint.h>
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#define PGM_P const char*
+#define pgm_read_byte(addr) (*(const uint8_t*) (addr))
+#define pgm_read_ptr(addr) (*(const void* const*) (addr))
+
+#endif // HOST_PGMSPACE_H
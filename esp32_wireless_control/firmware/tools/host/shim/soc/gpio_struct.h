@@ -0,0 +1,24 @@
+/**
+ * @file gpio_struct.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef HOST_SOC_GPIO_STRUCT_H
+#define HOST_SOC_GPIO_STRUCT_H
+
+// GPIO registers written by the step ISR, plain memory on the host
+
+#include <stdint.h>
+
+typedef struct
+{
+    volatile uint32_t out_w1ts;
+    volatile uint32_t out_w1tc;
+} gpio_dev_t;
+
+extern gpio_dev_t GPIO;
+
+#endif // HOST_SOC_GPIO_STRUCT_H
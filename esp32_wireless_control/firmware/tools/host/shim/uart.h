@@ -0,0 +1,26 @@
+/**
+ * @file uart.h
+ * @version 0.1.0
+ *
+ * @section License
+ * Copyright (C) 2025, Sylensky
+ */
+
+#ifndef UART_H
+#define UART_H
+
+// Host replacement for the firmware uart.h, output goes to stdout
+
+#include <Arduino.h>
+
+// Size of the firmware queue, the host prints at once and never queues
+#define UART_QUEUE_LENGTH 128
+
+// Set to false to silence firmware logging while measuring
+extern bool print_out_enabled;
+
+void print_out(const char* format, ...);
+void print_out_nonl(const char* format, ...);
+UBaseType_t uart_queue_depth();
+
+#endif
@@ -10,6 +10,7 @@
 #include <string.h>
 
 #include <common_strings.h>
+#include <metrics.h>
 #include <uart.h>
 
 QueueHandle_t uartq;
@@ -20,6 +21,12 @@ HardwareSerial* _uart;
 char rec_uart_buffer[MAX_UART_LINE_LEN];
 char tra_uart_buffer[MAX_UART_LINE_LEN];
 
+static void enqueue(const char* line)
+{
+    metrics.countUartLine(uxQueueSpacesAvailable(uartq) == 0);
+    xQueueSend(uartq, line, portMAX_DELAY);
+}
+
 void print_out(const char* format, ...)
 {
     va_list args;
@@ -30,7 +37,7 @@ void print_out(const char* format, ...)
 
     strcat(tra_uart_buffer, "\r\n");
 
-    xQueueSend(uartq, tra_uart_buffer, portMAX_DELAY);
+    enqueue(tra_uart_buffer);
 }
 
 void print_out_nonl(const char* format, ...)
@@ -41,7 +48,7 @@ void print_out_nonl(const char* format, ...)
     vsnprintf(tra_uart_buffer, MAX_UART_LINE_LEN, format, args);
     va_end(args);
 
-    xQueueSend(uartq, tra_uart_buffer, portMAX_DELAY);
+    enqueue(tra_uart_buffer);
 }
 
 void print_out_tbl(uint8_t index)
@@ -59,14 +66,14 @@ void print_out_tbl(uint8_t index)
     }
     tra_uart_buffer[i] = '\0';
 
-    xQueueSend(uartq, tra_uart_buffer, portMAX_DELAY);
+    enqueue(tra_uart_buffer);
 }
 
 void setup_uart(HardwareSerial* serial, long baudrate)
 {
     _uart = serial;
     _uart->begin(baudrate);
-    uartq = xQueueCreate(128, MAX_UART_LINE_LEN);
+    uartq = xQueueCreate(UART_QUEUE_LENGTH, MAX_UART_LINE_LEN);
     uart_tx_mutex = xSemaphoreCreateMutex();
     uart_rx_mutex = xSemaphoreCreateMutex();
     xSemaphoreGive(uart_tx_mutex);
@@ -86,3 +93,8 @@ void uart_task()
         }
     }
 }
+
+UBaseType_t uart_queue_depth()
+{
+    return uartq != NULL ? uxQueueMessagesWaiting(uartq) : 0;
+}
@@ -12,6 +12,8 @@
 #include <ErriezSerialTerminal.h>
 
 #define MAX_UART_LINE_LEN 128
+// Lines print_out() queues ahead of the UART task before callers wait
+#define UART_QUEUE_LENGTH 128
 
 #define CLI_DELIMITER_CHAR ' '
 #define CLI_NEWLINE_CHAR '\r'
@@ -23,5 +25,6 @@ void print_out_nonl(const char* format, ...);
 void print_out_tbl(uint8_t index);
 void setup_uart(HardwareSerial* serial, long baudrate);
 void uart_task();
+UBaseType_t uart_queue_depth();
 
 #endif
@@ -1,12 +1,25 @@
+#include <ArduinoJson.h>
+#include <new>
+
 #include "api_handler.h"
+#include "embedded_asset.h"
 #include "../axis.h"
-#include "../catalogues/star_database.h"
+#include "../catalogues/apparent_place.h"
+#include "../catalogues/catalogue_attribute_query.h"
+#include "../catalogues/catalogue_browser.h"
+#include "../catalogues/catalogue_page_cache.h"
+#include "../catalogues/catalogue_partition.h"
+#include "../catalogues/catalogue_query_cache.h"
+#include "../catalogues/sky_tiles.h"
+#include "../catalogues/sky_visibility.h"
+#include "../catalogues/star_database_registry.h"
 #include "../commands.h"
 #include "../configs/consts.h"
 #include "../eeprom_manager.h"
 #include "../error.h"
 #include "../functions/intervalometer/intervalometer.h"
 #include "../functions/ota/ota_handler.h"
+#include "../metrics.h"
 #include "../tools/heap_monitor.h"
 #include "../tracking_rates.h"
 #include "../uart.h"
@@ -18,12 +31,47 @@ extern Axis ra_axis;
 extern Intervalometer* intervalometer;
 extern TrackingRates trackingRates;
 extern Languages language;
-extern StarDatabase* starDatabase;
-extern StarDatabase* handleStarDatabase(StarDatabaseType catalogType);
 
-// External HTML interface data
-extern const uint8_t _interface_index_html_start[] asm("_binary_interface_index_html_start");
-extern const uint8_t _interface_index_html_end[] asm("_binary_interface_index_html_end");
+extern void systemShutdown();
+
+// Most names resolved by one POST /starBatch
+#define STAR_BATCH_MAX_NAMES 64
+// Objects listed by GET /visibleObjects without a limit argument
+#define VISIBLE_OBJECTS_DEFAULT_LIMIT 20
+// Records per GET /catalogBrowse page
+#define CATALOG_BROWSE_DEFAULT_LIMIT 50
+#define CATALOG_BROWSE_MAX_LIMIT 1000
+// Catalogue responses are written into this buffer, one piece of the response at a time
+#define CATALOG_BROWSE_BUFFER_SIZE 2048
+// Longest JSON object of a record: the numbers and four fields of up to 128 bytes
+#define CATALOG_JSON_RECORD_MAX 704
+// GET /metrics is written into this buffer, two parts at a time
+#define METRICS_SOURCE_BUFFER_SIZE (2 * METRICS_PART_SIZE)
+// Largest size bound of GET /catalogFilter in arcminutes
+#define CATALOG_FILTER_MAX_SIZE 6000.0f
+// Most commands a /commands request may hold
+#define COMMAND_BATCH_MAX 16
+
+// Web interface per language, translated, minified and compressed by shared/web_assets.py
+extern const uint8_t _interface_dist_index_en_html_gz_start[] asm(
+    "_binary_interface_dist_index_en_html_gz_start");
+extern const uint8_t _interface_dist_index_en_html_gz_end[] asm(
+    "_binary_interface_dist_index_en_html_gz_end");
+extern const uint8_t _interface_dist_index_cn_html_gz_start[] asm(
+    "_binary_interface_dist_index_cn_html_gz_start");
+extern const uint8_t _interface_dist_index_cn_html_gz_end[] asm(
+    "_binary_interface_dist_index_cn_html_gz_end");
+extern const uint8_t _interface_dist_index_de_html_gz_start[] asm(
+    "_binary_interface_dist_index_de_html_gz_start");
+extern const uint8_t _interface_dist_index_de_html_gz_end[] asm(
+    "_binary_interface_dist_index_de_html_gz_end");
+// Next language
+
+// Client-side search index, written by catalogues/search_index.py
+extern const uint8_t _catalogues_search_index_json_gz_start[] asm(
+    "_binary_catalogues_search_index_json_gz_start");
+extern const uint8_t _catalogues_search_index_json_gz_end[] asm(
+    "_binary_catalogues_search_index_json_gz_end");
 
 ApiHandler& ApiHandler::getInstance()
 {
@@ -52,6 +100,24 @@ static void logRequest(WebServer* server, const char* endpoint)
 }
 #endif
 
+// Current RA position in seconds (0-86399)
+static long getCurrentRaSeconds()
+{
+    // Normalize position to handle negative values and multiple revolutions
+    int64_t currentStepPosition = ra_axis.getPosition();
+    int64_t normalizedSteps =
+        ((currentStepPosition % STEPS_PER_TRACKER_FULL_REV_INT) + STEPS_PER_TRACKER_FULL_REV_INT) %
+        STEPS_PER_TRACKER_FULL_REV_INT;
+    return (long) ((normalizedSteps * RA_SECONDS_PER_FULL_REV) / STEPS_PER_TRACKER_FULL_REV_INT);
+}
+
+static Position toPosition(int64_t seconds)
+{
+    Position position(0, 0, 0);
+    position.arcseconds = seconds;
+    return position;
+}
+
 static Position calculatePosition(String Arg)
 {
     Position position(0, 0, 0);
@@ -72,54 +138,98 @@ void ApiHandler::registerEndpoints()
 {
     ApiHandler* api = this;
 
+    // Request headers are only kept when asked for, sky tiles and the search index are
+    // revalidated by ETag, the search index can be fetched in ranges. Debug builds log the
+    // User-Agent of page loads.
+    static const char* collectedHeaders[] = {"If-None-Match", "Range", "If-Range", "User-Agent"};
+    _server->collectHeaders(collectedHeaders,
+                            sizeof(collectedHeaders) / sizeof(collectedHeaders[0]));
+
     // Web interface
-    _server->on("/", HTTP_GET, [api]() { api->handleRoot(); });
+    on("/", HTTP_GET, [api]() { api->handleRoot(); });
 
     // Tracking control
-    _server->on("/on", HTTP_GET, [api]() { api->handleOn(); });
-    _server->on("/off", HTTP_GET, [api]() { api->handleOff(); });
+    on("/on", HTTP_GET, [api]() { api->handleOn(); });
+    on("/off", HTTP_GET, [api]() { api->handleOff(); });
     // Slewing control
-    _server->on("/startslew", HTTP_GET, [api]() { api->handleSlewRequest(); });
-    _server->on("/stopslew", HTTP_GET, [api]() { api->handleSlewOff(); });
+    on("/startslew", HTTP_GET, [api]() { api->handleSlewRequest(); });
+    on("/stopslew", HTTP_GET, [api]() { api->handleSlewOff(); });
 
     // Goto control
-    _server->on("/gotoRA", HTTP_GET, [api]() { api->handleGotoRA(); });
-    _server->on("/abort-goto-ra", HTTP_GET, [api]() { api->handleAbortGoToRA(); });
+    on("/gotoRA", HTTP_GET, [api]() { api->handleGotoRA(); });
+    on("/abort-goto-ra", HTTP_GET, [api]() { api->handleAbortGoToRA(); });
     // Position management
-    _server->on("/setPosition", HTTP_GET, [api]() { api->handleSetPosition(); });
-    _server->on("/getCurrentPosition", HTTP_GET, [api]() { api->handleGetCurrentPosition(); });
+    on("/setPosition", HTTP_GET, [api]() { api->handleSetPosition(); });
+    on("/getCurrentPosition", HTTP_GET, [api]() { api->handleGetCurrentPosition(); });
     // Intervalometer control
-    _server->on("/setCurrent", HTTP_GET, [api]() { api->handleSetCurrent(); });
-    _server->on("/readPreset", HTTP_GET, [api]() { api->handleGetPresetExposureSettings(); });
-    _server->on("/abort", HTTP_GET, [api]() { api->handleAbortCapture(); });
+    on("/setCurrent", HTTP_GET, [api]() { api->handleSetCurrent(); });
+    on("/readPreset", HTTP_GET, [api]() { api->handleGetPresetExposureSettings(); });
+    on("/abort", HTTP_GET, [api]() { api->handleAbortCapture(); });
     // Tracking rates
-    _server->on("/getTrackingRates", HTTP_GET, [api]() { api->handleGetTrackingRates(); });
-    _server->on("/saveTrackingRatePreset", HTTP_GET,
-                [api]() { api->handleSaveTrackingRatePreset(); });
-    _server->on("/loadTrackingRatePreset", HTTP_GET,
-                [api]() { api->handleLoadTrackingRatePreset(); });
+    on("/getTrackingRates", HTTP_GET, [api]() { api->handleGetTrackingRates(); });
+    on("/saveTrackingRatePreset", HTTP_GET, [api]() { api->handleSaveTrackingRatePreset(); });
+    on("/loadTrackingRatePreset", HTTP_GET, [api]() { api->handleLoadTrackingRatePreset(); });
+    // Several of the above in one request
+    on("/commands", HTTP_POST, [api]() { api->handleCommands(); });
 
     // Status & info
-    _server->on("/status", HTTP_GET, [api]() { api->handleStatusRequest(); });
-    _server->on("/version", HTTP_GET, [api]() { api->handleVersion(); });
+    on("/status", HTTP_GET, [api]() { api->handleStatusRequest(); });
+    on("/state", HTTP_GET, [api]() { api->handleState(); });
+    on("/events", HTTP_GET, [api]() { api->handleEvents(); });
+    on("/version", HTTP_GET, [api]() { api->handleVersion(); });
+    on("/metrics", HTTP_GET, [api]() { api->handleMetrics(); });
 
     // Catalog search
-    _server->on("/starSearch", HTTP_GET, [api]() { api->handleCatalogSearch(); });
+    on("/starSearch", HTTP_GET, [api]() { api->handleCatalogSearch(); });
+    on("/starBatch", HTTP_POST, [api]() { api->handleCatalogBatch(); });
+    on("/visibleObjects", HTTP_GET, [api]() { api->handleVisibleObjects(); });
+    on("/catalogBrowse", HTTP_GET, [api]() { api->handleCatalogBrowse(); });
+    on("/catalogFilter", HTTP_GET, [api]() { api->handleCatalogFilter(); });
+    on("/catalogIndex", HTTP_GET, [api]() { api->handleCatalogIndex(); });
+    on("/skyTile", HTTP_GET, [api]() { api->handleSkyTile(); });
+    on("/catalogCache", HTTP_GET, [api]() { api->handleCatalogCache(); });
+    on("/catalogInfo", HTTP_GET, [api]() { api->handleCatalogInfo(); });
+    on(
+        "/catalogUpload", HTTP_POST, [api]() { api->handleCatalogUploadComplete(); },
+        [api]() { api->handleCatalogUpload(); });
     // Settings
-    _server->on("/setlang", HTTP_GET, [api]() { api->handleSetLanguage(); });
-    _server->on("/getlang", HTTP_GET, [api]() { api->handleGetLanguage(); });
-    _server->on("/langstrings", HTTP_GET, [api]() { api->handleGetLanguageStrings(); });
+    on("/setlang", HTTP_GET, [api]() { api->handleSetLanguage(); });
+    on("/getlang", HTTP_GET, [api]() { api->handleGetLanguage(); });
+    on("/langstrings", HTTP_GET, [api]() { api->handleGetLanguageStrings(); });
 
     // OTA firmware update
-    _server->on("/ota", HTTP_GET, []() { OTAHandler::getInstance().handleOTAPage(); });
-    _server->on(
+    on("/ota", HTTP_GET, []() { OTAHandler::getInstance().handleOTAPage(); });
+    on(
         "/update", HTTP_POST, []() { OTAHandler::getInstance().handleOTAComplete(); },
         []() { OTAHandler::getInstance().handleOTAUpload(); });
-    _server->on("/checkversion", HTTP_GET,
-                []() { OTAHandler::getInstance().handleCheckVersion(); });
-    _server->on("/downloadupdate", HTTP_GET,
-                []() { OTAHandler::getInstance().handleDownloadUpdate(); });
-    _server->on("/otastatus", HTTP_GET, []() { OTAHandler::getInstance().handleOTAStatus(); });
+    on("/checkversion", HTTP_GET, []() { OTAHandler::getInstance().handleCheckVersion(); });
+    on("/downloadupdate", HTTP_GET, []() { OTAHandler::getInstance().handleDownloadUpdate(); });
+    on("/otastatus", HTTP_GET, []() { OTAHandler::getInstance().handleOTAStatus(); });
+}
+
+void ApiHandler::on(const char* uri, HTTPMethod method, WebServer::THandlerFunction handler)
+{
+    size_t route = metrics.addRoute(uri);
+    _server->on(uri, method, [handler, route]() {
+        uint32_t start = micros();
+        handler();
+        metrics.recordRequest(route, micros() - start);
+    });
+}
+
+void ApiHandler::on(const char* uri, HTTPMethod method, WebServer::THandlerFunction handler,
+                    WebServer::THandlerFunction uploadHandler)
+{
+    // Only the handler after the upload is timed, the upload chunks depend on the client
+    size_t route = metrics.addRoute(uri);
+    _server->on(
+        uri, method,
+        [handler, route]() {
+            uint32_t start = micros();
+            handler();
+            metrics.recordRequest(route, micros() - start);
+        },
+        uploadHandler);
 }
 
 // Handler implementations
@@ -132,14 +242,31 @@ void ApiHandler::handleRoot()
     HeapMonitor::log("handleRoot-start");
 #endif
 
-    // Simply serve the HTML as-is - no server-side processing
-    // Language strings are loaded via JavaScript on the client side
-    _server->send_P(200, MIME_TYPE_HTML, (const char*) _interface_index_html_start,
-                    _interface_index_html_end - _interface_index_html_start);
+    // In the order of Languages
+    static EmbeddedAsset pages[LANG_COUNT] = {
+        EmbeddedAsset(_interface_dist_index_en_html_gz_start,
+                      _interface_dist_index_en_html_gz_end),
+        EmbeddedAsset(_interface_dist_index_cn_html_gz_start,
+                      _interface_dist_index_cn_html_gz_end),
+        EmbeddedAsset(_interface_dist_index_de_html_gz_start,
+                      _interface_dist_index_de_html_gz_end),
+        // Next language
+    };
+    EmbeddedAsset& page = pages[language < LANG_COUNT ? language : EN];
+    if (!hasTransferRoom())
+        return;
+
+    // Revalidated on every load, a firmware update or another language changes the ETag
+    if (page.sendValidators(_server, "no-cache"))
+        return;
+
+    // Translated and compressed at build time, no server-side processing and no
+    // /langstrings request, the page carries its strings
+    _server->sendHeader("Content-Encoding", "gzip");
+    sendInBackground(200, MIME_TYPE_HTML, page.getData(), page.getLength());
 
 #if DEBUG == 1
-    print_out("  HTML served directly, size: %d bytes",
-              _interface_index_html_end - _interface_index_html_start);
+    print_out("  HTML served directly, size: %d bytes", page.getLength());
     HeapMonitor::log("handleRoot-end");
 #endif
 }
@@ -155,20 +282,23 @@ void ApiHandler::handleOn()
     uint64_t custom_rate = _server->arg(TRACKING_SPEED).toInt();
     int direction = _server->arg(DIRECTION).toInt();
 
-    trackingRates.setCustomRate(custom_rate);
+    _server->send(200, MIME_TYPE_TEXT, startTracking(custom_rate, direction));
+#if DEBUG == 1
+    print_out("  Tracking ON response sent");
+#endif
+}
+
+const char* ApiHandler::startTracking(uint64_t customRate, bool direction)
+{
+    trackingRates.setCustomRate(customRate);
 #if DEBUG == 1
     print_out("  Direction: %d, Final rate: %llu", direction, trackingRates.getRate());
 #endif
     ra_axis.startTracking(trackingRates.getRate(), direction);
 
     if (intervalometer->getErrorMessage() == ErrorMessage::ERR_MSG_NONE)
-        _server->send(200, MIME_TYPE_TEXT, languageMessageStrings[language][MSG_TRACKING_ON]);
-    else
-        _server->send(200, MIME_TYPE_TEXT,
-                      languageErrorMessageStrings[language][intervalometer->getErrorMessage()]);
-#if DEBUG == 1
-    print_out("  Tracking ON response sent");
-#endif
+        return languageMessageStrings[language][MSG_TRACKING_ON];
+    return languageErrorMessageStrings[language][intervalometer->getErrorMessage()];
 }
 
 void ApiHandler::handleOff()
@@ -183,15 +313,20 @@ void ApiHandler::handleSlewRequest()
     { // if slew is not active - needed for ipad (passes multiple touchon events)
         int slew_speed = _server->arg(SPEED).toInt();
         int direction = _server->arg(DIRECTION).toInt();
-        // limit custom slew speed to 2-400
-        slew_speed = slew_speed > MAX_CUSTOM_SLEW_RATE   ? MAX_CUSTOM_SLEW_RATE
-                     : slew_speed < MIN_CUSTOM_SLEW_RATE ? MIN_CUSTOM_SLEW_RATE
-                                                         : slew_speed;
-        ra_axis.startSlew((2 * ra_axis.rate.tracking) / slew_speed, direction);
-        _server->send(200, MIME_TYPE_TEXT, languageMessageStrings[language][MSG_SLEWING]);
+        _server->send(200, MIME_TYPE_TEXT, startSlew(slew_speed, direction));
     }
 }
 
+const char* ApiHandler::startSlew(int speed, bool direction)
+{
+    // limit custom slew speed to 2-400
+    speed = speed > MAX_CUSTOM_SLEW_RATE   ? MAX_CUSTOM_SLEW_RATE
+            : speed < MIN_CUSTOM_SLEW_RATE ? MIN_CUSTOM_SLEW_RATE
+                                           : speed;
+    ra_axis.startSlew((2 * ra_axis.rate.tracking) / speed, direction);
+    return languageMessageStrings[language][MSG_SLEWING];
+}
+
 void ApiHandler::handleSlewOff()
 {
     if (ra_axis.slewActive)
@@ -433,20 +568,10 @@ void ApiHandler::handleSetCurrent()
         }
         else if (currentMode == "start")
         {
-            Intervalometer::Mode mode = intervalometer->getMode();
-            if ((mode == Intervalometer::Mode::LongExposureMovie ||
-                 mode == Intervalometer::Mode::LongExposureStill) &&
-                !ra_axis.trackingActive)
-            {
-                _server->send(200, MIME_TYPE_TEXT,
-                              languageMessageStrings[language][MSG_TRACKING_NOT_ACTIVE]);
-            }
-            else
-            {
-                intervalometer->startCapture();
-                _server->send(200, MIME_TYPE_TEXT,
-                              languageMessageStrings[language][MSG_CAPTURE_ON]);
-            }
+            bool started = startCapture();
+            _server->send(200, MIME_TYPE_TEXT,
+                          languageMessageStrings[language][started ? MSG_CAPTURE_ON
+                                                                   : MSG_TRACKING_NOT_ACTIVE]);
         }
     }
     else
@@ -456,11 +581,33 @@ void ApiHandler::handleSetCurrent()
     }
 }
 
+// Long exposures need the sky to hold still
+static bool captureNeedsTracking(Intervalometer::Mode mode)
+{
+    return mode == Intervalometer::Mode::LongExposureMovie ||
+           mode == Intervalometer::Mode::LongExposureStill;
+}
+
+bool ApiHandler::startCapture()
+{
+    if (captureNeedsTracking(intervalometer->getMode()) && !ra_axis.trackingActive)
+        return false;
+
+    intervalometer->startCapture();
+    return true;
+}
+
 void ApiHandler::handleGotoRA()
 {
     Position currentPosition = calculatePosition(_server->arg("currentRA"));
     Position targetPosition = calculatePosition(_server->arg("targetRA"));
     int pan_speed = _server->arg(SPEED).toInt();
+    _server->send(200, MIME_TYPE_TEXT, gotoRA(currentPosition, targetPosition, pan_speed));
+}
+
+const char* ApiHandler::gotoRA(const Position& currentPosition, const Position& targetPosition,
+                               int pan_speed)
+{
     bool hemisphereDirection = ra_axis.direction.tracking;
 
     pan_speed = pan_speed > MAX_CUSTOM_SLEW_RATE   ? MAX_CUSTOM_SLEW_RATE
@@ -475,16 +622,21 @@ void ApiHandler::handleGotoRA()
 
     ra_axis.gotoTarget(TRACKER_MOTOR_MICROSTEPPING / 2, (2 * ra_axis.rate.tracking) / pan_speed,
                        currentPosition, targetPosition, hemisphereDirection);
-    _server->send(200, MIME_TYPE_TEXT, languageMessageStrings[language][MSG_GOTO_RA_PANNING_ON]);
+    return languageMessageStrings[language][MSG_GOTO_RA_PANNING_ON];
 }
 
 void ApiHandler::handleSetPosition()
 {
     Position currentPosition = calculatePosition(_server->arg("currentRA"));
+    _server->send(200, MIME_TYPE_TEXT, setPosition(currentPosition));
+}
+
+const char* ApiHandler::setPosition(const Position& currentPosition)
+{
     int64_t stepPosition = currentPosition.arcseconds * trackingRates.getStepsPerSecondSolar();
 
     ra_axis.setPosition(stepPosition);
-    _server->send(200, MIME_TYPE_TEXT, languageMessageStrings[language][MSG_POSITION_SET_SUCCESS]);
+    return languageMessageStrings[language][MSG_POSITION_SET_SUCCESS];
 }
 
 void ApiHandler::handleGetPresetExposureSettings()
@@ -536,9 +688,22 @@ void ApiHandler::handleAbortGoToRA()
     }
 }
 
-void ApiHandler::handleStatusRequest()
+DeviceState ApiHandler::getDeviceState() const
 {
     if (intervalometer->isActive())
+        return DEVICE_CAPTURE;
+    if (ra_axis.slewActive)
+        return ra_axis.goToTarget ? DEVICE_GOTO : DEVICE_SLEWING;
+    if (ra_axis.trackingActive)
+        return DEVICE_TRACKING;
+    return intervalometer->getErrorMessage() == ErrorMessage::ERR_MSG_NONE ? DEVICE_IDLE
+                                                                           : DEVICE_ERROR;
+}
+
+String ApiHandler::getStatusMessage() const
+{
+    DeviceState state = getDeviceState();
+    if (state == DEVICE_CAPTURE)
     {
         // Build status string with progress info
         String statusMsg;
@@ -575,36 +740,127 @@ void ApiHandler::handleStatusRequest()
                 break;
         }
 
-        if (statusMsg.length() > 0)
-        {
-            _server->send(200, MIME_TYPE_TEXT, statusMsg);
-        }
+        return statusMsg;
     }
-    else if (ra_axis.slewActive && !ra_axis.goToTarget)
+    else if (state == DEVICE_SLEWING)
     {
-        _server->send(200, MIME_TYPE_TEXT, languageMessageStrings[language][MSG_SLEWING]);
+        return languageMessageStrings[language][MSG_SLEWING];
     }
-    else if (ra_axis.slewActive && ra_axis.goToTarget)
+    else if (state == DEVICE_GOTO)
     {
-        _server->send(200, MIME_TYPE_TEXT,
-                      languageMessageStrings[language][MSG_GOTO_RA_PANNING_ON]);
+        return languageMessageStrings[language][MSG_GOTO_RA_PANNING_ON];
+    }
+    else if (state == DEVICE_TRACKING)
+    {
+        return languageMessageStrings[language][MSG_TRACKING_ON];
     }
-    else if (ra_axis.trackingActive)
+    else if (state == DEVICE_IDLE)
     {
-        _server->send(200, MIME_TYPE_TEXT, languageMessageStrings[language][MSG_TRACKING_ON]);
+        return languageMessageStrings[language][MSG_IDLE];
     }
     else
     {
-        if (intervalometer->getErrorMessage() == ErrorMessage::ERR_MSG_NONE)
-            _server->send(200, MIME_TYPE_TEXT, languageMessageStrings[language][MSG_IDLE]);
-        else
-            _server->send(200, MIME_TYPE_TEXT,
-                          languageErrorMessageStrings[language][intervalometer->getErrorMessage()]);
+        return languageErrorMessageStrings[language][intervalometer->getErrorMessage()];
+    }
+}
+
+void ApiHandler::handleStatusRequest()
+{
+    String statusMsg = getStatusMessage();
+    if (statusMsg.length() > 0)
+    {
+        _server->send(200, MIME_TYPE_TEXT, statusMsg);
     }
 
     _server->send(204, MIME_TYPE_TEXT, "dummy");
 }
 
+void ApiHandler::handleState()
+{
+    ErrorMessage error = intervalometer->getErrorMessage();
+
+    // Codes only, formatted into one buffer, the client localizes them
+    char json[320];
+    snprintf(json, sizeof(json),
+             "{\"v\":%d,\"state\":%d,\"tracking\":%d,\"direction\":%d,\"trackingRate\":%llu,"
+             "\"capture\":%d,\"exposures\":%u,\"totalExposures\":%u,\"error\":%d,\"ra\":%ld,"
+             "\"lang\":%d,\"firmware\":\"%s\",\"internalVersion\":%d}",
+             DEVICE_STATE_VERSION, (int) getDeviceState(), ra_axis.trackingActive ? 1 : 0,
+             ra_axis.direction.tracking ? 1 : 0, (unsigned long long) trackingRates.getRate(),
+             (int) intervalometer->getState(), (unsigned) intervalometer->getExposuresTaken(),
+             (unsigned) intervalometer->getSettings().exposures,
+             error == ErrorMessage::ERR_MSG_NONE ? -1 : (int) error, getCurrentRaSeconds(),
+             (int) language, BUILD_VERSION, INTERNAL_VERSION);
+
+    _server->send(200, MIME_APPLICATION_JSON, json);
+}
+
+String ApiHandler::getStateEvent() const
+{
+    ArduinoJson::JsonDocument state;
+    state["status"] = getStatusMessage();
+    state["trackingActive"] = ra_axis.trackingActive;
+    state["slewActive"] = ra_axis.slewActive && !ra_axis.goToTarget;
+    state["goToTarget"] = ra_axis.slewActive && ra_axis.goToTarget;
+    state["intervalometerActive"] = intervalometer->isActive();
+    state["captureState"] = (int) intervalometer->getState();
+    state["exposuresTaken"] = intervalometer->getExposuresTaken();
+    state["exposures"] = intervalometer->getSettings().exposures;
+    state["ra"] = getCurrentRaSeconds();
+
+    String json;
+    serializeJson(state, json);
+    return json;
+}
+
+void ApiHandler::handleEvents()
+{
+    // The page opens the stream with its clock, like it polled /getCurrentPosition before
+    if (_server->hasArg(UTC_TIME))
+        ApparentPlace::getInstance().setEpoch(_server->arg(UTC_TIME));
+
+    if (!_events.subscribe(_server->client(), getStateEvent()))
+        _server->send(503, MIME_TYPE_TEXT, "Too many event streams");
+}
+
+void ApiHandler::loop()
+{
+    _transfers.loop();
+    if (_events.isDue())
+        _events.publish(getStateEvent());
+}
+
+bool ApiHandler::hasTransferRoom()
+{
+    if (_transfers.hasRoom())
+        return true;
+    // Every slot holds a slow download, the browser tries again shortly
+    _server->sendHeader("Retry-After", "1");
+    _server->send(503, MIME_TYPE_TEXT, "Server busy");
+    return false;
+}
+
+void ApiHandler::sendInBackground(int code, const char* contentType, const uint8_t* data,
+                                  size_t length)
+{
+    // WebServer writes the status line and the collected headers, the body follows from loop()
+    _server->setContentLength(length);
+    _server->send(code, contentType, "");
+    _transfers.start(_server->client(), data, length);
+}
+
+void ApiHandler::sendGenerated(const char* contentType, TransferSource* source,
+                               const char* headers)
+{
+    // WebServer would end a chunked response when the handler returns, the queue writes the
+    // head itself. Without keep-alive the connection closes after the last chunk.
+    String head = "HTTP/1.1 200 OK\r\nContent-Type: ";
+    head += contentType;
+    head += "\r\nConnection: close\r\n";
+    head += headers;
+    _transfers.start(_server->client(), head, source);
+}
+
 void ApiHandler::handleVersion()
 {
     String json = "{";
@@ -616,6 +872,54 @@ void ApiHandler::handleVersion()
     _server->send(200, MIME_APPLICATION_JSON, json);
 }
 
+/**
+ * The exposition text of GET /metrics, a few parts per piece. A part is
+ * written while the buffer has room for the largest one, the metrics are
+ * sampled as the scrape goes out.
+ */
+class MetricsSource : public TransferSource, public MetricsSink
+{
+  public:
+    MetricsSource() : _part(0), _used(0)
+    {
+    }
+
+    bool next(const uint8_t*& data, size_t& length) override
+    {
+        _used = 0;
+        while (_part < metrics.getPartCount() && sizeof(_buffer) - _used >= METRICS_PART_SIZE)
+            metrics.writePart(_part++, *this);
+        data = reinterpret_cast<const uint8_t*>(_buffer);
+        length = _used;
+        return true;
+    }
+
+    void write(const char* text, size_t len) override
+    {
+        configASSERT(_used + len <= sizeof(_buffer));
+        memcpy(_buffer + _used, text, len);
+        _used += len;
+    }
+
+  private:
+    size_t _part;
+    char _buffer[METRICS_SOURCE_BUFFER_SIZE];
+    size_t _used;
+};
+
+void ApiHandler::handleMetrics()
+{
+    if (!hasTransferRoom())
+        return;
+    MetricsSource* source = new (std::nothrow) MetricsSource();
+    if (source == nullptr)
+    {
+        _server->send(503, MIME_TYPE_TEXT, "Not enough memory");
+        return;
+    }
+    sendGenerated(MIME_PROMETHEUS_TEXT, source, "Cache-Control: no-cache\r\n");
+}
+
 void ApiHandler::handleGetTrackingRates()
 {
 #if DEBUG == 1
@@ -654,18 +958,14 @@ void ApiHandler::handleGetTrackingRates()
 
 void ApiHandler::handleGetCurrentPosition()
 {
-    String utcTimeStr = _server->arg("utcTime");
+    String utcTimeStr = _server->arg(UTC_TIME);
     String timezoneStr = _server->arg("timezone");
     float longitude = _server->arg("longitude").toFloat();
-    int64_t currentStepPosition = ra_axis.getPosition();
 
-    // Calculate current RA position in arcseconds (0-86399)
-    // Normalize position to handle negative values and multiple revolutions
-    int64_t normalizedSteps =
-        ((currentStepPosition % STEPS_PER_TRACKER_FULL_REV_INT) + STEPS_PER_TRACKER_FULL_REV_INT) %
-        STEPS_PER_TRACKER_FULL_REV_INT;
-    long raSeconds =
-        (long) ((normalizedSteps * RA_SECONDS_PER_FULL_REV) / STEPS_PER_TRACKER_FULL_REV_INT);
+    // The web interface polls this with its clock, keep the catalogue epoch current
+    ApparentPlace::getInstance().setEpoch(utcTimeStr);
+
+    long raSeconds = getCurrentRaSeconds();
 
     String response = "{\"ra\":" + String(raSeconds) + ",\"utcTime\":\"" + utcTimeStr + "\"" +
                       ",\"longitude\":" + String(longitude) + "}";
@@ -706,17 +1006,279 @@ void ApiHandler::handleLoadTrackingRatePreset()
         _server->send(400, MIME_TYPE_TEXT, "Invalid preset number");
 }
 
+// Commands of POST /commands, named after the endpoint doing the same
+enum BatchCommandType
+{
+    BATCH_SET_POSITION,
+    BATCH_LOAD_RATE_PRESET,
+    BATCH_TRACKING_ON,
+    BATCH_TRACKING_OFF,
+    BATCH_START_SLEW,
+    BATCH_STOP_SLEW,
+    BATCH_GOTO_RA,
+    BATCH_ABORT_GOTO,
+    BATCH_START_CAPTURE,
+    BATCH_ABORT_CAPTURE,
+    BATCH_COMMAND_COUNT
+};
+
+static const char* const batchCommandNames[BATCH_COMMAND_COUNT] = {
+    "setPosition",
+    "loadTrackingRatePreset",
+    "on",
+    "off",
+    "startslew",
+    "stopslew",
+    "gotoRA",
+    "abort-goto-ra",
+    "startCapture",
+    "abort",
+};
+
+struct BatchCommand
+{
+    BatchCommandType type;
+    int64_t currentRA; // Seconds of RA, as the currentRA/targetRA arguments
+    int64_t targetRA;
+    uint64_t trackingSpeed;
+    int speed;
+    int preset; // -1 for none
+    bool direction;
+};
+
+// Integer member of a command in [min, max], or def if it is missing and optional
+static bool readBatchInt(ArduinoJson::JsonObjectConst item, const char* key, int64_t min,
+                         int64_t max, bool required, int64_t def, int64_t& value)
+{
+    ArduinoJson::JsonVariantConst member = item[key];
+    if (member.isNull())
+    {
+        value = def;
+        return !required;
+    }
+    if (!member.is<int64_t>())
+        return false;
+    value = member.as<int64_t>();
+    return value >= min && value <= max;
+}
+
+// Checks a command and reads its arguments, nothing is executed
+static const char* parseBatchCommand(ArduinoJson::JsonObjectConst item, BatchCommand& command)
+{
+    const char* name = item["command"] | "";
+    int type = 0;
+    while (type < BATCH_COMMAND_COUNT && strcmp(name, batchCommandNames[type]) != 0)
+        type++;
+    if (type == BATCH_COMMAND_COUNT)
+        return "Unknown command";
+    command.type = (BatchCommandType) type;
+
+    int64_t currentRA = 0, targetRA = 0, trackingSpeed = 0, speed = 0, preset = -1, direction = 0;
+    bool valid = true;
+    switch (command.type)
+    {
+        case BATCH_SET_POSITION:
+            valid = readBatchInt(item, "currentRA", 0, 86399, true, 0, currentRA);
+            break;
+        case BATCH_LOAD_RATE_PRESET:
+            valid = readBatchInt(item, PRESET, 0, 4, true, 0, preset);
+            break;
+        case BATCH_TRACKING_ON:
+            valid = readBatchInt(item, DIRECTION, 0, 1, true, 0, direction) &&
+                    readBatchInt(item, TRACKING_SPEED, 0, INT64_MAX, false, 0, trackingSpeed);
+            break;
+        case BATCH_START_SLEW:
+            valid = readBatchInt(item, DIRECTION, 0, 1, true, 0, direction) &&
+                    readBatchInt(item, SPEED, INT32_MIN, INT32_MAX, true, 0, speed);
+            break;
+        case BATCH_GOTO_RA:
+            valid = readBatchInt(item, "currentRA", 0, 86399, true, 0, currentRA) &&
+                    readBatchInt(item, "targetRA", 0, 86399, true, 0, targetRA) &&
+                    readBatchInt(item, SPEED, INT32_MIN, INT32_MAX, true, 0, speed);
+            break;
+        case BATCH_START_CAPTURE:
+            valid = readBatchInt(item, PRESET, 0, 4, false, -1, preset);
+            break;
+        default:
+            break;
+    }
+    if (!valid)
+        return "Missing or invalid argument";
+
+    command.currentRA = currentRA;
+    command.targetRA = targetRA;
+    command.trackingSpeed = (uint64_t) trackingSpeed;
+    command.speed = (int) speed;
+    command.preset = (int) preset;
+    command.direction = direction != 0;
+    return nullptr;
+}
+
+void ApiHandler::handleCommands()
+{
+    ArduinoJson::JsonDocument request;
+    if (deserializeJson(request, _server->arg("plain")) != DeserializationError::Ok)
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid JSON");
+        return;
+    }
+
+    ArduinoJson::JsonArrayConst items = request["commands"];
+    size_t count = items.size();
+    if (count == 0 || count > COMMAND_BATCH_MAX)
+    {
+        _server->send(400, MIME_TYPE_TEXT,
+                      "1 to " + String(COMMAND_BATCH_MAX) + " commands required");
+        return;
+    }
+
+    // Everything is checked before the first command runs. Capture, tracking and the capture
+    // mode are followed through the list: only one capture can run and a long exposure needs
+    // tracking when it starts.
+    BatchCommand commands[COMMAND_BATCH_MAX];
+    bool capturing = intervalometer->isActive();
+    bool tracking = ra_axis.trackingActive;
+    Intervalometer::Mode mode = intervalometer->getMode();
+    for (size_t i = 0; i < count; i++)
+    {
+        const char* error = items[i].is<ArduinoJson::JsonObjectConst>()
+                                ? parseBatchCommand(items[i].as<ArduinoJson::JsonObjectConst>(),
+                                                    commands[i])
+                                : "Command object expected";
+        if (error == nullptr && commands[i].type == BATCH_START_CAPTURE)
+        {
+            if (commands[i].preset >= 0)
+                mode = intervalometer->getPresetMode(commands[i].preset);
+            if (capturing)
+                error = languageMessageStrings[language][MSG_CAPTURE_ALREADY_ON];
+            else if (captureNeedsTracking(mode) && !tracking)
+                error = languageMessageStrings[language][MSG_TRACKING_NOT_ACTIVE];
+            capturing = true;
+        }
+        else if (error == nullptr && commands[i].type == BATCH_ABORT_CAPTURE)
+        {
+            capturing = false;
+        }
+        else if (error == nullptr && commands[i].type == BATCH_TRACKING_ON)
+        {
+            tracking = true;
+        }
+        else if (error == nullptr && commands[i].type == BATCH_TRACKING_OFF)
+        {
+            tracking = false;
+        }
+
+        if (error != nullptr)
+        {
+            ArduinoJson::JsonDocument response;
+            response["error"] = error;
+            response["index"] = i;
+            String json;
+            serializeJson(response, json);
+            _server->send(400, MIME_APPLICATION_JSON, json);
+            return;
+        }
+    }
+    request.clear();
+
+    // One handler call, no other request can come in between the commands
+    ArduinoJson::JsonDocument response;
+    ArduinoJson::JsonArray results = response["results"].to<ArduinoJson::JsonArray>();
+    size_t completed = 0;
+    bool refused = false;
+    for (; completed < count && !refused; completed++)
+    {
+        const BatchCommand& command = commands[completed];
+        const char* message = nullptr;
+        // Set with the reason as message by a command that did not run
+        bool ok = true;
+        switch (command.type)
+        {
+            case BATCH_SET_POSITION:
+                message = setPosition(toPosition(command.currentRA));
+                break;
+            case BATCH_LOAD_RATE_PRESET:
+                trackingRates.loadTrackingRatePreset(command.preset);
+                message = languageMessageStrings[language][MSG_OK];
+                break;
+            case BATCH_TRACKING_ON:
+                message = startTracking(command.trackingSpeed, command.direction);
+                break;
+            case BATCH_TRACKING_OFF:
+                ra_axis.stopTracking();
+                message = languageMessageStrings[language][MSG_TRACKING_OFF];
+                break;
+            case BATCH_START_SLEW:
+                message = ra_axis.slewActive ? languageMessageStrings[language][MSG_SLEWING]
+                                             : startSlew(command.speed, command.direction);
+                break;
+            case BATCH_STOP_SLEW:
+                if (ra_axis.slewActive)
+                    ra_axis.stopSlew();
+                message = languageMessageStrings[language][MSG_SLEW_CANCELLED];
+                break;
+            case BATCH_GOTO_RA:
+                message = gotoRA(toPosition(command.currentRA), toPosition(command.targetRA),
+                                 command.speed);
+                break;
+            case BATCH_ABORT_GOTO:
+                if (ra_axis.slewActive)
+                    ra_axis.stopGotoTarget();
+                message = languageMessageStrings[language][MSG_GOTO_RA_PANNING_OFF];
+                break;
+            case BATCH_START_CAPTURE:
+                intervalometer->setErrorMessage(ERR_MSG_NONE);
+                if (command.preset >= 0)
+                    intervalometer->readSettingsFromPreset(command.preset);
+                // Checked above already, a refusal here means the checks missed a case
+                ok = startCapture();
+                message = languageMessageStrings[language][ok ? MSG_CAPTURE_ON
+                                                               : MSG_TRACKING_NOT_ACTIVE];
+                break;
+            case BATCH_ABORT_CAPTURE:
+                if (intervalometer->isActive())
+                    intervalometer->abortCapture();
+                message = languageMessageStrings[language][MSG_CAPTURE_OFF];
+                break;
+            default:
+                break;
+        }
+
+        // A refused command ends the list, the commands before it stay done
+        refused = !ok;
+        ArduinoJson::JsonObject result = results.add<ArduinoJson::JsonObject>();
+        result["command"] = batchCommandNames[command.type];
+        result["ok"] = ok;
+        result["message"] = message;
+    }
+
+    response["completed"] = refused ? completed - 1 : completed;
+    response["state"] = (int) getDeviceState();
+
+    String json;
+    serializeJson(response, json);
+    _server->send(refused ? 409 : 200, MIME_APPLICATION_JSON, json);
+}
+
 void ApiHandler::handleCatalogSearch()
 {
-    StarDatabaseType catalogType = (StarDatabaseType) _server->arg(STAR_CATALOG).toInt();
+    // A missing catalogue argument (DB_NONE) searches all catalogues
+    int catalogArg = _server->arg(STAR_CATALOG).toInt();
     String objectName = _server->arg(STAR_NAME);
 
-    starDatabase = handleStarDatabase(catalogType);
-
 #if DEBUG == 1
-    print_out("Received catalog=%d, name=%s", catalogType, objectName.c_str());
+    print_out("Received catalog=%d, name=%s", catalogArg, objectName.c_str());
 #endif
 
+    if (_server->hasArg(UTC_TIME))
+        ApparentPlace::getInstance().setEpoch(_server->arg(UTC_TIME));
+
+    if (catalogArg < DB_NONE || catalogArg >= DB_COUNT)
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid catalog");
+        return;
+    }
+
     if (objectName.length() == 0)
     {
         _server->send(400, MIME_TYPE_TEXT, "Object name required");
@@ -724,23 +1286,30 @@ void ApiHandler::handleCatalogSearch()
     }
 
     StarUnifiedEntry foundObject;
-    bool found = starDatabase->findByName(objectName.c_str(), foundObject);
+    bool found = StarDatabaseRegistry::getInstance().findByName((StarDatabaseType) catalogArg,
+                                                                objectName, foundObject);
 
     if (found)
     {
+        // The mount points at the apparent place, catalogue positions are J2000
+        const ApparentPlace& apparentPlace = ApparentPlace::getInstance();
+        apparentPlace.apply(foundObject);
+
         ArduinoJson::JsonDocument objectData;
         String json;
         objectData["name"] = foundObject.name;
-        objectData["ra"] = (long long) (foundObject.ra_hours * 3600.0);
-        objectData["dec"] = (long long) (foundObject.dec_deg * 3600.0);
+        objectData["ra"] = foundObject.raSeconds();
+        objectData["dec"] = foundObject.decArcseconds();
         objectData["type"] = foundObject.type_str;
         objectData["magnitude"] = foundObject.magnitude;
         objectData["constellation"] = foundObject.constellation;
+        objectData["catalog"] = (int) foundObject.source_db;
+        objectData["apparent"] = apparentPlace.isValid();
         serializeJson(objectData, json);
 
 #if DEBUG == 1
         print_out("Found object: %s at RA=%.2fh, Dec=%.2f°", foundObject.name.c_str(),
-                  foundObject.ra_hours, foundObject.dec_deg);
+                  foundObject.raHours(), foundObject.decDegrees());
 #endif
         _server->send(200, MIME_APPLICATION_JSON, json);
     }
@@ -752,3 +1321,911 @@ void ApiHandler::handleCatalogSearch()
         _server->send(404, "text/plain", "Object not found");
     }
 }
+
+/**
+ * Writes catalogue records as JSON objects into a fixed buffer, one piece
+ * of the response at a time. The transfer queue asks for the next piece
+ * once the last one is out, so a response of any size needs the same
+ * memory and a slow client holds up nothing but its own response. The
+ * subclasses pick up where the previous piece ended.
+ */
+class CatalogJsonSource : public TransferSource, public CatalogueRecordVisitor
+{
+  public:
+    // With size, records carry their apparent size in arcminutes too
+    CatalogJsonSource(bool size = false)
+        : _size(size), _used(0), _count(0), _last(0), _complete(false)
+    {
+    }
+
+    bool next(const uint8_t*& data, size_t& length) override
+    {
+        // POST /catalogUpload erases the partition the records are read from
+        StarDatabaseRegistry::Reader reader;
+        if (!reader.isOpen())
+            return false;
+
+        _used = 0;
+        while (!_complete && hasRoom())
+            _complete = !write();
+        data = reinterpret_cast<const uint8_t*>(_buffer);
+        length = _used;
+        return true;
+    }
+
+    // Records of browse and filter pages, the scan stops once the buffer is full
+    bool visit(size_t index, const CatalogueRecord& record) override
+    {
+        int32_t ra = skyAngleFromCatalogue(record.ra);
+        int32_t dec = skyAngleFromCatalogue(record.dec);
+        ApparentPlace::getInstance().apply(ra, dec);
+
+        char numbers[96];
+        snprintf(numbers, sizeof(numbers),
+                 "%s{\"index\":%u,\"ra\":%ld,\"dec\":%ld,\"magnitude\":%.2f",
+                 _count > 0 ? "," : "", (unsigned) index, (long) skyAngleToSeconds(ra),
+                 (long) skyAngleToArcseconds(dec), record.magnitude());
+        append(numbers);
+        if (_size)
+        {
+            snprintf(numbers, sizeof(numbers), ",\"size\":%.1f", record.sizeArcmin());
+            append(numbers);
+        }
+        appendField("name", record.name);
+        appendField("type", record.type);
+        appendField("constellation", record.constellation);
+        append("}");
+
+        _count++;
+        _last = index;
+        return hasRoom();
+    }
+
+  protected:
+    // Write to the buffer while hasRoom(), false once the end of the body is written
+    virtual bool write() = 0;
+
+    // There is room for another record and the end of the body
+    bool hasRoom() const
+    {
+        return _used + CATALOG_JSON_RECORD_MAX <= sizeof(_buffer);
+    }
+
+    // An object of GET /visibleObjects with its place in the sky of the observer
+    void visibleObject(const CatalogueRecord& record, const SkyVisibleObject& object)
+    {
+        int32_t ra = skyAngleFromCatalogue(record.ra);
+        int32_t dec = skyAngleFromCatalogue(record.dec);
+        ApparentPlace::getInstance().apply(ra, dec);
+
+        char numbers[160];
+        snprintf(numbers, sizeof(numbers),
+                 "%s{\"ra\":%ld,\"dec\":%ld,\"altitude\":%.2f,\"azimuth\":%.2f,"
+                 "\"magnitude\":%.2f,\"catalog\":%d",
+                 _count > 0 ? "," : "", (long) skyAngleToSeconds(ra),
+                 (long) skyAngleToArcseconds(dec), object.altitude_deg, object.azimuth_deg,
+                 record.magnitude(), (int) object.source);
+        append(numbers);
+        appendField("name", record.name);
+        appendField("type", record.type);
+        appendField("constellation", record.constellation);
+        append("}");
+        _count++;
+    }
+
+    // A result of POST /starBatch, object is nullptr if the name was not found
+    void batchResult(const StarBatchEntry& entry, const StarUnifiedEntry* object, bool apparent)
+    {
+        if (object == nullptr)
+        {
+            append(_count > 0 ? ",{\"found\":false" : "{\"found\":false");
+            appendField("query", entry.name.c_str());
+            append("}");
+            _count++;
+            return;
+        }
+
+        char numbers[160];
+        snprintf(numbers, sizeof(numbers),
+                 "%s{\"found\":true,\"ra\":%ld,\"dec\":%ld,\"magnitude\":%.2f,"
+                 "\"catalog\":%d,\"apparent\":%s",
+                 _count > 0 ? "," : "", (long) object->raSeconds(), (long) object->decArcseconds(),
+                 object->magnitude, (int) entry.source, apparent ? "true" : "false");
+        append(numbers);
+        appendField("query", entry.name.c_str());
+        appendField("name", object->name.c_str());
+        appendField("type", object->type_str.c_str());
+        appendField("constellation", object->constellation.c_str());
+        append("}");
+        _count++;
+    }
+
+    // Text fits as long as a record is written only while hasRoom()
+    void append(const char* text)
+    {
+        size_t length = strlen(text);
+        configASSERT(_used + length <= sizeof(_buffer));
+        memcpy(_buffer + _used, text, length);
+        _used += length;
+    }
+
+    size_t getCount() const
+    {
+        return _count;
+    }
+    size_t getLast() const
+    {
+        return _last;
+    }
+
+  private:
+    // "key":"value" with the value escaped for JSON, long values are cut
+    void appendField(const char* key, const char* value)
+    {
+        char field[128];
+        size_t length = snprintf(field, sizeof(field), ",\"%s\":\"", key);
+        for (; *value != '\0' && length < sizeof(field) - 3; value++)
+        {
+            if (*value == '"' || *value == '\\')
+                field[length++] = '\\';
+            if ((unsigned char) *value >= 0x20)
+                field[length++] = *value;
+        }
+        field[length++] = '"';
+        field[length] = '\0';
+        append(field);
+    }
+
+    bool _size;
+    char _buffer[CATALOG_BROWSE_BUFFER_SIZE];
+    size_t _used;
+    size_t _count;
+    size_t _last;
+    bool _complete;
+};
+
+// The results of POST /starBatch in request order
+class StarBatchList : public CatalogJsonSource
+{
+  public:
+    // Takes over entries
+    StarBatchList(StarBatchEntry* entries, size_t count)
+        : _entries(entries), _entry_count(count), _next(0), _started(false)
+    {
+    }
+
+    ~StarBatchList()
+    {
+        delete[] _entries;
+    }
+
+  protected:
+    bool write() override
+    {
+        if (!_started)
+        {
+            _started = true;
+            append("[");
+        }
+
+        // The registry resolved the names, the objects are read as they are sent
+        const StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+        const ApparentPlace& apparentPlace = ApparentPlace::getInstance();
+        for (; _next < _entry_count && hasRoom(); _next++)
+        {
+            const StarBatchEntry& entry = _entries[_next];
+            const StarDatabase* db = registry.getDatabase(entry.source);
+            StarUnifiedEntry foundObject;
+            if (db != nullptr && db->findByIndex(entry.index, foundObject))
+            {
+                apparentPlace.apply(foundObject);
+                batchResult(entry, &foundObject, apparentPlace.isValid());
+            }
+            else
+            {
+                batchResult(entry, nullptr, false);
+            }
+        }
+        if (_next < _entry_count)
+            return true;
+        append("]");
+        return false;
+    }
+
+  private:
+    StarBatchEntry* _entries;
+    size_t _entry_count;
+    size_t _next;
+    bool _started;
+};
+
+void ApiHandler::handleCatalogBatch()
+{
+    ArduinoJson::JsonDocument request;
+    if (deserializeJson(request, _server->arg("plain")) != DeserializationError::Ok)
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid JSON");
+        return;
+    }
+
+    ArduinoJson::JsonArrayConst names = request["names"];
+    int defaultCatalog = request[STAR_CATALOG] | (int) DB_NONE;
+    size_t count = names.size();
+    if (count == 0 || count > STAR_BATCH_MAX_NAMES)
+    {
+        _server->send(400, MIME_TYPE_TEXT,
+                      "1 to " + String(STAR_BATCH_MAX_NAMES) + " names required");
+        return;
+    }
+    if (!hasTransferRoom())
+        return;
+
+    if (request[UTC_TIME].is<const char*>())
+        ApparentPlace::getInstance().setEpoch(String(request[UTC_TIME].as<const char*>()));
+
+    // count is capped above, the request cannot ask for more than the batch limit
+    StarBatchEntry* entries = new (std::nothrow) StarBatchEntry[count];
+    if (entries == nullptr)
+    {
+        _server->send(503, MIME_TYPE_TEXT, "Not enough memory");
+        return;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        // Plain names use the default catalogue, {"name", "starCatalog"} picks one per name
+        ArduinoJson::JsonVariantConst item = names[i];
+        int catalogArg = defaultCatalog;
+        if (item.is<ArduinoJson::JsonObjectConst>())
+        {
+            catalogArg = item[STAR_CATALOG] | defaultCatalog;
+            item = item["name"];
+        }
+        if (catalogArg < DB_NONE || catalogArg >= DB_COUNT || !item.is<const char*>())
+        {
+            delete[] entries;
+            _server->send(400, MIME_TYPE_TEXT, "Invalid catalog or name");
+            return;
+        }
+        entries[i].name = item.as<const char*>();
+        entries[i].catalogue = (StarDatabaseType) catalogArg;
+    }
+    // The request is not needed anymore, free it before the response is built
+    request.clear();
+
+    // Resolve all names first, one pass per catalogue
+    StarDatabaseRegistry::getInstance().findBatch(entries, count);
+
+    StarBatchList* list = new (std::nothrow) StarBatchList(entries, count);
+    if (list == nullptr)
+    {
+        delete[] entries;
+        _server->send(503, MIME_TYPE_TEXT, "Not enough memory");
+        return;
+    }
+    sendGenerated(MIME_APPLICATION_JSON, list);
+}
+
+// The objects found by GET /visibleObjects, best first
+class VisibleObjectList : public CatalogJsonSource
+{
+  public:
+    // Takes over results
+    VisibleObjectList(SkyVisibleObject* results, size_t count)
+        : _results(results), _result_count(count), _next(0), _started(false)
+    {
+    }
+
+    ~VisibleObjectList()
+    {
+        delete[] _results;
+    }
+
+  protected:
+    bool write() override
+    {
+        if (!_started)
+        {
+            _started = true;
+            append("[");
+        }
+
+        const StarDatabaseRegistry& registry = StarDatabaseRegistry::getInstance();
+        for (; _next < _result_count && hasRoom(); _next++)
+        {
+            const SkyVisibleObject& object = _results[_next];
+            const StarDatabase* db = registry.getDatabase(object.source);
+            const CatalogueBlob* blob = db != nullptr ? db->getBlob() : nullptr;
+            CatalogueRecord record;
+            if (blob != nullptr && CataloguePageCache::getInstance().getRecord(
+                                       *blob, db->isCompactProjection(), object.index, record))
+                visibleObject(record, object);
+        }
+        if (_next < _result_count)
+            return true;
+        append("]");
+        return false;
+    }
+
+  private:
+    SkyVisibleObject* _results;
+    size_t _result_count;
+    size_t _next;
+    bool _started;
+};
+
+void ApiHandler::handleVisibleObjects()
+{
+    SkyVisibilityQuery query;
+    if (!_server->hasArg(LATITUDE) || !_server->hasArg(LONGITUDE) ||
+        !ApparentPlace::parseUtc(_server->arg(UTC_TIME), query.utc))
+    {
+        _server->send(400, MIME_TYPE_TEXT, "lat, lon and utcTime required");
+        return;
+    }
+
+    query.latitude_deg = _server->arg(LATITUDE).toFloat();
+    query.longitude_deg = _server->arg(LONGITUDE).toFloat();
+    if (query.latitude_deg < -90.0f || query.latitude_deg > 90.0f ||
+        query.longitude_deg < -180.0f || query.longitude_deg > 360.0f)
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid position");
+        return;
+    }
+
+    // A missing catalogue argument (DB_NONE) scans NGC 2000 and BSC5
+    int catalogArg = _server->arg(STAR_CATALOG).toInt();
+    int limit = _server->hasArg(RESULT_LIMIT) ? _server->arg(RESULT_LIMIT).toInt()
+                                              : VISIBLE_OBJECTS_DEFAULT_LIMIT;
+    if (catalogArg < DB_NONE || catalogArg >= DB_COUNT || limit < 1 ||
+        limit > SKY_VISIBILITY_MAX_RESULTS)
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid catalog or limit");
+        return;
+    }
+    if (!hasTransferRoom())
+        return;
+
+    query.catalogue = (StarDatabaseType) catalogArg;
+    query.min_altitude_deg = _server->arg(MIN_ALTITUDE).toFloat();
+    query.max_magnitude = _server->hasArg(MAX_MAGNITUDE) ? _server->arg(MAX_MAGNITUDE).toFloat()
+                                                         : SKY_VISIBILITY_ANY_MAGNITUDE;
+    query.sort = _server->arg(SORT_ORDER) == "magnitude" ? SORT_BY_MAGNITUDE : SORT_BY_ALTITUDE;
+
+    // The results and the list are the only allocations, however many objects are listed
+    SkyVisibleObject* results = new (std::nothrow) SkyVisibleObject[limit];
+    if (results == nullptr)
+    {
+        _server->send(503, MIME_TYPE_TEXT, "Not enough memory");
+        return;
+    }
+
+#if DEBUG == 1
+    unsigned long start = micros();
+#endif
+    size_t count = SkyVisibility(query).find(results, limit);
+#if DEBUG == 1
+    print_out("Visible objects: %zu listed in %lu us", count, micros() - start);
+#endif
+
+    // The scan set the epoch, positions are reported as apparent place of date
+    VisibleObjectList* list = new (std::nothrow) VisibleObjectList(results, count);
+    if (list == nullptr)
+    {
+        delete[] results;
+        _server->send(503, MIME_TYPE_TEXT, "Not enough memory");
+        return;
+    }
+    sendGenerated(MIME_APPLICATION_JSON, list);
+}
+
+// A page of GET /catalogBrowse, continued after the last record of each piece
+class CatalogBrowsePage : public CatalogJsonSource
+{
+  public:
+    CatalogBrowsePage(const CatalogueBlob& blob, bool compact, CatalogueSortKey key,
+                      StarDatabaseType type, size_t total, size_t offset, long after,
+                      size_t limit)
+        : _browser(blob, compact, key), _key(key), _type(type), _total(total), _offset(offset),
+          _after(after), _limit(limit), _started(false), _listed(false)
+    {
+    }
+
+  protected:
+    bool write() override
+    {
+        char text[160];
+        if (!_started)
+        {
+            _started = true;
+            snprintf(text, sizeof(text),
+                     "{\"catalog\":%d,\"sort\":\"%s\",\"total\":%u,\"apparent\":%s,\"objects\":[",
+                     (int) _type, CatalogueBrowser::getKeyName(_key), (unsigned) _total,
+                     ApparentPlace::getInstance().isValid() ? "true" : "false");
+            append(text);
+            return true;
+        }
+
+        if (!_listed)
+        {
+            size_t done = getCount();
+            if (done > 0)
+                _browser.browseAfter(getLast(), _limit - done, *this);
+            else if (_after >= 0)
+                _browser.browseAfter((size_t) _after, _limit, *this);
+            else
+                _browser.browse(_offset, _limit, *this);
+            // Stopped by the limit or the end of the catalogue rather than a full buffer
+            _listed = hasRoom() || getCount() == _limit;
+            return true;
+        }
+
+        // The index of the last record continues with the next page, null after the last page
+        if (getCount() == _limit)
+            snprintf(text, sizeof(text), "],\"next\":%u}", (unsigned) getLast());
+        else
+            snprintf(text, sizeof(text), "],\"next\":null}");
+        append(text);
+        return false;
+    }
+
+  private:
+    CatalogueBrowser _browser;
+    CatalogueSortKey _key;
+    StarDatabaseType _type;
+    size_t _total;
+    size_t _offset;
+    long _after;
+    size_t _limit;
+    bool _started;
+    bool _listed;
+};
+
+void ApiHandler::handleCatalogBrowse()
+{
+    StarDatabaseType type = (StarDatabaseType) _server->arg(STAR_CATALOG).toInt();
+    const StarDatabase* db = StarDatabaseRegistry::getInstance().getDatabase(type);
+    const CatalogueBlob* blob = db != nullptr ? db->getBlob() : nullptr;
+    if (blob == nullptr)
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid catalog");
+        return;
+    }
+
+    CatalogueSortKey key = SORT_KEY_INDEX;
+    if (_server->hasArg(SORT_ORDER) &&
+        !CatalogueBrowser::parseKey(_server->arg(SORT_ORDER).c_str(), key))
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid sort key");
+        return;
+    }
+
+    long limit = _server->hasArg(RESULT_LIMIT) ? _server->arg(RESULT_LIMIT).toInt()
+                                               : CATALOG_BROWSE_DEFAULT_LIMIT;
+    long offset = _server->arg(RESULT_OFFSET).toInt();
+    long after = _server->hasArg(RESULT_AFTER) ? _server->arg(RESULT_AFTER).toInt() : -1;
+    if (limit < 1 || limit > CATALOG_BROWSE_MAX_LIMIT || offset < 0)
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid offset or limit");
+        return;
+    }
+    if (!hasTransferRoom())
+        return;
+
+    if (_server->hasArg(UTC_TIME))
+        ApparentPlace::getInstance().setEpoch(_server->arg(UTC_TIME));
+
+    // Allocated once per request, the page size does not change the memory needed
+    CatalogBrowsePage* page = new (std::nothrow)
+        CatalogBrowsePage(*blob, db->isCompactProjection(), key, type, db->getTotalObjectCount(),
+                          (size_t) offset, after, (size_t) limit);
+    if (page == nullptr)
+    {
+        _server->send(503, MIME_TYPE_TEXT, "Not enough memory");
+        return;
+    }
+    sendGenerated(MIME_APPLICATION_JSON, page);
+}
+
+// Reads an optional bound argument and scales it to the integer units of the catalogue
+static bool parseBound(WebServer* server, const char* name, float limit, float scale, bool upper,
+                       int32_t& value)
+{
+    if (!server->hasArg(name))
+        return true;
+    float bound = server->arg(name).toFloat();
+    if (bound < -limit || bound > limit)
+        return false;
+    // Round towards the inside of the range, a bound never admits a value beyond it
+    value = (int32_t) (upper ? floorf(bound * scale) : ceilf(bound * scale));
+    return true;
+}
+
+// A page of GET /catalogFilter. The first piece counts all matches, the
+// following ones continue after the last record without counting again.
+class CatalogFilterPage : public CatalogJsonSource
+{
+  public:
+    CatalogFilterPage(const CatalogueBlob& blob, bool compact,
+                      const CatalogueAttributeQuery& query, StarDatabaseType type, size_t offset,
+                      size_t limit)
+        : CatalogJsonSource(true), _scan(blob, compact, query), _type(type), _total(0),
+          _offset(offset), _limit(limit), _started(false), _listed(false)
+    {
+    }
+
+  protected:
+    bool write() override
+    {
+        char text[96];
+        if (!_started)
+        {
+            _started = true;
+            snprintf(text, sizeof(text), "{\"catalog\":%d,\"apparent\":%s,\"objects\":[",
+                     (int) _type, ApparentPlace::getInstance().isValid() ? "true" : "false");
+            append(text);
+            return true;
+        }
+
+        if (!_listed)
+        {
+            size_t done = getCount();
+            if (done > 0)
+                _scan.runAfter(getLast(), _limit - done, *this);
+            else
+                _scan.run(_offset, _limit, *this, _total);
+            // Stopped by the limit or the last match rather than a full buffer
+            _listed = hasRoom() || getCount() == _limit;
+            return true;
+        }
+
+        // The offset of the next page, null after the last page
+        size_t end = _offset + getCount();
+        if (end < _total)
+            snprintf(text, sizeof(text), "],\"total\":%u,\"next\":%u}", (unsigned) _total,
+                     (unsigned) end);
+        else
+            snprintf(text, sizeof(text), "],\"total\":%u,\"next\":null}", (unsigned) _total);
+        append(text);
+        return false;
+    }
+
+  private:
+    CatalogueAttributeScan _scan;
+    StarDatabaseType _type;
+    size_t _total;
+    size_t _offset;
+    size_t _limit;
+    bool _started;
+    bool _listed;
+};
+
+void ApiHandler::handleCatalogFilter()
+{
+    StarDatabaseType type = (StarDatabaseType) _server->arg(STAR_CATALOG).toInt();
+    const StarDatabase* db = StarDatabaseRegistry::getInstance().getDatabase(type);
+    const CatalogueBlob* blob = db != nullptr ? db->getBlob() : nullptr;
+    if (blob == nullptr)
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid catalog");
+        return;
+    }
+
+    long limit = _server->hasArg(RESULT_LIMIT) ? _server->arg(RESULT_LIMIT).toInt()
+                                               : CATALOG_BROWSE_DEFAULT_LIMIT;
+    long offset = _server->arg(RESULT_OFFSET).toInt();
+    if (limit < 0 || limit > CATALOG_BROWSE_MAX_LIMIT || offset < 0)
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid offset or limit");
+        return;
+    }
+
+    int32_t mag_min = INT16_MIN;
+    int32_t mag_max = INT16_MAX;
+    int32_t size_min = 0;
+    int32_t size_max = UINT16_MAX;
+    if (!parseBound(_server, MIN_MAGNITUDE, 30.0f, 100.0f, false, mag_min) ||
+        !parseBound(_server, MAX_MAGNITUDE, 30.0f, 100.0f, true, mag_max) ||
+        !parseBound(_server, MIN_SIZE, CATALOG_FILTER_MAX_SIZE, 10.0f, false, size_min) ||
+        !parseBound(_server, MAX_SIZE, CATALOG_FILTER_MAX_SIZE, 10.0f, true, size_max) ||
+        size_min < 0 || size_max < 0)
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid magnitude or size");
+        return;
+    }
+    if (!hasTransferRoom())
+        return;
+
+    // The scan resolves type and constellation when the page is created
+    String objectType = _server->arg(OBJECT_TYPE);
+    String constellation = _server->arg(CONSTELLATION);
+    CatalogueAttributeQuery query;
+    query.type = objectType.c_str();
+    query.constellation = constellation.c_str();
+    query.mag_min = (int16_t) mag_min;
+    query.mag_max = (int16_t) mag_max;
+    query.size_min = (uint16_t) size_min;
+    query.size_max = (uint16_t) size_max;
+
+    if (_server->hasArg(UTC_TIME))
+        ApparentPlace::getInstance().setEpoch(_server->arg(UTC_TIME));
+
+    CatalogFilterPage* page = new (std::nothrow) CatalogFilterPage(
+        *blob, db->isCompactProjection(), query, type, (size_t) offset, (size_t) limit);
+    if (page == nullptr)
+    {
+        _server->send(503, MIME_TYPE_TEXT, "Not enough memory");
+        return;
+    }
+    sendGenerated(MIME_APPLICATION_JSON, page);
+}
+
+/**
+ * Parses a single byte range of a Range header: "bytes=first-last",
+ * "bytes=first-" or "bytes=-suffix". Returns false if there is none or it is
+ * not understood, the whole body is sent then. A range starting beyond the
+ * body leaves first > last.
+ */
+static bool parseByteRange(const String& header, size_t length, size_t& first, size_t& last)
+{
+    int dash = header.indexOf('-');
+    if (!header.startsWith("bytes=") || header.indexOf(',') >= 0 || dash < 0 || length == 0)
+        return false;
+
+    String start = header.substring(6, dash);
+    String end = header.substring(dash + 1);
+    start.trim();
+    end.trim();
+    if (start.length() == 0)
+    {
+        long suffix = end.toInt();
+        if (suffix <= 0)
+            return false;
+        first = (size_t) suffix < length ? length - suffix : 0;
+        last = length - 1;
+        return true;
+    }
+
+    long from = start.toInt();
+    long to = end.length() > 0 ? end.toInt() : (long) length - 1;
+    if (from < 0 || (end.length() > 0 && to < from))
+        return false;
+    first = (size_t) from;
+    if (first >= length)
+        last = 0;
+    else
+        last = (size_t) to < length ? (size_t) to : length - 1;
+    return true;
+}
+
+void ApiHandler::handleCatalogIndex()
+{
+    // The index only changes with a firmware update
+    static EmbeddedAsset searchIndex(_catalogues_search_index_json_gz_start,
+                                     _catalogues_search_index_json_gz_end);
+    const uint8_t* data = searchIndex.getData();
+    size_t length = searchIndex.getLength();
+    const char* etag = searchIndex.getETag();
+    if (!hasTransferRoom())
+        return;
+
+    _server->sendHeader("Accept-Ranges", "bytes");
+    if (searchIndex.sendValidators(_server, "public, max-age=604800"))
+        return;
+
+    // A range only applies to the version the client already holds part of
+    size_t first = 0;
+    size_t last = length - 1;
+    int code = 200;
+    String ifRange = _server->header("If-Range");
+    if ((ifRange.length() == 0 || ifRange == etag) &&
+        parseByteRange(_server->header("Range"), length, first, last))
+    {
+        char range[48];
+        if (first > last)
+        {
+            snprintf(range, sizeof(range), "bytes */%u", (unsigned) length);
+            _server->sendHeader("Content-Range", range);
+            _server->send(416);
+            return;
+        }
+        snprintf(range, sizeof(range), "bytes %u-%u/%u", (unsigned) first, (unsigned) last,
+                 (unsigned) length);
+        _server->sendHeader("Content-Range", range);
+        code = 206;
+    }
+
+    // Compressed at build time, the bytes go out as they are in flash
+    _server->sendHeader("Content-Encoding", "gzip");
+    sendInBackground(code, MIME_APPLICATION_JSON, data + first, last - first + 1);
+}
+
+// The pieces of a sky tile, encoded as they are sent
+class SkyTileSource : public TransferSource
+{
+  public:
+    SkyTileSource(const CatalogueBlob& blob, bool compact) : _encoder(blob, compact)
+    {
+    }
+
+    bool begin(size_t tile, int16_t mag_max_centi)
+    {
+        return _encoder.begin(tile, mag_max_centi);
+    }
+
+    bool next(const uint8_t*& data, size_t& length) override
+    {
+        // POST /catalogUpload erases the partition the records are read from
+        StarDatabaseRegistry::Reader reader;
+        if (!reader.isOpen())
+            return false;
+        length = _encoder.next(data);
+        return true;
+    }
+
+  private:
+    SkyTileEncoder _encoder;
+};
+
+void ApiHandler::handleSkyTile()
+{
+    StarDatabaseType type = (StarDatabaseType) _server->arg(STAR_CATALOG).toInt();
+    const StarDatabase* db = StarDatabaseRegistry::getInstance().getDatabase(type);
+    const CatalogueBlob* blob = db != nullptr ? db->getBlob() : nullptr;
+    long tile = _server->hasArg(SKY_TILE) ? _server->arg(SKY_TILE).toInt() : -1;
+    if (blob == nullptr || tile < 0 || tile >= SKY_TILE_COUNT)
+    {
+        _server->send(400, MIME_TYPE_TEXT, "Invalid catalog or tile");
+        return;
+    }
+
+    int16_t mag_max = INT16_MAX;
+    if (_server->hasArg(MAX_MAGNITUDE))
+    {
+        float magnitude = _server->arg(MAX_MAGNITUDE).toFloat();
+        if (magnitude < -30.0f || magnitude > 30.0f)
+        {
+            _server->send(400, MIME_TYPE_TEXT, "Invalid magnitude");
+            return;
+        }
+        mag_max = (int16_t) floorf(magnitude * 100.0f);
+    }
+
+    // Tiles only change with the catalogue data, the URL holds everything else
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%08lx-%d\"", (unsigned long) SkyTileEncoder::getDataTag(type),
+             SKY_TILE_FORMAT_VERSION);
+    if (_server->header("If-None-Match") == etag)
+    {
+        _server->sendHeader("ETag", etag);
+        _server->sendHeader("Cache-Control", "no-cache");
+        _server->send(304);
+        return;
+    }
+    if (!hasTransferRoom())
+        return;
+
+    // Allocated once per request, holds the send buffer
+    SkyTileSource* source = new (std::nothrow) SkyTileSource(*blob, db->isCompactProjection());
+    if (source == nullptr)
+    {
+        _server->send(503, MIME_TYPE_TEXT, "Not enough memory");
+        return;
+    }
+    if (!source->begin(tile, mag_max))
+    {
+        delete source;
+        _server->send(400, MIME_TYPE_TEXT, "Invalid catalog or tile");
+        return;
+    }
+
+    char headers[80];
+    snprintf(headers, sizeof(headers), "ETag: %s\r\nCache-Control: no-cache\r\n", etag);
+    sendGenerated(MIME_APPLICATION_OCTET_STREAM, source, headers);
+}
+
+void ApiHandler::handleCatalogCache()
+{
+    CataloguePageCache& cache = CataloguePageCache::getInstance();
+    CataloguePageCacheStats stats = cache.getStats();
+    CatalogueQueryCache& queryCache = CatalogueQueryCache::getInstance();
+    CatalogueQueryCacheStats queryStats = queryCache.getStats();
+
+    if (_server->arg("reset").toInt() == 1)
+    {
+        cache.resetStats();
+        queryCache.resetStats();
+    }
+
+    ArduinoJson::JsonDocument response;
+    response["budget"] = stats.budget_bytes;
+    response["used"] = stats.used_bytes;
+    response["pages"] = stats.pages;
+    response["pinned"] = stats.pinned_pages;
+    response["hits"] = stats.hits;
+    response["misses"] = stats.misses;
+    response["evictions"] = stats.evictions;
+    response["queries"]["entries"] = queryStats.entries;
+    response["queries"]["capacity"] = queryStats.capacity;
+    response["queries"]["hits"] = queryStats.hits;
+    response["queries"]["misses"] = queryStats.misses;
+
+    String json;
+    serializeJson(response, json);
+    _server->send(200, MIME_APPLICATION_JSON, json);
+}
+
+void ApiHandler::handleCatalogInfo()
+{
+    const CataloguePartition& partition = CataloguePartition::getInstance();
+
+    ArduinoJson::JsonDocument response;
+    response["source"] = partition.isValid() ? "partition" : "embedded";
+    response["partition"] = partition.hasPartition();
+    response["version"] = partition.getBundleVersion();
+    response["size"] = partition.getBundleSize();
+    response["capacity"] = partition.getCapacity();
+    response["catalogues"] = StarDatabaseRegistry::getInstance().getDatabaseCount();
+    response["updating"] = partition.isUpdating();
+    response["written"] = partition.getUpdateWritten();
+    if (partition.getUpdateError() != nullptr)
+        response["error"] = partition.getUpdateError();
+
+    String json;
+    serializeJson(response, json);
+    _server->send(200, MIME_APPLICATION_JSON, json);
+}
+
+void ApiHandler::handleCatalogUpload()
+{
+    CataloguePartition& partition = CataloguePartition::getInstance();
+    HTTPUpload& upload = _server->upload();
+
+    if (upload.status == UPLOAD_FILE_START)
+    {
+        print_out("Catalogue upload start: %s", upload.filename.c_str());
+        // The catalogues in use are read straight from the partition
+        if (partition.isValid())
+            StarDatabaseRegistry::getInstance().suspend();
+        partition.beginUpdate(0);
+    }
+    else if (upload.status == UPLOAD_FILE_WRITE)
+    {
+        partition.writeUpdate(upload.buf, upload.currentSize);
+    }
+    else if (upload.status == UPLOAD_FILE_END)
+    {
+        partition.endUpdate();
+    }
+    else if (upload.status == UPLOAD_FILE_ABORTED)
+    {
+        partition.abortUpdate();
+    }
+}
+
+void ApiHandler::handleCatalogUploadComplete()
+{
+    const CataloguePartition& partition = CataloguePartition::getInstance();
+    bool success = !partition.isUpdating() && partition.getUpdateError() == nullptr;
+
+    if (success)
+        _server->send(200, MIME_TYPE_TEXT, "Catalogue update complete, rebooting...");
+    else if (!partition.hasPartition())
+        _server->send(409, MIME_TYPE_TEXT, CATALOGUE_NO_PARTITION_ERROR);
+    else if (partition.getUpdateError() != nullptr)
+        _server->send(400, MIME_TYPE_TEXT, partition.getUpdateError());
+    else
+        _server->send(400, MIME_TYPE_TEXT, "Incomplete bundle");
+
+    // The partition is only picked up at boot, after a failed upload the
+    // catalogues embedded in the firmware are used again
+    if (!success && !StarDatabaseRegistry::getInstance().isSuspended())
+        return;
+
+    // Let the response go out before the restart
+    for (int i = 0; i < 20; i++)
+    {
+        _server->handleClient();
+        vTaskDelay(100);
+    }
+    systemShutdown();
+}
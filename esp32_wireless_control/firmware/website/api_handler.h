@@ -3,6 +3,25 @@
 
 #include <WebServer.h>
 
+#include "event_stream.h"
+#include "transfer_queue.h"
+
+class Position;
+
+// Format of GET /state, raised when a field changes meaning or goes away
+#define DEVICE_STATE_VERSION 1
+
+// Code of the "state" field of GET /state, the activity /status describes
+enum DeviceState
+{
+    DEVICE_IDLE = 0,
+    DEVICE_TRACKING,
+    DEVICE_SLEWING,
+    DEVICE_GOTO,
+    DEVICE_CAPTURE,
+    DEVICE_ERROR // Idle after an intervalometer error, see "error"
+};
+
 /**
  * @class ApiHandler
  * @brief REST API handler for OG Star Tracker
@@ -19,6 +38,15 @@ class ApiHandler
 
     void registerEndpoints();
 
+    // Continue background transfers and push /events, called from the web server task
+    // after each WebServer::handleClient()
+    void loop();
+
+    // false after answering 503 if every background transfer is taken, call before any header
+    bool hasTransferRoom();
+    // Send the headers and leave a constant body (flash data) to the transfer queue
+    void sendInBackground(int code, const char* contentType, const uint8_t* data, size_t length);
+
     // ==================== TRACKING CONTROL ====================
 
     /**
@@ -157,21 +185,57 @@ class ApiHandler
      */
     void handleLoadTrackingRatePreset();
 
+    // ==================== COMMAND BATCH ====================
+
+    /**
+     * @endpoint POST /commands
+     * @brief Run a list of control commands in one request, without other requests in between
+     * @param body - JSON {"commands": [{"command": "setPosition", "currentRA": 45000}, ...]},
+     *   commands and arguments as the endpoints of the same name: setPosition (currentRA),
+     *   loadTrackingRatePreset (preset), on (direction, trackingSpeed), off, startslew
+     *   (speed, direction), stopslew, gotoRA (currentRA, targetRA, speed), abort-goto-ra,
+     *   startCapture (optional preset), abort. At most COMMAND_BATCH_MAX commands.
+     * @response 200 OK with JSON {"results": [{"command", "ok", "message"}], "completed",
+     *   "state": DeviceState}. 400 with {"error", "index"} if a command is invalid or cannot
+     *   run after the ones before it (a second capture, a long exposure without tracking),
+     *   nothing has run then. 409 if a command was refused while running anyway, the
+     *   commands before it stay done.
+     */
+    void handleCommands();
+
     // ==================== STATUS & INFO ====================
 
     /**
      * @endpoint GET /status
      * @brief Get device status information
-     * @response 200 OK with JSON containing:
-     *   - slewActive: boolean
-     *   - trackingActive: boolean
-     *   - intervalometerActive: boolean
-     *   - goToTarget: boolean
-     *   - exposuresTaken: number
-     *   - currentExposure: number
+     * @response 200 OK with the status as text in the selected language, e.g. "Tracking ON"
+     * @note The web interface follows /events instead and only polls this without it
      */
     void handleStatusRequest();
 
+    /**
+     * @endpoint GET /state
+     * @brief Get all live state in one compact JSON with numeric codes, for clients that
+     *   localize themselves; replaces /status, /getCurrentPosition, /version and
+     *   /getTrackingRates?type=0
+     * @response 200 OK with JSON: {"v": DEVICE_STATE_VERSION, "state": DeviceState,
+     *   "tracking": 0|1, "direction": 0|1, "trackingRate", "capture": intervalometer state,
+     *   "exposures", "totalExposures", "error": ErrorMessage or -1, "ra": seconds,
+     *   "lang": Languages, "firmware", "internalVersion"}
+     */
+    void handleState();
+
+    /**
+     * @endpoint GET /events
+     * @brief Subscribe to state changes as server-sent events (text/event-stream)
+     * @param utcTime - Optional current time (ISO 8601 UTC), epoch for apparent coordinates
+     * @response 200 OK with an open stream, one event with the current state and then one
+     *   per change, at most every EVENT_STREAM_INTERVAL_MS: {"status", "trackingActive",
+     *   "slewActive", "goToTarget", "intervalometerActive", "captureState", "exposuresTaken",
+     *   "exposures", "ra"}. 503 if EVENT_STREAM_MAX_CLIENTS streams are open.
+     */
+    void handleEvents();
+
     /**
      * @endpoint GET /version
      * @brief Get firmware version
@@ -179,17 +243,149 @@ class ApiHandler
      */
     void handleVersion();
 
+    /**
+     * @endpoint GET /metrics
+     * @brief Counters and gauges for Prometheus
+     * @response 200 OK with text/plain in the Prometheus text format: steps, slews and gotos,
+     *   request latency per route, UART queue, catalogue caches, heap and tasks
+     */
+    void handleMetrics();
+
     // ==================== CATALOG SEARCH ====================
 
     /**
      * @endpoint GET /starSearch
      * @brief Search star/object catalog
-     * @param catalog - Catalog type (0-3: NGC2000/NGC2000_COMPACT/BSC5/BSC5_COMPACT)
-     * @param query - Search query string
-     * @response 200 OK with JSON object containing search results
+     * @param starCatalog - Catalog type (0=all, 1-4: NGC2000/NGC2000_COMPACT/BSC5/BSC5_COMPACT,
+     *                      5-7: Messier/Caldwell/Hipparcos)
+     * @param starName - Object name to search for
+     * @param utcTime - Optional current time (ISO 8601 UTC), epoch for apparent coordinates
+     * @response 200 OK with JSON object containing search results and source catalog,
+     *   ra/dec are apparent coordinates of date once an epoch is known, J2000 otherwise
      */
     void handleCatalogSearch();
 
+    /**
+     * @endpoint POST /starBatch
+     * @brief Resolve a list of object names in one request
+     * @param body - JSON: {"names": ["M31", {"name": "Vega", "starCatalog": 3}, ...],
+     *   "starCatalog": default catalog type (0=all), "utcTime": optional epoch}, 1 to 64 names
+     * @response 200 OK with a streamed JSON array in request order, one object per name:
+     *   {"query", "found": true, "name", "ra", "dec", "type", "magnitude", "constellation",
+     *   "catalog", "apparent"} or {"query", "found": false}. 400 on invalid input.
+     * @note Every catalogue is searched once for all names, a name is found in the same
+     *   catalogue as by /starSearch
+     */
+    void handleCatalogBatch();
+
+    /**
+     * @endpoint GET /visibleObjects
+     * @brief List the objects above the horizon for an observer and a time
+     * @param lat - Observer latitude in degrees, north positive
+     * @param lon - Observer longitude in degrees, east positive
+     * @param utcTime - Observation time (ISO 8601 UTC), also the epoch for apparent coordinates
+     * @param limit - Optional, number of objects to return (1-100, default 20)
+     * @param minAltitude - Optional, horizon limit in degrees (default 0)
+     * @param maxMagnitude - Optional, skip fainter objects and objects without magnitude
+     * @param sort - Optional, "altitude" (highest first, default) or "magnitude" (brightest first)
+     * @param starCatalog - Optional catalog type, 0 (default) scans NGC2000 and BSC5
+     * @response 200 OK with a streamed JSON array, best first: {"name", "ra", "dec",
+     *   "altitude", "azimuth", "type", "magnitude", "constellation", "catalog"}, ra/dec are
+     *   apparent coordinates of date, altitude/azimuth in degrees (azimuth from north
+     *   through east, no refraction). 400 on invalid input.
+     */
+    void handleVisibleObjects();
+
+    /**
+     * @endpoint GET /catalogBrowse
+     * @brief Page through a catalog without building the listing in memory
+     * @param starCatalog - Catalog type (1-7, see /starSearch)
+     * @param sort - Optional sort key: "index" (catalog order, default), "name", "magnitude",
+     *   "ra" or "dec"
+     * @param limit - Optional, records per page (1-1000, default 50)
+     * @param offset - Optional, position of the first record in the sort order (default 0)
+     * @param after - Optional, continue after the record with this index (the "next" value
+     *   of the previous page), faster than offset for sorted pages deep into the catalog
+     * @param utcTime - Optional current time (ISO 8601 UTC), epoch for apparent coordinates
+     * @response 200 OK with streamed JSON: {"catalog", "sort", "total", "apparent",
+     *   "objects": [{"index", "ra", "dec", "magnitude", "name", "type", "constellation"}],
+     *   "next": index or null}. 400 on invalid input.
+     * @note Memory use does not depend on the page size
+     */
+    void handleCatalogBrowse();
+
+    /**
+     * @endpoint GET /catalogFilter
+     * @brief Count and page the objects of a catalog matching attribute conditions
+     * @param starCatalog - Catalog type (1-7, see /starSearch)
+     * @param type - Optional object type as in the catalog, e.g. "Gx" (case-insensitive)
+     * @param constellation - Optional constellation abbreviation, e.g. "Leo"
+     * @param minMagnitude - Optional, skip brighter objects
+     * @param maxMagnitude - Optional, skip fainter objects
+     * @param minSize - Optional, skip smaller objects (arcminutes)
+     * @param maxSize - Optional, skip larger objects (arcminutes)
+     * @param limit - Optional, objects per page (0-1000, default 50), 0 only counts
+     * @param offset - Optional, position of the first match (default 0)
+     * @param utcTime - Optional current time (ISO 8601 UTC), epoch for apparent coordinates
+     * @response 200 OK with streamed JSON: {"catalog", "apparent", "objects": [{"index",
+     *   "ra", "dec", "magnitude", "size", "name", "type", "constellation"}], "total",
+     *   "next": offset or null}. 400 on invalid input.
+     * @note A magnitude or size bound leaves out objects without a magnitude or size
+     */
+    void handleCatalogFilter();
+
+    /**
+     * @endpoint GET /catalogIndex
+     * @brief Get the names and J2000 positions of the built-in catalogs for searching in
+     *   the browser
+     * @response 200 OK with gzip-compressed JSON (Content-Encoding: gzip), see
+     *   catalogues/search_index.py for the layout. 206 Partial Content for a byte range
+     *   (Range, If-Range), 416 if the range is outside the data. 304 Not Modified if
+     *   If-None-Match holds the ETag.
+     * @note Built with the firmware, a catalogue bundle uploaded later is not reflected
+     */
+    void handleCatalogIndex();
+
+    /**
+     * @endpoint GET /skyTile
+     * @brief Get the objects of one sky tile as compact binary records for chart drawing
+     * @param starCatalog - Catalog type (1-7, see /starSearch)
+     * @param tile - Tile number (0-287): band * 24 + sector, band = floor((dec + 90) / 15),
+     *   sector = floor(ra in hours)
+     * @param maxMagnitude - Optional, skip fainter objects and objects without magnitude
+     * @response 200 OK with application/octet-stream, see sky_tiles.h for the layout.
+     *   304 Not Modified if If-None-Match holds the ETag. 400 on invalid input.
+     * @note Positions are J2000, the ETag changes with the catalogue data only
+     */
+    void handleSkyTile();
+
+    /**
+     * @endpoint GET /catalogCache
+     * @brief Get catalogue page cache and query cache statistics
+     * @param reset - Optional, 1 resets the hit/miss/eviction counters after reading them
+     * @response 200 OK with JSON: {"budget", "used", "pages", "pinned", "hits", "misses",
+     *   "evictions", "queries": {"entries", "capacity", "hits", "misses"}}
+     */
+    void handleCatalogCache();
+
+    /**
+     * @endpoint GET /catalogInfo
+     * @brief Get the catalogue data source and the state of a catalogue update
+     * @response 200 OK with JSON: {"source": "partition"|"embedded", "version", "size",
+     *   "capacity", "catalogues", "updating", "written", "error"}
+     */
+    void handleCatalogInfo();
+
+    /**
+     * @endpoint POST /catalogUpload
+     * @brief Upload a catalogue bundle (catalogue_bundle.bin) into the catalogue partition
+     * @param file - Multipart form upload of the bundle
+     * @response 200 OK with message, 400 with the error if the bundle was rejected
+     * @note Catalogue lookups fail during the upload, the device reboots afterwards
+     */
+    void handleCatalogUpload();
+    void handleCatalogUploadComplete();
+
     // ==================== SETTINGS ====================
 
     /**
@@ -266,7 +462,30 @@ class ApiHandler
     ApiHandler(const ApiHandler&) = delete;
     ApiHandler& operator=(const ApiHandler&) = delete;
 
+    // WebServer::on() with the time spent in the handler recorded per route
+    void on(const char* uri, HTTPMethod method, WebServer::THandlerFunction handler);
+    void on(const char* uri, HTTPMethod method, WebServer::THandlerFunction handler,
+            WebServer::THandlerFunction uploadHandler);
+
+    DeviceState getDeviceState() const;
+    // Actions shared by the endpoints and /commands, return the response message
+    const char* startTracking(uint64_t customRate, bool direction);
+    const char* startSlew(int speed, bool direction);
+    const char* gotoRA(const Position& currentPosition, const Position& targetPosition,
+                       int pan_speed);
+    const char* setPosition(const Position& currentPosition);
+    // false if the capture mode needs tracking and it is off
+    bool startCapture();
+    // Status text of /status, empty while a capture is between states
+    String getStatusMessage() const;
+    String getStateEvent() const;
+    // Take the connection over and send a 200 with the body of source chunked from loop(), the
+    // source is deleted once done. headers are complete lines ("Name: value\r\n").
+    void sendGenerated(const char* contentType, TransferSource* source, const char* headers = "");
+
     WebServer* _server;
+    EventStream _events;
+    TransferQueue _transfers;
 };
 
 #endif // API_HANDLER_H
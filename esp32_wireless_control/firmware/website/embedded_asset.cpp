@@ -0,0 +1,32 @@
+#include <stdio.h>
+
+#include "embedded_asset.h"
+
+EmbeddedAsset::EmbeddedAsset(const uint8_t* start, const uint8_t* end)
+    : _data(start), _length(end - start), _etag()
+{
+}
+
+const char* EmbeddedAsset::getETag()
+{
+    if (_etag[0] == '\0')
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < _length; i++)
+            hash = (hash ^ _data[i]) * 16777619u;
+        snprintf(_etag, sizeof(_etag), "\"%08lx\"", (unsigned long) hash);
+    }
+    return _etag;
+}
+
+bool EmbeddedAsset::sendValidators(WebServer* server, const char* cacheControl)
+{
+    const char* etag = getETag();
+    server->sendHeader("ETag", etag);
+    server->sendHeader("Cache-Control", cacheControl);
+    if (server->header("If-None-Match") != etag)
+        return false;
+
+    server->send(304);
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef EMBEDDED_ASSET_H
+#define EMBEDDED_ASSET_H
+
+#include <WebServer.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @class EmbeddedAsset
+ * @brief A file embedded in the firmware image, served with an ETag
+ *
+ * The ETag is the FNV-1a of the bytes, computed on first use and kept until
+ * reboot (the data only changes with a firmware update). Used from the web
+ * server task only.
+ */
+class EmbeddedAsset
+{
+  public:
+    EmbeddedAsset(const uint8_t* start, const uint8_t* end);
+
+    const uint8_t* getData() const
+    {
+        return _data;
+    }
+    size_t getLength() const
+    {
+        return _length;
+    }
+
+    // Quoted ETag, e.g. "\"1a2b3c4d\""
+    const char* getETag();
+
+    /**
+     * @brief Send the ETag and Cache-Control headers, answer If-None-Match
+     * @return true if the client holds this version, 304 Not Modified has been sent then
+     */
+    bool sendValidators(WebServer* server, const char* cacheControl);
+
+  private:
+    const uint8_t* _data;
+    size_t _length;
+    char _etag[12];
+};
+
+#endif // EMBEDDED_ASSET_H
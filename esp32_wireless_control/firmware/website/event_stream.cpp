@@ -0,0 +1,127 @@
+#include <errno.h>
+#include <lwip/sockets.h>
+
+#include "event_stream.h"
+
+EventStream::EventStream()
+    : _used(), _stale(), _stalled_since(), _count(0), _last_check(0), _last_send(0)
+{
+}
+
+bool EventStream::subscribe(WiFiClient& client, const String& state)
+{
+    // Browsers close the stream of a reloaded page, its slot is free for the new one
+    for (size_t i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++)
+    {
+        if (_used[i] && !_clients[i].connected())
+            drop(i);
+    }
+
+    size_t slot = 0;
+    while (slot < EVENT_STREAM_MAX_CLIENTS && _used[slot])
+        slot++;
+    if (slot == EVENT_STREAM_MAX_CLIENTS)
+        return false;
+
+    // No Content-Length, the response ends when either side closes the connection
+    String head = "HTTP/1.1 200 OK\r\n"
+                  "Content-Type: text/event-stream\r\n"
+                  "Cache-Control: no-cache\r\n"
+                  "Connection: keep-alive\r\n"
+                  "\r\n"
+                  "retry: ";
+    head += String(EVENT_STREAM_RETRY_MS) + "\n\n";
+    // The new subscriber always gets the current state, the others only a change.
+    // A client gone already needs no other answer.
+    head += "data: " + state + "\n\n";
+    if (write(client, head) != WRITE_SENT)
+        return true;
+
+    _clients[slot] = client;
+    _used[slot] = true;
+    _stale[slot] = false;
+    _count++;
+    return true;
+}
+
+bool EventStream::isDue() const
+{
+    return _count > 0 && millis() - _last_check >= EVENT_STREAM_INTERVAL_MS;
+}
+
+void EventStream::publish(const String& state)
+{
+    _last_check = millis();
+    if (state != _last_state)
+    {
+        _last_state = state;
+        sendToAll("data: " + state + "\n\n");
+        return;
+    }
+
+    // Clients that missed the last change get it once their socket has room
+    for (size_t i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++)
+    {
+        if (_used[i] && _stale[i])
+            sendTo(i, "data: " + state + "\n\n");
+    }
+    if (_last_check - _last_send >= EVENT_STREAM_KEEPALIVE_MS)
+        sendToAll(": keep-alive\n\n");
+}
+
+EventStream::WriteResult EventStream::write(WiFiClient& client, const String& text)
+{
+    if (!client.connected())
+        return WRITE_FAILED;
+
+    // WiFiClient::write() waits for room in the socket, a plain send returns at once
+    int written = send(client.fd(), text.c_str(), text.length(), MSG_DONTWAIT);
+    if (written == (int) text.length())
+        return WRITE_SENT;
+    // Part of an event would corrupt the next one, only a write of nothing can be skipped
+    if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return WRITE_BLOCKED;
+    return WRITE_FAILED;
+}
+
+void EventStream::sendTo(size_t slot, const String& text)
+{
+    switch (write(_clients[slot], text))
+    {
+        case WRITE_SENT:
+            _stale[slot] = false;
+            break;
+        case WRITE_BLOCKED:
+            if (!_stale[slot])
+            {
+                _stale[slot] = true;
+                _stalled_since[slot] = _last_check;
+            }
+            else if (_last_check - _stalled_since[slot] >= EVENT_STREAM_STALL_TIMEOUT_MS)
+            {
+                drop(slot);
+            }
+            break;
+        case WRITE_FAILED:
+            drop(slot);
+            break;
+    }
+}
+
+void EventStream::sendToAll(const String& text)
+{
+    _last_send = _last_check;
+    for (size_t i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++)
+    {
+        if (_used[i])
+            sendTo(i, text);
+    }
+}
+
+void EventStream::drop(size_t slot)
+{
+    _clients[slot].stop();
+    _clients[slot] = WiFiClient();
+    _used[slot] = false;
+    _count--;
+}
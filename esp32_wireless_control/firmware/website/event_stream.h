@@ -0,0 +1,81 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+// Browsers open one stream per tab, further subscribers are refused
+#define EVENT_STREAM_MAX_CLIENTS 4
+// Shortest time between two state events, bounds the rate while tracking moves the RA
+#define EVENT_STREAM_INTERVAL_MS 250
+// Comment sent to idle streams, keeps proxies from closing them and finds dead clients
+#define EVENT_STREAM_KEEPALIVE_MS 15000
+// Reconnect delay suggested to the browser after the stream broke
+#define EVENT_STREAM_RETRY_MS 2000
+// A subscriber whose socket stays full this long is dropped
+#define EVENT_STREAM_STALL_TIMEOUT_MS 5000
+
+/**
+ * @class EventStream
+ * @brief Server-sent events (text/event-stream) fan-out for the web interface
+ *
+ * A subscriber is the connection of a GET request the WebServer handed over:
+ * the response headers are written by hand and the socket is kept open
+ * after the handler returns (copies of a WiFiClient share the socket). Each
+ * event is a single "data:" line with the state as JSON. An event is only
+ * sent when the state differs from the last one, at most every
+ * EVENT_STREAM_INTERVAL_MS.
+ *
+ * Writes never wait for a slow client: an event that finds its socket
+ * full is skipped and the client gets the current state once there is room
+ * again. A client is dropped when a write fails, when only part of an
+ * event fit, or when its socket stayed full for
+ * EVENT_STREAM_STALL_TIMEOUT_MS. Used from the web server task only.
+ */
+class EventStream
+{
+  public:
+    EventStream();
+
+    /**
+     * @brief Answer a request with the stream headers and the current state
+     * @return false if all EVENT_STREAM_MAX_CLIENTS are taken, nothing is written then
+     */
+    bool subscribe(WiFiClient& client, const String& state);
+
+    // True if there is a subscriber and the last check is at least one interval ago
+    bool isDue() const;
+
+    // Send state to every subscriber if it changed, a keep-alive comment if idle for long
+    void publish(const String& state);
+
+    size_t getClientCount() const
+    {
+        return _count;
+    }
+
+  private:
+    enum WriteResult
+    {
+        WRITE_SENT,
+        WRITE_BLOCKED, // Nothing was written, the socket is full
+        WRITE_FAILED
+    };
+
+    static WriteResult write(WiFiClient& client, const String& text);
+    void sendTo(size_t slot, const String& text);
+    void sendToAll(const String& text);
+    void drop(size_t slot);
+
+    WiFiClient _clients[EVENT_STREAM_MAX_CLIENTS];
+    bool _used[EVENT_STREAM_MAX_CLIENTS];
+    // Missed an event because the socket was full, since _stalled_since
+    bool _stale[EVENT_STREAM_MAX_CLIENTS];
+    unsigned long _stalled_since[EVENT_STREAM_MAX_CLIENTS];
+    size_t _count;
+    String _last_state;
+    unsigned long _last_check;
+    unsigned long _last_send;
+};
+
+#endif // EVENT_STREAM_H
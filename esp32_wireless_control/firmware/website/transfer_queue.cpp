@@ -0,0 +1,171 @@
+#include <errno.h>
+#include <lwip/sockets.h>
+#include <stdio.h>
+
+#include "transfer_queue.h"
+
+static const char CHUNK_END[] = "\r\n";
+static const char LAST_CHUNK[] = "0\r\n\r\n";
+
+TransferQueue::TransferQueue() : _transfers(), _count(0)
+{
+}
+
+TransferQueue::Transfer* TransferQueue::reserve(WiFiClient& client)
+{
+    for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; i++)
+    {
+        Transfer& transfer = _transfers[i];
+        if (transfer.active)
+            continue;
+        transfer.client = client;
+        transfer.sent = 0;
+        transfer.last_progress = millis();
+        transfer.active = true;
+        transfer.source = nullptr;
+        transfer.stage = STAGE_BODY;
+        _count++;
+        return &transfer;
+    }
+    return nullptr;
+}
+
+bool TransferQueue::start(WiFiClient& client, const uint8_t* data, size_t length)
+{
+    Transfer* transfer = reserve(client);
+    if (transfer == nullptr)
+        return false;
+    transfer->data = data;
+    transfer->length = length;
+    return true;
+}
+
+bool TransferQueue::start(WiFiClient& client, const String& head, TransferSource* source)
+{
+    Transfer* transfer = reserve(client);
+    if (transfer == nullptr)
+    {
+        delete source;
+        return false;
+    }
+    transfer->source = source;
+    transfer->head = head;
+    transfer->head += "Transfer-Encoding: chunked\r\n\r\n";
+    transfer->data = (const uint8_t*) transfer->head.c_str();
+    transfer->length = transfer->head.length();
+    return true;
+}
+
+bool TransferQueue::advance(Transfer& transfer)
+{
+    if (transfer.source == nullptr)
+        return false;
+
+    switch (transfer.stage)
+    {
+        case STAGE_BODY:
+        case STAGE_TRAILER:
+        {
+            // The head or the previous chunk is out, the source may reuse its buffer
+            transfer.head = String();
+            size_t length = 0;
+            if (!transfer.source->next(transfer.piece, length))
+                return false;
+            if (length == 0)
+            {
+                transfer.stage = STAGE_END;
+                transfer.data = (const uint8_t*) LAST_CHUNK;
+                transfer.length = sizeof(LAST_CHUNK) - 1;
+                break;
+            }
+            transfer.piece_length = length;
+            transfer.stage = STAGE_SIZE;
+            transfer.data = (const uint8_t*) transfer.size_line;
+            transfer.length = snprintf(transfer.size_line, sizeof(transfer.size_line), "%x\r\n",
+                                       (unsigned) length);
+            break;
+        }
+        case STAGE_SIZE:
+            transfer.stage = STAGE_PIECE;
+            transfer.data = transfer.piece;
+            transfer.length = transfer.piece_length;
+            break;
+        case STAGE_PIECE:
+            transfer.stage = STAGE_TRAILER;
+            transfer.data = (const uint8_t*) CHUNK_END;
+            transfer.length = sizeof(CHUNK_END) - 1;
+            break;
+        case STAGE_END:
+        default:
+            return false;
+    }
+    transfer.sent = 0;
+    return true;
+}
+
+void TransferQueue::loop()
+{
+    if (_count == 0)
+        return;
+
+    unsigned long now = millis();
+    for (size_t i = 0; i < TRANSFER_QUEUE_SIZE; i++)
+    {
+        Transfer& transfer = _transfers[i];
+        if (!transfer.active)
+            continue;
+
+        // One slice per pass, the regions of a chunk framing are written as they fit
+        size_t budget = TRANSFER_SLICE_SIZE;
+        bool done = false;
+        while (budget > 0)
+        {
+            if (transfer.sent == transfer.length && !advance(transfer))
+            {
+                done = true;
+                break;
+            }
+
+            size_t slice = transfer.length - transfer.sent;
+            if (slice > budget)
+                slice = budget;
+            // WiFiClient::write() waits for room in the socket, a plain send returns at once
+            int written =
+                send(transfer.client.fd(), transfer.data + transfer.sent, slice, MSG_DONTWAIT);
+            if (written > 0)
+            {
+                transfer.sent += written;
+                transfer.last_progress = now;
+                budget -= written;
+                if ((size_t) written < slice)
+                    break;
+            }
+            else if (written == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            {
+                done = true;
+                break;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        if (done || now - transfer.last_progress >= TRANSFER_STALL_TIMEOUT_MS)
+            finish(transfer);
+    }
+}
+
+void TransferQueue::finish(Transfer& transfer)
+{
+    // The response has no keep-alive, closing ends it. A generated body given up before its
+    // last chunk is seen as cut short by the client.
+    transfer.client.stop();
+    transfer.client = WiFiClient();
+    delete transfer.source;
+    transfer.source = nullptr;
+    transfer.head = String();
+    transfer.data = nullptr;
+    transfer.active = false;
+    _count--;
+}
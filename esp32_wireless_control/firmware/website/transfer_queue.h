@@ -0,0 +1,123 @@
+#ifndef TRANSFER_QUEUE_H
+#define TRANSFER_QUEUE_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+// Responses sent in the background at the same time, a request finding all taken gets a 503
+#define TRANSFER_QUEUE_SIZE 8
+// Bytes offered to one socket per pass, keeps a pass short when many transfers run
+#define TRANSFER_SLICE_SIZE 2048
+// A transfer without progress for this long is given up, the client is gone or stuck
+#define TRANSFER_STALL_TIMEOUT_MS 10000
+
+/**
+ * @class TransferSource
+ * @brief Produces a response body piece by piece for TransferQueue
+ *
+ * next() is only called once the previous piece is out, so a piece may live
+ * in a buffer of the source that the next call overwrites. The source reads
+ * what it sends when it is asked, not when the request came in.
+ */
+class TransferSource
+{
+  public:
+    virtual ~TransferSource()
+    {
+    }
+
+    /**
+     * @brief Produce the next piece of the body
+     * @param length Set to 0 once the body is complete
+     * @return false to give up, the client sees the response cut short
+     */
+    virtual bool next(const uint8_t*& data, size_t& length) = 0;
+};
+
+/**
+ * @class TransferQueue
+ * @brief Sends large response bodies without blocking the web server
+ *
+ * WebServer handles one request at a time and a body is written in one
+ * blocking call, so the web interface loading over a weak link held up every
+ * other request, stop-slew included. The connection is taken over here
+ * instead (copies of a WiFiClient share the socket) and the body is written
+ * from loop() with non-blocking sends, as much as the socket accepts, while
+ * WebServer goes on with the next request.
+ *
+ * A constant body (flash data) follows the headers WebServer already sent.
+ * A generated body is produced by a TransferSource while it is sent and goes
+ * out chunked behind a head written here: WebServer would end a chunked
+ * response as soon as the handler returns. Used from the web server task
+ * only.
+ */
+class TransferQueue
+{
+  public:
+    TransferQueue();
+
+    bool hasRoom() const
+    {
+        return _count < TRANSFER_QUEUE_SIZE;
+    }
+
+    /**
+     * @brief Send data to the client from loop() on, headers must be out already
+     * @return false if the queue is full, nothing is taken over then
+     */
+    bool start(WiFiClient& client, const uint8_t* data, size_t length);
+
+    /**
+     * @brief Send head and then the pieces of source chunked, from loop() on
+     * @param head Status line and headers, without Transfer-Encoding and the empty line
+     * @return false if the queue is full. The source is taken over in any case.
+     */
+    bool start(WiFiClient& client, const String& head, TransferSource* source);
+
+    // Write the next slice of every transfer the socket has room for, never blocks
+    void loop();
+
+    size_t getCount() const
+    {
+        return _count;
+    }
+
+  private:
+    // Part of a generated response being written
+    enum Stage
+    {
+        STAGE_BODY = 0, // Constant body, or the head of a generated one
+        STAGE_SIZE,     // Size line of a chunk
+        STAGE_PIECE,    // Data of a chunk
+        STAGE_TRAILER,  // End of a chunk
+        STAGE_END       // Last chunk
+    };
+
+    struct Transfer
+    {
+        WiFiClient client;
+        // Region being written
+        const uint8_t* data;
+        size_t length;
+        size_t sent;
+        unsigned long last_progress;
+        bool active;
+        // Generated bodies only
+        TransferSource* source;
+        String head;
+        Stage stage;
+        const uint8_t* piece;
+        size_t piece_length;
+        char size_line[12];
+    };
+
+    Transfer* reserve(WiFiClient& client);
+    // Move on to the next region of a generated body, false once there is none
+    bool advance(Transfer& transfer);
+    void finish(Transfer& transfer);
+
+    Transfer _transfers[TRANSFER_QUEUE_SIZE];
+    size_t _count;
+};
+
+#endif // TRANSFER_QUEUE_H
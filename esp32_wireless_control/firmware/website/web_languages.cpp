@@ -120,6 +120,7 @@ const char* const HTMLplaceHolders[numberOfHTMLStrings] PROGMEM = {
   "%STR_TUNE_RATE%",
   "%STR_RATE_PRESET%",
   "%STR_SAVE_RATE_PRESET%",
-  "%STR_LOAD_RATE_PRESET%"
+  "%STR_LOAD_RATE_PRESET%",
+  "%STR_STAR_CATALOG_ALL%"
 };
 /* clang-format on */
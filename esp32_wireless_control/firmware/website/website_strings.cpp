@@ -27,6 +27,23 @@ const char* DISABLE_TRACKING_ON_FINISH = "disableTrackingOnFinish";
 const char* MIME_TYPE_TEXT = "text/plain";
 const char* MIME_TYPE_HTML = "text/html";
 const char* MIME_APPLICATION_JSON = "application/json";
+const char* MIME_APPLICATION_OCTET_STREAM = "application/octet-stream";
+const char* MIME_PROMETHEUS_TEXT = "text/plain; version=0.0.4; charset=utf-8";
 const char* GOTO_RA = "gotoRA";
 const char* STAR_CATALOG = "starCatalog";
 const char* STAR_NAME = "starName";
+const char* UTC_TIME = "utcTime";
+const char* LATITUDE = "lat";
+const char* LONGITUDE = "lon";
+const char* MIN_ALTITUDE = "minAltitude";
+const char* MIN_MAGNITUDE = "minMagnitude";
+const char* MAX_MAGNITUDE = "maxMagnitude";
+const char* SORT_ORDER = "sort";
+const char* RESULT_LIMIT = "limit";
+const char* RESULT_OFFSET = "offset";
+const char* RESULT_AFTER = "after";
+const char* SKY_TILE = "tile";
+const char* OBJECT_TYPE = "type";
+const char* CONSTELLATION = "constellation";
+const char* MIN_SIZE = "minSize";
+const char* MAX_SIZE = "maxSize";
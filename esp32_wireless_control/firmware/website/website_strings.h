@@ -28,8 +28,25 @@ extern const char* DISABLE_TRACKING_ON_FINISH;
 extern const char* MIME_TYPE_TEXT;
 extern const char* MIME_TYPE_HTML;
 extern const char* MIME_APPLICATION_JSON;
+extern const char* MIME_APPLICATION_OCTET_STREAM;
+extern const char* MIME_PROMETHEUS_TEXT;
 extern const char* GOTO_RA;
 extern const char* STAR_CATALOG;
 extern const char* STAR_NAME;
+extern const char* UTC_TIME;
+extern const char* LATITUDE;
+extern const char* LONGITUDE;
+extern const char* MIN_ALTITUDE;
+extern const char* MIN_MAGNITUDE;
+extern const char* MAX_MAGNITUDE;
+extern const char* SORT_ORDER;
+extern const char* RESULT_LIMIT;
+extern const char* RESULT_OFFSET;
+extern const char* RESULT_AFTER;
+extern const char* SKY_TILE;
+extern const char* OBJECT_TYPE;
+extern const char* CONSTELLATION;
+extern const char* MIN_SIZE;
+extern const char* MAX_SIZE;
 
 #endif // STRINGS_H